@@ -24,6 +24,7 @@
 
 #include <algorithm>
 
+#ifdef _WIN32
 namespace {
 HFONT GetDefaultFont()
 {
@@ -138,6 +139,38 @@ bool LICE_SysBitmap::resizeInternal(int w, int h)
 
     return true;
 }
+#endif // _WIN32
+
+LICE_MemBitmap::LICE_MemBitmap(int w, int h)
+{
+    resize(w, h);
+}
+
+LICE_MemBitmap::~LICE_MemBitmap()
+{
+    delete[] m_bits;
+}
+
+bool LICE_MemBitmap::resize(int w, int h)
+{
+    if (w == m_width && h == m_height)
+        return false;
+
+    delete[] m_bits;
+    m_bits = nullptr;
+    m_width = 0;
+    m_height = 0;
+
+    if (w <= 0 || h <= 0)
+        return true;
+
+    const size_t totalPixels = static_cast<size_t>(w) * static_cast<size_t>(h);
+    m_bits = new LICE_pixel[totalPixels];
+    std::fill(m_bits, m_bits + totalPixels, 0);
+    m_width = w;
+    m_height = h;
+    return true;
+}
 
 static void FillSpan(LICE_pixel* row, int start, int end, LICE_pixel color)
 {
@@ -228,6 +261,7 @@ void LICE_DrawRect(LICE_IBitmap* dest, int x, int y, int w, int h, LICE_pixel co
     }
 }
 
+#ifdef _WIN32
 namespace {
 HDC GetMeasureDC()
 {
@@ -346,3 +380,4 @@ void LICE_DrawText(LICE_IBitmap* bm, int x, int y, const char* string, LICE_pixe
     if (oldFont)
         SelectObject(hdc, oldFont);
 }
+#endif // _WIN32
@@ -23,6 +23,7 @@
 #ifndef WDL_LICE_LICE_H
 #define WDL_LICE_LICE_H
 
+#ifdef _WIN32
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #endif
@@ -30,6 +31,14 @@
 #define NOMINMAX
 #endif
 #include <windows.h>
+#else
+// Elsewhere only the memory bitmap and the fill primitives are built; RECT
+// is laid out as SWELL declares it.
+typedef struct tagRECT
+{
+    int left, top, right, bottom;
+} RECT;
+#endif
 #include <cstddef>
 #include <cstdint>
 
@@ -56,9 +65,12 @@ public:
     virtual int getRowSpan() = 0;
     virtual bool isFlipped() { return false; }
     virtual bool resize(int w, int h) = 0;
+#ifdef _WIN32
     virtual HDC getDC() { return nullptr; }
+#endif
 };
 
+#ifdef _WIN32
 class LICE_SysBitmap : public LICE_IBitmap
 {
 public:
@@ -88,13 +100,37 @@ private:
     HBITMAP m_bitmap = nullptr;
     HGDIOBJ m_oldBitmap = nullptr;
 };
+#endif // _WIN32
+
+class LICE_MemBitmap : public LICE_IBitmap
+{
+public:
+    explicit LICE_MemBitmap(int w = 0, int h = 0);
+    ~LICE_MemBitmap() override;
+
+    LICE_MemBitmap(const LICE_MemBitmap&) = delete;
+    LICE_MemBitmap& operator=(const LICE_MemBitmap&) = delete;
+
+    LICE_pixel* getBits() override { return m_bits; }
+    int getWidth() override { return m_width; }
+    int getHeight() override { return m_height; }
+    int getRowSpan() override { return m_width; }
+    bool resize(int w, int h) override;
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    LICE_pixel* m_bits = nullptr;
+};
 
 void LICE_Clear(LICE_IBitmap* dest, LICE_pixel color, float alpha = 1.0f, int mode = LICE_BLIT_MODE_COPY);
 void LICE_FillRect(LICE_IBitmap* dest, int x, int y, int w, int h, LICE_pixel color, float alpha = 1.0f, int mode = LICE_BLIT_MODE_COPY);
 void LICE_DrawRect(LICE_IBitmap* dest, int x, int y, int w, int h, LICE_pixel color, float alpha = 1.0f, int mode = LICE_BLIT_MODE_COPY);
+#ifdef _WIN32
 void LICE_DrawText(LICE_IBitmap* bm, int x, int y, const char* string, LICE_pixel color, float alpha = 1.0f, int mode = LICE_BLIT_MODE_COPY);
 void LICE_MeasureText(const char* string, int* w, int* h);
 
 #define LICE_Scale_BitBlt(hdc, x, y, w, h, src, sx, sy, mode) StretchBlt((hdc), (x), (y), (w), (h), (src)->getDC(), (sx), (sy), (w), (h), (mode))
+#endif // _WIN32
 
 #endif // WDL_LICE_LICE_H
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class EnvelopeStage
+{
+    Idle,
+    Attack,
+    Decay,
+    Sustain,
+    Release,
+};
+
+// Where a voice is within its current segment. Owned by the voice; the
+// envelope keeps it in step and recounts it whenever the stage, the value or
+// the envelope's settings changed behind its back, so callers may keep
+// assigning stage and value directly.
+struct AdsrSegment
+{
+    EnvelopeStage stage = EnvelopeStage::Idle;
+    std::uint32_t generation = 0;
+    // Samples left in the segment, including the one that lands on its target.
+    std::uint64_t remaining = 0;
+    double value = 0.0;
+};
+
+// Exponential ADSR shared by every voice of a track. Each segment closes in
+// on its target by a fixed ratio per sample and snaps to it once within
+// 1e-5, so a segment's length is known up front: the ratios are worked out
+// only when the settings change and a voice's countdown only when it enters
+// a segment.
+class AdsrEnvelope
+{
+public:
+    static constexpr double kEpsilon = 1e-5;
+
+    // Times in seconds. Cheap when nothing changed, so it can be called with
+    // modulated values every sample.
+    void configure(double attack, double decay, double sustain, double release, double sampleRate);
+
+    // Advances one sample and returns the new value; stage moves on in the
+    // sample that reaches a segment's target.
+    double advance(EnvelopeStage& stage, double value, AdsrSegment& segment) const;
+
+    // Renders up to frames samples, stopping after the sample in which the
+    // stage changes so callers can act on it (retire an idle voice, say).
+    // Returns the number of samples written.
+    std::size_t render(EnvelopeStage& stage, double& value, AdsrSegment& segment, float* out,
+                       std::size_t frames) const;
+
+    // Samples until the current stage ends, counting the one that ends it;
+    // 0 for the open-ended Idle and Sustain stages.
+    std::uint64_t samplesUntilStageEnd(EnvelopeStage stage, double value, AdsrSegment& segment) const;
+
+    [[nodiscard]] double sustain() const noexcept { return m_sustain; }
+    [[nodiscard]] std::uint32_t generation() const noexcept { return m_generation; }
+
+private:
+    struct Curve
+    {
+        double target = 0.0;
+        double coefficient = 0.0;
+    };
+
+    bool curveFor(EnvelopeStage stage, Curve& curve) const;
+    void sync(EnvelopeStage stage, double value, AdsrSegment& segment) const;
+    static double coefficientFor(double seconds, double sampleRate);
+    static std::uint64_t segmentLength(double value, const Curve& curve);
+    static EnvelopeStage nextStage(EnvelopeStage stage);
+
+    double m_attack = -1.0;
+    double m_decay = -1.0;
+    double m_sustain = 0.0;
+    double m_release = -1.0;
+    double m_sampleRate = 0.0;
+    double m_attackCoefficient = 0.0;
+    double m_decayCoefficient = 0.0;
+    double m_releaseCoefficient = 0.0;
+    std::uint32_t m_generation = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+// Heap buffer whose storage starts on a 64-byte boundary, enough for any
+// vector width the DSP kernels are compiled for and a whole cache line.
+// Grows only; resize() allocates just when the buffer has to get bigger, so
+// the audio thread can call it every block once the largest size was seen.
+template <typename T>
+class AlignedBuffer
+{
+public:
+    static constexpr std::size_t kAlignment = 64;
+
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(std::size_t size) { resize(size); }
+
+    void resize(std::size_t size)
+    {
+        if (size > m_capacity)
+        {
+            m_data.reset(static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t(kAlignment))));
+            m_capacity = size;
+            std::fill(m_data.get(), m_data.get() + m_capacity, T{});
+        }
+        m_size = size;
+    }
+
+    void clear() { std::fill(m_data.get(), m_data.get() + m_size, T{}); }
+
+    [[nodiscard]] T* data() noexcept { return m_data.get(); }
+    [[nodiscard]] const T* data() const noexcept { return m_data.get(); }
+    [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+    T& operator[](std::size_t index) noexcept { return m_data[index]; }
+    const T& operator[](std::size_t index) const noexcept { return m_data[index]; }
+
+private:
+    struct Deleter
+    {
+        void operator()(T* data) const { ::operator delete(data, std::align_val_t(kAlignment)); }
+    };
+
+    std::unique_ptr<T[], Deleter> m_data;
+    std::size_t m_size = 0;
+    std::size_t m_capacity = 0;
+};
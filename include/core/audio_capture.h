@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/sample_loader.h"
+
+// Single-producer single-consumer ring of interleaved float frames. The
+// capture thread writes, one consumer (disk writer or monitor) reads; neither
+// side locks or allocates after construction.
+class AudioFrameRing
+{
+public:
+    AudioFrameRing(std::size_t capacityFrames, int channels);
+
+    int channels() const { return m_channels; }
+    std::size_t capacityFrames() const { return m_capacityFrames; }
+
+    // Writes all frames or none; false if they do not fit.
+    bool write(const float* interleaved, std::size_t frames);
+    // Reads up to maxFrames frames and returns how many were read.
+    std::size_t read(float* interleaved, std::size_t maxFrames);
+    // Drops up to frames frames from the reading side.
+    std::size_t skip(std::size_t frames);
+    std::size_t availableFrames() const;
+
+private:
+    std::vector<float> m_samples;
+    std::size_t m_capacityFrames = 0;
+    int m_channels = 0;
+    std::atomic<std::size_t> m_readFrame{0};
+    std::atomic<std::size_t> m_writeFrame{0};
+};
+
+// Source of input audio. After start() the backend calls the sink from its
+// own thread with interleaved float frames until stop().
+class AudioCaptureBackend
+{
+public:
+    using FrameSink = std::function<void(const float* interleaved, std::uint32_t frames)>;
+
+    virtual ~AudioCaptureBackend() = default;
+
+    virtual bool start(FrameSink sink) = 0;
+    virtual void stop() = 0;
+
+    // Valid once start() succeeded.
+    virtual int channels() const = 0;
+    virtual int sampleRate() const = 0;
+    // Capture latency reported by the device: how late a frame reaches the
+    // sink after it hit the converter.
+    virtual std::uint32_t latencyFrames() const = 0;
+};
+
+struct AudioInputDevice
+{
+    std::wstring id;
+    std::wstring name;
+};
+
+std::vector<AudioInputDevice> enumerateAudioInputDevices();
+
+// WASAPI shared-mode capture on Windows (the default input when deviceId is
+// empty); a backend that never starts elsewhere.
+std::unique_ptr<AudioCaptureBackend> createDefaultAudioCaptureBackend(const std::wstring& deviceId = L"");
+
+// Plays a sample buffer as if it came from an input device, in packets of
+// packetFrames. realtime paces the packets at the buffer's sample rate;
+// otherwise they are delivered as fast as the sink takes them. Lets the
+// recording path run without audio hardware.
+class BufferAudioCaptureBackend : public AudioCaptureBackend
+{
+public:
+    BufferAudioCaptureBackend(std::shared_ptr<const SampleBuffer> source, std::uint32_t packetFrames,
+                              std::uint32_t latencyFrames = 0, bool realtime = true);
+    ~BufferAudioCaptureBackend() override;
+
+    bool start(FrameSink sink) override;
+    void stop() override;
+    // True once every frame of the source was delivered.
+    bool finished() const { return m_finished.load(std::memory_order_acquire); }
+
+    int channels() const override { return m_source ? m_source->channels : 0; }
+    int sampleRate() const override { return m_source ? m_source->sampleRate : 0; }
+    std::uint32_t latencyFrames() const override { return m_latencyFrames; }
+
+private:
+    std::shared_ptr<const SampleBuffer> m_source;
+    std::uint32_t m_packetFrames = 0;
+    std::uint32_t m_latencyFrames = 0;
+    bool m_realtime = true;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_finished{false};
+};
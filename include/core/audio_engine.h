@@ -1,17 +1,97 @@
 #pragma once
 
+#include "core/effects/pan_gain_stage.h"
+
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+namespace kj
+{
+class PluginDatabase;
+class VST3Host;
+}
+
 extern std::atomic<bool> isPlaying;
 void initAudio();
 void shutdownAudio();
+// Sample rate of the running output device, or 0 before it has started.
+double getAudioEngineSampleRate();
 bool loadSampleFile(int trackId, const std::filesystem::path& path);
-bool requestTrackVstLoad(int trackId, const std::filesystem::path& path);
+// Records the default audio input to path (.caf as CAF, otherwise 32-bit
+// float WAV). On stop the take replaces the track's sample buffer directly.
+bool startTrackRecording(int trackId, const std::filesystem::path& path);
+bool stopTrackRecording();
+bool isTrackRecording();
+// Mixes the audio input into the master output when its sample rate matches
+// the output device.
+void setInputMonitoring(bool enabled);
+bool inputMonitoringEnabled();
+// Loads the plug-in into a new host on the loader pool and swaps it into the
+// track once it is prepared; the track keeps playing its current plug-in until
+// then. onLoaded runs on a loader thread.
+bool requestTrackVstLoad(int trackId, const std::filesystem::path& path,
+                         std::function<void(bool)> onLoaded = {});
+// Same as requestTrackVstLoad, then applies state saved by
+// VST3Host::saveState before the host goes live. Project load queues every
+// plug-in this way so they restore in parallel.
+bool requestTrackVstRestore(int trackId, const std::filesystem::path& path, std::vector<std::uint8_t> state,
+                            std::function<void(bool)> onLoaded = {});
 bool requestTrackVstUnload(int trackId);
+// Records GUI edits and the plug-in's own parameter changes on a VST track
+// while the transport runs. Turning it off merges the take into the track's
+// automation lanes, replacing what they had over the recorded range.
+bool setTrackAutomationRecording(int trackId, bool enabled);
+bool trackAutomationRecording(int trackId);
+// Unloads a host that has been removed from its track once nothing else
+// references it.
+void retireVstHost(std::shared_ptr<kj::VST3Host> host);
+// Loads plug-ins into worker processes so a crash or hang only silences their
+// own tracks. Applies to plug-ins loaded afterwards.
+void setPluginSandboxEnabled(bool enabled);
+bool pluginSandboxEnabled();
+// Pan law every track is mixed with; saved with the project. Changing it
+// ramps the track gains rather than stepping them.
+void setPanLaw(PanLaw law);
+PanLaw getPanLaw();
+// Plug-ins in the standard VST3 folders. initAudio loads the on-disk cache
+// and scans new or changed bundles in the background.
+kj::PluginDatabase& getPluginDatabase();
+
+// Where in a track's chain a NaN or infinity first showed up.
+enum class TrackFaultStage
+{
+    Source,
+    Equalizer,
+    Compressor,
+    Delay,
+    Reverb,
+    Output,
+};
+constexpr std::size_t kTrackFaultStageCount = 6;
+
+struct TrackFaultReport
+{
+    int trackId = -1;
+    TrackFaultStage stage = TrackFaultStage::Source;
+    std::uint64_t count = 0;
+};
+
+// A track whose block came out non-finite is muted and its DSP state reset;
+// it plays again after its next clean block. Counts are per track and stage
+// for the life of the process. Lock-free; safe to poll from the UI.
+std::vector<TrackFaultReport> getTrackFaultReports();
+std::uint64_t getTrackFaultTotal();
+
+// Tracks the mixer skipped in the last block because nothing could come out
+// of them: idle source and decayed tails. A note or a sequencer reset wakes
+// them. Lock-free.
+int getSleepingTrackCount();
 
 struct AudioThreadNotification
 {
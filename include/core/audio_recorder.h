@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/audio_capture.h"
+#include "core/sample_loader.h"
+
+// Streams captured audio to disk. The capture thread pushes frames into a
+// lock-free ring; a writer thread drains it in large chunks into a
+// preallocated 32-bit float WAV or CAF file whose sample data starts on a
+// 4 KiB boundary, and keeps the same frames in memory so a finished take can
+// go straight to a sampler track.
+class AudioRecorder
+{
+public:
+    enum class FileFormat
+    {
+        Wav,
+        Caf,
+    };
+
+    struct Take
+    {
+        std::filesystem::path path;
+        std::shared_ptr<const SampleBuffer> buffer;
+        std::uint64_t frames = 0;
+        // Frames lost because the writer fell behind and the ring was full.
+        std::uint64_t droppedFrames = 0;
+        // Frames trimmed from the start to line the take up with the transport.
+        std::uint32_t compensatedFrames = 0;
+    };
+
+    static constexpr std::size_t kWriteChunkBytes = 256 * 1024;
+    static constexpr std::uint64_t kPreallocateBytes = 32ull * 1024 * 1024;
+
+    AudioRecorder();
+    ~AudioRecorder();
+    AudioRecorder(const AudioRecorder&) = delete;
+    AudioRecorder& operator=(const AudioRecorder&) = delete;
+
+    // .caf files are written as CAF, everything else as WAV. The first
+    // latencyFrames frames pushed are dropped, so the take starts at the
+    // moment recording was started rather than when its audio arrived.
+    // ringSeconds of audio can be buffered before frames are dropped.
+    bool start(const std::filesystem::path& path, int channels, int sampleRate, std::uint32_t latencyFrames = 0,
+               double ringSeconds = 4.0);
+    // Capture thread; never locks, allocates or touches the file. False if
+    // the frames did not fit and were dropped.
+    bool push(const float* interleaved, std::uint32_t frames);
+    // Drains the ring, finalises the file and trims the preallocated tail.
+    bool stop(Take& take);
+
+    bool recording() const { return m_recording.load(std::memory_order_acquire); }
+    std::uint64_t framesWritten() const { return m_framesWritten.load(std::memory_order_acquire); }
+
+    static FileFormat formatForPath(const std::filesystem::path& path);
+
+private:
+    void writerLoop();
+    bool writeChunk(const float* interleaved, std::size_t frames);
+    bool ensurePreallocated(std::uint64_t endOffset);
+    bool setFileSize(std::uint64_t size);
+    bool writeHeader(std::uint64_t dataBytes, bool final);
+
+    std::filesystem::path m_path;
+    FileFormat m_format = FileFormat::Wav;
+    std::FILE* m_file = nullptr;
+    int m_channels = 0;
+    int m_sampleRate = 0;
+    std::uint64_t m_dataOffset = 0;
+    std::uint64_t m_preallocatedEnd = 0;
+    bool m_writeFailed = false;
+
+    std::unique_ptr<AudioFrameRing> m_ring;
+    std::vector<float> m_chunk;
+    std::shared_ptr<SampleBuffer> m_buffer;
+    // Counted down by the capture thread only.
+    std::atomic<std::uint32_t> m_latencyToSkip{0};
+    std::uint32_t m_latencyFrames = 0;
+    std::atomic<std::uint64_t> m_droppedFrames{0};
+    std::atomic<std::uint64_t> m_framesWritten{0};
+
+    std::thread m_writer;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_recording{false};
+    std::atomic<bool> m_stopRequested{false};
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core/tracks.h"
+
+#include <array>
+#include <filesystem>
+#include <memory>
+
+class ConvolutionReverb;
+
+// One shared effect bus. Tracks feed it through their send levels; its
+// effect chain runs once per block on the sum and the result is added to
+// the master at returnLevel.
+struct AuxBus
+{
+    float returnLevel = 1.0f;
+    bool delayEnabled = true;
+    float delayTimeMs = 350.0f;
+    float delayFeedback = 0.35f;
+    // Runs after the delay once an impulse response is loaded.
+    bool reverbEnabled = true;
+};
+
+std::array<AuxBus, kAuxBusCount> getAuxBuses();
+AuxBus auxBusGet(int busIndex);
+
+void auxBusSetReturnLevel(int busIndex, float level);
+void auxBusSetDelayEnabled(int busIndex, bool enabled);
+void auxBusSetDelayTimeMs(int busIndex, float value);
+void auxBusSetDelayFeedback(int busIndex, float value);
+void auxBusSetReverbEnabled(int busIndex, bool enabled);
+
+// Reads an impulse response with the sample loader and gives the bus a
+// convolution reverb built from it. Returns false, leaving the bus as it
+// was, when the file cannot be read.
+bool auxBusLoadReverbImpulse(int busIndex, const std::filesystem::path& path);
+void auxBusClearReverbImpulse(int busIndex);
+// Empty when the bus has no impulse response.
+std::filesystem::path auxBusGetReverbImpulsePath(int busIndex);
+
+// Reverb of every bus, prepared for sampleRate; null where no impulse
+// response is loaded. Building one is expensive, so this happens here, on
+// the caller's thread, for a new response or a new sample rate. Keep it off
+// the render thread.
+std::array<std::shared_ptr<ConvolutionReverb>, kAuxBusCount> getAuxBusReverbs(double sampleRate);
+
+// Back to the defaults, as for a new project.
+void resetAuxBuses();
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#define KJ_DENORMALS_SSE 1
+#elif defined(_M_ARM64)
+#include <float.h>
+#define KJ_DENORMALS_MSVC_ARM64 1
+#elif defined(__aarch64__)
+#define KJ_DENORMALS_AARCH64 1
+#endif
+
+// Puts the calling thread into flush-to-zero / denormals-are-zero mode for
+// its lifetime and restores the previous mode on destruction. Decaying tails
+// (delay feedback, filter state, envelope releases) otherwise end up in
+// subnormal numbers, which cost tens to hundreds of cycles per operation.
+// Create one at the top of every thread that renders audio.
+class ScopedDenormalFlush
+{
+public:
+    ScopedDenormalFlush()
+        : m_previous(readMode())
+    {
+        writeMode(m_previous | kFlushBits);
+    }
+
+    ~ScopedDenormalFlush() { writeMode(m_previous); }
+
+    ScopedDenormalFlush(const ScopedDenormalFlush&) = delete;
+    ScopedDenormalFlush& operator=(const ScopedDenormalFlush&) = delete;
+
+    // True when the calling thread flushes denormals; false on targets where
+    // the mode cannot be set.
+    static bool active() { return kFlushBits != 0 && (readMode() & kFlushBits) == kFlushBits; }
+
+private:
+#if defined(KJ_DENORMALS_SSE)
+    // MXCSR flush-to-zero and denormals-are-zero.
+    static constexpr std::uint64_t kFlushBits = 0x8000 | 0x0040;
+    static std::uint64_t readMode() { return _mm_getcsr(); }
+    static void writeMode(std::uint64_t mode) { _mm_setcsr(static_cast<unsigned int>(mode)); }
+#elif defined(KJ_DENORMALS_MSVC_ARM64)
+    static constexpr std::uint64_t kFlushBits = _DN_FLUSH;
+    static std::uint64_t readMode()
+    {
+        unsigned int control = 0;
+        _controlfp_s(&control, 0, 0);
+        return control & _MCW_DN;
+    }
+    static void writeMode(std::uint64_t mode)
+    {
+        unsigned int control = 0;
+        _controlfp_s(&control, static_cast<unsigned int>(mode) & _MCW_DN, _MCW_DN);
+    }
+#elif defined(KJ_DENORMALS_AARCH64)
+    // FPCR.FZ; AArch64 has no separate input flag, FZ covers both.
+    static constexpr std::uint64_t kFlushBits = 1ull << 24;
+    static std::uint64_t readMode()
+    {
+        std::uint64_t fpcr = 0;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+        return fpcr;
+    }
+    static void writeMode(std::uint64_t mode) { __asm__ __volatile__("msr fpcr, %0" : : "r"(mode)); }
+#else
+    static constexpr std::uint64_t kFlushBits = 0;
+    static std::uint64_t readMode() { return 0; }
+    static void writeMode(std::uint64_t) {}
+#endif
+
+    std::uint64_t m_previous;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Sample type of the block stages of the mix: the master bus, sends, aux
+// buses and the conversion to the device format. 32-bit float by default,
+// which doubles the samples per vector over double; configure with
+// KJ_DSP_DOUBLE_PRECISION=ON to run them in 64-bit instead.
+//
+// The per-track renderer ahead of them stays scalar double. It runs every
+// track one frame at a time because sidechains feed one track's level into
+// another within the frame, so there is no vector to fill there until it
+// is rebuilt around blocks; float would only add conversions. That rebuild
+// is open work, see docs/roadmap.md.
+#if defined(KJ_DSP_DOUBLE_PRECISION)
+using MixSample = double;
+#else
+using MixSample = float;
+#endif
+
+// Stages whose error accumulates across samples - phase accumulators,
+// biquads tuned far below the sample rate - keep 64-bit state whatever
+// MixSample is.
+using StateSample = double;
+
+#if defined(_MSC_VER)
+#define KJ_RESTRICT __restrict
+#else
+#define KJ_RESTRICT __restrict__
+#endif
+
+// Block kernels for planar buffers. Plain loops over restrict pointers with
+// no branches in the body, so the compiler vectorises them for whatever the
+// target offers (SSE2, AVX2, NEON). Instantiated for float and double.
+namespace dsp
+{
+    template <typename T>
+    void add(T* KJ_RESTRICT destination, const T* KJ_RESTRICT source, std::size_t frames);
+
+    template <typename T>
+    void addScaled(T* KJ_RESTRICT destination, const T* KJ_RESTRICT source, T gain, std::size_t frames);
+
+    template <typename T>
+    void applyGain(T* samples, T gain, std::size_t frames);
+
+    // Linear ramp from startGain at the first frame towards endGain, reaching
+    // it one frame past the end, so consecutive blocks join without a step.
+    template <typename T>
+    void applyGainRamp(T* samples, T startGain, T endGain, std::size_t frames);
+
+    template <typename T>
+    void clamp(T* samples, T low, T high, std::size_t frames);
+
+    // Replaces NaN and infinity with silence and returns how many samples it
+    // replaced. Branch-free, so checking a whole block costs about as much
+    // as a copy.
+    template <typename T>
+    std::size_t replaceNonFinite(T* samples, std::size_t frames);
+
+    // Adds an interleaved stereo float stream (the monitor feed, a plug-in
+    // output) onto a planar pair.
+    template <typename T>
+    void addInterleavedStereo(T* KJ_RESTRICT left, T* KJ_RESTRICT right, const float* KJ_RESTRICT interleaved,
+                              std::size_t frames);
+
+    // Writes a planar stereo pair to an interleaved device buffer. One channel
+    // gets the mono sum; channels past the second are silenced.
+    template <typename T>
+    void interleaveToFloat(const T* KJ_RESTRICT left, const T* KJ_RESTRICT right, float* KJ_RESTRICT output,
+                           std::size_t frames, std::size_t channels);
+    // As above, rounding to 16-bit PCM. Input is expected within [-1, 1].
+    template <typename T>
+    void interleaveToInt16(const T* KJ_RESTRICT left, const T* KJ_RESTRICT right, std::int16_t* KJ_RESTRICT output,
+                           std::size_t frames, std::size_t channels);
+
+    template <typename T>
+    void downmixToMono(const T* KJ_RESTRICT left, const T* KJ_RESTRICT right, float* KJ_RESTRICT output,
+                       std::size_t frames);
+
+    // Transposed direct form II. Coefficients are normalised by a0.
+    struct BiquadCoefficients
+    {
+        double b0 = 1.0;
+        double b1 = 0.0;
+        double b2 = 0.0;
+        double a1 = 0.0;
+        double a2 = 0.0;
+    };
+
+    template <typename S>
+    struct BiquadState
+    {
+        S z1 = 0;
+        S z2 = 0;
+    };
+
+    // The recursion is serial, so this is about precision rather than width:
+    // samples are T, the state and arithmetic are S.
+    template <typename T, typename S>
+    void processBiquad(const BiquadCoefficients& coefficients, BiquadState<S>& state, T* samples,
+                       std::size_t frames);
+} // namespace dsp
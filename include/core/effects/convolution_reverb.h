@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct SampleBuffer;
+
+// Stereo convolution with a recorded impulse response, wet only. Meant for
+// an aux bus, where one instance serves every track sending to it.
+//
+// The response is split into three stages so that nothing adds latency and
+// the cost per block stays flat however long the response is:
+//   head - the first kHeadLength taps, as a direct FIR on every frame;
+//   body - up to kTailOffset, in kHeadLength partitions, run through the FFT
+//          on the render thread each time kHeadLength frames have come in;
+//   tail - the rest, in kTailPartition partitions, convolved on a worker
+//          thread while the next kTailPartition frames play.
+// The render thread never waits for the worker, which runs at audio
+// priority, and never convolves the tail itself. A job the worker has not
+// finished by its deadline, started or not, is added to the output as soon
+// as it finishes, late, and the next tail partition is held back until then.
+class ConvolutionReverb
+{
+public:
+    static constexpr std::size_t kHeadLength = 128;
+    static constexpr std::size_t kTailPartition = 2048;
+    static constexpr std::size_t kTailOffset = 2 * kTailPartition;
+    static constexpr double kMaxImpulseSeconds = 10.0;
+
+    // A mono response feeds both sides; with more channels the first two are
+    // used. The response is resampled to sampleRate, cut at
+    // kMaxImpulseSeconds and normalised to unit energy on its louder side.
+    // backgroundTail false convolves the tail on the calling thread instead,
+    // for offline renders.
+    ConvolutionReverb(const SampleBuffer& impulse, double sampleRate, bool backgroundTail = true);
+    ~ConvolutionReverb();
+
+    ConvolutionReverb(const ConvolutionReverb&) = delete;
+    ConvolutionReverb& operator=(const ConvolutionReverb&) = delete;
+
+    // Replaces the input with the reverb. Allocation-free and lock-free.
+    void process(float* left, float* right, std::size_t frameCount);
+    // Clears the reverb. Safe on the render thread: a tail job in flight is
+    // left to finish and its output dropped.
+    void reset();
+
+    [[nodiscard]] double sampleRate() const noexcept { return m_sampleRate; }
+    // Frames after the last non-silent input until the output is silent.
+    [[nodiscard]] std::size_t tailSamples() const noexcept { return m_impulseLength; }
+
+private:
+    struct Stage;
+    struct TailSignal;
+
+    void addToOutput(const float* left, const float* right, std::size_t frameCount);
+    bool collectTailJob();
+    bool releaseHeldTail();
+    void startTailJob(const float* left, const float* right);
+    void workerLoop();
+
+    double m_sampleRate;
+    std::size_t m_impulseLength = 0;
+
+    // Head FIR: taps, and the input history written twice so the taps always
+    // read one contiguous run.
+    std::vector<float> m_headLeft;
+    std::vector<float> m_headRight;
+    std::vector<float> m_historyLeft;
+    std::vector<float> m_historyRight;
+    std::size_t m_historyIndex = 0;
+
+    std::unique_ptr<Stage> m_body;
+    std::unique_ptr<Stage> m_tail;
+    std::size_t m_bodyFill = 0;
+    std::size_t m_tailFill = 0;
+    // Tail input gathering while the worker convolves the previous block.
+    std::vector<float> m_tailInputLeft;
+    std::vector<float> m_tailInputRight;
+    // A full tail partition held back while the worker is late with the one
+    // before; started at the first head boundary after that one finishes.
+    std::vector<float> m_heldInputLeft;
+    std::vector<float> m_heldInputRight;
+    bool m_tailHeld = false;
+    // Set by reset() while a job is running: drop its output and clear the
+    // tail stage once it finishes.
+    bool m_tailDiscard = false;
+
+    // Body and tail output, indexed by frame modulo the size; each stage adds
+    // into frames still to come and the head reads and clears the current one.
+    std::vector<float> m_outputLeft;
+    std::vector<float> m_outputRight;
+    std::size_t m_outputMask = 0;
+    std::size_t m_outputIndex = 0;
+
+    enum TailJobState : std::uint32_t
+    {
+        kTailIdle,
+        kTailQueued,
+        kTailRunning,
+        kTailDone,
+        kTailStop,
+    };
+    // Hand-off between the render thread and the worker; the worker sleeps
+    // on it between jobs.
+    std::atomic<std::uint32_t> m_tailJob{kTailIdle};
+    bool m_backgroundTail;
+    std::unique_ptr<TailSignal> m_signal;
+    std::thread m_worker;
+};
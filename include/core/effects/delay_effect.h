@@ -30,6 +30,9 @@ public:
     [[nodiscard]] float delayTimeMs() const noexcept { return m_delayTimeMs; }
     [[nodiscard]] float feedback() const noexcept { return m_feedback; }
     [[nodiscard]] float mix() const noexcept { return m_mix; }
+    // Frames of silent input after which the echoes still in the buffer have
+    // decayed below -120 dB with the current time and feedback.
+    [[nodiscard]] std::size_t tailSamples() const noexcept;
 
 private:
     void resizeBuffer(std::size_t requiredSamples);
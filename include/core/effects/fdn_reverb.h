@@ -0,0 +1,110 @@
+#pragma once
+
+#include "core/aligned_buffer.h"
+
+#include <array>
+#include <cstddef>
+
+// Algorithmic stereo reverb: an eight-line feedback delay network mixed by a
+// normalised Hadamard matrix, with a slowly modulated read on every line and
+// a one-pole damping filter in every feedback path. Cheap enough to run as a
+// track insert on many tracks at once.
+//
+// All per-line state is kept in fixed eight-wide arrays and the delay lines
+// are interleaved frame by frame, so every step of a frame is a plain loop
+// over kLineCount that the compiler turns into one or two vector operations,
+// like the block kernels in dsp_kernels.h.
+//
+// Parameters are smoothed once per block and ramped linearly across it;
+// beginBlock() does that and processFrame() runs one frame, for callers such
+// as the engine's per-frame insert chain. process() does both for a block.
+class FdnReverb
+{
+public:
+    static constexpr std::size_t kLineCount = 8;
+    static constexpr float kMinSize = 0.0f;
+    static constexpr float kMaxSize = 1.0f;
+    static constexpr float kMinDecaySeconds = 0.1f;
+    static constexpr float kMaxDecaySeconds = 10.0f;
+    static constexpr float kMinDamping = 0.0f;
+    static constexpr float kMaxDamping = 1.0f;
+    static constexpr float kMinMix = 0.0f;
+    static constexpr float kMaxMix = 1.0f;
+    static constexpr float kDefaultSize = 0.3f;
+    static constexpr float kDefaultDecaySeconds = 1.2f;
+    static constexpr float kDefaultDamping = 0.4f;
+    static constexpr float kDefaultMix = 0.25f;
+
+    explicit FdnReverb(double sampleRate = 44100.0);
+
+    // Sizes the delay lines for the largest room at sampleRate and clears
+    // them. The only call that allocates; does nothing if the rate is the
+    // one already prepared.
+    void prepare(double sampleRate);
+
+    // Targets the next blocks move towards.
+    void setSize(float value);
+    void setDecay(float seconds);
+    void setDamping(float value);
+    void setMix(float value);
+
+    void reset();
+
+    // Moves the parameters one block of frameCount frames towards their
+    // targets and ramps them across the frames that follow.
+    void beginBlock(std::size_t frameCount);
+    // Runs one frame in place. Allocation-free.
+    void processFrame(float& left, float& right);
+    void process(float* left, float* right, std::size_t frameCount);
+
+    [[nodiscard]] double sampleRate() const noexcept { return m_sampleRate; }
+    [[nodiscard]] float size() const noexcept { return m_size; }
+    [[nodiscard]] float decaySeconds() const noexcept { return m_decaySeconds; }
+    [[nodiscard]] float damping() const noexcept { return m_damping; }
+    [[nodiscard]] float mix() const noexcept { return m_mix; }
+    // Frames of silent input after which the network has decayed below
+    // -120 dB with the current decay time.
+    [[nodiscard]] std::size_t tailSamples() const noexcept;
+
+private:
+    using LineValues = std::array<float, kLineCount>;
+
+    void computeTargets(float size, float decaySeconds, LineValues& delays, LineValues& gains) const;
+
+    double m_sampleRate = 0.0;
+    float m_size = kDefaultSize;
+    float m_decaySeconds = kDefaultDecaySeconds;
+    float m_damping = kDefaultDamping;
+    float m_mix = kDefaultMix;
+
+    // Smoothed parameters as of the end of the current block.
+    float m_smoothedSize = kDefaultSize;
+    float m_smoothedDecay = kDefaultDecaySeconds;
+    float m_smoothedDamping = kDefaultDamping;
+    float m_smoothedMix = kDefaultMix;
+
+    // Frame-interleaved delay memory: frame f of line l lives at
+    // (f & m_ringMask) * kLineCount + l.
+    AlignedBuffer<float> m_ring;
+    std::size_t m_ringMask = 0;
+    std::size_t m_writeFrame = 0;
+    float m_modulationDepth = 0.0f;
+
+    // Per-frame values and their per-frame increments for the current block.
+    alignas(32) LineValues m_delay{};
+    alignas(32) LineValues m_delayStep{};
+    alignas(32) LineValues m_gain{};
+    alignas(32) LineValues m_gainStep{};
+    float m_dampingCoeff = 0.0f;
+    float m_dampingStep = 0.0f;
+    float m_wet = 0.0f;
+    float m_wetStep = 0.0f;
+    std::size_t m_rampFrames = 0;
+
+    alignas(32) LineValues m_lowpass{};
+    // Modulation oscillators, rotated by a fixed angle every frame.
+    alignas(32) LineValues m_lfoCos{};
+    alignas(32) LineValues m_lfoSin{};
+    alignas(32) LineValues m_lfoRotateCos{};
+    alignas(32) LineValues m_lfoRotateSin{};
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Built-in effects a track runs between its source and the fader.
+enum class InsertEffect : std::uint8_t
+{
+    Equalizer,
+    Compressor,
+    Delay,
+    Reverb,
+};
+constexpr int kInsertEffectCount = 4;
+
+// Processing order of a track's inserts; every effect appears exactly once.
+// Multiple instances per type, and the formant and sidechain stages as
+// inserts, are planned work (docs/roadmap.md).
+using InsertOrder = std::array<InsertEffect, kInsertEffectCount>;
+
+// The order the chain had before it could be changed, with the reverb last.
+constexpr InsertOrder kDefaultInsertOrder = {InsertEffect::Equalizer, InsertEffect::Compressor, InsertEffect::Delay,
+                                             InsertEffect::Reverb};
+
+bool isValidInsertOrder(const InsertOrder& order);
+
+// Moves the insert in slot from to slot to, shifting the ones in between.
+// Returns false, leaving order alone, for a slot out of range.
+bool moveInsert(InsertOrder& order, int from, int to);
+
+// Two bits per slot, so a track keeps its order in a single atomic word.
+// Unpacking anything that is not a valid order gives the default.
+std::uint32_t packInsertOrder(const InsertOrder& order);
+InsertOrder unpackInsertOrder(std::uint32_t packed);
+
+// Names used in project files.
+const char* insertEffectKey(InsertEffect effect);
+bool insertEffectFromKey(const std::string& key, InsertEffect& effect);
+
+// The inserts that actually run, in order. Compiled with the track snapshot,
+// off the render thread; bypassed inserts are left out, so the frame loop
+// neither runs nor tests them.
+struct InsertPlan
+{
+    std::array<InsertEffect, kInsertEffectCount> effects{};
+    std::uint8_t count = 0;
+};
+
+// enabled is indexed by InsertEffect.
+InsertPlan compileInsertPlan(const InsertOrder& order, const std::array<bool, kInsertEffectCount>& enabled);
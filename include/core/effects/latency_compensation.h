@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core/retiring_pool.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Stereo delay that lines a track up with the slowest track at the master bus.
+// The buffer is allocated once in prepare(); changing the delay afterwards
+// never allocates.
+class LatencyCompensationDelay
+{
+public:
+    // Longest compensation a track can receive (about 0.68 s at 48 kHz).
+    static constexpr int kMaxDelaySamples = 32768;
+
+    void prepare(int maxDelaySamples = kMaxDelaySamples);
+    void reset();
+
+    // Clamped to the prepared maximum.
+    void setDelay(int samples) noexcept;
+    [[nodiscard]] int delay() const noexcept { return m_delaySamples; }
+    [[nodiscard]] int maxDelay() const noexcept { return m_maxDelaySamples; }
+    [[nodiscard]] bool prepared() const noexcept { return !m_bufferLeft.empty(); }
+
+    void process(double& left, double& right) noexcept;
+
+private:
+    std::vector<double> m_bufferLeft;
+    std::vector<double> m_bufferRight;
+    std::size_t m_mask = 0;
+    std::size_t m_writeIndex = 0;
+    int m_maxDelaySamples = 0;
+    int m_delaySamples = 0;
+};
+
+// Compensation delays of every track, prepared off the render thread and
+// sized to the latency reported rather than kMaxDelaySamples. A track keeps
+// its delay while the size still fits; one that has to grow is replaced and
+// the old one retired.
+class LatencyCompensationPool : public RetiringPool<LatencyCompensationDelay>
+{
+public:
+    // Delay for trackId that can take maxDelaySamples; null while no track
+    // needs compensating and the track never had a delay.
+    std::shared_ptr<LatencyCompensationDelay> acquire(int trackId, int maxDelaySamples);
+};
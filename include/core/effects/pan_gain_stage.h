@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+// How a track is spread across the stereo pair. Named by the level each
+// side gets with the track panned to the centre.
+enum class PanLaw : std::uint8_t
+{
+    ConstantPower, // -3 dB, equal loudness across the field
+    Compromise,    // -4.5 dB, between constant power and linear
+    Linear,        // -6 dB, sums to unity in mono
+};
+constexpr int kPanLawCount = 3;
+
+struct PanGains
+{
+    double left = 1.0;
+    double right = 1.0;
+};
+
+// Gains for pan in [-1, 1] (clamped), interpolated from a per-law table.
+PanGains panLawGains(PanLaw law, double pan);
+
+// Volume and pan of one track. A new volume, pan or law moves the gains in
+// a linear ramp instead of a step, and the pan law is looked up only when
+// one of them changes, so the per-frame cost is two adds.
+class PanGainStage
+{
+public:
+    // Sets the gains to ramp to over rampFrames. The first target after
+    // construction or reset() is applied immediately.
+    void setTarget(PanLaw law, double volume, double pan, int rampFrames);
+    void reset();
+
+    // Gains for the current frame; advances the ramp by one frame.
+    PanGains next() noexcept
+    {
+        PanGains gains = m_current;
+        if (m_remaining > 0)
+        {
+            m_current.left += m_step.left;
+            m_current.right += m_step.right;
+            if (--m_remaining == 0)
+                m_current = m_target;
+        }
+        return gains;
+    }
+
+    [[nodiscard]] bool ramping() const noexcept { return m_remaining > 0; }
+    [[nodiscard]] PanGains target() const noexcept { return m_target; }
+
+private:
+    PanLaw m_law = PanLaw::ConstantPower;
+    double m_volume = 0.0;
+    double m_pan = 0.0;
+    bool m_hasTarget = false;
+    PanGains m_current;
+    PanGains m_target;
+    PanGains m_step;
+    int m_remaining = 0;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+// Topology-preserving (zero-delay-feedback) state-variable filter. All four
+// responses come out of one pass, and the coefficients are a table lookup
+// and a division, so cutoff and resonance can move every sample without
+// the filter going unstable.
+class StateVariableFilter
+{
+public:
+    struct Outputs
+    {
+        double low = 0.0;
+        double band = 0.0;
+        double high = 0.0;
+        double notch = 0.0;
+    };
+
+    static constexpr double kMinQ = 0.1;
+
+    explicit StateVariableFilter(double sampleRate = 44100.0);
+
+    void setSampleRate(double sampleRate);
+    // Cutoff is clamped to just below Nyquist.
+    void setParameters(double cutoffHz, double q);
+
+    void reset();
+    Outputs process(double input);
+
+    [[nodiscard]] double sampleRate() const noexcept { return m_sampleRate; }
+    [[nodiscard]] double cutoff() const noexcept { return m_cutoff; }
+    [[nodiscard]] double q() const noexcept { return m_q; }
+
+    // tan(pi * normalizedFrequency) from a shared table, for normalized
+    // frequencies (cutoff / sampleRate) up to the filter's clamp.
+    static double prewarp(double normalizedFrequency);
+
+private:
+    void updateCoefficients();
+
+    double m_sampleRate;
+    double m_cutoff;
+    double m_q;
+    double m_g;
+    double m_k;
+    double m_a1;
+    double m_a2;
+    double m_a3;
+    double m_ic1eq;
+    double m_ic2eq;
+};
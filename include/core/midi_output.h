@@ -1,5 +1,37 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+
+class MidiOutputBackend;
+
+// Immediate sends. These go through the scheduler queue with "as soon as
+// possible" timing and are safe to call from any non-real-time thread.
 void midiOutputSendNoteOn(int portId, int channel, int note, int velocity);
 void midiOutputSendNoteOff(int portId, int channel, int note, int velocity);
+
+// Render-thread API. Events are timestamped in render frames (the running
+// frame counter of the audio loop) and pushed onto a lock-free SPSC queue; the
+// scheduler thread maps them to wall-clock time through the render clock and
+// dispatches them in order. Returns false when the queue is full.
+bool midiOutputScheduleNoteOn(int portId, int channel, int note, int velocity, std::int64_t renderFrame);
+bool midiOutputScheduleNoteOff(int portId, int channel, int note, int velocity, std::int64_t renderFrame);
+
+// Called by the render thread once per block. blockStartFrame is the render
+// frame written first in this block and queuedFrames the number of frames the
+// device still has to play before it, so the scheduler can derive when
+// blockStartFrame reaches the speakers.
+void midiOutputPublishRenderClock(std::int64_t blockStartFrame, double sampleRate, std::int64_t queuedFrames);
+
+// Opens a port on the scheduler thread ahead of the first event so the open
+// never happens in the dispatch path. Non-real-time.
+void midiOutputPreparePort(int portId);
+
+// Replaces the output backend (WinMM by default). Intended for tests and
+// non-Windows builds, where a loopback backend records dispatched messages.
+void setMidiOutputBackend(std::unique_ptr<MidiOutputBackend> backend);
+
+void startMidiOutput();
+// Stops the scheduler, sends note-offs for every note still sounding and
+// closes all ports.
 void shutdownMidiOutput();
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Destination for scheduled MIDI messages. All methods are called from the
+// MIDI scheduler thread only.
+class MidiOutputBackend
+{
+public:
+    virtual ~MidiOutputBackend() = default;
+
+    virtual bool openPort(int portId) = 0;
+    virtual void sendShortMessage(int portId, std::uint32_t message) = 0;
+    virtual void closeAllPorts() = 0;
+};
+
+// Default backend: WinMM on Windows, a no-op elsewhere.
+std::unique_ptr<MidiOutputBackend> createDefaultMidiOutputBackend();
+
+// Records every message together with the wall-clock time it was dispatched,
+// so timing can be verified without MIDI hardware.
+class LoopbackMidiOutputBackend : public MidiOutputBackend
+{
+public:
+    struct Message
+    {
+        int portId = -1;
+        std::uint32_t message = 0;
+        std::chrono::steady_clock::time_point dispatchTime{};
+    };
+
+    bool openPort(int portId) override;
+    void sendShortMessage(int portId, std::uint32_t message) override;
+    void closeAllPorts() override;
+
+    [[nodiscard]] std::vector<Message> messages() const;
+    [[nodiscard]] std::vector<int> openPorts() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Message> m_messages;
+    std::vector<int> m_openPorts;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Per-track objects that the cache updater builds for the track snapshots
+// and the render thread runs. An object that is dropped, for a removed track
+// or because it had to be replaced, may still be in use by a block that
+// started from an older snapshot. It is therefore tagged with the generation
+// of the first snapshot built without it, and freed once the render thread
+// has acknowledged that generation.
+//
+// Only the cache updater touches the pool. Each pass over the tracks is
+// bracketed by beginPass() and endPass(); derived pools decide in their
+// acquire() when an object is created or replaced.
+template <typename T>
+class RetiringPool
+{
+public:
+    void beginPass(std::uint64_t generation) noexcept { m_generation = generation; }
+
+    // Retires the objects of tracks not looked up since beginPass() and
+    // frees the retired objects of generations up to acknowledgedGeneration.
+    void endPass(std::uint64_t acknowledgedGeneration)
+    {
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+        {
+            if (it->second.used)
+            {
+                it->second.used = false;
+                ++it;
+                continue;
+            }
+            retire(std::move(it->second.object));
+            it = m_entries.erase(it);
+        }
+        m_retired.erase(std::remove_if(m_retired.begin(), m_retired.end(),
+                                       [acknowledgedGeneration](const Retired& entry) {
+                                           return entry.generation <= acknowledgedGeneration;
+                                       }),
+                        m_retired.end());
+    }
+
+    [[nodiscard]] std::size_t retiredCount() const noexcept { return m_retired.size(); }
+
+protected:
+    // Object slot of trackId, marked as used in this pass. Null when the
+    // track has none and create is false.
+    std::shared_ptr<T>* find(int trackId, bool create)
+    {
+        auto it = m_entries.find(trackId);
+        if (it == m_entries.end())
+        {
+            if (!create)
+                return nullptr;
+            it = m_entries.emplace(trackId, Entry{}).first;
+        }
+        it->second.used = true;
+        return &it->second.object;
+    }
+
+    void replace(std::shared_ptr<T>& slot, std::shared_ptr<T> object)
+    {
+        retire(std::move(slot));
+        slot = std::move(object);
+    }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<T> object;
+        bool used = false;
+    };
+
+    struct Retired
+    {
+        std::shared_ptr<T> object;
+        std::uint64_t generation = 0;
+    };
+
+    void retire(std::shared_ptr<T> object)
+    {
+        if (object)
+            m_retired.push_back(Retired{std::move(object), m_generation});
+    }
+
+    std::unordered_map<int, Entry> m_entries;
+    std::vector<Retired> m_retired;
+    std::uint64_t m_generation = 0;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer sequence lock for small trivially copyable values. The writer
+// never blocks; readers retry while a write is in flight. Used to publish
+// render-thread state (transport position, tempo schedule) to other threads.
+template <typename T>
+class SeqLockValue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLockValue requires a trivially copyable type");
+
+public:
+    SeqLockValue() = default;
+    explicit SeqLockValue(const T& initial) { copyWords(m_storage, reinterpret_cast<const unsigned char*>(&initial)); }
+
+    // Only one thread may call store() at a time.
+    void store(const T& value) noexcept
+    {
+        const std::uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        copyWords(m_storage, reinterpret_cast<const unsigned char*>(&value));
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    [[nodiscard]] T load() const noexcept
+    {
+        T result{};
+        while (!tryLoad(result))
+        {
+        }
+        return result;
+    }
+
+    // Single attempt; returns false if a write overlapped the read.
+    bool tryLoad(T& out) const noexcept
+    {
+        const std::uint32_t begin = m_sequence.load(std::memory_order_acquire);
+        if (begin & 1u)
+            return false;
+
+        unsigned char buffer[sizeof(T)];
+        readWords(buffer);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) != begin)
+            return false;
+
+        std::memcpy(&out, buffer, sizeof(T));
+        return true;
+    }
+
+private:
+    static constexpr std::size_t kWordCount = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    // The payload is stored as relaxed atomic words so concurrent reads are
+    // well defined; torn reads are rejected by the sequence check.
+    void copyWords(std::atomic<std::uint64_t>* words, const unsigned char* source) noexcept
+    {
+        for (std::size_t i = 0; i < kWordCount; ++i)
+        {
+            std::uint64_t word = 0;
+            const std::size_t offset = i * sizeof(std::uint64_t);
+            const std::size_t bytes = (sizeof(T) - offset) < sizeof(word) ? (sizeof(T) - offset) : sizeof(word);
+            std::memcpy(&word, source + offset, bytes);
+            words[i].store(word, std::memory_order_relaxed);
+        }
+    }
+
+    void readWords(unsigned char* destination) const noexcept
+    {
+        for (std::size_t i = 0; i < kWordCount; ++i)
+        {
+            const std::uint64_t word = m_storage[i].load(std::memory_order_relaxed);
+            const std::size_t offset = i * sizeof(std::uint64_t);
+            const std::size_t bytes = (sizeof(T) - offset) < sizeof(word) ? (sizeof(T) - offset) : sizeof(word);
+            std::memcpy(destination + offset, &word, bytes);
+        }
+    }
+
+    std::atomic<std::uint32_t> m_sequence{0};
+    std::atomic<std::uint64_t> m_storage[kWordCount]{};
+};
@@ -1,9 +1,16 @@
 #pragma once
 
+#include "core/transport.h"
+
 #include <atomic>
+#include <vector>
 
 constexpr int kSequencerStepsPerPage = 16;
-constexpr int kMaxSequencerSteps = 1024;
+constexpr int kMaxSequencerSteps = 4096;
+constexpr double kSequencerMinBpm = 30.0;
+constexpr double kSequencerMaxBpm = 240.0;
+// Fraction of a sixteenth that every second step is delayed by.
+constexpr double kSequencerMaxSwing = 0.75;
 
 enum class SequencerResetReason
 {
@@ -12,8 +19,8 @@ enum class SequencerResetReason
     StepCountChange,
 };
 
-extern std::atomic<int> sequencerCurrentStep;
-extern std::atomic<int> sequencerBPM;
+extern std::atomic<double> sequencerBPM;
+extern std::atomic<double> sequencerSwing;
 extern std::atomic<bool> sequencerResetRequested;
 extern std::atomic<SequencerResetReason> sequencerResetReason;
 
@@ -25,3 +32,9 @@ void setSequencerStepCount(int trackId, int count);
 int getSequencerStepCount(int trackId);
 int getActiveSequencerTrackId();
 void setActiveSequencerTrackId(int trackId);
+
+// Tempo changes applied by the transport on top of sequencerBPM. Changes are
+// sorted by beat; at most kMaxTempoChanges are kept. Safe to read from the
+// render thread.
+void setSequencerTempoSchedule(std::vector<TempoChange> changes);
+TempoSchedule getSequencerTempoSchedule();
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core/tracks.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One note on one step. Field names match StepNoteInfo so step note ranges can
+// be iterated the same way as note lists.
+struct StepNoteEvent
+{
+    int step = 0;
+    int midiNote = 0;
+    float velocity = kTrackStepVelocityMax;
+    bool sustain = false;
+};
+
+// Per-step values that differ from the defaults. Steps without an entry use
+// StepParameters{} (full velocity, centre pan, no pitch offset).
+struct StepParameters
+{
+    static constexpr int kDefaultLastNote = 69; // A4
+
+    int step = 0;
+    float velocity = kTrackStepVelocityMax;
+    float pan = 0.0f;
+    float pitch = 0.0f;
+    // Note restored when a step without notes is switched back on.
+    int lastNote = kDefaultLastNote;
+
+    [[nodiscard]] bool isDefault() const noexcept;
+};
+
+class StepNoteRange
+{
+public:
+    StepNoteRange() = default;
+    StepNoteRange(const StepNoteEvent* first, const StepNoteEvent* last) : m_begin(first), m_end(last) {}
+
+    [[nodiscard]] const StepNoteEvent* begin() const noexcept { return m_begin; }
+    [[nodiscard]] const StepNoteEvent* end() const noexcept { return m_end; }
+    [[nodiscard]] std::size_t size() const noexcept { return static_cast<std::size_t>(m_end - m_begin); }
+    [[nodiscard]] bool empty() const noexcept { return m_begin == m_end; }
+
+private:
+    const StepNoteEvent* m_begin = nullptr;
+    const StepNoteEvent* m_end = nullptr;
+};
+
+// Sparse step pattern: note events sorted by (step, note) and parameter
+// overrides sorted by step. Memory scales with the number of notes, not with
+// kMaxSequencerSteps. Published patterns are immutable; writers copy the
+// current pattern, edit the copy and publish it under a new version.
+class StepPattern
+{
+public:
+    [[nodiscard]] std::uint64_t version() const noexcept { return m_version; }
+    void setVersion(std::uint64_t version) noexcept { m_version = version; }
+
+    [[nodiscard]] StepNoteRange notesForStep(int step) const noexcept;
+    [[nodiscard]] bool stepEnabled(int step) const noexcept { return !notesForStep(step).empty(); }
+    [[nodiscard]] StepParameters parametersForStep(int step) const noexcept;
+
+    [[nodiscard]] const std::vector<StepNoteEvent>& events() const noexcept { return m_events; }
+    [[nodiscard]] const std::vector<StepParameters>& parameters() const noexcept { return m_parameters; }
+
+    // Editing; only valid on a copy that has not been published yet.
+    // Replaces the notes of a step; notes are sorted and de-duplicated.
+    void setStepNotes(int step, std::vector<StepNoteEvent> notes);
+    void setStepParameters(const StepParameters& parameters);
+    // Drops notes and parameters on steps >= firstStep.
+    void clearFrom(int firstStep);
+
+private:
+    std::vector<StepNoteEvent> m_events;
+    std::vector<StepParameters> m_parameters;
+    std::uint64_t m_version = 0;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#endif
+
+// Raises the calling thread to the priority of the audio render thread, for
+// helpers the render thread relies on to finish within a block. Returns
+// false when the system refuses, which is usual for unprivileged processes
+// on Linux; the thread then keeps running at normal priority.
+inline bool raiseThreadToAudioPriority()
+{
+#ifdef _WIN32
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+    sched_param param {};
+    const int maximum = sched_get_priority_max(SCHED_FIFO);
+    if (maximum < 0)
+        return false;
+    // Below the device callbacks, which usually sit near the top of the range.
+    param.sched_priority = std::max(sched_get_priority_min(SCHED_FIFO), maximum - 10);
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#endif
+}
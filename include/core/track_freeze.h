@@ -0,0 +1,69 @@
+#pragma once
+
+#include "core/sample_loader.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace kj
+{
+class VST3Host;
+}
+
+// What a frozen render depends on. When any of it changes, or the track gains
+// automation, the freeze is dropped and the track is processed live again.
+struct FrozenTrackKey
+{
+    const kj::VST3Host* host = nullptr;
+    std::uint64_t hostEditGeneration = 0;
+    std::uint64_t patternVersion = 0;
+    int stepCount = 0;
+    int midiChannel = 0;
+    double bpm = 0.0;
+    double swing = 0.0;
+    double sampleRate = 0.0;
+
+    bool operator==(const FrozenTrackKey& other) const noexcept;
+    bool operator!=(const FrozenTrackKey& other) const noexcept { return !(*this == other); }
+};
+
+// Plug-in output of one pattern loop, rendered offline. Tails that run past
+// the loop end are folded back onto its start so the stem loops seamlessly,
+// and the plug-in latency is removed. The mixer (EQ, compressor, delay,
+// sidechain, volume and pan) still runs live on top of it.
+struct FrozenTrack
+{
+    FrozenTrackKey key;
+    SampleBuffer stem; // interleaved stereo at key.sampleRate
+    // First frame of each step inside the stem; the engine re-syncs to the
+    // sequencer on every step.
+    std::vector<std::int64_t> stepOffsets;
+};
+
+// Pieces of the offline render that do not touch the engine; split out so
+// they can be tested on their own.
+//
+// Start of each step of the loop in frames, plus the loop end, with the
+// same swing as TransportClock: even steps lengthened, odd ones shortened.
+std::vector<double> computeFrozenStepStarts(const FrozenTrackKey& key);
+// Adds frameCount frames of plug-in output, rendered from frame on, into a
+// stereo stem of loopFrames frames. The first latency frames of the render
+// are the plug-in's delay and are dropped; frames past the loop end wrap
+// onto its start, so tails ring into the next pass of the loop.
+void addToFrozenStem(std::vector<float>& stem, std::int64_t loopFrames, std::int64_t latency, std::int64_t frame,
+                     const float* left, const float* right, int frameCount);
+
+// Renders the VST track's pattern loop on the freeze worker. Returns false if
+// the track cannot be frozen right now (not a VST track, no plug-in, automation
+// lanes with points, no running audio device, a tempo schedule is active, or
+// swing with an odd step count). onFinished runs on the worker thread.
+bool requestTrackFreeze(int trackId, std::function<void(bool)> onFinished = {});
+void trackUnfreeze(int trackId);
+// Current freeze of the track, or nullptr. A freeze whose key no longer
+// matches the track is dropped here, which unfreezes the track.
+std::shared_ptr<const FrozenTrack> trackGetFrozen(int trackId);
+bool trackIsFrozen(int trackId);
+
+void shutdownTrackFreeze();
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+// Watches a track's source and output so the mixer can skip the track once
+// nothing more can come out of it. The engine feeds it every frame and asks
+// at the end of each block; the tail lengths come from the track's effects.
+class TrackSleepMonitor
+{
+public:
+    // Output peak, -120 dB, a block may reach and still count as silent.
+    static constexpr double kThreshold = 1e-6;
+    // Filter ringing allowed for on top of the effect tails.
+    static constexpr double kSettleSeconds = 0.05;
+
+    // Counts consecutive all-zero source frames; any other frame restarts
+    // the count.
+    void observeSource(double left, double right) noexcept
+    {
+        m_silentInputFrames = (left == 0.0 && right == 0.0) ? m_silentInputFrames + 1 : 0;
+    }
+    void observeOutput(double level) noexcept
+    {
+        if (level > m_blockPeak)
+            m_blockPeak = level;
+    }
+
+    // True once the source is idle, the current block stayed under the
+    // threshold and the source has been silent for the settle time plus
+    // tailFrames.
+    [[nodiscard]] bool canSleep(bool sourceIdle, std::size_t tailFrames, double sampleRate) const noexcept;
+
+    void endBlock() noexcept { m_blockPeak = 0.0; }
+    void reset() noexcept;
+
+    [[nodiscard]] std::size_t silentInputFrames() const noexcept { return m_silentInputFrames; }
+    [[nodiscard]] double blockPeak() const noexcept { return m_blockPeak; }
+
+private:
+    std::size_t m_silentInputFrames = 0;
+    double m_blockPeak = 0.0;
+};
@@ -1,9 +1,19 @@
 #pragma once
 
 #include "core/tracks.h"
+#include "hosting/AutomationLane.h"
 
 #include <memory>
 
 std::shared_ptr<kj::VST3Host> trackGetVstHost(int trackId);
 std::shared_ptr<kj::VST3Host> trackEnsureVstHost(int trackId);
+// Replaces the host of a VST track and hands back the previous one. Returns
+// false (and leaves the track unchanged) if the track is gone or is no longer
+// a VST track.
+bool trackPublishVstHost(int trackId, std::shared_ptr<kj::VST3Host> host, std::shared_ptr<kj::VST3Host>& previous);
 
+
+// Lanes are replaced as a whole; the audio thread keeps playing the previous
+// set until its next snapshot.
+std::shared_ptr<const kj::AutomationLanes> trackGetAutomation(int trackId);
+void trackSetAutomation(int trackId, std::shared_ptr<const kj::AutomationLanes> lanes);
@@ -1,12 +1,16 @@
 #pragma once
 
+#include "core/effects/insert_chain.h"
+
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 struct SampleBuffer;
+class StepPattern;
 
 namespace kj
 {
@@ -44,6 +48,10 @@ struct LfoSettings
     float deform = 0.0f;
 };
 
+// Shared effect buses (see aux_buses.h); each track has a post-fader send
+// level for every one of them.
+constexpr int kAuxBusCount = 4;
+
 struct Track
 {
     int id;
@@ -60,11 +68,17 @@ struct Track
     float delayTimeMs = 350.0f;
     float delayFeedback = 0.35f;
     float delayMix = 0.4f;
+    bool reverbEnabled = false;
+    float reverbSize = 0.3f;
+    float reverbDecaySeconds = 1.2f;
+    float reverbDamping = 0.4f;
+    float reverbMix = 0.25f;
     bool compressorEnabled = false;
     float compressorThresholdDb = -12.0f;
     float compressorRatio = 4.0f;
     float compressorAttack = 0.01f;
     float compressorRelease = 0.2f;
+    InsertOrder insertOrder = kDefaultInsertOrder;
     bool sidechainEnabled = false;
     int sidechainSourceTrackId = -1;
     float sidechainAmount = 1.0f;
@@ -83,6 +97,7 @@ struct Track
     float sampleAttack = 0.005f;
     float sampleRelease = 0.3f;
     std::array<LfoSettings, 3> lfoSettings{};
+    std::array<float, kAuxBusCount> sendLevels{};
     int midiChannel = 1;
     int midiPort = -1;
     std::wstring midiPortName;
@@ -107,6 +122,10 @@ void initTracks();
 Track addTrack(const std::string& name = {});
 std::vector<Track> getTracks();
 size_t getTrackCount();
+// Changes whenever a track is added or one of its settings changes, so
+// callers can skip copying the tracks while it holds still. Step edits are
+// not counted; see trackGetStepPattern.
+std::uint64_t getTrackSettingsVersion();
 
 void trackSetName(int trackId, const std::string& name);
 
@@ -142,6 +161,22 @@ void trackSetDelayFeedback(int trackId, float value);
 float trackGetDelayMix(int trackId);
 void trackSetDelayMix(int trackId, float value);
 
+bool trackGetReverbEnabled(int trackId);
+void trackSetReverbEnabled(int trackId, bool enabled);
+
+// Room size, 0 (small) to 1 (large).
+float trackGetReverbSize(int trackId);
+void trackSetReverbSize(int trackId, float value);
+
+float trackGetReverbDecay(int trackId);
+void trackSetReverbDecay(int trackId, float seconds);
+
+float trackGetReverbDamping(int trackId);
+void trackSetReverbDamping(int trackId, float value);
+
+float trackGetReverbMix(int trackId);
+void trackSetReverbMix(int trackId, float value);
+
 bool trackGetCompressorEnabled(int trackId);
 void trackSetCompressorEnabled(int trackId, bool enabled);
 
@@ -172,6 +207,20 @@ void trackSetSidechainAttack(int trackId, float value);
 float trackGetSidechainRelease(int trackId);
 void trackSetSidechainRelease(int trackId, float value);
 
+// Order of the EQ, compressor, delay and reverb on the track. Set ignores orders
+// that do not hold each effect once; move shifts one insert to another slot.
+InsertOrder trackGetInsertOrder(int trackId);
+void trackSetInsertOrder(int trackId, const InsertOrder& order);
+bool trackMoveInsert(int trackId, int fromSlot, int toSlot);
+
+// Post-fader send from the track to an aux bus, 0 (off) to 1.
+float trackGetSendLevel(int trackId, int busIndex);
+void trackSetSendLevel(int trackId, int busIndex, float level);
+
+// Immutable snapshot of the track's steps; a new version is published on
+// every edit.
+std::shared_ptr<const StepPattern> trackGetStepPattern(int trackId);
+
 bool trackGetStepState(int trackId, int stepIndex);
 void trackSetStepState(int trackId, int stepIndex, bool enabled);
 void trackToggleStepState(int trackId, int stepIndex);
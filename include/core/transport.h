@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Position of the shared transport. Published by the render thread once per
+// block; GUI, plug-in hosting and the MIDI scheduler read the same values.
+struct TransportPosition
+{
+    std::int64_t samplePosition = 0; // samples since playback started
+    double beatPosition = 0.0;       // quarter notes since playback started
+    double barStartBeat = 0.0;       // quarter-note position of the current bar
+    std::int32_t bar = 0;
+    std::int64_t step = 0;           // sixteenth steps since the last sequencer reset
+    double stepOriginBeat = 0.0;     // beatPosition where that reset put step 0
+    double tempo = 120.0;
+    double sampleRate = 0.0;
+    std::int32_t timeSigNum = 4;
+    std::int32_t timeSigDen = 4;
+    // Delay compensation already taken off the published position (see
+    // TransportClock::setLatencyCompensation).
+    std::int32_t latencySamples = 0;
+    bool playing = false;
+};
+
+struct TempoChange
+{
+    double beat = 0.0; // quarter-note position where the change takes effect
+    double bpm = 120.0;
+};
+
+constexpr std::size_t kMaxTempoChanges = 32;
+
+struct TempoSchedule
+{
+    std::array<TempoChange, kMaxTempoChanges> changes{};
+    std::size_t count = 0;
+};
+
+// Tempo settings a block runs at; the engine reads them from the sequencer
+// once per block.
+struct TransportTempo
+{
+    double bpm = 120.0;
+    double swing = 0.0;
+    TempoSchedule schedule{};
+};
+
+// Sample-accurate transport owned by the render thread. Each block is
+// advanced once; step boundaries inside the block are reported as frame
+// offsets so the render loop no longer counts samples per step. Tempo is
+// fractional, swing delays every second sixteenth, and scheduled tempo changes
+// apply from the first step that starts at or after their beat. Schedule beats
+// are on the timeline; a step grid restarted mid-playback stays on it, step n
+// starting at stepOriginBeat + n / kStepsPerBeat.
+class TransportClock
+{
+public:
+    static constexpr int kStepsPerBeat = 4;
+    static constexpr std::size_t kMaxStepBoundariesPerBlock = 64;
+
+    void prepare(double sampleRate);
+    void stop();
+
+    // Begins a block of numFrames at the given tempo settings and computes
+    // the step boundaries in the block.
+    void beginBlock(int numFrames, bool playing, const TransportTempo& tempo);
+    // Restarts the step grid at step 0 from the given frame of the current
+    // block (sequencer reset) and recomputes the remaining boundaries.
+    void restartStepsAt(int frameOffset);
+    // Publishes the position at the end of the block and advances to it.
+    void endBlock();
+
+    // Plug-in delay compensation applied at the master bus. Positions handed
+    // to plug-ins stay on the engine timeline every track is aligned to; the
+    // published position is moved back by this amount so it matches what is
+    // heard.
+    void setLatencyCompensation(int samples) noexcept { m_latencyCompensation = samples > 0 ? samples : 0; }
+    [[nodiscard]] int latencyCompensation() const noexcept { return m_latencyCompensation; }
+
+    [[nodiscard]] std::size_t stepBoundaryCount() const noexcept { return m_boundaryCount; }
+    [[nodiscard]] int stepBoundaryOffset(std::size_t index) const noexcept { return m_boundaryOffsets[index]; }
+    [[nodiscard]] bool isStepBoundary(int frameOffset) const noexcept;
+
+    // Position of a frame inside the current block.
+    [[nodiscard]] TransportPosition positionAt(int frameOffset) const noexcept;
+    [[nodiscard]] double tempo() const noexcept { return m_tempo; }
+    [[nodiscard]] double sampleRate() const noexcept { return m_sampleRate; }
+    [[nodiscard]] bool playing() const noexcept { return m_playing; }
+
+private:
+    [[nodiscard]] double tempoForBeat(double beat) const noexcept;
+    [[nodiscard]] double beatAfter(double beat, double frames) const noexcept;
+    [[nodiscard]] double stepBeat(std::int64_t step) const noexcept;
+    [[nodiscard]] double stepLengthSamples(std::int64_t step, double tempo) const noexcept;
+    void computeBoundaries(int fromFrame);
+
+    double m_sampleRate = 44100.0;
+    bool m_playing = false;
+
+    // Timeline (since playback started).
+    std::int64_t m_blockStartSample = 0;
+    double m_blockStartBeat = 0.0;
+    int m_blockFrames = 0;
+    double m_tempo = 120.0;
+    double m_swing = 0.0;
+    TempoSchedule m_schedule{};
+    int m_latencyCompensation = 0;
+
+    // Step grid (since the last sequencer reset).
+    double m_stepOriginBeat = 0.0;
+    std::int64_t m_step = 0;
+    double m_stepStartSample = 0.0; // absolute, fractional
+    double m_stepLength = 0.0;
+    std::int64_t m_blockStartStep = 0;
+
+    std::array<int, kMaxStepBoundariesPerBlock> m_boundaryOffsets{};
+    std::size_t m_boundaryCount = 0;
+};
+
+// Latest published position. Lock-free; safe from any thread.
+TransportPosition transportGetPosition();
+
+// Step of a pattern stepCount steps long that the position is on, the way
+// the render loop wraps every track's pattern; -1 while stopped.
+int transportPatternStep(const TransportPosition& position, int stepCount) noexcept;
@@ -0,0 +1,17 @@
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+// Send levels of the active track and the settings of the shared aux buses.
+void toggleAuxBusWindow(HWND parent);
+void closeAuxBusWindow();
+bool isAuxBusWindowOpen();
+void notifyAuxBusWindowTrackChanged(int trackId);
+// Sends and bus settings changed elsewhere, e.g. by loading a project.
+void notifyAuxBusWindowValuesChanged();
@@ -6,5 +6,15 @@ enum
     kMenuCommandToggleEffects = 1004,
     kMenuCommandToggleWaveform = 1005,
     kMenuCommandToggleModMatrix = 1006,
+    kMenuCommandFreezeTrack = 1007,
+    kMenuCommandUnfreezeTrack = 1008,
+    kMenuCommandTogglePluginSandbox = 1009,
+    kMenuCommandPanLawConstantPower = 1010,
+    kMenuCommandPanLawCompromise = 1011,
+    kMenuCommandPanLawLinear = 1012,
+    kMenuCommandToggleAuxBuses = 1013,
+    kMenuCommandRecordInput = 1014,
+    kMenuCommandToggleInputMonitoring = 1015,
+    kMenuCommandToggleAutomationRecording = 1016,
 };
 
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "wdl/lice/lice.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Retained widget layer for LICE-backed windows.
+//
+// Each widget owns a rectangle and a state version. Callers publish the
+// current version of whatever the widget displays (a hash of the values it
+// draws); when the version changes the widget is flagged dirty. Rendering
+// only touches dirty widgets, and the accumulated dirty rectangles can be
+// forwarded to InvalidateRect so the window blits just the changed pixels.
+//
+// The layer works against any LICE_IBitmap, so it can be exercised headless
+// with LICE_MemBitmap.
+class RetainedWidgetLayer
+{
+public:
+    using DrawCallback = std::function<void(LICE_IBitmap& surface, const RECT& bounds)>;
+
+    int addWidget(const RECT& bounds, DrawCallback draw);
+    void clear();
+
+    [[nodiscard]] std::size_t widgetCount() const noexcept { return m_widgets.size(); }
+
+    void setWidgetBounds(int widgetId, const RECT& bounds);
+    [[nodiscard]] RECT widgetBounds(int widgetId) const noexcept;
+
+    // Returns true when the version differs from the last rendered one.
+    bool updateWidgetState(int widgetId, std::uint64_t stateVersion);
+    void markWidgetDirty(int widgetId);
+    void markAllDirty();
+
+    [[nodiscard]] bool hasDirtyWidgets() const noexcept;
+    [[nodiscard]] bool isWidgetDirty(int widgetId) const noexcept;
+    void collectDirtyRects(std::vector<RECT>& rects) const;
+    [[nodiscard]] RECT dirtyBounds() const noexcept;
+
+    // Redraws dirty widgets into the surface and clears their flags. Returns
+    // the number of widgets drawn.
+    int renderDirty(LICE_IBitmap& surface);
+    // Redraws every widget regardless of its flag.
+    int renderAll(LICE_IBitmap& surface);
+
+private:
+    struct Widget
+    {
+        RECT bounds{};
+        RECT lastDrawnBounds{};
+        std::uint64_t stateVersion = 0;
+        bool hasState = false;
+        bool dirty = true;
+        DrawCallback draw;
+    };
+
+    [[nodiscard]] bool validId(int widgetId) const noexcept;
+    void drawWidget(LICE_IBitmap& surface, Widget& widget);
+
+    std::vector<Widget> m_widgets;
+};
+
+// Mixes a value into a widget state version (64-bit FNV-1a over the bytes).
+inline std::uint64_t hashWidgetState(std::uint64_t seed, std::uint64_t value) noexcept
+{
+    std::uint64_t hash = seed == 0 ? 1469598103934665603ull : seed;
+    for (int i = 0; i < 8; ++i)
+    {
+        hash ^= (value >> (i * 8)) & 0xffu;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kj {
+
+// Positions are in quarter notes from the project start, so lanes survive
+// tempo and sample-rate changes. Values are normalized plug-in parameter
+// values.
+struct AutomationPoint {
+    double beat = 0.0;
+    float value = 0.0f;
+};
+
+// Breakpoints of one parameter, sorted by beat. Values are linear between
+// points and held before the first and after the last.
+struct AutomationLane {
+    std::uint32_t paramId = 0;
+    std::vector<AutomationPoint> points;
+
+    // hint is the index of the segment found by the previous call; reading a
+    // lane front to back is then constant time per call.
+    float valueAt(double beat, std::size_t& hint) const;
+};
+
+// Lanes of one track, sorted by paramId.
+using AutomationLanes = std::vector<AutomationLane>;
+
+// Ramer-Douglas-Peucker on the value axis: drops every point whose value is
+// within tolerance of the line between the points kept around it. The error
+// is measured vertically because that is what playback interpolates.
+std::vector<AutomationPoint> thinAutomationPoints(const std::vector<AutomationPoint>& points, float tolerance);
+
+// A recorded change, as the audio thread captured it.
+struct AutomationCapturePoint {
+    std::uint32_t paramId = 0;
+    float value = 0.0f;
+    double beat = 0.0;
+};
+
+// Merges a recorded take into lanes. For every parameter in the take the
+// beat range it covers replaces what the lane had there; the result is
+// thinned. take does not need to be sorted.
+void mergeAutomationTake(AutomationLanes& lanes, std::vector<AutomationCapturePoint> take, float tolerance);
+
+// Compact little-endian form used in project files: 8-byte beat, 4-byte value.
+std::vector<std::uint8_t> encodeAutomationPoints(const std::vector<AutomationPoint>& points);
+bool decodeAutomationPoints(const std::vector<std::uint8_t>& data, std::vector<AutomationPoint>& points);
+
+// Single-producer single-consumer ring from the audio thread to whoever
+// collects the take. Fixed capacity; points that do not fit are counted and
+// dropped.
+class AutomationCaptureQueue {
+public:
+    static constexpr std::size_t kCapacity = 8192;
+
+    AutomationCaptureQueue();
+
+    // Audio thread.
+    bool push(const AutomationCapturePoint& point);
+    // Consumer thread.
+    bool pop(AutomationCapturePoint& point);
+    void clear();
+
+    [[nodiscard]] std::uint64_t droppedPoints() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<AutomationCapturePoint> ring_;
+    std::atomic<std::size_t> head_{0};
+    std::atomic<std::size_t> tail_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+} // namespace kj
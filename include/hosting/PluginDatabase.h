@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace kj {
+
+// What a scan learned about one plug-in bundle. Strings are UTF-8.
+
+struct PluginBusInfo {
+    std::string name;
+    std::int32_t mediaType = 0;     // Steinberg::Vst::MediaTypes
+    std::int32_t direction = 0;     // Steinberg::Vst::BusDirections
+    std::int32_t busType = 0;       // Steinberg::Vst::BusTypes
+    std::int32_t channelCount = 0;
+    std::uint64_t arrangement = 0;  // Steinberg::Vst::SpeakerArrangement
+};
+
+struct PluginClassInfo {
+    std::string classId;  // 32 hex digits
+    std::string name;
+    std::string category;
+    std::string subCategories;
+    std::string vendor;
+    std::string version;
+    std::string sdkVersion;
+    // Only filled for audio processor classes.
+    std::vector<PluginBusInfo> buses;
+    std::int32_t latencySamples = 0;
+};
+
+// Cache entries are keyed by bundle path and modification stamp; a bundle
+// that changed on disk is scanned again. Failed scans are cached too, so a
+// plug-in that crashes the scanner is not retried until it is updated.
+struct PluginBundleInfo {
+    std::string path;
+    std::int64_t modifiedTime = 0;
+    std::uint64_t size = 0;
+    bool valid = false;
+    std::string error;
+    std::vector<PluginClassInfo> classes;
+};
+
+bool serializePluginBundleInfo(const PluginBundleInfo& info, std::vector<std::uint8_t>& out);
+bool deserializePluginBundleInfo(const std::uint8_t* data, std::size_t size, PluginBundleInfo& info);
+
+// Stamp of the bundle on disk: newest modification time and total size of the
+// bundle file or the files in its Contents folder. False if it does not exist.
+bool readPluginBundleStamp(const std::filesystem::path& bundle, std::int64_t& modifiedTime, std::uint64_t& size);
+
+// Standard per-machine and per-user VST3 folders.
+std::vector<std::filesystem::path> defaultVst3SearchPaths();
+// .vst3 files and bundle folders below the roots. Bundles are not descended into.
+std::vector<std::filesystem::path> findVst3Bundles(const std::vector<std::filesystem::path>& roots);
+
+// Fills info.valid/error/classes for one bundle. Must be thread-safe; scans
+// run on several threads at once.
+using PluginScanFunction = std::function<bool(const std::filesystem::path& bundle, PluginBundleInfo& info)>;
+
+// Scans in kj_plugin_worker processes so a plug-in that crashes or hangs
+// while being scanned only takes its own worker down. Each concurrent scan
+// uses its own worker; workers are reused until they fail.
+PluginScanFunction makeSandboxedPluginScanner(const std::filesystem::path& workerExecutable);
+
+class PluginDatabase {
+public:
+    PluginDatabase() = default;
+    explicit PluginDatabase(std::filesystem::path cacheFile);
+    PluginDatabase(const PluginDatabase&) = delete;
+    PluginDatabase& operator=(const PluginDatabase&) = delete;
+    ~PluginDatabase();
+
+    const std::filesystem::path& cacheFile() const { return cacheFile_; }
+
+    // Replaces the in-memory entries with the cache file. False if it is
+    // missing or unreadable; the database is then empty.
+    bool loadCache();
+    // Written to a temporary file and renamed over the cache.
+    bool saveCache() const;
+
+    // Brings the entries for bundles up to date: unchanged bundles keep their
+    // cached entry, new or modified ones are scanned on up to threadCount
+    // threads, and entries for bundles that are gone are dropped. Returns the
+    // number of bundles scanned.
+    std::size_t refresh(const std::vector<std::filesystem::path>& bundles, const PluginScanFunction& scanner,
+                        unsigned threadCount = 0);
+
+    // refresh() on a background thread, followed by saveCache(). onFinished
+    // runs on that thread. False if a scan is already running.
+    bool refreshAsync(std::vector<std::filesystem::path> bundles, PluginScanFunction scanner,
+                      std::function<void(std::size_t scanned)> onFinished = {}, unsigned threadCount = 0);
+    bool scanning() const { return scanning_.load(std::memory_order_acquire); }
+    // Stops a running refresh after the bundles currently being scanned;
+    // bundles not reached keep no entry and are scanned next time.
+    void cancelScan() { cancelled_.store(true, std::memory_order_release); }
+    void waitForScan();
+
+    std::optional<PluginBundleInfo> findBundle(const std::filesystem::path& bundle) const;
+    // Bundle providing the class, or nullopt if no scanned bundle has it.
+    std::optional<PluginBundleInfo> findClass(const std::string& classId) const;
+    std::vector<PluginBundleInfo> bundles() const;
+
+private:
+    static std::string keyFor(const std::filesystem::path& bundle);
+
+    std::filesystem::path cacheFile_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const PluginBundleInfo>> entries_;
+
+    std::mutex scanMutex_;
+    std::thread scanThread_;
+    std::atomic<bool> scanning_ {false};
+    std::atomic<bool> cancelled_ {false};
+};
+
+} // namespace kj
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "pluginterfaces/vst/ivstevents.h"
+#include "pluginterfaces/vst/ivstparameterchanges.h"
+
+namespace kj {
+
+// Out-of-process plug-in hosting. A worker process owns up to
+// kSandboxMaxSlots plug-ins; each one talks to the host through its own slot
+// in a shared-memory segment. The host posts a request by bumping the slot's
+// request counter and ringing the worker's doorbell; the worker answers by
+// copying the sequence into the reply counter. Both counters double as wait
+// words (futex on Linux, named semaphores on Windows).
+//
+// Audio crosses one block at a time: events queued while block N plays are
+// posted when it ends and the host waits at most half a block for the worker
+// to render them, so they play as block N + 1. A sandboxed plug-in therefore
+// adds one block of latency, reported through latencySamples() for delay
+// compensation. A block that misses the wait plays as silence.
+
+constexpr int kSandboxMaxSlots = 8;
+constexpr int kSandboxMaxChannels = 2;
+constexpr int kSandboxMaxBlockSize = 4096;
+constexpr int kSandboxMaxEvents = 512;
+constexpr int kSandboxMaxParameterPoints = 1024;
+// Plug-in paths and state blobs; pages are only committed when touched.
+constexpr std::size_t kSandboxMaxMessageBytes = std::size_t {4} << 20;
+
+// First argument of a worker process command line.
+constexpr const char* kSandboxWorkerFlag = "--kj-plugin-worker";
+
+struct SandboxSharedMemory;
+struct SandboxSlot;
+
+struct SandboxTransport {
+    double samplePosition = 0.0;
+    double projectTimeMusic = -1.0;
+    double barPositionMusic = -1.0;
+    double tempo = 120.0;
+    std::int32_t timeSigNum = 4;
+    std::int32_t timeSigDen = 4;
+    bool playing = false;
+};
+
+struct SandboxParameterPoint {
+    Steinberg::Vst::ParamID id = 0;
+    std::int32_t sampleOffset = 0;
+    double value = 0.0;
+};
+
+// One block as the worker's processor sees it. Outputs are cleared before
+// process() is called.
+struct SandboxBlock {
+    int numSamples = 0;
+    int numChannels = 0;
+    float* const* outputs = nullptr;
+    const Steinberg::Vst::Event* events = nullptr;
+    std::size_t eventCount = 0;
+    const SandboxParameterPoint* points = nullptr;
+    std::size_t pointCount = 0;
+    SandboxTransport transport;
+};
+
+// Worker-side plug-in instance.
+class SandboxProcessor {
+public:
+    virtual ~SandboxProcessor() = default;
+
+    virtual bool load(const std::string& path) = 0;
+    virtual bool prepare(double sampleRate, int maxBlockSize) = 0;
+    virtual void process(const SandboxBlock& block) = 0;
+    virtual bool saveState(std::vector<std::uint8_t>& outState) = 0;
+    virtual bool loadState(const std::uint8_t* data, std::size_t size) = 0;
+    virtual int latencySamples() const = 0;
+    virtual int parameterCount() const = 0;
+
+    // Describes the plug-in bundle at path without keeping it loaded; used by
+    // out-of-process scanning. The format is up to the caller.
+    virtual bool scan(const std::string& path, std::vector<std::uint8_t>& outDescription)
+    {
+        (void)path;
+        (void)outDescription;
+        return false;
+    }
+};
+
+using SandboxProcessorFactory = std::function<std::unique_ptr<SandboxProcessor>()>;
+
+bool isSandboxWorkerCommandLine(int argc, char** argv);
+// Serves requests until the host shuts the worker down or exits. Returns the
+// process exit code.
+int runSandboxWorker(int argc, char** argv, const SandboxProcessorFactory& factory);
+
+// Host-side handle of one worker process.
+class PluginSandboxProcess {
+public:
+    // Starts workerExecutable with the worker command line and waits until it
+    // has mapped the shared segment. Returns nullptr on failure.
+    static std::shared_ptr<PluginSandboxProcess> launch(const std::filesystem::path& workerExecutable);
+
+    PluginSandboxProcess(const PluginSandboxProcess&) = delete;
+    PluginSandboxProcess& operator=(const PluginSandboxProcess&) = delete;
+    ~PluginSandboxProcess();
+
+    // -1 when every slot is taken or the worker is gone.
+    int acquireSlot();
+    void releaseSlot(int slot);
+    int freeSlotCount() const;
+
+    // False once the worker crashed, stopped responding or was terminated.
+    bool alive() const { return !failed_.load(std::memory_order_acquire); }
+    void terminate();
+
+private:
+    friend class SandboxedPlugin;
+    struct Platform;
+
+    PluginSandboxProcess();
+
+    SandboxSlot& slot(int index);
+    std::uint32_t post(int slot);
+    bool replied(int slot, std::uint32_t sequence) const;
+    // False on timeout or when the worker died while waiting.
+    bool waitReply(int slot, std::uint32_t sequence, std::chrono::nanoseconds timeout);
+    // Waits on the reply word only and never reaps the worker, so the audio
+    // thread may call it.
+    bool awaitReply(int slot, std::uint32_t sequence, std::chrono::nanoseconds timeout);
+    void checkWorkerExited();
+
+    std::unique_ptr<Platform> platform_;
+    SandboxSharedMemory* shared_ = nullptr;
+    std::atomic<bool> failed_ {false};
+    mutable std::mutex slotsMutex_;
+    std::array<bool, kSandboxMaxSlots> slotUsed_ {};
+};
+
+// One plug-in running in a worker process. Control calls (load, prepare,
+// state) block and must not be made from the audio thread; process() is
+// real-time safe and waits for the worker for at most half a block.
+class SandboxedPlugin {
+public:
+    using ParameterSource = std::function<Steinberg::Vst::IParameterChanges*(int numSamples)>;
+
+    explicit SandboxedPlugin(std::shared_ptr<PluginSandboxProcess> process);
+    SandboxedPlugin(const SandboxedPlugin&) = delete;
+    SandboxedPlugin& operator=(const SandboxedPlugin&) = delete;
+    ~SandboxedPlugin();
+
+    // False when no slot was free in the worker.
+    bool valid() const { return slot_ >= 0; }
+    bool crashed() const { return !process_ || !process_->alive(); }
+
+    bool load(const std::string& path);
+    bool prepare(double sampleRate, int maxBlockSize);
+    void unload();
+    bool saveState(std::vector<std::uint8_t>& outState);
+    bool loadState(const std::uint8_t* data, std::size_t size);
+    // Runs SandboxProcessor::scan on a fresh processor in the worker; the
+    // slot's loaded plug-in is left alone.
+    bool scan(const std::string& path, std::vector<std::uint8_t>& outDescription);
+
+    bool prepared() const { return prepared_.load(std::memory_order_acquire); }
+    int blockSize() const { return blockSize_; }
+    int parameterCount() const { return parameterCount_; }
+    // Plug-in latency plus the block the exchange adds.
+    int latencySamples() const { return latencySamples_.load(std::memory_order_acquire); }
+
+    // Called once per block exchange to collect parameter points for it.
+    void setParameterSource(ParameterSource source);
+
+    // Plays the collected block and queues events, sorted by sampleOffset, at
+    // their position in the one being gathered. A block the worker has not
+    // finished in time plays as silence; while the worker is still busy the
+    // next block's events and parameter points are held for the request
+    // after it.
+    void process(float** outputs, int numChannels, int numSamples, const Steinberg::Vst::Event* events,
+                 std::size_t eventCount, const SandboxTransport& transport);
+
+    // Blocks collected in time and blocks that played as silence instead.
+    std::uint64_t exchangeCount() const { return exchangeCount_.load(std::memory_order_relaxed); }
+    std::uint64_t missedBlockCount() const { return missedBlockCount_.load(std::memory_order_relaxed); }
+    // Post-to-reply time of each collected block, and the part of it the
+    // worker spent rendering.
+    double averageRoundTripMicros() const;
+    double maxRoundTripMicros() const;
+    double averageRenderMicros() const;
+    double maxRenderMicros() const;
+
+private:
+    bool control(std::uint32_t command, std::chrono::milliseconds timeout);
+    bool drainInFlightRequest(std::chrono::nanoseconds timeout);
+    void exchange();
+    void gatherParameterPoints();
+    void holdPendingInput();
+
+    std::shared_ptr<PluginSandboxProcess> process_;
+    int slot_ = -1;
+    std::mutex controlMutex_;
+    std::atomic<bool> prepared_ {false};
+    std::atomic<int> latencySamples_ {0};
+    int blockSize_ = 0;
+    std::chrono::nanoseconds replyBudget_ {0};
+    int parameterCount_ = 0;
+    ParameterSource parameterSource_;
+
+    // Audio thread state.
+    std::array<std::vector<float>, kSandboxMaxChannels> ready_;
+    int cursor_ = 0;
+    std::vector<Steinberg::Vst::Event> pendingEvents_;
+    std::vector<SandboxParameterPoint> pendingPoints_;
+    SandboxTransport blockTransport_;
+    bool inFlight_ = false;
+    std::uint32_t inFlightSequence_ = 0;
+    std::chrono::steady_clock::time_point inFlightSince_;
+
+    std::atomic<std::uint64_t> exchangeCount_ {0};
+    std::atomic<std::uint64_t> missedBlockCount_ {0};
+    std::atomic<std::uint64_t> totalRoundTripNanos_ {0};
+    std::atomic<std::uint64_t> maxRoundTripNanos_ {0};
+    std::atomic<std::uint64_t> totalRenderNanos_ {0};
+    std::atomic<std::uint64_t> maxRenderNanos_ {0};
+};
+
+} // namespace kj
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+namespace kj {
+
+// Debug check that the audio path does not allocate. While a guard is alive
+// on a thread, every operator new on that thread is counted and the first one
+// per guard is reported on stderr. Debug builds define
+// KJ_REALTIME_ALLOCATION_GUARD; otherwise guards compile to nothing.
+class RealtimeAllocationGuard {
+public:
+#ifdef KJ_REALTIME_ALLOCATION_GUARD
+    RealtimeAllocationGuard();
+    ~RealtimeAllocationGuard();
+    // Allocations made inside guards on any thread since startup.
+    static std::size_t violationCount();
+#else
+    RealtimeAllocationGuard() {}
+    static std::size_t violationCount() { return 0; }
+#endif
+    RealtimeAllocationGuard(const RealtimeAllocationGuard&) = delete;
+    RealtimeAllocationGuard& operator=(const RealtimeAllocationGuard&) = delete;
+};
+
+// Lifts the guard for code the host does not own, such as the plug-in's own
+// process() call.
+class RealtimeAllocationExemption {
+public:
+#ifdef KJ_REALTIME_ALLOCATION_GUARD
+    RealtimeAllocationExemption();
+    ~RealtimeAllocationExemption();
+#else
+    RealtimeAllocationExemption() {}
+#endif
+    RealtimeAllocationExemption(const RealtimeAllocationExemption&) = delete;
+    RealtimeAllocationExemption& operator=(const RealtimeAllocationExemption&) = delete;
+};
+
+} // namespace kj
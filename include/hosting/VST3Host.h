@@ -24,6 +24,8 @@
 #ifdef _WIN32
 #include "hosting/VST3AsyncLoader.h"
 #endif
+#include "hosting/AutomationLane.h"
+#include "hosting/VstParameterQueue.h"
 #include "pluginterfaces/base/fplatform.h"
 #include "pluginterfaces/base/funknown.h"
 #include "pluginterfaces/gui/iplugview.h"
@@ -46,16 +48,31 @@ namespace kj {
 #ifdef _WIN32
 class PlugFrame;
 #endif
+class PluginSandboxProcess;
+class SandboxedPlugin;
+struct PluginBundleInfo;
 
 constexpr size_t VST3_STRING128_SIZE = 128;
 using String128 = Steinberg::Vst::TChar[VST3_STRING128_SIZE];
 
 class VST3Host : public std::enable_shared_from_this<VST3Host> {
 public:
-    VST3Host() = default;
+    // Out of line: sandbox_ holds a type only declared here.
+    VST3Host();
     ~VST3Host();
 
     bool load(const std::string& path);
+    // Loads the plug-in into a worker process instead of this one. Audio,
+    // events, parameters and state then go through the sandbox, which adds
+    // one block of latency; the plug-in has no editor.
+    bool loadSandboxed(const std::string& path, std::shared_ptr<PluginSandboxProcess> sandbox);
+    bool isSandboxed() const { return sandbox_ != nullptr; }
+    // True once the worker hosting this plug-in crashed or stopped responding.
+    bool sandboxCrashed() const;
+    // Describes every class in the bundle, with bus layouts and latency of its
+    // audio processors, without creating controllers or editors. Used by the
+    // plug-in database; may run on any thread.
+    static bool scanBundle(const std::string& path, PluginBundleInfo& info);
 #ifdef _WIN32
     void loadPluginAsync(const std::wstring& path);
     void setOnPluginLoaded(std::function<void(bool)> callback);
@@ -64,7 +81,10 @@ public:
     bool ShowPluginEditor();
     void unload();
 
-    bool prepare(double sampleRate, int maxBlockSize);
+    // processMode is kRealtime for the engine; offline renders (track freeze)
+    // pass kOffline so plug-ins may use their high-quality paths.
+    bool prepare(double sampleRate, int maxBlockSize,
+                 Steinberg::int32 processMode = Steinberg::Vst::kRealtime);
     void process(float** inputs, int numInputChannels, float** outputs, int numOutputChannels, int numSamples);
     void process(float** outputs, int numChannels, int numSamples);
     void renderAudio(float** out, int numChannels, int numSamples);
@@ -73,8 +93,32 @@ public:
         return Steinberg::Vst::SpeakerArr::getChannelCount(outputArrangement_);
     }
 
+    // Every audio output bus of the plug-in, main bus first; valid after
+    // prepare(). Multi-output instruments render their extra outputs here.
+    int audioOutputBusCount() const { return static_cast<int>(outputBuses_.size()); }
+    int audioOutputBusChannelCount(int bus) const;
+    // Routes an output bus straight into caller-owned channel buffers, each at
+    // least as long as the process() calls that follow, so the plug-in renders
+    // into them without a copy. Bus channels beyond numChannels render into
+    // the host's own buffers and are dropped; nullptr maps none of them.
+    // Call from the thread that calls process(), or before processing starts.
+    void mapOutputBus(int bus, float* const* channels, int numChannels);
+
+    // First auxiliary (kAux) audio input bus, the plug-in's sidechain input,
+    // or -1 if it has none. Valid after prepare(); sandboxed plug-ins have none.
+    int sidechainInputBus() const { return sidechainInputBus_; }
+    // Feeds an input bus from caller-owned channel buffers without copying.
+    // Bus channels beyond numChannels reuse the last given channel, so a mono
+    // source feeds both sides of a stereo sidechain; nullptr feeds silence.
+    // Same threading rules as mapOutputBus().
+    void mapInputBus(int bus, float* const* channels, int numChannels);
+
     struct HostTransportState {
         double samplePosition = 0.0;
+        // Quarter-note positions from the host transport; negative values
+        // fall back to deriving the position from samplePosition and tempo.
+        double projectTimeMusic = -1.0;
+        double barPositionMusic = -1.0;
         double tempo = 120.0;
         Steinberg::int32 timeSigNum = 4;
         Steinberg::int32 timeSigDen = 4;
@@ -85,6 +129,24 @@ public:
 
     void queueEvent(const Steinberg::Vst::Event& ev);
     void queueNoteEvent(const Steinberg::Vst::Event& ev);
+    // Parameter point at a sample time on the host's processing clock (samples
+    // processed since prepare()). Used by the sandbox worker, which receives
+    // points with their block offsets.
+    void queueParameterPoint(Steinberg::Vst::ParamID paramId, Steinberg::Vst::ParamValue value,
+                             std::int64_t sampleTime);
+
+    // Lanes played while the transport runs and recording is off. Read
+    // during process() only; the caller keeps them alive until it returns
+    // and sets them from the thread that calls process(). Lanes beyond
+    // kMaxAutomationLanes are ignored.
+    static constexpr size_t kMaxAutomationLanes = 256;
+    void setAutomationLanes(const AutomationLanes* lanes) { automationLanes_ = lanes; }
+    // While on and the transport runs, GUI edits and the plug-in's own output
+    // parameter changes are stamped with their project position and pushed
+    // into automationCapture(). Sandboxed plug-ins only record GUI edits.
+    void setAutomationRecording(bool enabled) { automationRecording_.store(enabled, std::memory_order_release); }
+    bool automationRecording() const { return automationRecording_.load(std::memory_order_acquire); }
+    AutomationCaptureQueue& automationCapture() { return automationCapture_; }
 
     void setOwningTrackId(int trackId) { owningTrackId_.store(trackId, std::memory_order_release); }
 
@@ -96,7 +158,18 @@ public:
 
     bool isPluginLoaded() const;
     bool isPluginReady() const;
+    // True once prepare() succeeded for this format in realtime mode. Lets the
+    // engine adopt a host prepared on a loader thread without preparing it again.
+    bool isPreparedFor(double sampleRate, int maxBlockSize) const;
+    const std::filesystem::path& pluginPath() const { return pluginPath_; }
+    // Bumped whenever parameters or state change from the host side, so cached
+    // renders of this plug-in can tell they are stale.
+    std::uint64_t editGeneration() const { return editGeneration_.load(std::memory_order_acquire); }
     bool isPluginLoading() const;
+    // Processing latency reported by the plug-in, refreshed on prepare() and
+    // when the plug-in restarts with kLatencyChanged. Safe from any thread.
+    Steinberg::int32 latencySamples() const { return latencySamples_.load(std::memory_order_acquire); }
+    Steinberg::int32 parameterCount() const;
     bool waitUntilReady();
     bool waitForPluginReady();
 
@@ -182,6 +255,23 @@ private:
             head_.store(next, std::memory_order_release);
         }
 
+        // Hands every queued item to fn in order without copying it out.
+        template <typename Fn>
+        size_t popEach(Fn&& fn)
+        {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            const size_t head = head_.load(std::memory_order_acquire);
+            size_t count = 0;
+            while (tail != head)
+            {
+                fn(buffer_[tail]);
+                tail = increment(tail);
+                ++count;
+            }
+            tail_.store(tail, std::memory_order_release);
+            return count;
+        }
+
         size_t popAll(std::vector<T>& out)
         {
             const size_t availableCapacity = capacity();
@@ -211,11 +301,6 @@ private:
         std::atomic<size_t> tail_ {0};
     };
 
-    struct PendingParameterChange {
-        Steinberg::Vst::ParamID id {Steinberg::Vst::kNoParamId};
-        Steinberg::Vst::ParamValue value {0.0};
-    };
-
     class HostApplication : public Steinberg::Vst::IHostApplication
     {
     public:
@@ -260,13 +345,17 @@ private:
     void queueParameterChange(Steinberg::Vst::ParamID paramId, Steinberg::Vst::ParamValue value, bool notifyController = true);
     void onControllerParameterChanged(Steinberg::Vst::ParamID paramId, Steinberg::Vst::ParamValue value);
     void onRestartComponent(Steinberg::int32 flags);
+    void refreshLatency();
     void onComponentRequestOpenEditor(const char* viewType);
     bool createViewForRequestedType(const char* preferredType, Steinberg::IPtr<Steinberg::IPlugView>& outView,
                                     std::string& usedType, std::string& platformType,
                                     Steinberg::Vst::IEditController* controllerOverride = nullptr);
-    void processInternal(float** inputs, int numInputChannels, float** outputs, int numOutputChannels, int numSamples,
-                         const std::vector<PendingParameterChange>& changes,
-                         const std::vector<Steinberg::Vst::Event>& events);
+    void processSandboxed(float** outputs, int numChannels, int numSamples);
+    void processBlock(float** inputs, int numInputChannels, float** outputs, int numOutputChannels, int offset,
+                      int numSamples);
+    void playAutomation(int numSamples);
+    void captureAutomation(Steinberg::Vst::IParameterChanges* changes);
+    void advanceProcessContext(int numSamples);
     void unloadLocked();
     void suspendProcessing();
     void resumeProcessing();
@@ -298,6 +387,7 @@ private:
     bool processingActive_ = false;
     Steinberg::int32 mainInputBusIndex_ = -1;
     Steinberg::int32 mainOutputBusIndex_ = -1;
+    int sidechainInputBus_ = -1;
     Steinberg::Vst::SpeakerArrangement inputArrangement_ = Steinberg::Vst::SpeakerArr::kEmpty;
     Steinberg::Vst::SpeakerArrangement outputArrangement_ = Steinberg::Vst::SpeakerArr::kEmpty;
     mutable std::mutex vst3Mutex_;
@@ -306,20 +396,49 @@ private:
     std::atomic<uint32_t> activeProcessCount_ {0};
     std::atomic<bool> pendingEditorShow_ {false};
     std::atomic<bool> guiAttachReady_ {false};
+    std::atomic<Steinberg::int32> latencySamples_ {0};
+    std::atomic<std::uint64_t> editGeneration_ {0};
+    Steinberg::int32 processMode_ = Steinberg::Vst::kRealtime;
 
-    Steinberg::Vst::ParameterChanges inputParameterChanges_;
-    SpscRingBuffer<PendingParameterChange> parameterChangeQueue_ {512};
-    std::vector<PendingParameterChange> processParameterChanges_;
+    VstParameterQueue parameterQueue_;
+    std::unique_ptr<SandboxedPlugin> sandbox_;
+    HostTransportState sandboxTransport_;
     Steinberg::Vst::EventList inputEventList_;
     SpscRingBuffer<Steinberg::Vst::Event> eventQueue_ {512};
     std::vector<Steinberg::Vst::Event> processEvents_;
     Steinberg::Vst::ProcessContext processContext_ {};
     std::vector<uint8_t> controllerStateData_;
 
-    std::vector<std::vector<float>> internalIn_;
-    std::vector<std::vector<float>> internalOut_;
-    std::vector<float*> inputChannelPointers_;
-    std::vector<float*> outputChannelPointers_;
+    // Playback position in each lane and the value last sent, so constant
+    // stretches send nothing. Reserved in prepare(); reset when the lanes
+    // change.
+    struct AutomationCursor {
+        size_t hint = 0;
+        float sent = 0.0f;
+        bool hasSent = false;
+    };
+    const AutomationLanes* automationLanes_ = nullptr;
+    const AutomationLanes* cursorLanes_ = nullptr;
+    std::vector<AutomationCursor> automationCursors_;
+    std::atomic<bool> automationRecording_ {false};
+    AutomationCaptureQueue automationCapture_;
+
+    // Sized in prepare() for every audio bus so processing never allocates.
+    // Channel tables hold all buses back to back and each AudioBusBuffers
+    // points at its slice; the storage tables keep the host-owned buffer of
+    // each channel, and the mapping tables the caller buffers from
+    // mapInputBus() and mapOutputBus().
+    std::vector<float> busStorage_;
+    std::vector<Steinberg::Vst::AudioBusBuffers> inputBuses_;
+    std::vector<Steinberg::Vst::AudioBusBuffers> outputBuses_;
+    std::vector<float*> inputChannelTable_;
+    std::vector<float*> outputChannelTable_;
+    std::vector<float*> inputStorageTable_;
+    std::vector<float*> outputStorageTable_;
+    std::vector<float*> inputMappings_;
+    std::vector<float*> outputMappings_;
+    std::vector<size_t> inputBusFirstChannel_;
+    std::vector<size_t> outputBusFirstChannel_;
 
     std::string requestedViewType_ {Steinberg::Vst::ViewType::kEditor};
     std::string currentViewType_;
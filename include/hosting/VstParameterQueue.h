@@ -1,33 +1,168 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
 #include <vector>
 
-#include "pluginterfaces/vst/ivstprocesscontext.h"
+#include "core/seqlock.h"
 #include "pluginterfaces/vst/ivstaudioprocessor.h"
-#include "public.sdk/source/vst/hosting/parameterchanges.h"
+#include "pluginterfaces/vst/ivstparameterchanges.h"
 
 namespace kj {
 
+// Parameter automation for one plug-in instance. Producers (GUI edits,
+// controller performEdit, modulation) push timestamped points into a
+// lock-free ring. Once per block the audio thread drains the ring, coalesces
+// the points per ParamID and hands the processor one multi-point queue per
+// parameter with sample offsets inside the block. All storage is allocated in
+// the constructor and prepare(); the audio thread never locks or allocates.
 class VstParameterQueue {
 public:
+    static constexpr std::size_t kRingCapacity = 4096;
+    static constexpr Steinberg::int32 kMaxPointsPerParameter = 32;
+    // Sample time for points that should land at the start of the next block.
+    static constexpr std::int64_t kAsSoonAsPossible = INT64_MIN;
+
+    VstParameterQueue();
+
+    // Non-realtime, with processing stopped. Sizes the per-block queues for
+    // the plug-in's parameter count and restarts the block clock.
+    void prepare(Steinberg::int32 maxParameters, double sampleRate, Steinberg::int32 maxBlockSize);
+    // Non-realtime, with processing stopped. Drops every pending point.
+    void clear();
+
+    // Producer side; any thread except the audio thread.
+    // GUI edits are stamped one block ahead of the audio clock so the spacing
+    // of a knob sweep is kept inside the next block.
     void push_gui_change(Steinberg::Vst::ParamID id, double normalized_value);
+    void push_change(Steinberg::Vst::ParamID id, double normalized_value, std::int64_t sample_time);
+    // Retries points that did not fit into the ring. Called when processing
+    // resumes; every push retries as well.
+    void flush_overflow();
+    [[nodiscard]] std::int64_t estimated_sample_time() const;
+
+    // Audio thread. Adds a point to the next block collected, sampleOffset
+    // samples into it. Used for automation playback, which is already on the
+    // audio thread and must not be recorded again.
+    void push_block_point(Steinberg::Vst::ParamID id, double normalized_value, Steinberg::int32 sampleOffset);
+    // Audio thread. Returns the changes for the next numSamples samples (or
+    // nullptr if there are none) and advances the block clock.
+    Steinberg::Vst::IParameterChanges* collect_block(Steinberg::int32 numSamples);
+    // Also hands the processor a preallocated queue for its output changes.
     void apply_to_audio_processor(Steinberg::Vst::ProcessData& data);
+    // Audio thread. GUI edits delivered by the last collect_block, once; the
+    // next call returns nullptr until another block has been collected.
+    Steinberg::Vst::IParameterChanges* take_gui_changes();
+    // Audio thread. What the processor reported through outputParameterChanges
+    // in the last apply_to_audio_processor call.
+    Steinberg::Vst::IParameterChanges* output_changes();
+
+    // Points that could not be delivered (unknown parameters beyond the
+    // prepared count). Readable from any thread.
+    [[nodiscard]] std::uint64_t dropped_points() const { return dropped_points_.load(std::memory_order_relaxed); }
 
 private:
-    struct ParameterChange
+    struct ParameterPoint
     {
-        Steinberg::Vst::ParamID id{};
+        Steinberg::Vst::ParamID id{Steinberg::Vst::kNoParamId};
         Steinberg::Vst::ParamValue value{};
-        Steinberg::int32 sampleOffset{0};
+        std::int64_t sampleTime{kAsSoonAsPossible};
+        std::uint64_t sequence{0};
+        bool fromGui{false};
+    };
+
+    struct ClockSnapshot
+    {
+        std::int64_t blockStartSample = 0;
+        std::int64_t blockStartNanos = 0; // steady clock; 0 until the first block
+        double sampleRate = 0.0;
+        std::int32_t latencySamples = 0;
+    };
+
+    // Fixed-capacity IParamValueQueue. Points arrive in time order; a point on
+    // the same offset replaces the previous one and a full queue moves its
+    // last point forward, so the final value always survives.
+    class PointQueue : public Steinberg::Vst::IParamValueQueue
+    {
+    public:
+        void reset(Steinberg::Vst::ParamID id);
+        void append(Steinberg::int32 sampleOffset, Steinberg::Vst::ParamValue value);
+
+        Steinberg::tresult PLUGIN_API queryInterface(const Steinberg::TUID iid, void** obj) override;
+        Steinberg::uint32 PLUGIN_API addRef() override { return 1; }
+        Steinberg::uint32 PLUGIN_API release() override { return 1; }
+
+        Steinberg::Vst::ParamID PLUGIN_API getParameterId() override { return id_; }
+        Steinberg::int32 PLUGIN_API getPointCount() override { return count_; }
+        Steinberg::tresult PLUGIN_API getPoint(Steinberg::int32 index, Steinberg::int32& sampleOffset,
+                                               Steinberg::Vst::ParamValue& value) override;
+        Steinberg::tresult PLUGIN_API addPoint(Steinberg::int32 sampleOffset, Steinberg::Vst::ParamValue value,
+                                               Steinberg::int32& index) override;
+
+    private:
+        struct Point
+        {
+            Steinberg::int32 offset = 0;
+            Steinberg::Vst::ParamValue value = 0.0;
+        };
+
+        Steinberg::Vst::ParamID id_{Steinberg::Vst::kNoParamId};
+        std::array<Point, kMaxPointsPerParameter> points_{};
+        Steinberg::int32 count_ = 0;
     };
 
-    std::atomic<bool> is_dirty_{false};
-    std::vector<ParameterChange> change_buffer_;
-    std::mutex access_mutex_;
-    Steinberg::Vst::ParameterChanges parameter_changes_{};
+    class BlockChanges : public Steinberg::Vst::IParameterChanges
+    {
+    public:
+        void resize(Steinberg::int32 maxParameters);
+        void clear() { used_ = 0; }
+        // Next free queue; nullptr once every prepared queue is in use.
+        PointQueue* append(Steinberg::Vst::ParamID id);
+
+        Steinberg::tresult PLUGIN_API queryInterface(const Steinberg::TUID iid, void** obj) override;
+        Steinberg::uint32 PLUGIN_API addRef() override { return 1; }
+        Steinberg::uint32 PLUGIN_API release() override { return 1; }
+
+        Steinberg::int32 PLUGIN_API getParameterCount() override { return used_; }
+        Steinberg::Vst::IParamValueQueue* PLUGIN_API getParameterData(Steinberg::int32 index) override;
+        Steinberg::Vst::IParamValueQueue* PLUGIN_API addParameterData(const Steinberg::Vst::ParamID& id,
+                                                                       Steinberg::int32& index) override;
+
+    private:
+        std::vector<PointQueue> queues_;
+        Steinberg::int32 used_ = 0;
+    };
+
+    void push_point(Steinberg::Vst::ParamID id, double normalized_value, std::int64_t sample_time, bool from_gui);
+    bool try_push_locked(const ParameterPoint& point);
+
+    // Producer side, serialised by producer_mutex_ (never taken by audio).
+    std::mutex producer_mutex_;
+    std::vector<ParameterPoint> overflow_;
+    std::uint64_t next_sequence_ = 0;
+
+    // Ring shared between producers and the audio thread.
+    std::vector<ParameterPoint> ring_;
+    std::atomic<std::size_t> head_{0};
+    std::atomic<std::size_t> tail_{0};
+
+    // Audio thread only.
+    std::vector<ParameterPoint> pending_;
+    std::vector<ParameterPoint> due_;
+    BlockChanges changes_;
+    BlockChanges gui_changes_;
+    BlockChanges output_changes_;
+    bool gui_changes_pending_ = false;
+    std::int64_t block_start_sample_ = 0;
+    double sample_rate_ = 0.0;
+    Steinberg::int32 max_block_size_ = 0;
+
+    SeqLockValue<ClockSnapshot> clock_{ClockSnapshot{}};
+    std::atomic<std::uint64_t> dropped_points_{0};
 };
 
 } // namespace kj
-
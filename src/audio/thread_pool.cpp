@@ -1,5 +1,7 @@
 #include "audio/thread_pool.h"
 
+#include "core/denormals.h"
+
 #include <algorithm>
 
 namespace {
@@ -78,6 +80,8 @@ bool ThreadPool::enqueue(Job job)
 
 void ThreadPool::workerLoop()
 {
+    // Workers run track DSP for the render thread.
+    ScopedDenormalFlush denormalFlush;
     while (true)
     {
         Job job;
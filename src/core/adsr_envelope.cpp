@@ -0,0 +1,198 @@
+#include "core/adsr_envelope.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Longer than any envelope the UI allows; keeps the count finite when a
+    // segment is configured with an absurd time.
+    constexpr double kMaxSegmentSamples = 1e15;
+} // namespace
+
+void AdsrEnvelope::configure(double attack, double decay, double sustain, double release, double sampleRate)
+{
+    const double sr = sampleRate > 0.0 ? sampleRate : 44100.0;
+    const double safeSustain = std::clamp(sustain, 0.0, 1.0);
+    if (attack == m_attack && decay == m_decay && safeSustain == m_sustain && release == m_release &&
+        sr == m_sampleRate)
+        return;
+
+    if (attack != m_attack || sr != m_sampleRate)
+        m_attackCoefficient = coefficientFor(attack, sr);
+    if (decay != m_decay || sr != m_sampleRate)
+        m_decayCoefficient = coefficientFor(decay, sr);
+    if (release != m_release || sr != m_sampleRate)
+        m_releaseCoefficient = coefficientFor(release, sr);
+    m_attack = attack;
+    m_decay = decay;
+    m_sustain = safeSustain;
+    m_release = release;
+    m_sampleRate = sr;
+    // Zero is what a fresh AdsrSegment holds, so skip it on wrap-around.
+    if (++m_generation == 0)
+        m_generation = 1;
+}
+
+double AdsrEnvelope::coefficientFor(double seconds, double sampleRate)
+{
+    if (!(seconds > 0.0))
+        return 0.0;
+
+    const double totalSamples = std::max(seconds * sampleRate, 1.0);
+    const double coefficient = std::exp(std::log(kEpsilon) / totalSamples);
+    if (!std::isfinite(coefficient) || coefficient < 0.0 || coefficient >= 1.0)
+        return 0.0;
+    return coefficient;
+}
+
+bool AdsrEnvelope::curveFor(EnvelopeStage stage, Curve& curve) const
+{
+    switch (stage)
+    {
+    case EnvelopeStage::Attack:
+        curve = {1.0, m_attackCoefficient};
+        return true;
+    case EnvelopeStage::Decay:
+        curve = {m_sustain, m_decayCoefficient};
+        return true;
+    case EnvelopeStage::Release:
+        curve = {0.0, m_releaseCoefficient};
+        return true;
+    case EnvelopeStage::Idle:
+    case EnvelopeStage::Sustain:
+        break;
+    }
+    return false;
+}
+
+EnvelopeStage AdsrEnvelope::nextStage(EnvelopeStage stage)
+{
+    switch (stage)
+    {
+    case EnvelopeStage::Attack:
+        return EnvelopeStage::Decay;
+    case EnvelopeStage::Decay:
+        return EnvelopeStage::Sustain;
+    case EnvelopeStage::Release:
+        return EnvelopeStage::Idle;
+    case EnvelopeStage::Idle:
+    case EnvelopeStage::Sustain:
+        break;
+    }
+    return stage;
+}
+
+std::uint64_t AdsrEnvelope::segmentLength(double value, const Curve& curve)
+{
+    // The segment ends in the first sample k with distance * c^k <= tolerance.
+    const double distance = std::abs(value - curve.target);
+    const double tolerance = std::max(kEpsilon, std::abs(curve.target) * kEpsilon);
+    if (curve.coefficient <= 0.0 || !(distance > tolerance))
+        return 1;
+
+    const double samples = std::ceil(std::log(tolerance / distance) / std::log(curve.coefficient));
+    if (!std::isfinite(samples) || samples < 1.0)
+        return 1;
+    return static_cast<std::uint64_t>(std::min(samples, kMaxSegmentSamples));
+}
+
+void AdsrEnvelope::sync(EnvelopeStage stage, double value, AdsrSegment& segment) const
+{
+    if (segment.stage == stage && segment.generation == m_generation && segment.value == value)
+        return;
+
+    Curve curve;
+    segment.stage = stage;
+    segment.generation = m_generation;
+    segment.value = value;
+    segment.remaining = curveFor(stage, curve) ? segmentLength(value, curve) : 0;
+}
+
+double AdsrEnvelope::advance(EnvelopeStage& stage, double value, AdsrSegment& segment) const
+{
+    Curve curve;
+    if (!curveFor(stage, curve))
+    {
+        value = stage == EnvelopeStage::Sustain ? m_sustain : 0.0;
+        sync(stage, value, segment);
+        return value;
+    }
+
+    sync(stage, value, segment);
+    if (segment.remaining > 1)
+    {
+        // The coefficient is in [0, 1), so a finite value stays finite; a
+        // track that feeds in a non-finite one is caught by the engine's
+        // per-block fault check.
+        value = curve.target + (value - curve.target) * curve.coefficient;
+        --segment.remaining;
+        segment.value = value;
+        return value;
+    }
+
+    stage = nextStage(stage);
+    value = stage == EnvelopeStage::Idle ? 0.0 : curve.target;
+    segment.stage = stage;
+    segment.value = value;
+    segment.remaining = curveFor(stage, curve) ? segmentLength(value, curve) : 0;
+    return value;
+}
+
+std::size_t AdsrEnvelope::render(EnvelopeStage& stage, double& value, AdsrSegment& segment, float* out,
+                                 std::size_t frames) const
+{
+    if (frames == 0 || !out)
+        return 0;
+
+    Curve curve;
+    if (!curveFor(stage, curve))
+    {
+        value = stage == EnvelopeStage::Sustain ? m_sustain : 0.0;
+        sync(stage, value, segment);
+        std::fill(out, out + frames, static_cast<float>(value));
+        return frames;
+    }
+
+    sync(stage, value, segment);
+    const auto curveSamples =
+        static_cast<std::size_t>(std::min<std::uint64_t>(segment.remaining - 1, static_cast<std::uint64_t>(frames)));
+
+    // value(k) = target + distance * c^k. Four lanes a step apart advance by
+    // c^4 together, so the loop carries no dependency the compiler cannot
+    // vectorise.
+    const double c = curve.coefficient;
+    const double lanes[4] = {c, c * c, c * c * c, c * c * c * c};
+    double distance = value - curve.target;
+    std::size_t i = 0;
+    for (; i + 4 <= curveSamples; i += 4)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+            out[i + lane] = static_cast<float>(curve.target + distance * lanes[lane]);
+        distance *= lanes[3];
+    }
+    for (; i < curveSamples; ++i)
+    {
+        distance *= c;
+        out[i] = static_cast<float>(curve.target + distance);
+    }
+
+    value = std::isfinite(distance) ? curve.target + distance : 0.0;
+    segment.remaining -= curveSamples;
+    segment.value = value;
+    if (curveSamples == frames)
+        return frames;
+
+    value = advance(stage, value, segment);
+    out[curveSamples] = static_cast<float>(value);
+    return curveSamples + 1;
+}
+
+std::uint64_t AdsrEnvelope::samplesUntilStageEnd(EnvelopeStage stage, double value, AdsrSegment& segment) const
+{
+    Curve curve;
+    if (!curveFor(stage, curve))
+        return 0;
+    sync(stage, value, segment);
+    return segment.remaining;
+}
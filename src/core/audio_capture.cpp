@@ -0,0 +1,464 @@
+#include "core/audio_capture.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <audioclient.h>
+#include <mmdeviceapi.h>
+#include <functiondiscoverykeys_devpkey.h>
+#include <ksmedia.h>
+#include <mmreg.h>
+#include <propvarutil.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iostream>
+
+AudioFrameRing::AudioFrameRing(std::size_t capacityFrames, int channels)
+    : m_samples(capacityFrames * static_cast<std::size_t>(std::max(channels, 0)), 0.0f),
+      m_capacityFrames(capacityFrames),
+      m_channels(std::max(channels, 0))
+{
+}
+
+bool AudioFrameRing::write(const float* interleaved, std::size_t frames)
+{
+    if (frames == 0 || m_channels == 0)
+        return frames == 0;
+
+    const std::size_t writeFrame = m_writeFrame.load(std::memory_order_relaxed);
+    const std::size_t readFrame = m_readFrame.load(std::memory_order_acquire);
+    if (m_capacityFrames - (writeFrame - readFrame) < frames)
+        return false;
+
+    const auto channels = static_cast<std::size_t>(m_channels);
+    const std::size_t start = writeFrame % m_capacityFrames;
+    const std::size_t firstPart = std::min(frames, m_capacityFrames - start);
+    std::memcpy(m_samples.data() + start * channels, interleaved, firstPart * channels * sizeof(float));
+    if (firstPart < frames)
+        std::memcpy(m_samples.data(), interleaved + firstPart * channels, (frames - firstPart) * channels * sizeof(float));
+
+    m_writeFrame.store(writeFrame + frames, std::memory_order_release);
+    return true;
+}
+
+std::size_t AudioFrameRing::read(float* interleaved, std::size_t maxFrames)
+{
+    const std::size_t readFrame = m_readFrame.load(std::memory_order_relaxed);
+    const std::size_t writeFrame = m_writeFrame.load(std::memory_order_acquire);
+    const std::size_t frames = std::min(maxFrames, writeFrame - readFrame);
+    if (frames == 0)
+        return 0;
+
+    const auto channels = static_cast<std::size_t>(m_channels);
+    const std::size_t start = readFrame % m_capacityFrames;
+    const std::size_t firstPart = std::min(frames, m_capacityFrames - start);
+    std::memcpy(interleaved, m_samples.data() + start * channels, firstPart * channels * sizeof(float));
+    if (firstPart < frames)
+        std::memcpy(interleaved + firstPart * channels, m_samples.data(), (frames - firstPart) * channels * sizeof(float));
+
+    m_readFrame.store(readFrame + frames, std::memory_order_release);
+    return frames;
+}
+
+std::size_t AudioFrameRing::skip(std::size_t frames)
+{
+    const std::size_t readFrame = m_readFrame.load(std::memory_order_relaxed);
+    const std::size_t writeFrame = m_writeFrame.load(std::memory_order_acquire);
+    frames = std::min(frames, writeFrame - readFrame);
+    m_readFrame.store(readFrame + frames, std::memory_order_release);
+    return frames;
+}
+
+std::size_t AudioFrameRing::availableFrames() const
+{
+    return m_writeFrame.load(std::memory_order_acquire) - m_readFrame.load(std::memory_order_acquire);
+}
+
+BufferAudioCaptureBackend::BufferAudioCaptureBackend(std::shared_ptr<const SampleBuffer> source,
+                                                     std::uint32_t packetFrames, std::uint32_t latencyFrames,
+                                                     bool realtime)
+    : m_source(std::move(source)),
+      m_packetFrames(std::max<std::uint32_t>(packetFrames, 1)),
+      m_latencyFrames(latencyFrames),
+      m_realtime(realtime)
+{
+}
+
+BufferAudioCaptureBackend::~BufferAudioCaptureBackend()
+{
+    stop();
+}
+
+bool BufferAudioCaptureBackend::start(FrameSink sink)
+{
+    stop();
+    if (!m_source || m_source->channels <= 0 || m_source->sampleRate <= 0 || !sink)
+        return false;
+
+    m_finished.store(false, std::memory_order_release);
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread([this, sink = std::move(sink)]() {
+        const auto channels = static_cast<std::size_t>(m_source->channels);
+        const std::size_t totalFrames = m_source->frameCount();
+        const auto packetDuration = std::chrono::duration<double>(static_cast<double>(m_packetFrames) /
+                                                                  static_cast<double>(m_source->sampleRate));
+        auto nextPacket = std::chrono::steady_clock::now();
+
+        std::size_t frame = 0;
+        while (frame < totalFrames && m_running.load(std::memory_order_acquire))
+        {
+            const std::size_t frames = std::min<std::size_t>(m_packetFrames, totalFrames - frame);
+            sink(m_source->samples.data() + frame * channels, static_cast<std::uint32_t>(frames));
+            frame += frames;
+            if (m_realtime)
+            {
+                nextPacket += std::chrono::duration_cast<std::chrono::steady_clock::duration>(packetDuration);
+                std::this_thread::sleep_until(nextPacket);
+            }
+        }
+        m_finished.store(frame >= totalFrames, std::memory_order_release);
+    });
+    return true;
+}
+
+void BufferAudioCaptureBackend::stop()
+{
+    m_running.store(false, std::memory_order_release);
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+namespace
+{
+#if defined(_WIN32)
+    constexpr REFERENCE_TIME kCaptureBufferDuration = 1000000; // 100 ms
+
+    template <typename T>
+    void releaseCom(T*& object)
+    {
+        if (object)
+        {
+            object->Release();
+            object = nullptr;
+        }
+    }
+
+    enum class CaptureSampleFormat
+    {
+        Unsupported,
+        Float32,
+        Pcm16,
+        Pcm24In32,
+    };
+
+    CaptureSampleFormat captureSampleFormat(const WAVEFORMATEX* format)
+    {
+        if (!format)
+            return CaptureSampleFormat::Unsupported;
+
+        WORD tag = format->wFormatTag;
+        WORD validBits = format->wBitsPerSample;
+        if (tag == WAVE_FORMAT_EXTENSIBLE && format->cbSize >= (sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX)))
+        {
+            const auto* extensible = reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(format);
+            if (IsEqualGUID(extensible->SubFormat, KSDATAFORMAT_SUBTYPE_IEEE_FLOAT))
+                tag = WAVE_FORMAT_IEEE_FLOAT;
+            else if (IsEqualGUID(extensible->SubFormat, KSDATAFORMAT_SUBTYPE_PCM))
+                tag = WAVE_FORMAT_PCM;
+            if (extensible->Samples.wValidBitsPerSample != 0)
+                validBits = extensible->Samples.wValidBitsPerSample;
+        }
+
+        if (tag == WAVE_FORMAT_IEEE_FLOAT && format->wBitsPerSample == 32)
+            return CaptureSampleFormat::Float32;
+        if (tag == WAVE_FORMAT_PCM && format->wBitsPerSample == 16)
+            return CaptureSampleFormat::Pcm16;
+        if (tag == WAVE_FORMAT_PCM && format->wBitsPerSample == 32 && validBits <= 32)
+            return CaptureSampleFormat::Pcm24In32;
+        return CaptureSampleFormat::Unsupported;
+    }
+
+    // Shared-mode capture on its own thread. The COM objects are created,
+    // used and released on that thread; the sink sees device packets as they
+    // arrive, converted to float in a buffer sized when the stream opens.
+    class WasapiAudioCaptureBackend : public AudioCaptureBackend
+    {
+    public:
+        explicit WasapiAudioCaptureBackend(std::wstring deviceId) : m_deviceId(std::move(deviceId)) {}
+        ~WasapiAudioCaptureBackend() override { stop(); }
+
+        bool start(FrameSink sink) override
+        {
+            stop();
+            if (!sink)
+                return false;
+
+            std::promise<bool> opened;
+            auto openResult = opened.get_future();
+            m_running.store(true, std::memory_order_release);
+            m_thread = std::thread([this, sink = std::move(sink), opened = std::move(opened)]() mutable {
+                captureLoop(sink, opened);
+            });
+            if (!openResult.get())
+            {
+                stop();
+                return false;
+            }
+            return true;
+        }
+
+        void stop() override
+        {
+            m_running.store(false, std::memory_order_release);
+            if (m_thread.joinable())
+                m_thread.join();
+        }
+
+        int channels() const override { return m_channels; }
+        int sampleRate() const override { return m_sampleRate; }
+        std::uint32_t latencyFrames() const override { return m_latencyFrames; }
+
+    private:
+        void captureLoop(const FrameSink& sink, std::promise<bool>& opened)
+        {
+            const HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            const bool comInitialized = SUCCEEDED(comResult);
+
+            IMMDeviceEnumerator* enumerator = nullptr;
+            IMMDevice* device = nullptr;
+            IAudioClient* client = nullptr;
+            IAudioCaptureClient* captureClient = nullptr;
+            WAVEFORMATEX* mixFormat = nullptr;
+            HANDLE packetEvent = nullptr;
+            bool started = false;
+
+            auto fail = [&](const char* action, HRESULT hr) {
+                std::cerr << "[Capture] " << action << " failed with HRESULT 0x" << std::hex
+                          << static_cast<unsigned long>(hr) << std::dec << "\n";
+                opened.set_value(false);
+            };
+
+            HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                          __uuidof(IMMDeviceEnumerator), reinterpret_cast<void**>(&enumerator));
+            if (FAILED(hr))
+            {
+                fail("CoCreateInstance(IMMDeviceEnumerator)", hr);
+            }
+            else if (FAILED(hr = m_deviceId.empty() ? enumerator->GetDefaultAudioEndpoint(eCapture, eConsole, &device)
+                                                    : enumerator->GetDevice(m_deviceId.c_str(), &device)))
+            {
+                fail("IMMDeviceEnumerator::GetDevice", hr);
+            }
+            else if (FAILED(hr = device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr,
+                                                  reinterpret_cast<void**>(&client))))
+            {
+                fail("IMMDevice::Activate(IAudioClient)", hr);
+            }
+            else if (FAILED(hr = client->GetMixFormat(&mixFormat)))
+            {
+                fail("IAudioClient::GetMixFormat", hr);
+            }
+            else if (captureSampleFormat(mixFormat) == CaptureSampleFormat::Unsupported)
+            {
+                std::cerr << "[Capture] Unsupported capture format (tag " << mixFormat->wFormatTag << ", "
+                          << mixFormat->wBitsPerSample << " bits).\n";
+                opened.set_value(false);
+            }
+            else if (FAILED(hr = client->Initialize(AUDCLNT_SHAREMODE_SHARED, AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+                                                    kCaptureBufferDuration, 0, mixFormat, nullptr)))
+            {
+                fail("IAudioClient::Initialize", hr);
+            }
+            else if (!(packetEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr)))
+            {
+                fail("CreateEvent", HRESULT_FROM_WIN32(GetLastError()));
+            }
+            else if (FAILED(hr = client->SetEventHandle(packetEvent)))
+            {
+                fail("IAudioClient::SetEventHandle", hr);
+            }
+            else if (FAILED(hr = client->GetService(__uuidof(IAudioCaptureClient),
+                                                    reinterpret_cast<void**>(&captureClient))))
+            {
+                fail("IAudioClient::GetService(IAudioCaptureClient)", hr);
+            }
+            else
+            {
+                UINT32 bufferFrames = 0;
+                client->GetBufferSize(&bufferFrames);
+                m_channels = mixFormat->nChannels;
+                m_sampleRate = static_cast<int>(mixFormat->nSamplesPerSec);
+
+                // Stream latency plus one device period of buffering before
+                // the packet is signalled, in 100 ns units.
+                REFERENCE_TIME streamLatency = 0;
+                REFERENCE_TIME devicePeriod = 0;
+                client->GetStreamLatency(&streamLatency);
+                client->GetDevicePeriod(&devicePeriod, nullptr);
+                m_latencyFrames = static_cast<std::uint32_t>((streamLatency + devicePeriod) *
+                                                             static_cast<REFERENCE_TIME>(m_sampleRate) / 10000000);
+
+                m_converted.assign(static_cast<std::size_t>(bufferFrames) * static_cast<std::size_t>(m_channels), 0.0f);
+                if (FAILED(hr = client->Start()))
+                {
+                    fail("IAudioClient::Start", hr);
+                }
+                else
+                {
+                    started = true;
+                    opened.set_value(true);
+                }
+            }
+
+            const CaptureSampleFormat format = captureSampleFormat(mixFormat);
+            while (started && m_running.load(std::memory_order_acquire))
+            {
+                if (WaitForSingleObject(packetEvent, 200) != WAIT_OBJECT_0)
+                    continue;
+
+                UINT32 packetFrames = 0;
+                while (SUCCEEDED(captureClient->GetNextPacketSize(&packetFrames)) && packetFrames > 0)
+                {
+                    BYTE* data = nullptr;
+                    UINT32 frames = 0;
+                    DWORD flags = 0;
+                    if (FAILED(captureClient->GetBuffer(&data, &frames, &flags, nullptr, nullptr)))
+                        break;
+
+                    const std::size_t samples = std::min(static_cast<std::size_t>(frames) * m_channels,
+                                                         m_converted.size());
+                    if ((flags & AUDCLNT_BUFFERFLAGS_SILENT) || !data)
+                    {
+                        std::fill(m_converted.begin(), m_converted.begin() + samples, 0.0f);
+                    }
+                    else if (format == CaptureSampleFormat::Float32)
+                    {
+                        std::memcpy(m_converted.data(), data, samples * sizeof(float));
+                    }
+                    else if (format == CaptureSampleFormat::Pcm16)
+                    {
+                        const auto* source = reinterpret_cast<const std::int16_t*>(data);
+                        for (std::size_t i = 0; i < samples; ++i)
+                            m_converted[i] = static_cast<float>(source[i]) / 32768.0f;
+                    }
+                    else
+                    {
+                        const auto* source = reinterpret_cast<const std::int32_t*>(data);
+                        for (std::size_t i = 0; i < samples; ++i)
+                            m_converted[i] = static_cast<float>(source[i]) / 2147483648.0f;
+                    }
+
+                    sink(m_converted.data(), static_cast<std::uint32_t>(samples / m_channels));
+                    captureClient->ReleaseBuffer(frames);
+                }
+            }
+
+            if (started)
+                client->Stop();
+            releaseCom(captureClient);
+            if (packetEvent)
+                CloseHandle(packetEvent);
+            if (mixFormat)
+                CoTaskMemFree(mixFormat);
+            releaseCom(client);
+            releaseCom(device);
+            releaseCom(enumerator);
+            if (comInitialized)
+                CoUninitialize();
+        }
+
+        std::wstring m_deviceId;
+        std::thread m_thread;
+        std::atomic<bool> m_running{false};
+        std::vector<float> m_converted;
+        int m_channels = 0;
+        int m_sampleRate = 0;
+        std::uint32_t m_latencyFrames = 0;
+    };
+#else
+    class NullAudioCaptureBackend : public AudioCaptureBackend
+    {
+    public:
+        bool start(FrameSink) override { return false; }
+        void stop() override {}
+        int channels() const override { return 0; }
+        int sampleRate() const override { return 0; }
+        std::uint32_t latencyFrames() const override { return 0; }
+    };
+#endif
+} // namespace
+
+std::unique_ptr<AudioCaptureBackend> createDefaultAudioCaptureBackend(const std::wstring& deviceId)
+{
+#if defined(_WIN32)
+    return std::make_unique<WasapiAudioCaptureBackend>(deviceId);
+#else
+    (void)deviceId;
+    return std::make_unique<NullAudioCaptureBackend>();
+#endif
+}
+
+std::vector<AudioInputDevice> enumerateAudioInputDevices()
+{
+    std::vector<AudioInputDevice> devices;
+#if defined(_WIN32)
+    IMMDeviceEnumerator* enumerator = nullptr;
+    if (FAILED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator),
+                                reinterpret_cast<void**>(&enumerator))))
+        return devices;
+
+    IMMDeviceCollection* collection = nullptr;
+    if (FAILED(enumerator->EnumAudioEndpoints(eCapture, DEVICE_STATE_ACTIVE, &collection)))
+    {
+        releaseCom(enumerator);
+        return devices;
+    }
+
+    UINT count = 0;
+    collection->GetCount(&count);
+    for (UINT i = 0; i < count; ++i)
+    {
+        IMMDevice* device = nullptr;
+        if (FAILED(collection->Item(i, &device)) || !device)
+            continue;
+
+        AudioInputDevice info;
+        LPWSTR id = nullptr;
+        if (SUCCEEDED(device->GetId(&id)) && id)
+        {
+            info.id = id;
+            CoTaskMemFree(id);
+        }
+
+        IPropertyStore* propertyStore = nullptr;
+        if (SUCCEEDED(device->OpenPropertyStore(STGM_READ, &propertyStore)) && propertyStore)
+        {
+            PROPVARIANT name;
+            PropVariantInit(&name);
+            if (SUCCEEDED(propertyStore->GetValue(PKEY_Device_FriendlyName, &name)) && name.vt == VT_LPWSTR &&
+                name.pwszVal)
+                info.name = name.pwszVal;
+            PropVariantClear(&name);
+            propertyStore->Release();
+        }
+        if (info.name.empty())
+            info.name = L"Input Device";
+
+        devices.push_back(std::move(info));
+        device->Release();
+    }
+
+    collection->Release();
+    releaseCom(enumerator);
+#endif
+    return devices;
+}
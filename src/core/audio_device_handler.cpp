@@ -1,4 +1,5 @@
 #include "core/audio_device_handler.h"
+#include "core/denormals.h"
 
 #include <algorithm>
 #include <cstring>
@@ -671,6 +672,7 @@ bool AudioDeviceHandler::start() {
 
     dspRunning_.store(true);
     dspThread_ = std::thread([this]() {
+        ScopedDenormalFlush denormalFlush;
         const uint32_t frames = engineBlockSize;
         // Determine channel count based on VST3 bus arrangement
         uint32_t channels = ringBufferChannels_;
@@ -31,7 +31,7 @@
 #include <mutex>
 #include <deque>
 #include <condition_variable>
-#include <future>
+#include <functional>
 #include <iostream>
 
 #include "core/tracks.h"
@@ -40,20 +40,37 @@
 #include "core/track_type_vst.h"
 #include "core/sample_loader.h"
 #include "core/sequencer.h"
+#include "core/step_pattern.h"
+#include "core/track_freeze.h"
+#include "core/track_sleep.h"
+#include "core/transport.h"
+#include "core/audio_capture.h"
 #include "core/audio_device_handler.h"
+#include "core/audio_recorder.h"
+#include "core/aux_buses.h"
+#include "core/adsr_envelope.h"
+#include "core/aligned_buffer.h"
+#include "core/denormals.h"
+#include "core/retiring_pool.h"
+#include "core/dsp_kernels.h"
 #include "core/effects/delay_effect.h"
+#include "core/effects/fdn_reverb.h"
+#include "core/effects/latency_compensation.h"
+#include "core/effects/convolution_reverb.h"
+#include "core/effects/insert_chain.h"
 #include "core/effects/sidechain_processor.h"
+#include "core/effects/state_variable_filter.h"
 #include "core/midi_output.h"
 #include "core/mod_matrix.h"
 #include "core/mod_matrix_parameters.h"
 #include "audio/thread_pool.h"
+#include "hosting/PluginDatabase.h"
+#include "hosting/PluginSandbox.h"
 #include "hosting/VST3Host.h"
 
 std::atomic<bool> isPlaying = false;
 static std::atomic<bool> running{true};
 static std::thread audioThread;
-static std::thread sequencerThread;
-static std::atomic<bool> audioSequencerReady{false};
 struct AudioDeviceSnapshot
 {
     std::wstring requestedId;
@@ -102,35 +119,198 @@ static std::array<AudioThreadNotification, kAudioNotificationCapacity> gAudioNot
 static std::atomic<std::size_t> gAudioNotificationHead{0};
 static std::atomic<std::size_t> gAudioNotificationTail{0};
 
-enum class VstCommandType
+// Fault counters. The render thread is the only writer: it claims a slot by
+// publishing the track id after the counts are zeroed, readers skip slots
+// without one.
+constexpr std::size_t kTrackFaultSlots = 64;
+struct TrackFaultSlot
 {
-    Load,
-    Unload,
+    std::atomic<int> trackId{-1};
+    std::array<std::atomic<std::uint64_t>, kTrackFaultStageCount> counts{};
 };
+static std::array<TrackFaultSlot, kTrackFaultSlots> gTrackFaultSlots{};
+static std::atomic<std::uint64_t> gTrackFaultTotal{0};
+static std::atomic<int> gSleepingTrackCount{0};
 
 struct VstCommand
 {
-    VstCommandType type = VstCommandType::Load;
     int trackId = -1;
+    std::uint64_t generation = 0;
     std::filesystem::path path;
-    std::shared_ptr<kj::VST3Host> host;
-    std::shared_ptr<std::promise<bool>> completion;
+    // Saved plug-in state applied before the host is published; empty for a
+    // plain load.
+    std::vector<std::uint8_t> state;
+    std::function<void(bool)> onLoaded;
 };
 
+// Plug-ins are instantiated and prepared on a pool so several tracks can load
+// in parallel; a project restore queues all of its plug-ins at once. A loaded
+// host is only published to its track once it is ready to process; the engine
+// keeps running the previous host until then.
+constexpr unsigned kMinVstLoadWorkers = 3;
+constexpr unsigned kMaxVstLoadWorkers = 16;
+
 static std::mutex vstCommandMutex;
 static std::deque<VstCommand> vstCommandQueue;
 static std::condition_variable vstCommandCv;
-static std::atomic<int> vstOperationsPending{0};
-static std::thread vstCommandThread;
+static std::vector<std::thread> vstCommandThreads;
+// Latest load/unload request per track; older loads that finish late are
+// discarded instead of replacing a newer plug-in. Guarded by vstCommandMutex.
+static std::unordered_map<int, std::uint64_t> vstRequestGenerations;
+static std::uint64_t vstNextGeneration = 1;
+// Hosts that have been swapped out of a track. They are unloaded once the
+// engine's snapshots have dropped their references. Guarded by vstCommandMutex.
+static std::vector<std::shared_ptr<kj::VST3Host>> vstRetiredHosts;
+
+// Sandboxed plug-ins share worker processes until their slots run out. Workers
+// are owned by the hosts using them and exit with the last one.
+static std::atomic<bool> gPluginSandboxEnabled{false};
+static std::atomic<PanLaw> gPanLaw{PanLaw::ConstantPower};
+static std::mutex sandboxProcessMutex;
+static std::vector<std::weak_ptr<kj::PluginSandboxProcess>> sandboxProcesses;
+
+// Format of the running device, used to prepare new hosts off the render thread.
+static std::atomic<double> gEngineSampleRate{0.0};
+static std::atomic<int> gEngineBlockSize{0};
+
+// Input capture for recording and monitoring. gRecordingMutex serialises the
+// control calls; the capture thread only pushes into the recorder and the
+// monitor ring, and the render thread only reads the monitor ring.
+static std::mutex gRecordingMutex;
+static std::unique_ptr<AudioCaptureBackend> gCaptureBackend;
+static AudioRecorder gRecorder;
+static int gRecordingTrackId = 0;
+static std::atomic<bool> gInputMonitoring{false};
+static std::atomic<int> gCaptureChannels{0};
+static std::atomic<int> gCaptureSampleRate{0};
+constexpr std::size_t kMonitorRingFrames = 16384;
+static AudioFrameRing gMonitorRing(kMonitorRingFrames, 2);
+
+static void pushMonitorFrames(const float* interleaved, std::uint32_t frames)
+{
+    const int channels = gCaptureChannels.load(std::memory_order_acquire);
+    if (channels <= 0)
+        return;
 
-static void enqueuePluginLoad(VstCommand&& command)
+    constexpr std::uint32_t kScratchFrames = 256;
+    float stereo[kScratchFrames * 2];
+    while (frames > 0)
+    {
+        const std::uint32_t count = std::min(frames, kScratchFrames);
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            const float* frame = interleaved + static_cast<std::size_t>(i) * channels;
+            stereo[i * 2] = frame[0];
+            stereo[i * 2 + 1] = channels > 1 ? frame[1] : frame[0];
+        }
+        gMonitorRing.write(stereo, count);
+        interleaved += static_cast<std::size_t>(count) * channels;
+        frames -= count;
+    }
+}
+
+// Render thread. Fills up to maxFrames stereo frames of monitored input and
+// drops any backlog beyond one block so monitoring latency stays bounded.
+static std::size_t pullMonitorFrames(float* stereo, std::size_t maxFrames, double sampleRate)
+{
+    if (!gInputMonitoring.load(std::memory_order_acquire) ||
+        gCaptureSampleRate.load(std::memory_order_acquire) != static_cast<int>(sampleRate))
+        return 0;
+
+    const std::size_t available = gMonitorRing.availableFrames();
+    if (available > maxFrames * 2)
+        gMonitorRing.skip(available - maxFrames);
+    return gMonitorRing.read(stereo, maxFrames);
+}
+
+static bool startInputCaptureLocked()
+{
+    if (gCaptureBackend)
+        return true;
+
+    auto backend = createDefaultAudioCaptureBackend();
+    bool started = backend && backend->start([](const float* interleaved, std::uint32_t frames) {
+        gRecorder.push(interleaved, frames);
+        if (gInputMonitoring.load(std::memory_order_relaxed))
+            pushMonitorFrames(interleaved, frames);
+    });
+    if (!started)
+    {
+        std::cerr << "[Capture] Could not open the audio input device." << std::endl;
+        return false;
+    }
+    gCaptureChannels.store(backend->channels(), std::memory_order_release);
+    gCaptureSampleRate.store(backend->sampleRate(), std::memory_order_release);
+    gCaptureBackend = std::move(backend);
+    return true;
+}
+
+static void stopInputCaptureLocked()
+{
+    if (!gCaptureBackend)
+        return;
+    gCaptureBackend->stop();
+    gCaptureBackend.reset();
+    gCaptureChannels.store(0, std::memory_order_release);
+    gCaptureSampleRate.store(0, std::memory_order_release);
+}
+
+// Automation takes being recorded, by track. The cache updater drains the
+// hosts' capture queues into them often enough that the queues never fill.
+static std::mutex gAutomationMutex;
+static std::unordered_map<int, std::vector<kj::AutomationCapturePoint>> gAutomationTakes;
+// Thinning tolerance in normalized parameter units.
+constexpr float kAutomationThinTolerance = 0.002f;
+
+static void drainAutomationCapturesLocked(int trackId, std::vector<kj::AutomationCapturePoint>& take)
+{
+    auto host = trackGetVstHost(trackId);
+    if (!host)
+        return;
+    kj::AutomationCapturePoint point;
+    while (host->automationCapture().pop(point))
+        take.push_back(point);
+}
+
+static void drainAutomationCaptures()
+{
+    std::lock_guard<std::mutex> lock(gAutomationMutex);
+    for (auto& entry : gAutomationTakes)
+        drainAutomationCapturesLocked(entry.first, entry.second);
+}
+
+static void enqueueVstCommand(VstCommand&& command)
 {
     // Plugin loading happens off the audio thread, so the request queue can
     // use conventional synchronization primitives without affecting the
     // real-time callback.
     std::lock_guard<std::mutex> lock(vstCommandMutex);
     vstCommandQueue.push_back(std::move(command));
-    vstOperationsPending.fetch_add(1, std::memory_order_acq_rel);
+    vstCommandCv.notify_one();
+}
+
+static std::uint64_t beginVstRequest(int trackId)
+{
+    std::lock_guard<std::mutex> lock(vstCommandMutex);
+    std::uint64_t generation = vstNextGeneration++;
+    vstRequestGenerations[trackId] = generation;
+    return generation;
+}
+
+static bool isLatestVstRequest(int trackId, std::uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(vstCommandMutex);
+    auto it = vstRequestGenerations.find(trackId);
+    return it != vstRequestGenerations.end() && it->second == generation;
+}
+
+void retireVstHost(std::shared_ptr<kj::VST3Host> host)
+{
+    if (!host)
+        return;
+
+    std::lock_guard<std::mutex> lock(vstCommandMutex);
+    vstRetiredHosts.push_back(std::move(host));
     vstCommandCv.notify_one();
 }
 
@@ -198,6 +378,16 @@ static void publishVstResetBatch()
     gVstResetBatches[gVstWriteBatchIndex].count = 0;
 }
 
+static std::mutex gVstResetWriteMutex;
+
+static void publishVstReset(int trackId)
+{
+    // Several loader threads may publish; the render thread is the only reader.
+    std::lock_guard<std::mutex> lock(gVstResetWriteMutex);
+    enqueueVstReset(trackId);
+    publishVstResetBatch();
+}
+
 bool consumeAudioThreadNotification(AudioThreadNotification& notification)
 {
     const std::size_t head = gAudioNotificationHead.load(std::memory_order_acquire);
@@ -212,7 +402,57 @@ bool consumeAudioThreadNotification(AudioThreadNotification& notification)
     return true;
 }
 
-bool requestTrackVstLoad(int trackId, const std::filesystem::path& path)
+static void recordTrackFault(int trackId, TrackFaultStage stage)
+{
+    gTrackFaultTotal.fetch_add(1, std::memory_order_relaxed);
+    for (auto& slot : gTrackFaultSlots)
+    {
+        int slotTrackId = slot.trackId.load(std::memory_order_relaxed);
+        if (slotTrackId < 0)
+        {
+            for (auto& count : slot.counts)
+                count.store(0, std::memory_order_relaxed);
+            slot.trackId.store(trackId, std::memory_order_release);
+            slotTrackId = trackId;
+        }
+        if (slotTrackId == trackId)
+        {
+            slot.counts[static_cast<std::size_t>(stage)].fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+std::vector<TrackFaultReport> getTrackFaultReports()
+{
+    std::vector<TrackFaultReport> reports;
+    for (const auto& slot : gTrackFaultSlots)
+    {
+        int trackId = slot.trackId.load(std::memory_order_acquire);
+        if (trackId < 0)
+            break;
+        for (std::size_t stage = 0; stage < kTrackFaultStageCount; ++stage)
+        {
+            std::uint64_t count = slot.counts[stage].load(std::memory_order_relaxed);
+            if (count > 0)
+                reports.push_back({trackId, static_cast<TrackFaultStage>(stage), count});
+        }
+    }
+    return reports;
+}
+
+std::uint64_t getTrackFaultTotal()
+{
+    return gTrackFaultTotal.load(std::memory_order_relaxed);
+}
+
+int getSleepingTrackCount()
+{
+    return gSleepingTrackCount.load(std::memory_order_relaxed);
+}
+
+static bool enqueueVstLoad(int trackId, const std::filesystem::path& path, std::vector<std::uint8_t> state,
+                           std::function<void(bool)> onLoaded)
 {
     if (trackId <= 0)
     {
@@ -226,27 +466,35 @@ bool requestTrackVstLoad(int trackId, const std::filesystem::path& path)
         return false;
     }
 
-    auto host = trackEnsureVstHost(trackId);
-    if (!host)
+    if (!trackEnsureVstHost(trackId))
     {
         std::cerr << "[VST] Rejecting plug-in load; no host available for track " << trackId << std::endl;
         return false;
     }
 
-    auto completion = std::make_shared<std::promise<bool>>();
-
     VstCommand command{};
-    command.type = VstCommandType::Load;
     command.trackId = trackId;
+    command.generation = beginVstRequest(trackId);
     command.path = path;
-    command.host = std::move(host);
-    command.completion = completion;
+    command.state = std::move(state);
+    command.onLoaded = std::move(onLoaded);
 
-    enqueuePluginLoad(std::move(command));
-    // Do not block the GUI thread; the caller can poll host->isPluginReady().
+    enqueueVstCommand(std::move(command));
+    // Do not block the GUI thread; onLoaded runs on a loader thread.
     return true;
 }
 
+bool requestTrackVstLoad(int trackId, const std::filesystem::path& path, std::function<void(bool)> onLoaded)
+{
+    return enqueueVstLoad(trackId, path, {}, std::move(onLoaded));
+}
+
+bool requestTrackVstRestore(int trackId, const std::filesystem::path& path, std::vector<std::uint8_t> state,
+                            std::function<void(bool)> onLoaded)
+{
+    return enqueueVstLoad(trackId, path, std::move(state), std::move(onLoaded));
+}
+
 bool requestTrackVstUnload(int trackId)
 {
     if (trackId <= 0)
@@ -255,47 +503,234 @@ bool requestTrackVstUnload(int trackId)
         return false;
     }
 
-    auto host = trackGetVstHost(trackId);
-    if (!host)
+    // Swap in an empty host right away; only this track stops producing
+    // sound. The old plug-in is torn down on a loader thread.
+    beginVstRequest(trackId);
+    auto emptyHost = std::make_shared<kj::VST3Host>();
+    std::shared_ptr<kj::VST3Host> previous;
+    if (!trackPublishVstHost(trackId, emptyHost, previous))
     {
         std::cerr << "[VST] Rejecting plug-in unload; no host available for track " << trackId << std::endl;
         return false;
     }
 
-    auto completion = std::make_shared<std::promise<bool>>();
-    auto result = completion->get_future();
+    retireVstHost(std::move(previous));
+    publishVstReset(trackId);
+    return true;
+}
 
-    VstCommand command{};
-    command.type = VstCommandType::Unload;
-    command.trackId = trackId;
-    command.host = std::move(host);
-    command.completion = completion;
+void setPluginSandboxEnabled(bool enabled)
+{
+    gPluginSandboxEnabled.store(enabled, std::memory_order_release);
+}
 
-    std::lock_guard<std::mutex> lock(vstCommandMutex);
-    vstCommandQueue.push_back(std::move(command));
-    vstOperationsPending.fetch_add(1, std::memory_order_acq_rel);
-    vstCommandCv.notify_one();
+bool pluginSandboxEnabled()
+{
+    return gPluginSandboxEnabled.load(std::memory_order_acquire);
+}
 
-    // This synchronization is allowed because plugin unloading is non-real-time.
-    constexpr auto kUnloadTimeout = std::chrono::seconds(15);
-    if (result.wait_for(kUnloadTimeout) != std::future_status::ready)
-        return false;
+void setPanLaw(PanLaw law)
+{
+    gPanLaw.store(law, std::memory_order_relaxed);
+}
+
+PanLaw getPanLaw()
+{
+    return gPanLaw.load(std::memory_order_relaxed);
+}
+
+static std::filesystem::path pluginWorkerExecutable()
+{
+    std::array<wchar_t, MAX_PATH> buffer{};
+    DWORD length = GetModuleFileNameW(nullptr, buffer.data(), static_cast<DWORD>(buffer.size()));
+    if (length == 0 || length == buffer.size())
+        return {};
+    return std::filesystem::path(buffer.data()).parent_path() / L"kj_plugin_worker.exe";
+}
+
+static std::filesystem::path pluginCacheFile()
+{
+    if (const wchar_t* localAppData = _wgetenv(L"LOCALAPPDATA"))
+        return std::filesystem::path(localAppData) / L"KJ" / L"plugin-cache.bin";
+    return pluginWorkerExecutable().parent_path() / L"plugin-cache.bin";
+}
 
-    return result.get();
+kj::PluginDatabase& getPluginDatabase()
+{
+    static kj::PluginDatabase database(pluginCacheFile());
+    return database;
+}
+
+// Scans in worker processes when the worker is installed next to KJ, so a
+// plug-in that crashes while being scanned cannot take the app down.
+static void startPluginScan()
+{
+    auto& database = getPluginDatabase();
+    database.loadCache();
+
+    kj::PluginScanFunction scanner;
+    std::error_code ec;
+    const auto worker = pluginWorkerExecutable();
+    if (!worker.empty() && std::filesystem::is_regular_file(worker, ec))
+    {
+        scanner = kj::makeSandboxedPluginScanner(worker);
+    }
+    else
+    {
+        scanner = [](const std::filesystem::path& bundle, kj::PluginBundleInfo& info) {
+            return kj::VST3Host::scanBundle(bundle.u8string(), info);
+        };
+    }
+
+    database.refreshAsync(kj::findVst3Bundles(kj::defaultVst3SearchPaths()), std::move(scanner),
+                          [](std::size_t scanned) {
+                              if (scanned > 0)
+                                  std::cout << "[VST] Scanned " << scanned << " new or updated plug-in bundles." << std::endl;
+                          });
+}
+
+// A running worker with a free slot, or a newly launched one.
+static std::shared_ptr<kj::PluginSandboxProcess> acquireSandboxProcess()
+{
+    std::lock_guard<std::mutex> lock(sandboxProcessMutex);
+    std::shared_ptr<kj::PluginSandboxProcess> available;
+    auto it = sandboxProcesses.begin();
+    while (it != sandboxProcesses.end())
+    {
+        auto process = it->lock();
+        if (!process || !process->alive())
+        {
+            it = sandboxProcesses.erase(it);
+            continue;
+        }
+        if (!available && process->freeSlotCount() > 0)
+            available = std::move(process);
+        ++it;
+    }
+    if (available)
+        return available;
+
+    auto process = kj::PluginSandboxProcess::launch(pluginWorkerExecutable());
+    if (!process)
+    {
+        std::cerr << "[VST] Failed to start the plug-in sandbox worker." << std::endl;
+        return nullptr;
+    }
+    sandboxProcesses.push_back(process);
+    return process;
+}
+
+static void runVstLoad(VstCommand& command)
+{
+    auto host = std::make_shared<kj::VST3Host>();
+    host->setOwningTrackId(command.trackId);
+    bool success = false;
+    // A bundle that failed its last scan, for example by crashing the scanner,
+    // goes into a worker process even when sandboxing is off.
+    bool sandboxed = pluginSandboxEnabled();
+    if (auto scanned = getPluginDatabase().findBundle(command.path); scanned && !scanned->valid && !sandboxed)
+    {
+        std::cerr << "[VST] " << command.path.string() << " failed its last scan (" << scanned->error
+                  << "); loading it in the plug-in sandbox." << std::endl;
+        sandboxed = true;
+    }
+    if (sandboxed)
+    {
+        // Another loader may have taken the last slot in between; retry once
+        // with a fresh worker in that case.
+        for (int attempt = 0; attempt < 2 && !success; ++attempt)
+        {
+            auto process = acquireSandboxProcess();
+            if (!process)
+                break;
+            success = host->loadSandboxed(command.path.string(), process);
+            if (!success && (!process->alive() || process->freeSlotCount() > 0))
+                break;
+        }
+    }
+    else
+    {
+        success = host->load(command.path.string());
+    }
+
+    // State goes in before prepare, while the processor is still inactive. A
+    // plug-in that rejects its saved state still comes up with its defaults.
+    if (success && !command.state.empty() && !host->loadState(command.state.data(), command.state.size()))
+    {
+        std::cerr << "[VST] Failed to restore plug-in state for track " << command.trackId << ": "
+                  << command.path.string() << std::endl;
+    }
+
+    double sampleRate = gEngineSampleRate.load(std::memory_order_acquire);
+    int blockSize = gEngineBlockSize.load(std::memory_order_acquire);
+    if (success && sampleRate > 0.0 && blockSize > 0)
+        success = host->prepare(sampleRate, blockSize);
+
+    if (!success)
+    {
+        std::cerr << "[VST] Failed to load plug-in for track " << command.trackId << ": " << command.path.string()
+                  << std::endl;
+        retireVstHost(std::move(host));
+    }
+    else if (!isLatestVstRequest(command.trackId, command.generation))
+    {
+        // A newer load or unload for this track was requested meanwhile.
+        retireVstHost(std::move(host));
+        success = false;
+    }
+    else
+    {
+        std::shared_ptr<kj::VST3Host> previous;
+        if (trackPublishVstHost(command.trackId, host, previous))
+        {
+            retireVstHost(std::move(previous));
+            publishVstReset(command.trackId);
+        }
+        else
+        {
+            retireVstHost(std::move(host));
+            success = false;
+        }
+    }
+
+    if (command.onLoaded)
+        command.onLoaded(success);
+}
+
+// Unloads retired hosts that nothing but the retire list refers to any more.
+static void releaseRetiredVstHosts(std::unique_lock<std::mutex>& lock)
+{
+    std::vector<std::shared_ptr<kj::VST3Host>> releasable;
+    auto it = std::partition(vstRetiredHosts.begin(), vstRetiredHosts.end(),
+                             [](const std::shared_ptr<kj::VST3Host>& host) { return host.use_count() > 1; });
+    std::move(it, vstRetiredHosts.end(), std::back_inserter(releasable));
+    vstRetiredHosts.erase(it, vstRetiredHosts.end());
+
+    if (releasable.empty())
+        return;
+
+    lock.unlock();
+    for (auto& host : releasable)
+        host->unload();
+    releasable.clear();
+    lock.lock();
 }
 
 static void vstCommandLoop()
 {
     CoInitializeEx(nullptr, COINIT_MULTITHREADED);
 
+    constexpr auto kRetirePollInterval = std::chrono::milliseconds(50);
+    std::unique_lock<std::mutex> lock(vstCommandMutex);
     while (running.load(std::memory_order_acquire))
     {
-        std::unique_lock<std::mutex> lock(vstCommandMutex);
-        vstCommandCv.wait(lock, [] {
+        vstCommandCv.wait_for(lock, kRetirePollInterval, [] {
             return !vstCommandQueue.empty() || !running.load(std::memory_order_acquire);
         });
 
-        if (!running.load(std::memory_order_acquire) && vstCommandQueue.empty())
+        releaseRetiredVstHosts(lock);
+
+        if (!running.load(std::memory_order_acquire))
             break;
 
         if (vstCommandQueue.empty())
@@ -305,37 +740,18 @@ static void vstCommandLoop()
         vstCommandQueue.pop_front();
         lock.unlock();
 
-        bool success = (command.host != nullptr);
-        if (command.host)
-        {
-            if (command.type == VstCommandType::Load)
-                success = command.host->load(command.path.string());
-            else
-                command.host->unload();
-        }
-
-        if (command.completion)
-            command.completion->set_value(success);
+        runVstLoad(command);
 
-        if (command.trackId > 0)
-        {
-            enqueueVstReset(command.trackId);
-            publishVstResetBatch();
-        }
-
-        vstOperationsPending.fetch_sub(1, std::memory_order_acq_rel);
+        lock.lock();
     }
 
+    for (auto& pending : vstCommandQueue)
     {
-        std::lock_guard<std::mutex> lock(vstCommandMutex);
-        for (auto& pending : vstCommandQueue)
-        {
-            if (pending.completion)
-                pending.completion->set_value(false);
-        }
-        vstCommandQueue.clear();
-        vstOperationsPending.store(0, std::memory_order_release);
+        if (pending.onLoaded)
+            pending.onLoaded(false);
     }
+    vstCommandQueue.clear();
+    lock.unlock();
 
     CoUninitialize();
 }
@@ -456,6 +872,8 @@ constexpr double kMidPeakQ = 1.0;
 constexpr double kSampleEnvelopeSmoothingSeconds = 0.003;
 constexpr double kSynthEnvelopeSmoothingSeconds = 0.002;
 constexpr double kSynthGainSmoothingSeconds = 0.002;
+// Shortest ramp for a volume or pan change; otherwise they ramp over a block.
+constexpr double kPanGainMinRampSeconds = 0.005;
 constexpr double kDelayTimeMinMs = DelayEffect::kMinDelayTimeMs;
 constexpr double kDelayTimeMaxMs = DelayEffect::kMaxDelayTimeMs;
 constexpr double kDelayFeedbackMin = DelayEffect::kMinFeedback;
@@ -645,26 +1063,15 @@ double computeFormantResonanceQ(double normalizedResonance)
     return kMinQ + safeNorm * (kMaxQ - kMinQ);
 }
 
-void configureFormantFilter(BiquadFilter& filter,
+void configureFormantFilter(StateVariableFilter& filter,
                             double sampleRate,
                             double normalizedFormant,
                             double normalizedResonance)
 {
     double sr = sampleRate > 0.0 ? sampleRate : 44100.0;
-    double frequency = computeFormantFrequency(sr, normalizedFormant);
-    double w0 = 2.0 * kPi * clampFrequency(sr, frequency) / sr;
-    double cosw0 = std::cos(w0);
-    double sinw0 = std::sin(w0);
-    double q = computeFormantResonanceQ(normalizedResonance);
-    double alpha = sinw0 / (2.0 * std::max(q, 1e-3));
-
-    double b0 = (1.0 - cosw0) * 0.5;
-    double b1 = 1.0 - cosw0;
-    double b2 = (1.0 - cosw0) * 0.5;
-    double a0 = 1.0 + alpha;
-    double a1 = -2.0 * cosw0;
-    double a2 = 1.0 - alpha;
-    setBiquadCoefficients(filter, b0, b1, b2, a0, a1, a2);
+    filter.setSampleRate(sr);
+    filter.setParameters(computeFormantFrequency(sr, normalizedFormant),
+                         computeFormantResonanceQ(normalizedResonance));
 }
 
 double computePitchEnvelopeStep(double sampleRate, double rangeSemitones)
@@ -677,15 +1084,6 @@ double computePitchEnvelopeStep(double sampleRate, double rangeSemitones)
     return 1.0 / (envelopeTime * sr);
 }
 
-enum class EnvelopeStage
-{
-    Idle,
-    Attack,
-    Decay,
-    Sustain,
-    Release,
-};
-
 const char* envelopeStageToString(EnvelopeStage stage)
 {
     switch (stage)
@@ -704,86 +1102,6 @@ const char* envelopeStageToString(EnvelopeStage stage)
     return "Unknown";
 }
 
-double advanceEnvelope(EnvelopeStage& stage, double currentValue, double attack, double decay, double sustain,
-                       double release, double sampleRate)
-{
-    double sr = sampleRate > 0.0 ? sampleRate : 44100.0;
-    double value = currentValue;
-    double safeSustain = std::clamp(sustain, 0.0, 1.0);
-    auto advanceCurved = [&](double target, double timeSeconds) {
-        if (timeSeconds <= 0.0)
-        {
-            value = target;
-            return true;
-        }
-
-        double totalSamples = std::max(timeSeconds * sr, 1.0);
-        constexpr double epsilon = 1e-5;
-        double coefficient = std::exp(std::log(epsilon) / totalSamples);
-        if (!std::isfinite(coefficient) || coefficient < 0.0 || coefficient >= 1.0)
-        {
-            coefficient = 0.0;
-        }
-
-        double delta = (target - value) * (1.0 - coefficient);
-        if (!std::isfinite(delta))
-        {
-            value = target;
-            return true;
-        }
-
-        double next = value + delta;
-        if (target >= value)
-            next = std::min(next, target);
-        else
-            next = std::max(next, target);
-
-        value = next;
-
-        double tolerance = std::max(1e-5, std::abs(target) * 1e-5);
-        if (std::abs(value - target) <= tolerance)
-        {
-            value = target;
-            return true;
-        }
-        return false;
-    };
-
-    switch (stage)
-    {
-    case EnvelopeStage::Idle:
-        value = 0.0;
-        break;
-    case EnvelopeStage::Attack:
-        if (advanceCurved(1.0, attack))
-            stage = EnvelopeStage::Decay;
-        break;
-    case EnvelopeStage::Decay:
-        if (advanceCurved(safeSustain, decay))
-            stage = EnvelopeStage::Sustain;
-        break;
-    case EnvelopeStage::Sustain:
-        value = safeSustain;
-        break;
-    case EnvelopeStage::Release:
-        if (advanceCurved(0.0, release))
-        {
-            stage = EnvelopeStage::Idle;
-            value = 0.0;
-        }
-        break;
-    }
-
-    if (!std::isfinite(value))
-        value = 0.0;
-    if (value < 0.0)
-        value = 0.0;
-    if (value > 1.0)
-        value = 1.0;
-
-    return value;
-}
-
 struct TrackModulationState
 {
     std::array<double, 3> lfoPhase{0.0, 0.0, 0.0};
@@ -805,6 +1123,25 @@ void prepareModulationParameters(TrackModulationState& modulation)
         std::fill(modulation.parameterAmounts.begin(), modulation.parameterAmounts.end(), 0.0);
 }
 
+// Owns the track reverbs on the cache updater, which builds them so the
+// render thread never allocates their delay memory. A track keeps its reverb
+// once the insert has been switched on; switching it off only bypasses it.
+// One for an old sample rate is replaced and retired.
+class TrackReverbPool : public RetiringPool<FdnReverb>
+{
+public:
+    std::shared_ptr<FdnReverb> acquire(const Track& track, double sampleRate)
+    {
+        double sr = sampleRate > 0.0 ? sampleRate : 44100.0;
+        auto* reverb = find(track.id, track.reverbEnabled);
+        if (!reverb)
+            return nullptr;
+        if (!*reverb || std::abs((*reverb)->sampleRate() - sr) > 1e-6)
+            replace(*reverb, std::make_shared<FdnReverb>(sr));
+        return *reverb;
+    }
+};
+
 struct TrackPlaybackState {
     TrackType type = TrackType::Synth;
     int currentMidiNote = 69;
@@ -825,7 +1162,7 @@ struct TrackPlaybackState {
     double formantNormalized = 0.5;
     double formantResonance = 0.2;
     double formantBlend = 1.0;
-    BiquadFilter formantFilter;
+    StateVariableFilter formantFilter;
     double pitchBaseOffset = 0.0;
     double pitchRangeSemitones = 0.0;
     double pitchEnvelope = 0.0;
@@ -845,9 +1182,12 @@ struct TrackPlaybackState {
     double synthRelease = 0.3;
     bool synthPhaseSync = false;
     double synthGainSmoothed = 1.0;
+    AdsrEnvelope synthEnvelopeGenerator;
     double sampleEnvelope = 0.0;
     double sampleEnvelopeSmoothed = 0.0;
     EnvelopeStage sampleEnvelopeStage = EnvelopeStage::Idle;
+    AdsrEnvelope sampleEnvelopeGenerator;
+    AdsrSegment sampleEnvelopeSegment;
     double sampleAttack = 0.005;
     double sampleRelease = 0.3;
     double sampleLastLeft = 0.0;
@@ -861,6 +1201,11 @@ struct TrackPlaybackState {
     std::unique_ptr<DelayEffect> delayEffect;
     double delaySampleRate = 0.0;
     bool delayParametersDirty = false;
+    // Built and owned by the cache updater's TrackReverbPool and handed over
+    // in the track snapshot; null until the insert is first switched on. Its
+    // parameters glide on their own, so they are handed over on every update.
+    bool reverbEnabled = false;
+    FdnReverb* reverbEffect = nullptr;
     bool compressorEnabled = false;
     double compressorThresholdDb = -12.0;
     double compressorRatio = 4.0;
@@ -869,7 +1214,41 @@ struct TrackPlaybackState {
     double compressorGain = 1.0;
     double compressorAttackCoeff = 0.0;
     double compressorReleaseCoeff = 0.0;
+    // Enabled inserts in chain order, from the track snapshot.
+    InsertPlan insertPlan;
     SidechainProcessor sidechain;
+    PanGainStage panGain;
+    // Post-fader output of the block: what the track put into the mix. Aux
+    // sends read it once the frame loop is done, and a block in which the
+    // track faults is mixed again from the other tracks' outputs.
+    AlignedBuffer<MixSample> outputLeft;
+    AlignedBuffer<MixSample> outputRight;
+    bool sending = false;
+    // Auxiliary outputs of a multi-output plug-in for the block, in bus order.
+    // The first pluginAuxOutputs of them feed the aux buses alongside the
+    // sends; sized with the send buffers.
+    std::array<AlignedBuffer<MixSample>, kAuxBusCount> pluginAuxLeft;
+    std::array<AlignedBuffer<MixSample>, kAuxBusCount> pluginAuxRight;
+    int pluginAuxOutputs = 0;
+    // Last frame this track sent to the mix. Plug-ins keyed from this track
+    // read it in place through their sidechain input bus.
+    float sidechainTap[2] = {0.0f, 0.0f};
+    // Plug-in delay compensation: latency this track adds and the delay that
+    // lines it up with the slowest track. The delay comes from the cache
+    // updater's LatencyCompensationPool in the track snapshot; null while no
+    // track reports any latency.
+    int latencySamples = 0;
+    LatencyCompensationDelay* latencyCompensation = nullptr;
+    // Running sums of (x - x) after each stage of the chain: zero while the
+    // samples are finite, NaN from the first non-finite one on. Checked once
+    // per block rather than testing every sample.
+    std::array<double, kTrackFaultStageCount> faultProbes{};
+    // Set at the end of a block in which the track faulted; its output for
+    // that block was dropped.
+    bool faultMuted = false;
+    // A sleeping track is skipped by the mixer.
+    TrackSleepMonitor sleepMonitor;
+    bool sleeping = false;
     double resetFadeGain = 1.0;
     double resetFadeStep = 0.0;
     int resetFadeSamples = 0;
@@ -877,8 +1256,16 @@ struct TrackPlaybackState {
     SequencerResetReason resetReason = SequencerResetReason::Manual;
     bool vstPrepared = false;
     bool vstPrepareErrorNotified = false;
+    bool vstCrashNotified = false;
     double vstPreparedSampleRate = 0.0;
     int vstPreparedBlockSize = 0;
+    // Host the prepared state refers to; a different pointer means the
+    // track's plug-in was swapped.
+    const kj::VST3Host* vstPreparedHost = nullptr;
+    // Read position in the frozen stem; frozenSource is the render it refers to.
+    const FrozenTrack* frozenSource = nullptr;
+    int frozenStep = -1;
+    size_t frozenFrame = 0;
     struct SynthVoice {
         int midiNote = 69;
         double frequency = midiNoteToFrequency(69);
@@ -888,6 +1275,7 @@ struct TrackPlaybackState {
         double velocitySmoothed = 1.0;
         double envelope = 0.0;
         EnvelopeStage envelopeStage = EnvelopeStage::Idle;
+        AdsrSegment envelopeSegment;
     };
     std::vector<SynthVoice> voices;
     int midiChannel = 0;
@@ -903,6 +1291,12 @@ void releaseDelayEffect(TrackPlaybackState& state)
     state.delayParametersDirty = false;
 }
 
+void releaseReverbEffect(TrackPlaybackState& state)
+{
+    state.reverbEffect = nullptr;
+    state.reverbEnabled = false;
+}
+
 void resetSamplePlaybackState(TrackPlaybackState& state)
 {
     state.samplePlaying = false;
@@ -920,16 +1314,349 @@ void resetSamplePlaybackState(TrackPlaybackState& state)
     state.lastAppliedResonance = -1.0;
 }
 
-void resetSynthPlaybackState(TrackPlaybackState& state)
-{
-    state.pitchEnvelope = 0.0;
-    state.voices.clear();
-    state.synthGainSmoothed = 1.0;
-    resetFilterState(state.formantFilter);
-    state.modulation.envelopeValue.store(0.0, std::memory_order_relaxed);
-    prepareModulationParameters(state.modulation);
-    state.lastAppliedFormant = -1.0;
-    state.lastAppliedResonance = -1.0;
+void resetSynthPlaybackState(TrackPlaybackState& state)
+{
+    state.pitchEnvelope = 0.0;
+    state.voices.clear();
+    state.synthGainSmoothed = 1.0;
+    state.formantFilter.reset();
+    state.modulation.envelopeValue.store(0.0, std::memory_order_relaxed);
+    prepareModulationParameters(state.modulation);
+    state.lastAppliedFormant = -1.0;
+    state.lastAppliedResonance = -1.0;
+}
+
+// Clears every piece of state a NaN or infinity can get stuck in, leaving
+// the track's settings alone. Allocation-free.
+void resetTrackAfterFault(TrackPlaybackState& state)
+{
+    resetSamplePlaybackState(state);
+    resetSynthPlaybackState(state);
+    resetFilterState(state.lowShelf);
+    resetFilterState(state.midPeak);
+    resetFilterState(state.highShelf);
+    state.compressorGain = 1.0;
+    if (state.delayEffect)
+        state.delayEffect->reset();
+    if (state.reverbEffect)
+        state.reverbEffect->reset();
+    if (state.latencyCompensation)
+        state.latencyCompensation->reset();
+    state.sidechain.reset();
+    state.sidechainTap[0] = 0.0f;
+    state.sidechainTap[1] = 0.0f;
+}
+
+// True once nothing can come out of the track any more: its source is idle
+// and the delay and reverb feedback, delay compensation and filter tails
+// behind it have had time to decay since the last non-zero input frame.
+// Plug-ins keep tails the host cannot see, so VST tracks never sleep.
+bool trackCanSleep(const TrackPlaybackState& state, double sampleRate)
+{
+    if (state.type == TrackType::VST || state.resetScheduled || state.faultMuted)
+        return false;
+    bool sourceIdle = state.type == TrackType::MidiOut ||
+                      (state.voices.empty() && !state.samplePlaying && !state.sampleTailActive &&
+                       state.sampleEnvelopeStage == EnvelopeStage::Idle);
+    std::size_t tailFrames =
+        state.latencyCompensation ? static_cast<std::size_t>(std::max(state.latencyCompensation->delay(), 0)) : 0;
+    if (state.delayEnabled && state.delayEffect)
+        tailFrames += state.delayEffect->tailSamples();
+    if (state.reverbEnabled && state.reverbEffect)
+        tailFrames += state.reverbEffect->tailSamples();
+    return state.sleepMonitor.canSleep(sourceIdle, tailFrames, sampleRate);
+}
+
+// Leaves the track's DSP state at rest, so what is left of the tails below
+// the threshold cannot come back when the track wakes.
+void putTrackToSleep(TrackPlaybackState& state)
+{
+    resetFilterState(state.lowShelf);
+    resetFilterState(state.midPeak);
+    resetFilterState(state.highShelf);
+    state.formantFilter.reset();
+    state.compressorGain = 1.0;
+    if (state.delayEffect)
+        state.delayEffect->reset();
+    if (state.reverbEffect)
+        state.reverbEffect->reset();
+    if (state.latencyCompensation)
+        state.latencyCompensation->reset();
+    state.sidechain.setDetectorLevel(0.0);
+    state.sidechainTap[0] = 0.0f;
+    state.sidechainTap[1] = 0.0f;
+    state.modulation.envelopeValue.store(0.0, std::memory_order_relaxed);
+    state.sleeping = true;
+}
+
+// Per-frame processing of the inserts. The plan only holds enabled ones,
+// so none of these test whether they are bypassed.
+void processEqualizerInsert(TrackPlaybackState& state, double& left, double& right)
+{
+    left = processBiquadSample(state.lowShelf, left, false);
+    left = processBiquadSample(state.midPeak, left, false);
+    left = processBiquadSample(state.highShelf, left, false);
+
+    right = processBiquadSample(state.lowShelf, right, true);
+    right = processBiquadSample(state.midPeak, right, true);
+    right = processBiquadSample(state.highShelf, right, true);
+}
+
+void processCompressorInsert(TrackPlaybackState& state, double& left, double& right, double thresholdDb,
+                             double ratio)
+{
+    double inputLevel = std::max(std::abs(left), std::abs(right));
+    double inputDb = 20.0 * std::log10(inputLevel + 1e-12);
+    double gainDb = 0.0;
+    ratio = std::max(ratio, kCompressorRatioMin);
+    if (inputDb > thresholdDb)
+    {
+        double overDb = inputDb - thresholdDb;
+        double compressedDb = thresholdDb + overDb / ratio;
+        gainDb = compressedDb - inputDb;
+    }
+    double targetGain = std::pow(10.0, gainDb / 20.0);
+    double coeff = (targetGain < state.compressorGain) ? state.compressorAttackCoeff : state.compressorReleaseCoeff;
+    state.compressorGain = targetGain + coeff * (state.compressorGain - targetGain);
+    left *= state.compressorGain;
+    right *= state.compressorGain;
+}
+
+void processDelayInsert(TrackPlaybackState& state, double& left, double& right, double mix)
+{
+    if (!state.delayEffect)
+        return;
+    state.delayEffect->setMix(static_cast<float>(mix));
+    float delayLeft = static_cast<float>(left);
+    float delayRight = static_cast<float>(right);
+    state.delayEffect->process(&delayLeft, &delayRight, 1);
+    left = delayLeft;
+    right = delayRight;
+}
+
+// The reverb's parameters were set up for the whole block before the frame
+// loop; here it only runs one frame.
+void processReverbInsert(TrackPlaybackState& state, double& left, double& right)
+{
+    if (!state.reverbEffect)
+        return;
+    float reverbLeft = static_cast<float>(left);
+    float reverbRight = static_cast<float>(right);
+    state.reverbEffect->processFrame(reverbLeft, reverbRight);
+    left = reverbLeft;
+    right = reverbRight;
+}
+
+TrackFaultStage insertFaultStage(InsertEffect effect)
+{
+    switch (effect)
+    {
+    case InsertEffect::Equalizer:
+        return TrackFaultStage::Equalizer;
+    case InsertEffect::Compressor:
+        return TrackFaultStage::Compressor;
+    case InsertEffect::Delay:
+        return TrackFaultStage::Delay;
+    case InsertEffect::Reverb:
+        return TrackFaultStage::Reverb;
+    }
+    return TrackFaultStage::Output;
+}
+
+// First stage, in the order the track runs them, whose probe went
+// non-finite; kTrackFaultStageCount when all of them are clean.
+std::size_t firstFaultStage(const TrackPlaybackState& state)
+{
+    auto isFaulted = [&](TrackFaultStage stage) {
+        return !std::isfinite(state.faultProbes[static_cast<std::size_t>(stage)]);
+    };
+    if (isFaulted(TrackFaultStage::Source))
+        return static_cast<std::size_t>(TrackFaultStage::Source);
+    for (std::size_t slot = 0; slot < state.insertPlan.count; ++slot)
+    {
+        TrackFaultStage stage = insertFaultStage(state.insertPlan.effects[slot]);
+        if (isFaulted(stage))
+            return static_cast<std::size_t>(stage);
+    }
+    if (isFaulted(TrackFaultStage::Output))
+        return static_cast<std::size_t>(TrackFaultStage::Output);
+    return kTrackFaultStageCount;
+}
+
+// Sums the block's mix again from the outputs of the tracks that did not
+// fault. Only runs in a block where one did, so the frame loop needs no
+// per-sample checks.
+void remixWithoutFaultedTracks(const std::vector<Track>& tracks,
+                               const std::unordered_map<int, TrackPlaybackState>& states, MixSample* mixLeft,
+                               MixSample* mixRight, std::size_t frames)
+{
+    std::fill(mixLeft, mixLeft + frames, MixSample(0));
+    std::fill(mixRight, mixRight + frames, MixSample(0));
+    for (const auto& track : tracks)
+    {
+        auto stateIt = states.find(track.id);
+        if (stateIt == states.end() || stateIt->second.faultMuted)
+            continue;
+        dsp::add(mixLeft, stateIt->second.outputLeft.data(), frames);
+        dsp::add(mixRight, stateIt->second.outputRight.data(), frames);
+    }
+}
+
+// Render-thread side of an aux bus: the send sum of the block and the
+// bus's own effect instances.
+struct AuxBusState
+{
+    AuxBusState() { delay.setMix(1.0f); }
+
+    AlignedBuffer<MixSample> left;
+    AlignedBuffer<MixSample> right;
+#if defined(KJ_DSP_DOUBLE_PRECISION)
+    // The bus effects run in float.
+    AlignedBuffer<float> scratchLeft;
+    AlignedBuffer<float> scratchRight;
+#endif
+    DelayEffect delay;
+    bool delayActive = false;
+    float delayTimeMs = -1.0f;
+    float delayFeedback = -1.0f;
+    // Owned by the aux bus settings and the track snapshots; the render
+    // thread only uses it.
+    ConvolutionReverb* reverb = nullptr;
+    std::size_t silentFrames = 0;
+    bool idle = true;
+};
+
+// Runs one of the bus's float effects over the block.
+template <typename Effect>
+void processAuxBusEffect(AuxBusState& bus, Effect& effect, std::size_t frames)
+{
+#if defined(KJ_DSP_DOUBLE_PRECISION)
+    bus.scratchLeft.resize(frames);
+    bus.scratchRight.resize(frames);
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        bus.scratchLeft[i] = static_cast<float>(bus.left[i]);
+        bus.scratchRight[i] = static_cast<float>(bus.right[i]);
+    }
+    effect.process(bus.scratchLeft.data(), bus.scratchRight.data(), frames);
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        bus.left[i] = bus.scratchLeft[i];
+        bus.right[i] = bus.scratchRight[i];
+    }
+#else
+    effect.process(bus.left.data(), bus.right.data(), frames);
+#endif
+}
+
+// Sums every track's sends and plug-in auxiliary outputs into the buses, one
+// pass per source, runs each bus's chain over the block and adds the returns
+// to the master.
+// A bus without input is skipped once its delay tail has died away.
+void renderAuxBuses(std::array<AuxBusState, kAuxBusCount>& buses, const std::array<AuxBus, kAuxBusCount>& settings,
+                    const std::array<std::shared_ptr<ConvolutionReverb>, kAuxBusCount>& reverbs,
+                    const std::vector<Track>& tracks, const std::unordered_map<int, TrackPlaybackState>& states,
+                    MixSample* mixLeft, MixSample* mixRight, std::size_t frames, double sampleRate)
+{
+    std::array<bool, kAuxBusCount> hasInput{};
+    for (auto& bus : buses)
+    {
+        bus.left.resize(frames);
+        bus.right.resize(frames);
+        bus.left.clear();
+        bus.right.clear();
+    }
+    for (const auto& track : tracks)
+    {
+        auto stateIt = states.find(track.id);
+        if (stateIt == states.end())
+            continue;
+        const auto& state = stateIt->second;
+        for (int busIndex = 0; busIndex < state.pluginAuxOutputs; ++busIndex)
+        {
+            const auto bus = static_cast<std::size_t>(busIndex);
+            dsp::add(buses[bus].left.data(), state.pluginAuxLeft[bus].data(), frames);
+            dsp::add(buses[bus].right.data(), state.pluginAuxRight[bus].data(), frames);
+            hasInput[bus] = true;
+        }
+        if (!state.sending)
+            continue;
+        for (std::size_t busIndex = 0; busIndex < buses.size(); ++busIndex)
+        {
+            const auto level = static_cast<MixSample>(track.sendLevels[busIndex]);
+            if (level <= 0)
+                continue;
+            dsp::addScaled(buses[busIndex].left.data(), state.outputLeft.data(), level, frames);
+            dsp::addScaled(buses[busIndex].right.data(), state.outputRight.data(), level, frames);
+            hasInput[busIndex] = true;
+        }
+    }
+
+    for (std::size_t busIndex = 0; busIndex < buses.size(); ++busIndex)
+    {
+        AuxBusState& bus = buses[busIndex];
+        const AuxBus& setting = settings[busIndex];
+        bus.delay.setSampleRate(sampleRate);
+        if (setting.delayTimeMs != bus.delayTimeMs)
+        {
+            bus.delay.setDelayTime(setting.delayTimeMs);
+            bus.delayTimeMs = setting.delayTimeMs;
+        }
+        if (setting.delayFeedback != bus.delayFeedback)
+        {
+            bus.delay.setFeedback(setting.delayFeedback);
+            bus.delayFeedback = setting.delayFeedback;
+        }
+        if (setting.delayEnabled != bus.delayActive)
+        {
+            bus.delay.reset();
+            bus.delayActive = setting.delayEnabled;
+        }
+        ConvolutionReverb* reverb = setting.reverbEnabled ? reverbs[busIndex].get() : nullptr;
+        if (reverb != bus.reverb)
+        {
+            // A new impulse response, or the reverb switched back on.
+            if (reverb)
+                reverb->reset();
+            bus.reverb = reverb;
+        }
+
+        bus.silentFrames = hasInput[busIndex] ? 0 : bus.silentFrames + frames;
+        std::size_t tailFrames = bus.delayActive ? bus.delay.tailSamples() : 0;
+        if (bus.reverb)
+            tailFrames += bus.reverb->tailSamples();
+        if (!hasInput[busIndex] && bus.silentFrames >= tailFrames + frames)
+        {
+            if (!bus.idle && bus.delayActive)
+                bus.delay.reset();
+            if (!bus.idle && bus.reverb)
+                bus.reverb->reset();
+            bus.idle = true;
+            continue;
+        }
+        bus.idle = false;
+
+        // The sends are clean already; a bus whose own effects went
+        // non-finite drops its return and starts them over, like a track.
+        if (bus.delayActive)
+            processAuxBusEffect(bus, bus.delay, frames);
+        if (bus.reverb)
+            processAuxBusEffect(bus, *bus.reverb, frames);
+        if (dsp::replaceNonFinite(bus.left.data(), frames) + dsp::replaceNonFinite(bus.right.data(), frames) > 0)
+        {
+            bus.left.clear();
+            bus.right.clear();
+            bus.delay.reset();
+            if (bus.reverb)
+                bus.reverb->reset();
+        }
+
+        const auto returnLevel = static_cast<MixSample>(setting.returnLevel);
+        if (returnLevel <= 0)
+            continue;
+        dsp::addScaled(mixLeft, bus.left.data(), returnLevel, frames);
+        dsp::addScaled(mixRight, bus.right.data(), returnLevel, frames);
+    }
 }
 
 void ensureDelayEffect(TrackPlaybackState& state, double sampleRate)
@@ -953,7 +1680,7 @@ void ensureDelayEffect(TrackPlaybackState& state, double sampleRate)
 }
 
 // Added proper includes and scope for updateMixerState (fix undefined type errors)
-void updateMixerState(TrackPlaybackState& state, const Track& track, double sampleRate)
+void updateMixerState(TrackPlaybackState& state, const Track& track, double sampleRate, FdnReverb* reverb)
 {
     double sr = sampleRate > 0.0 ? sampleRate : 44100.0;
     double newVolume = std::clamp(static_cast<double>(track.volume), 0.0, 1.0);
@@ -999,6 +1726,7 @@ void updateMixerState(TrackPlaybackState& state, const Track& track, double samp
     double newSidechainRelease = std::clamp(static_cast<double>(track.sidechainRelease), 0.0, 4.0);
     bool newEqEnabled = track.eqEnabled;
     bool requestedDelayEnabled = track.delayEnabled;
+    bool newReverbEnabled = track.reverbEnabled;
 
     bool sampleRateChanged = std::abs(state.lastSampleRate - sr) > 1e-6;
     bool lowChanged = sampleRateChanged || std::abs(state.lowGain - newLow) > 1e-6;
@@ -1048,7 +1776,6 @@ void updateMixerState(TrackPlaybackState& state, const Track& track, double samp
     if (sampleRateChanged || formantChanged || resonanceChanged)
     {
         configureFormantFilter(state.formantFilter, sr, state.formantNormalized, state.formantResonance);
-        resetFilterState(state.formantFilter);
     }
     if (pitchRangeChanged)
     {
@@ -1133,6 +1860,22 @@ void updateMixerState(TrackPlaybackState& state, const Track& track, double samp
         }
     }
 
+    // Switched off, the reverb stays with the track and is only bypassed.
+    // Switched on, or a new instance for a new rate: start from the settings
+    // rather than gliding to them.
+    bool reverbRestarted = reverb != state.reverbEffect || !state.reverbEnabled;
+    state.reverbEffect = reverb;
+    state.reverbEnabled = newReverbEnabled && reverb;
+    if (state.reverbEnabled)
+    {
+        reverb->setSize(track.reverbSize);
+        reverb->setDecay(track.reverbDecaySeconds);
+        reverb->setDamping(track.reverbDamping);
+        reverb->setMix(track.reverbMix);
+        if (reverbRestarted)
+            reverb->reset();
+    }
+
     if (compressorThresholdChanged)
         state.compressorThresholdDb = newCompressorThreshold;
     if (compressorRatioChanged)
@@ -1376,7 +2119,52 @@ TrackModulatedParameters computeTrackModulatedParameters(const TrackPlaybackStat
     return result;
 }
 
-void sendMidiNotesOffForState(TrackPlaybackState& state, int port, int channel)
+// Latency a track adds before the master bus. Only hosted plug-ins report
+// any; the built-in EQ, compressor, delay and sidechain have no lookahead,
+// and frozen stems have the plug-in latency removed.
+int trackLatencySamples(const TrackPlaybackState& state, const Track& track, const FrozenTrack* frozen)
+{
+    if (track.type != TrackType::VST || !track.vstHost || !state.vstPrepared || frozen)
+        return 0;
+    return std::max(0, static_cast<int>(track.vstHost->latencySamples()));
+}
+
+// Order in which the frame loop renders tracks: every sidechain source ahead
+// of the tracks keyed from it, otherwise track order. Tracks in a sidechain
+// cycle hear their source one frame late.
+void computeTrackRenderOrder(const std::vector<Track>& tracks, std::vector<size_t>& order)
+{
+    enum class Mark : unsigned char { None, Visiting, Placed };
+    std::vector<Mark> marks(tracks.size(), Mark::None);
+    std::vector<size_t> chain;
+    order.clear();
+    order.reserve(tracks.size());
+
+    auto sourceIndex = [&tracks](const Track& track) {
+        if (!track.sidechainEnabled || track.sidechainSourceTrackId == track.id)
+            return tracks.size();
+        auto it = std::find_if(tracks.begin(), tracks.end(),
+                               [&track](const Track& candidate) { return candidate.id == track.sidechainSourceTrackId; });
+        return static_cast<size_t>(it - tracks.begin());
+    };
+
+    for (size_t start = 0; start < tracks.size(); ++start)
+    {
+        chain.clear();
+        for (size_t index = start; index < tracks.size() && marks[index] == Mark::None; index = sourceIndex(tracks[index]))
+        {
+            marks[index] = Mark::Visiting;
+            chain.push_back(index);
+        }
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+        {
+            marks[*it] = Mark::Placed;
+            order.push_back(*it);
+        }
+    }
+}
+
+void sendMidiNotesOffForState(TrackPlaybackState& state, int port, int channel, std::int64_t renderFrame)
 {
     if (state.activeMidiNotes.empty())
         return;
@@ -1390,118 +2178,13 @@ void sendMidiNotesOffForState(TrackPlaybackState& state, int port, int channel)
     channel = std::clamp(channel, 0, 15);
     for (int note : state.activeMidiNotes)
     {
-        midiOutputSendNoteOff(port, channel, note, 0);
+        midiOutputScheduleNoteOff(port, channel, note, 0, renderFrame);
     }
     state.activeMidiNotes.clear();
 }
 
 } // namespace
 
-void sequencerWarmupLoop()
-{
-    using Clock = std::chrono::steady_clock;
-
-    Clock::time_point lastUpdate{};
-    double stepSampleCounter = 0.0;
-    int fallbackStep = 0;
-    bool previousPlaying = false;
-
-    while (running.load(std::memory_order_acquire))
-    {
-        if (!audioSequencerReady.load(std::memory_order_acquire))
-        {
-            lastUpdate = Clock::time_point{};
-            stepSampleCounter = 0.0;
-            fallbackStep = sequencerCurrentStep.load(std::memory_order_relaxed);
-            previousPlaying = isPlaying.load(std::memory_order_relaxed);
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
-            continue;
-        }
-
-        auto now = Clock::now();
-        bool playing = isPlaying.load(std::memory_order_relaxed);
-
-        if (!playing)
-        {
-            if (previousPlaying)
-            {
-                requestSequencerReset();
-            }
-            previousPlaying = false;
-            stepSampleCounter = 0.0;
-            fallbackStep = 0;
-            sequencerCurrentStep.store(0, std::memory_order_relaxed);
-            lastUpdate = now;
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
-            continue;
-        }
-
-        if (!previousPlaying)
-        {
-            requestSequencerReset();
-            previousPlaying = true;
-            stepSampleCounter = 0.0;
-            fallbackStep = sequencerCurrentStep.load(std::memory_order_relaxed);
-            lastUpdate = now;
-            std::this_thread::sleep_for(std::chrono::milliseconds(2));
-            continue;
-        }
-
-        if (lastUpdate.time_since_epoch().count() == 0)
-        {
-            lastUpdate = now;
-            std::this_thread::sleep_for(std::chrono::milliseconds(2));
-            continue;
-        }
-
-        double elapsedSeconds = std::chrono::duration<double>(now - lastUpdate).count();
-        lastUpdate = now;
-
-        double sampleRate = 44100.0;
-        int bpm = std::clamp(sequencerBPM.load(std::memory_order_relaxed), 30, 240);
-        double stepDurationSamples = sampleRate * 60.0 / (static_cast<double>(bpm) * 4.0);
-        if (stepDurationSamples < 1.0)
-            stepDurationSamples = 1.0;
-
-        bool resetNow = sequencerResetRequested.exchange(false, std::memory_order_acq_rel);
-        if (resetNow)
-        {
-            stepSampleCounter = 0.0;
-            fallbackStep = 0;
-            sequencerCurrentStep.store(0, std::memory_order_relaxed);
-        }
-
-        stepSampleCounter += elapsedSeconds * sampleRate;
-
-        int activeTrackId = getActiveSequencerTrackId();
-        int trackStepCount = getSequencerStepCount(activeTrackId);
-        trackStepCount = std::max(trackStepCount, 1);
-
-        if (fallbackStep >= trackStepCount)
-        {
-            fallbackStep %= trackStepCount;
-            sequencerCurrentStep.store(fallbackStep, std::memory_order_relaxed);
-        }
-
-        bool stepAdvanced = false;
-        while (stepSampleCounter >= stepDurationSamples)
-        {
-            stepSampleCounter -= stepDurationSamples;
-            stepAdvanced = true;
-            ++fallbackStep;
-            if (fallbackStep >= trackStepCount)
-                fallbackStep = 0;
-        }
-
-        if (stepAdvanced)
-        {
-            sequencerCurrentStep.store(fallbackStep, std::memory_order_relaxed);
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(2));
-    }
-}
-
 // REAL-TIME PATH ENTRY: audioLoop drives the WASAPI pull-model render thread. All
 // work reachable from this function runs on the render thread and must avoid
 // locks, waits, and allocations. Remaining legacy operations (map mutations,
@@ -1510,16 +2193,25 @@ void sequencerWarmupLoop()
 // for future passes.
 void audioLoop() {
     CoInitializeEx(NULL, COINIT_MULTITHREADED);
+    ScopedDenormalFlush denormalFlush;
 
     std::unique_ptr<AudioDeviceHandler> deviceHandler;
     UINT32 bufferFrameCount = 0;
     const WAVEFORMATEX* format = nullptr;
     double sampleRate = 44100.0;
-    double transportSamplePosition = 0.0;
+    TransportClock transport;
+    // Monotonic count of frames handed to the device; MIDI out events are
+    // timestamped against it.
+    std::int64_t renderFrameCounter = 0;
+    // Plug-in delay compensation at the master bus, in frames. MIDI out is
+    // scheduled this much later so external gear lines up with the audio.
+    std::int64_t latencyCompensationFrames = 0;
     const double twoPi = 6.283185307179586;
-    double stepSampleCounter = 0.0;
     bool previousPlaying = false;
     std::unordered_map<int, TrackPlaybackState> playbackStates;
+    std::array<AuxBusState, kAuxBusCount> auxBusStates;
+    // Interleaved stereo input for monitoring, one device buffer long.
+    std::vector<float> monitorSamples;
     bool deviceReady = false;
     bool samplerResetPending = true;
 #ifdef DEBUG_AUDIO
@@ -1551,6 +2243,7 @@ void audioLoop() {
                 state.vstPrepared = false;
                 state.vstPreparedSampleRate = 0.0;
                 state.vstPreparedBlockSize = 0;
+                state.vstPreparedHost = nullptr;
                 state.vstPrepareErrorNotified = false;
             }
         }
@@ -1610,6 +2303,7 @@ void audioLoop() {
     private:
         void workerLoop()
         {
+            ScopedDenormalFlush denormalFlush;
             while (true)
             {
                 ModulationRequest localRequest{};
@@ -1701,30 +2395,44 @@ void audioLoop() {
 
     constexpr size_t kCachedTrackCapacity = 64;
     constexpr size_t kCachedAssignmentCapacity = 32;
-    constexpr size_t kCachedStepCapacity = kMaxSequencerSteps;
-    constexpr size_t kCachedNotesPerStep = 8;
 
     struct TrackDataSnapshot
     {
         std::vector<Track> tracks;
         std::vector<int> trackStepCounts;
         std::vector<std::pair<int, std::vector<ModMatrixAssignment>>> assignmentsByTrack;
-        std::vector<std::vector<bool>> stepStatesByTrack;
-        std::vector<std::vector<std::vector<StepNoteInfo>>> stepNotesByTrack;
-        std::vector<std::vector<float>> stepVelocityByTrack;
-        std::vector<std::vector<float>> stepPanByTrack;
-        std::vector<std::vector<float>> stepPitchByTrack;
+        // Shared immutable patterns; the render thread only reads them.
+        std::vector<std::shared_ptr<const StepPattern>> stepPatternsByTrack;
+        // Frozen renders that replace the plug-in, null for live tracks.
+        std::vector<std::shared_ptr<const FrozenTrack>> frozenByTrack;
+        // Plug-in automation lanes, null for tracks without any.
+        std::vector<std::shared_ptr<const kj::AutomationLanes>> automationByTrack;
+        // Insert chains compiled from each track's order and bypass flags.
+        std::vector<InsertPlan> insertPlansByTrack;
+        // Track reverbs from the pool, null for tracks that never used one.
+        std::vector<std::shared_ptr<FdnReverb>> reverbsByTrack;
+        // Delay compensation from the pool, null while no track needs any.
+        std::vector<std::shared_ptr<LatencyCompensationDelay>> compensationByTrack;
+        // Indices into tracks with sidechain sources first.
+        std::vector<size_t> renderOrder;
+        std::array<AuxBus, kAuxBusCount> auxBuses{};
+        std::array<std::shared_ptr<ConvolutionReverb>, kAuxBusCount> auxBusReverbs{};
+        // Counts populated snapshots; the render thread acknowledges it so
+        // the pools know what it may still be running.
+        std::uint64_t generation = 0;
 
         void reserve()
         {
             tracks.reserve(kCachedTrackCapacity);
             trackStepCounts.reserve(kCachedTrackCapacity);
             assignmentsByTrack.reserve(kCachedTrackCapacity);
-            stepStatesByTrack.reserve(kCachedTrackCapacity);
-            stepNotesByTrack.reserve(kCachedTrackCapacity);
-            stepVelocityByTrack.reserve(kCachedTrackCapacity);
-            stepPanByTrack.reserve(kCachedTrackCapacity);
-            stepPitchByTrack.reserve(kCachedTrackCapacity);
+            stepPatternsByTrack.reserve(kCachedTrackCapacity);
+            frozenByTrack.reserve(kCachedTrackCapacity);
+            automationByTrack.reserve(kCachedTrackCapacity);
+            insertPlansByTrack.reserve(kCachedTrackCapacity);
+            reverbsByTrack.reserve(kCachedTrackCapacity);
+            compensationByTrack.reserve(kCachedTrackCapacity);
+            renderOrder.reserve(kCachedTrackCapacity);
             for (auto& entry : assignmentsByTrack)
                 entry.second.reserve(kCachedAssignmentCapacity);
         }
@@ -1737,57 +2445,33 @@ void audioLoop() {
                 trackStepCounts.reserve(kCachedTrackCapacity);
             if (assignmentsByTrack.capacity() < kCachedTrackCapacity)
                 assignmentsByTrack.reserve(kCachedTrackCapacity);
-            if (stepStatesByTrack.capacity() < kCachedTrackCapacity)
-                stepStatesByTrack.reserve(kCachedTrackCapacity);
-            if (stepNotesByTrack.capacity() < kCachedTrackCapacity)
-                stepNotesByTrack.reserve(kCachedTrackCapacity);
-            if (stepVelocityByTrack.capacity() < kCachedTrackCapacity)
-                stepVelocityByTrack.reserve(kCachedTrackCapacity);
-            if (stepPanByTrack.capacity() < kCachedTrackCapacity)
-                stepPanByTrack.reserve(kCachedTrackCapacity);
-            if (stepPitchByTrack.capacity() < kCachedTrackCapacity)
-                stepPitchByTrack.reserve(kCachedTrackCapacity);
+            if (stepPatternsByTrack.capacity() < kCachedTrackCapacity)
+                stepPatternsByTrack.reserve(kCachedTrackCapacity);
+            if (frozenByTrack.capacity() < kCachedTrackCapacity)
+                frozenByTrack.reserve(kCachedTrackCapacity);
+            if (automationByTrack.capacity() < kCachedTrackCapacity)
+                automationByTrack.reserve(kCachedTrackCapacity);
+            if (insertPlansByTrack.capacity() < kCachedTrackCapacity)
+                insertPlansByTrack.reserve(kCachedTrackCapacity);
+            if (reverbsByTrack.capacity() < kCachedTrackCapacity)
+                reverbsByTrack.reserve(kCachedTrackCapacity);
+            if (compensationByTrack.capacity() < kCachedTrackCapacity)
+                compensationByTrack.reserve(kCachedTrackCapacity);
 
             trackStepCounts.assign(trackCount, 0);
             assignmentsByTrack.resize(trackCount);
-            stepStatesByTrack.resize(trackCount);
-            stepNotesByTrack.resize(trackCount);
-            stepVelocityByTrack.resize(trackCount);
-            stepPanByTrack.resize(trackCount);
-            stepPitchByTrack.resize(trackCount);
+            stepPatternsByTrack.resize(trackCount);
+            frozenByTrack.resize(trackCount);
+            automationByTrack.resize(trackCount);
+            insertPlansByTrack.resize(trackCount);
+            reverbsByTrack.resize(trackCount);
+            compensationByTrack.resize(trackCount);
             for (auto& entry : assignmentsByTrack)
             {
                 entry.second.clear();
                 if (entry.second.capacity() < kCachedAssignmentCapacity)
                     entry.second.reserve(kCachedAssignmentCapacity);
             }
-            for (auto& stepStates : stepStatesByTrack)
-            {
-                stepStates.assign(kCachedStepCapacity, false);
-            }
-            for (auto& stepNotes : stepNotesByTrack)
-            {
-                stepNotes.clear();
-                stepNotes.resize(kCachedStepCapacity);
-                for (auto& notes : stepNotes)
-                {
-                    notes.clear();
-                    if (notes.capacity() < kCachedNotesPerStep)
-                        notes.reserve(kCachedNotesPerStep);
-                }
-            }
-            for (auto& stepVelocities : stepVelocityByTrack)
-            {
-                stepVelocities.assign(kCachedStepCapacity, kTrackStepVelocityMax);
-            }
-            for (auto& stepPans : stepPanByTrack)
-            {
-                stepPans.assign(kCachedStepCapacity, 0.0f);
-            }
-            for (auto& stepPitches : stepPitchByTrack)
-            {
-                stepPitches.assign(kCachedStepCapacity, 0.0f);
-            }
         }
     };
 
@@ -1796,33 +2480,57 @@ void audioLoop() {
     trackSnapshotA.reserve();
     trackSnapshotB.reserve();
     std::atomic<TrackDataSnapshot*> activeTrackSnapshot{ &trackSnapshotA };
+    // Generation of the last snapshot the render thread finished a block
+    // from; it never reads an older one again.
+    std::atomic<std::uint64_t> acknowledgedSnapshotGeneration{ 0 };
+    std::uint64_t nextSnapshotGeneration = 1;
     std::atomic<bool> cacheThreadRunning{ true };
     ModulationWorker modulationWorker;
     std::vector<TrackModulatedParameters> fallbackModulationParameters;
+    TrackReverbPool trackReverbPool;
+    LatencyCompensationPool latencyCompensationPool;
 
     auto populateTrackSnapshot = [&](TrackDataSnapshot& snapshot)
     {
         auto tracks = getTracks();
         snapshot.prepareForTracks(tracks.size());
         snapshot.tracks = std::move(tracks);
+        snapshot.generation = nextSnapshotGeneration++;
+        const double engineSampleRate = getAudioEngineSampleRate();
+        const std::uint64_t acknowledgedGeneration = acknowledgedSnapshotGeneration.load(std::memory_order_acquire);
+        trackReverbPool.beginPass(snapshot.generation);
+        latencyCompensationPool.beginPass(snapshot.generation);
 
         for (size_t i = 0; i < snapshot.tracks.size(); ++i)
         {
             snapshot.trackStepCounts[i] = getSequencerStepCount(snapshot.tracks[i].id);
             snapshot.assignmentsByTrack[i].first = snapshot.tracks[i].id;
-            int stepCount = std::clamp(snapshot.trackStepCounts[i], 0, static_cast<int>(kCachedStepCapacity));
-            snapshot.stepStatesByTrack[i].assign(stepCount, false);
-            snapshot.stepNotesByTrack[i].resize(stepCount);
-            snapshot.stepVelocityByTrack[i].assign(stepCount, kTrackStepVelocityMax);
-            snapshot.stepPanByTrack[i].assign(stepCount, 0.0f);
-            snapshot.stepPitchByTrack[i].assign(stepCount, 0.0f);
-            for (auto& notes : snapshot.stepNotesByTrack[i])
-            {
-                notes.clear();
-                if (notes.capacity() < kCachedNotesPerStep)
-                    notes.reserve(kCachedNotesPerStep);
-            }
+            snapshot.stepPatternsByTrack[i] = trackGetStepPattern(snapshot.tracks[i].id);
+            snapshot.frozenByTrack[i] = trackGetFrozen(snapshot.tracks[i].id);
+            snapshot.automationByTrack[i] = trackGetAutomation(snapshot.tracks[i].id);
+            const Track& track = snapshot.tracks[i];
+            snapshot.insertPlansByTrack[i] = compileInsertPlan(
+                track.insertOrder, {track.eqEnabled, track.compressorEnabled, track.delayEnabled, track.reverbEnabled});
+            snapshot.reverbsByTrack[i] = trackReverbPool.acquire(track, engineSampleRate);
+        }
+        trackReverbPool.endPass(acknowledgedGeneration);
+        // Every track may have to wait for the slowest plug-in, so each
+        // delay is sized for the largest latency reported.
+        int maxReportedLatency = 0;
+        for (size_t i = 0; i < snapshot.tracks.size(); ++i)
+        {
+            const Track& track = snapshot.tracks[i];
+            if (track.type == TrackType::VST && track.vstHost && !snapshot.frozenByTrack[i])
+                maxReportedLatency = std::max(maxReportedLatency, static_cast<int>(track.vstHost->latencySamples()));
         }
+        for (size_t i = 0; i < snapshot.tracks.size(); ++i)
+            snapshot.compensationByTrack[i] = latencyCompensationPool.acquire(snapshot.tracks[i].id, maxReportedLatency);
+        latencyCompensationPool.endPass(acknowledgedGeneration);
+        computeTrackRenderOrder(snapshot.tracks, snapshot.renderOrder);
+        snapshot.auxBuses = getAuxBuses();
+        // Builds a reverb for a new impulse response or sample rate here,
+        // away from the render thread.
+        snapshot.auxBusReverbs = getAuxBusReverbs(engineSampleRate);
 
         auto assignments = modMatrixGetAssignments();
         for (const auto& assignment : assignments)
@@ -1836,34 +2544,6 @@ void audioLoop() {
                 it->second.push_back(assignment);
             }
         }
-
-        for (size_t i = 0; i < snapshot.tracks.size(); ++i)
-        {
-            int trackId = snapshot.tracks[i].id;
-            int stepCount = snapshot.trackStepCounts[i];
-            for (int step = 0; step < stepCount && step < static_cast<int>(kCachedStepCapacity); ++step)
-            {
-                snapshot.stepStatesByTrack[i][step] = trackGetStepState(trackId, step);
-                snapshot.stepVelocityByTrack[i][step] = trackGetStepVelocity(trackId, step);
-                snapshot.stepPanByTrack[i][step] = trackGetStepPan(trackId, step);
-                snapshot.stepPitchByTrack[i][step] = trackGetStepPitchOffset(trackId, step);
-
-                auto notes = trackGetStepNoteInfo(trackId, step);
-                if (notes.empty())
-                {
-                    int fallback = trackGetStepNote(trackId, step);
-                    if (fallback >= 0)
-                    {
-                        StepNoteInfo info{};
-                        info.midiNote = fallback;
-                        info.velocity = trackGetStepNoteVelocity(trackId, step, fallback);
-                        info.sustain = trackGetStepNoteSustain(trackId, step, fallback);
-                        notes.push_back(info);
-                    }
-                }
-                snapshot.stepNotesByTrack[i][step] = std::move(notes);
-            }
-        }
     };
 
     populateTrackSnapshot(trackSnapshotA);
@@ -1875,6 +2555,7 @@ void audioLoop() {
             TrackDataSnapshot* staging = (current == &trackSnapshotA) ? &trackSnapshotB : &trackSnapshotA;
             populateTrackSnapshot(*staging);
             activeTrackSnapshot.store(staging, std::memory_order_release);
+            drainAutomationCaptures();
             std::this_thread::sleep_for(std::chrono::milliseconds(5));
         }
     });
@@ -1884,7 +2565,6 @@ void audioLoop() {
         std::wstring desiredDeviceId = gRequestedDeviceIds[gRequestedDeviceIndex.load(std::memory_order_acquire)];
 
         if (changeRequested) {
-            audioSequencerReady.store(false, std::memory_order_release);
             if (deviceHandler) {
                 deviceHandler->stop();
                 deviceHandler->shutdown();
@@ -1900,7 +2580,6 @@ void audioLoop() {
 
         if (!deviceReady) {
             if (deviceHandler->isInitializing()) {
-                audioSequencerReady.store(false, std::memory_order_release);
                 std::this_thread::sleep_for(std::chrono::milliseconds(10));
                 continue;
             }
@@ -1909,7 +2588,6 @@ void audioLoop() {
             bool initialized = deviceHandler->initialize(desiredDeviceId);
             if (!initialized) {
                 if (deviceHandler->isInitializing()) {
-                    audioSequencerReady.store(false, std::memory_order_release);
                     std::this_thread::sleep_for(std::chrono::milliseconds(10));
                     continue;
                 }
@@ -1917,7 +2595,6 @@ void audioLoop() {
                     initialized = deviceHandler->initialize();
                     if (!initialized) {
                         if (deviceHandler->isInitializing()) {
-                            audioSequencerReady.store(false, std::memory_order_release);
                             std::this_thread::sleep_for(std::chrono::milliseconds(10));
                             continue;
                         }
@@ -1929,7 +2606,6 @@ void audioLoop() {
 
             if (!initialized) {
                 if (deviceHandler->isInitializing()) {
-                    audioSequencerReady.store(false, std::memory_order_release);
                     std::this_thread::sleep_for(std::chrono::milliseconds(10));
                     continue;
                 }
@@ -1941,7 +2617,6 @@ void audioLoop() {
                 }
                 deviceHandler->shutdown();
                 deviceHandler.reset();
-                audioSequencerReady.store(false, std::memory_order_release);
                 std::this_thread::sleep_for(std::chrono::milliseconds(200));
                 continue;
             }
@@ -1951,7 +2626,6 @@ void audioLoop() {
             if (!deviceHandler->start()) {
                 deviceHandler->shutdown();
                 deviceHandler.reset();
-                audioSequencerReady.store(false, std::memory_order_release);
                 std::this_thread::sleep_for(std::chrono::milliseconds(200));
                 continue;
             }
@@ -1959,16 +2633,30 @@ void audioLoop() {
             bufferFrameCount = deviceHandler->bufferFrameCount();
             format = deviceHandler->format();
             sampleRate = format ? static_cast<double>(format->nSamplesPerSec) : 44100.0;
+            gEngineSampleRate.store(sampleRate, std::memory_order_release);
+            gEngineBlockSize.store(static_cast<int>(bufferFrameCount), std::memory_order_release);
             deviceReady = true;
-            stepSampleCounter = 0.0;
+            transport.prepare(sampleRate);
             previousPlaying = false;
             for (auto& entry : playbackStates) {
                 auto& state = entry.second;
                 resetSynthPlaybackState(state);
                 resetSamplePlaybackState(state);
                 releaseDelayEffect(state);
+                releaseReverbEffect(state);
             }
             playbackStates.clear();
+            // Sized to the device buffer once here; the per-block resizes
+            // below only shrink them and never allocate.
+            monitorSamples.assign(static_cast<std::size_t>(bufferFrameCount) * 2, 0.0f);
+            for (auto& bus : auxBusStates) {
+                bus.left.resize(bufferFrameCount);
+                bus.right.resize(bufferFrameCount);
+#if defined(KJ_DSP_DOUBLE_PRECISION)
+                bus.scratchLeft.resize(bufferFrameCount);
+                bus.scratchRight.resize(bufferFrameCount);
+#endif
+            }
             samplerResetPending = true;
 #ifdef DEBUG_AUDIO
             lastCallbackTime = std::chrono::steady_clock::now();
@@ -1997,18 +2685,19 @@ void audioLoop() {
                 gRequestedDeviceIndex.store(nextRequested, std::memory_order_release);
             }
             publishDeviceSnapshot(snapshot);
-            audioSequencerReady.store(true, std::memory_order_release);
         }
 
         if (!deviceReady || bufferFrameCount == 0) {
-            audioSequencerReady.store(false, std::memory_order_release);
+            // No block in progress; the next one starts from the latest
+            // snapshot.
+            acknowledgedSnapshotGeneration.store(activeTrackSnapshot.load(std::memory_order_acquire)->generation,
+                                                 std::memory_order_release);
             std::this_thread::sleep_for(std::chrono::milliseconds(50));
             continue;
         }
 
         if (!deviceHandler) {
             deviceReady = false;
-            audioSequencerReady.store(false, std::memory_order_release);
             std::this_thread::sleep_for(std::chrono::milliseconds(50));
             continue;
         }
@@ -2025,7 +2714,6 @@ void audioLoop() {
             bufferFrameCount = 0;
             format = nullptr;
             deviceReady = false;
-            audioSequencerReady.store(false, std::memory_order_release);
             continue;
         } else if (FAILED(paddingResult)) {
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -2046,7 +2734,6 @@ void audioLoop() {
                 bufferFrameCount = 0;
                 format = nullptr;
                 deviceReady = false;
-                audioSequencerReady.store(false, std::memory_order_release);
                 continue;
             } else if (FAILED(bufferResult)) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -2056,6 +2743,7 @@ void audioLoop() {
                 void* context = deviceHandler->streamCallbackContext();
                 callback(data, available, format, context);
             }
+            midiOutputPublishRenderClock(renderFrameCounter, sampleRate, static_cast<std::int64_t>(padding));
             BYTE* rawData = data;
             bool bufferIsFloat = isFloatWaveFormat(format);
             bool bufferIsPcm16 = isPcm16WaveFormat(format);
@@ -2069,56 +2757,31 @@ void audioLoop() {
             }
             float* floatSamples = bufferIsFloat ? reinterpret_cast<float*>(rawData) : nullptr;
             std::int16_t* intSamples = bufferIsPcm16 ? reinterpret_cast<std::int16_t*>(rawData) : nullptr;
-            auto toInt16 = [](double value) -> std::int16_t {
-                double clamped = std::clamp(value, -1.0, 1.0);
-                return static_cast<std::int16_t>(std::lround(clamped * 32767.0));
-            };
-            auto writeFrame = [&](UINT32 frameIndex, double left, double right) {
-                if (bufferIsFloat && floatSamples) {
-                    UINT32 base = frameIndex * channelCount;
-                    float leftFloat = static_cast<float>(left);
-                    float rightFloat = static_cast<float>(right);
-                    if (channelCount == 1) {
-                        floatSamples[base] = (leftFloat + rightFloat) * 0.5f;
-                    } else {
-                        floatSamples[base] = leftFloat;
-                        floatSamples[base + 1] = rightFloat;
-                        for (UINT32 ch = 2; ch < channelCount; ++ch) {
-                            floatSamples[base + ch] = 0.0f;
-                        }
-                    }
-                } else if (bufferIsPcm16 && intSamples) {
-                    UINT32 base = frameIndex * channelCount;
-                    if (channelCount == 1) {
-                        intSamples[base] = toInt16((left + right) * 0.5);
-                    } else {
-                        intSamples[base] = toInt16(left);
-                        intSamples[base + 1] = toInt16(right);
-                        for (UINT32 ch = 2; ch < channelCount; ++ch) {
-                            intSamples[base + ch] = 0;
-                        }
-                    }
-                } else if (rawData && strideBytes > 0) {
-                    std::memset(rawData + static_cast<std::size_t>(frameIndex) * strideBytes, 0, strideBytes);
-                }
-            };
+            const std::size_t monitorFrames = pullMonitorFrames(monitorSamples.data(), available, sampleRate);
+            // The mix is gathered per frame and handed to the device in one
+            // pass at the end of the block.
+            static thread_local AlignedBuffer<MixSample> mixLeft;
+            static thread_local AlignedBuffer<MixSample> mixRight;
+            mixLeft.resize(bufferFrameCount);
+            mixRight.resize(bufferFrameCount);
 #ifdef DEBUG_AUDIO
             double mixSumAbs = 0.0;
             double mixPeak = 0.0;
 #endif
-            int bpm = std::clamp(sequencerBPM.load(std::memory_order_relaxed), 30, 240);
-            double stepDurationSamples = sampleRate * 60.0 / (static_cast<double>(bpm) * 4.0);
-            if (stepDurationSamples < 1.0) stepDurationSamples = 1.0;
-
             TrackDataSnapshot* trackSnapshot = activeTrackSnapshot.load(std::memory_order_acquire);
+            const std::uint64_t trackSnapshotGeneration = trackSnapshot ? trackSnapshot->generation : 0;
             const auto& trackInfos = trackSnapshot ? trackSnapshot->tracks : trackSnapshotA.tracks;
             const auto& trackStepCounts = trackSnapshot ? trackSnapshot->trackStepCounts : trackSnapshotA.trackStepCounts;
             const auto& assignmentsByTrack = trackSnapshot ? trackSnapshot->assignmentsByTrack : trackSnapshotA.assignmentsByTrack;
-            const auto& stepStatesByTrack = trackSnapshot ? trackSnapshot->stepStatesByTrack : trackSnapshotA.stepStatesByTrack;
-            const auto& stepNotesByTrack = trackSnapshot ? trackSnapshot->stepNotesByTrack : trackSnapshotA.stepNotesByTrack;
-            const auto& stepVelocityByTrack = trackSnapshot ? trackSnapshot->stepVelocityByTrack : trackSnapshotA.stepVelocityByTrack;
-            const auto& stepPanByTrack = trackSnapshot ? trackSnapshot->stepPanByTrack : trackSnapshotA.stepPanByTrack;
-            const auto& stepPitchByTrack = trackSnapshot ? trackSnapshot->stepPitchByTrack : trackSnapshotA.stepPitchByTrack;
+            const auto& stepPatternsByTrack = trackSnapshot ? trackSnapshot->stepPatternsByTrack : trackSnapshotA.stepPatternsByTrack;
+            const auto& frozenByTrack = trackSnapshot ? trackSnapshot->frozenByTrack : trackSnapshotA.frozenByTrack;
+            const auto& automationByTrack = trackSnapshot ? trackSnapshot->automationByTrack : trackSnapshotA.automationByTrack;
+            const auto& insertPlansByTrack = trackSnapshot ? trackSnapshot->insertPlansByTrack : trackSnapshotA.insertPlansByTrack;
+            const auto& reverbsByTrack = trackSnapshot ? trackSnapshot->reverbsByTrack : trackSnapshotA.reverbsByTrack;
+            const auto& compensationByTrack = trackSnapshot ? trackSnapshot->compensationByTrack : trackSnapshotA.compensationByTrack;
+            const auto& renderOrder = trackSnapshot ? trackSnapshot->renderOrder : trackSnapshotA.renderOrder;
+            const auto& auxBusSettings = trackSnapshot ? trackSnapshot->auxBuses : trackSnapshotA.auxBuses;
+            const auto& auxBusReverbs = trackSnapshot ? trackSnapshot->auxBusReverbs : trackSnapshotA.auxBusReverbs;
 
             uint64_t modulationRequestId = 0;
             const auto* modulatedParameters = modulationWorker.consumeLatest(modulationRequestId);
@@ -2139,8 +2802,6 @@ void audioLoop() {
                 modulatedParameters = &fallbackModulationParameters;
             }
 
-            int activeTrackId = getActiveSequencerTrackId();
-
             for (auto it = playbackStates.begin(); it != playbackStates.end(); ) {
                 int trackId = it->first;
                 bool exists = std::any_of(trackInfos.begin(), trackInfos.end(), [trackId](const Track& track) {
@@ -2148,8 +2809,10 @@ void audioLoop() {
                 });
                 if (!exists) {
                     if (it->second.type == TrackType::MidiOut)
-                        sendMidiNotesOffForState(it->second, it->second.midiPort, it->second.midiChannel);
+                        sendMidiNotesOffForState(it->second, it->second.midiPort, it->second.midiChannel,
+                                                 renderFrameCounter + latencyCompensationFrames);
                     releaseDelayEffect(it->second);
+                    releaseReverbEffect(it->second);
                     it = playbackStates.erase(it);
                 } else {
                     ++it;
@@ -2176,7 +2839,8 @@ void audioLoop() {
                 if (previousType == TrackType::MidiOut &&
                     (trackInfo.type != TrackType::MidiOut || midiSettingsChanged))
                 {
-                    sendMidiNotesOffForState(state, previousMidiPort, previousMidiChannel);
+                    sendMidiNotesOffForState(state, previousMidiPort, previousMidiChannel,
+                                             renderFrameCounter + latencyCompensationFrames);
                 }
 
                 state.midiChannel = desiredMidiChannel;
@@ -2187,16 +2851,18 @@ void audioLoop() {
                 }
 
                 if (inserted) {
-                    int globalStep = sequencerCurrentStep.load(std::memory_order_relaxed);
-                    if (globalStep < 0) {
-                        globalStep = 0;
-                    }
-                    if (trackStepCount > 0) {
-                        state.currentStep = globalStep % trackStepCount;
-                    } else {
-                        state.currentStep = 0;
+                    // A new track gets its output buffers at full device size
+                    // along with its map entry, so the block never grows them.
+                    state.outputLeft.resize(bufferFrameCount);
+                    state.outputRight.resize(bufferFrameCount);
+                    for (std::size_t bus = 0; bus < state.pluginAuxLeft.size(); ++bus) {
+                        state.pluginAuxLeft[bus].resize(bufferFrameCount);
+                        state.pluginAuxRight[bus].resize(bufferFrameCount);
                     }
 
+                    // Joins the grid where the other tracks are.
+                    state.currentStep = std::max(transportPatternStep(transportGetPosition(), trackStepCount), 0);
+
                     resetSamplePlaybackState(state);
                     resetSynthPlaybackState(state);
                     state.pitchEnvelope = 0.0;
@@ -2218,6 +2884,7 @@ void audioLoop() {
                     state.vstPrepared = false;
                     state.vstPreparedSampleRate = 0.0;
                     state.vstPreparedBlockSize = 0;
+                    state.vstPreparedHost = nullptr;
                     state.vstPrepareErrorNotified = false;
                     auto sampleBuffer = trackGetSampleBuffer(trackInfo.id);
                     bool sampleBufferChanged = sampleBuffer != state.sampleBuffer;
@@ -2255,15 +2922,39 @@ void audioLoop() {
                         state.stepPitchOffset = 0.0;
                     }
 
-                    auto host = trackInfo.vstHost;
+                    const auto& host = trackInfo.vstHost;
                     if (host) {
+                        if (state.vstPreparedHost != host.get()) {
+                            // Notes held by the previous plug-in cannot be released on the new one.
+                            state.activeMidiNotes.clear();
+                            state.vstPrepared = false;
+                            state.vstPrepareErrorNotified = false;
+                            state.vstCrashNotified = false;
+                        }
+
+                        if (!state.vstCrashNotified && host->sandboxCrashed()) {
+                            std::wstring trackName(trackInfo.name.begin(), trackInfo.name.end());
+                            if (trackName.empty())
+                                trackName = L"Unnamed";
+
+                            std::wstring message = L"The sandboxed plug-in on track '" + trackName +
+                                                   L"' stopped responding and has been silenced.\nReload the plug-in to continue.";
+                            enqueueAudioThreadNotification(L"VST Plug-in Crashed", message);
+                            state.vstCrashNotified = true;
+                        }
+
                         bool needsPrepare = typeChanged || samplerResetPending || !state.vstPrepared ||
                                             std::abs(state.vstPreparedSampleRate - sampleRate) > 1e-6 ||
                                             state.vstPreparedBlockSize != static_cast<int>(bufferFrameCount);
 
                         if (needsPrepare) {
-                            bool prepared = host->prepare(sampleRate, static_cast<int>(bufferFrameCount));
+                            // Hosts published by the loader pool arrive prepared for
+                            // the current format; only fall back to preparing here
+                            // after a device change.
+                            bool prepared = host->isPreparedFor(sampleRate, static_cast<int>(bufferFrameCount)) ||
+                                            host->prepare(sampleRate, static_cast<int>(bufferFrameCount));
                             state.vstPrepared = prepared;
+                            state.vstPreparedHost = host.get();
 
                             if (prepared) {
                                 state.vstPreparedSampleRate = sampleRate;
@@ -2289,12 +2980,14 @@ void audioLoop() {
                         state.vstPrepared = false;
                         state.vstPreparedSampleRate = 0.0;
                         state.vstPreparedBlockSize = 0;
+                        state.vstPreparedHost = nullptr;
                         state.vstPrepareErrorNotified = false;
                     }
                 } else if (trackInfo.type == TrackType::MidiOut) {
                     state.vstPrepared = false;
                     state.vstPreparedSampleRate = 0.0;
                     state.vstPreparedBlockSize = 0;
+                    state.vstPreparedHost = nullptr;
                     state.vstPrepareErrorNotified = false;
                     if (state.sampleBuffer) {
                         state.sampleBuffer.reset();
@@ -2314,6 +3007,7 @@ void audioLoop() {
                     state.vstPrepared = false;
                     state.vstPreparedSampleRate = 0.0;
                     state.vstPreparedBlockSize = 0;
+                    state.vstPreparedHost = nullptr;
                     state.vstPrepareErrorNotified = false;
                     if (state.sampleBuffer) {
                         state.sampleBuffer.reset();
@@ -2335,27 +3029,73 @@ void audioLoop() {
                     state.currentFrequency = midiNoteToFrequency(state.currentMidiNote);
                 }
 
-                updateMixerState(state, trackInfo, sampleRate);
+                updateMixerState(state, trackInfo, sampleRate,
+                                 trackIndex < reverbsByTrack.size() ? reverbsByTrack[trackIndex].get() : nullptr);
             }
             if (samplerResetPending) {
                 samplerResetPending = false;
             }
 
+            // Delay every track up to the slowest one so all of them line up
+            // at the master bus and at the sidechain detectors.
+            int maxTrackLatency = 0;
+            for (size_t trackIndex = 0; trackIndex < trackInfos.size(); ++trackIndex) {
+                const auto& trackInfo = trackInfos[trackIndex];
+                auto stateIt = playbackStates.find(trackInfo.id);
+                if (stateIt == playbackStates.end())
+                    continue;
+                const FrozenTrack* frozen = trackIndex < frozenByTrack.size() ? frozenByTrack[trackIndex].get() : nullptr;
+                stateIt->second.latencyCompensation =
+                    trackIndex < compensationByTrack.size() ? compensationByTrack[trackIndex].get() : nullptr;
+                stateIt->second.latencySamples = trackLatencySamples(stateIt->second, trackInfo, frozen);
+                maxTrackLatency = std::max(maxTrackLatency, stateIt->second.latencySamples);
+            }
+            maxTrackLatency = std::min(maxTrackLatency, LatencyCompensationDelay::kMaxDelaySamples);
+            for (auto& entry : playbackStates) {
+                if (entry.second.latencyCompensation)
+                    entry.second.latencyCompensation->setDelay(maxTrackLatency - entry.second.latencySamples);
+            }
+            transport.setLatencyCompensation(maxTrackLatency);
+            latencyCompensationFrames = maxTrackLatency;
+            const std::int64_t midiBlockFrame = renderFrameCounter + latencyCompensationFrames;
+
             applyVstResetRequests();
             bool playingNow = isPlaying.load(std::memory_order_relaxed);
-            if (vstOperationsPending.load(std::memory_order_acquire) > 0)
-            {
-                for (UINT32 i = 0; i < available; ++i)
-                {
-                    writeFrame(i, 0.0, 0.0);
-                    if (playingNow)
-                        transportSamplePosition += 1.0;
+            // Step boundaries for the whole block are computed up front; the
+            // frame loop only checks whether frame i starts a new step.
+            TransportTempo transportTempo;
+            transportTempo.bpm = sequencerBPM.load(std::memory_order_relaxed);
+            transportTempo.swing = sequencerSwing.load(std::memory_order_relaxed);
+            transportTempo.schedule = getSequencerTempoSchedule();
+            transport.beginBlock(static_cast<int>(available), playingNow, transportTempo);
+            const PanLaw panLaw = gPanLaw.load(std::memory_order_relaxed);
+            const int panRampFrames = std::max(static_cast<int>(available),
+                                               static_cast<int>(kPanGainMinRampSeconds *
+                                                                (sampleRate > 0.0 ? sampleRate : 44100.0)));
+            for (size_t trackIndex = 0; trackIndex < trackInfos.size(); ++trackIndex) {
+                const auto& trackInfo = trackInfos[trackIndex];
+                auto stateIt = playbackStates.find(trackInfo.id);
+                if (stateIt == playbackStates.end())
+                    continue;
+                auto& state = stateIt->second;
+                state.insertPlan = trackIndex < insertPlansByTrack.size() ? insertPlansByTrack[trackIndex] : InsertPlan{};
+                if (state.reverbEnabled && state.reverbEffect)
+                    state.reverbEffect->beginBlock(available);
+                state.sending = std::any_of(trackInfo.sendLevels.begin(), trackInfo.sendLevels.end(),
+                                            [](float level) { return level > 0.0f; });
+                state.outputLeft.resize(available);
+                state.outputRight.resize(available);
+                state.outputLeft.clear();
+                state.outputRight.clear();
+                state.pluginAuxOutputs = 0;
+                if (trackInfo.type == TrackType::VST) {
+                    for (std::size_t bus = 0; bus < state.pluginAuxLeft.size(); ++bus) {
+                        state.pluginAuxLeft[bus].resize(available);
+                        state.pluginAuxRight[bus].resize(available);
+                        state.pluginAuxLeft[bus].clear();
+                        state.pluginAuxRight[bus].clear();
+                    }
                 }
-
-                previousPlaying = playingNow;
-
-                deviceHandler->releaseBuffer(available);
-                continue;
             }
 
             static thread_local std::vector<float> capturedSamples;
@@ -2367,10 +3107,8 @@ void audioLoop() {
                 capturedSamples.assign(capturedCapacity, 0.0f);
             }
 
-            std::size_t capturedCount = 0;
-
             for (UINT32 i = 0; i < available; i++) {
-                bool playing = isPlaying.load(std::memory_order_relaxed);
+                bool playing = playingNow;
                 bool stepAdvanced = false;
 
                 if (!playing) {
@@ -2378,8 +3116,6 @@ void audioLoop() {
                         requestSequencerReset();
                     }
                     previousPlaying = false;
-                    stepSampleCounter = 0.0;
-                    transportSamplePosition = 0.0;
                     for (auto& entry : playbackStates) {
                         auto& state = entry.second;
                         for (auto& voice : state.voices) {
@@ -2394,8 +3130,10 @@ void audioLoop() {
                         state.stepPan = 0.0;
                         state.stepPitchOffset = 0.0;
                         state.sidechain.reset();
+                        state.sidechainTap[0] = 0.0f;
+                        state.sidechainTap[1] = 0.0f;
                         if (state.type == TrackType::MidiOut)
-                            sendMidiNotesOffForState(state, state.midiPort, state.midiChannel);
+                            sendMidiNotesOffForState(state, state.midiPort, state.midiChannel, midiBlockFrame + i);
                     }
                 } else {
                     if (!previousPlaying) {
@@ -2405,8 +3143,7 @@ void audioLoop() {
 
                         if (sequencerResetRequested.exchange(false, std::memory_order_acq_rel)) {
                             SequencerResetReason reason = sequencerResetReason.load(std::memory_order_relaxed);
-                            sequencerCurrentStep.store(0, std::memory_order_relaxed);
-                            stepSampleCounter = 0.0;
+                            transport.restartStepsAt(static_cast<int>(i));
 
                             if (reason == SequencerResetReason::TrackSelection) {
                                 double fadeSeconds = 0.004; // ~4ms
@@ -2442,12 +3179,10 @@ void audioLoop() {
                             }
                         }
 
-                    stepSampleCounter += 1.0;
-                    if (stepSampleCounter >= stepDurationSamples) {
-                        stepSampleCounter -= stepDurationSamples;
-                        stepAdvanced = true;
-                    }
+                    stepAdvanced = transport.isStepBoundary(static_cast<int>(i));
 
+                    // Tracks sum in double, frame by frame; the mix becomes
+                    // MixSample once it is stored for the block stages.
                     double leftValue = 0.0;
                     double rightValue = 0.0;
 
@@ -2461,7 +3196,7 @@ void audioLoop() {
                             int trackStepCount = trackStepCounts[trackIndex];
                             if (trackStepCount <= 0) {
                                 if (trackInfo.type == TrackType::MidiOut)
-                                    sendMidiNotesOffForState(state, state.midiPort, state.midiChannel);
+                                    sendMidiNotesOffForState(state, state.midiPort, state.midiChannel, midiBlockFrame + i);
                                 state.currentStep = 0;
                                 continue;
                             }
@@ -2475,10 +3210,10 @@ void audioLoop() {
                         }
                     }
 
-                    int activeTrackStep = 0;
-                    bool activeTrackHasSteps = false;
-
-                    for (size_t trackIndex = 0; trackIndex < trackInfos.size(); ++trackIndex) {
+                    // Sidechain sources render first so the tracks keyed from
+                    // them hear this frame.
+                    for (size_t orderIndex = 0; orderIndex < trackInfos.size(); ++orderIndex) {
+                        const size_t trackIndex = orderIndex < renderOrder.size() ? renderOrder[orderIndex] : orderIndex;
                         const auto& trackInfo = trackInfos[trackIndex];
                         int trackStepCount = trackStepCounts[trackIndex];
                         auto stateIt = playbackStates.find(trackInfo.id);
@@ -2502,21 +3237,18 @@ void audioLoop() {
                         int previousParameterStep = state.lastParameterStep;
                         bool parameterStepUpdated = false;
 
+                        const StepPattern* stepPattern = trackIndex < stepPatternsByTrack.size()
+                                                             ? stepPatternsByTrack[trackIndex].get()
+                                                             : nullptr;
                         int parameterStep = (trackStepCount > 0 && stepIndex < trackStepCount) ? stepIndex : -1;
                         if (parameterStep >= 0) {
                             if (state.lastParameterStep != parameterStep) {
-                                float cachedVelocity = (trackIndex < stepVelocityByTrack.size() &&
-                                                        parameterStep < static_cast<int>(stepVelocityByTrack[trackIndex].size()))
-                                                           ? stepVelocityByTrack[trackIndex][parameterStep]
-                                                           : kTrackStepVelocityMax;
-                                float cachedPan = (trackIndex < stepPanByTrack.size() &&
-                                                   parameterStep < static_cast<int>(stepPanByTrack[trackIndex].size()))
-                                                      ? stepPanByTrack[trackIndex][parameterStep]
-                                                      : 0.0f;
-                                float cachedPitch = (trackIndex < stepPitchByTrack.size() &&
-                                                     parameterStep < static_cast<int>(stepPitchByTrack[trackIndex].size()))
-                                                        ? stepPitchByTrack[trackIndex][parameterStep]
-                                                        : 0.0f;
+                                StepParameters cachedParameters = stepPattern
+                                                                      ? stepPattern->parametersForStep(parameterStep)
+                                                                      : StepParameters{};
+                                float cachedVelocity = cachedParameters.velocity;
+                                float cachedPan = cachedParameters.pan;
+                                float cachedPitch = cachedParameters.pitch;
 
                                 state.stepVelocity = std::clamp(static_cast<double>(cachedVelocity),
                                                                 static_cast<double>(kTrackStepVelocityMin),
@@ -2539,7 +3271,8 @@ void audioLoop() {
 
                         bool gate = false;
                         bool triggered = false;
-                        const std::vector<StepNoteInfo>* stepNotes = nullptr;
+                        const StepNoteRange* stepNotes = nullptr;
+                        StepNoteRange stepNoteRange;
                         static thread_local std::vector<StepNoteInfo> cachedNoteOnNotes;
                         static thread_local std::vector<int> cachedNotesPresent;
                         cachedNoteOnNotes.clear();
@@ -2547,15 +3280,13 @@ void audioLoop() {
                         auto& noteOnNotes = cachedNoteOnNotes;
                         auto& notesPresent = cachedNotesPresent;
                         if (trackStepCount > 0 && stepIndex < trackStepCount) {
-                            bool stepEnabled = (trackIndex < stepStatesByTrack.size() &&
-                                                stepIndex < static_cast<int>(stepStatesByTrack[trackIndex].size()))
-                                                   ? stepStatesByTrack[trackIndex][stepIndex]
-                                                   : false;
-                            if (trackIndex < stepNotesByTrack.size() &&
-                                stepIndex < static_cast<int>(stepNotesByTrack[trackIndex].size()) &&
+                            if (stepPattern)
+                                stepNoteRange = stepPattern->notesForStep(stepIndex);
+                            bool stepEnabled = !stepNoteRange.empty();
+                            if (stepPattern &&
                                 (trackInfo.type == TrackType::Synth || trackInfo.type == TrackType::MidiOut || trackInfo.type == TrackType::VST))
                             {
-                                stepNotes = &stepNotesByTrack[trackIndex][stepIndex];
+                                stepNotes = &stepNoteRange;
                             }
 
                             if (stepEnabled) {
@@ -2575,7 +3306,7 @@ void audioLoop() {
                                             if (includeInPresent)
                                                 notesPresent.push_back(clampedNote);
                                             if (!noteInfo.sustain && velocity > 0.0)
-                                                noteOnNotes.push_back(noteInfo);
+                                                noteOnNotes.push_back(StepNoteInfo{noteInfo.midiNote, noteInfo.velocity, noteInfo.sustain});
                                         }
                                         std::sort(notesPresent.begin(), notesPresent.end());
                                         notesPresent.erase(std::unique(notesPresent.begin(), notesPresent.end()), notesPresent.end());
@@ -2602,15 +3333,22 @@ void audioLoop() {
                             state.lastParameterStep = previousParameterStep;
                         }
 
-                        if (trackInfo.id == activeTrackId && trackStepCount > 0) {
-                            activeTrackStep = stepIndex;
-                            activeTrackHasSteps = true;
-                        }
+                        // Sleeping tracks are skipped until a note or a
+                        // sequencer reset reaches them. MIDI-out tracks still
+                        // run their note handling and skip only the chain.
+                        if (state.sleeping && ((gate && stepAdvanced) || state.resetScheduled ||
+                                               trackInfo.type == TrackType::VST))
+                            state.sleeping = false;
+                        if (state.sleeping && trackInfo.type != TrackType::MidiOut)
+                            continue;
 
                         TrackModulatedParameters modulatedParams = (*modulatedParameters)[trackIndex];
 
                         double trackLeft = 0.0;
                         double trackRight = 0.0;
+                        // Set when the track's plug-in takes the sidechain
+                        // itself; the built-in ducker then stays out of it.
+                        bool sidechainInPlugin = false;
 
                         if (trackInfo.type == TrackType::Sample) {
                             if (triggered) {
@@ -2672,16 +3410,17 @@ void audioLoop() {
                                 trackRight = state.sampleLastRight;
                             }
 
-                            state.sampleEnvelope = advanceEnvelope(state.sampleEnvelopeStage, state.sampleEnvelope,
-                                                                    modulatedParams.sampleAttack, 0.0, 1.0,
-                                                                    modulatedParams.sampleRelease,
-                                                                    sampleRate);
+                            state.sampleEnvelopeGenerator.configure(modulatedParams.sampleAttack, 0.0, 1.0,
+                                                                    modulatedParams.sampleRelease, sampleRate);
+                            state.sampleEnvelope = state.sampleEnvelopeGenerator.advance(state.sampleEnvelopeStage,
+                                                                                         state.sampleEnvelope,
+                                                                                         state.sampleEnvelopeSegment);
 
                             double sr = sampleRate > 0.0 ? sampleRate : 44100.0;
                             double maxDelta = (kSampleEnvelopeSmoothingSeconds > 0.0)
                                 ? (1.0 / (kSampleEnvelopeSmoothingSeconds * sr))
                                 : 1.0;
-                            if (!std::isfinite(maxDelta) || maxDelta <= 0.0)
+                            if (maxDelta <= 0.0)
                                 maxDelta = 1.0;
                             double delta = state.sampleEnvelope - state.sampleEnvelopeSmoothed;
                             if (delta > maxDelta)
@@ -2723,8 +3462,54 @@ void audioLoop() {
                             }
                         } else if (trackInfo.type == TrackType::VST) {
                             state.modulation.envelopeValue.store(0.0, std::memory_order_relaxed);
-                            auto host = trackInfo.vstHost;
-                            if (host && state.vstPrepared) {
+                            const auto& host = trackInfo.vstHost;
+                            const FrozenTrack* frozen = trackIndex < frozenByTrack.size()
+                                                            ? frozenByTrack[trackIndex].get()
+                                                            : nullptr;
+                            if (frozen && (frozen->stepOffsets.size() != static_cast<size_t>(trackStepCount) ||
+                                           std::abs(frozen->key.sampleRate - sampleRate) > 1e-6 ||
+                                           frozen->stem.frameCount() == 0)) {
+                                frozen = nullptr;
+                            }
+                            if (frozen) {
+                                // The plug-in is bypassed; release whatever it
+                                // was holding when the track froze.
+                                if (host && !state.activeMidiNotes.empty()) {
+                                    for (int note : state.activeMidiNotes) {
+                                        Steinberg::Vst::Event ev {};
+                                        ev.busIndex = 0;
+                                        ev.sampleOffset = 0;
+                                        ev.type = Steinberg::Vst::Event::kNoteOffEvent;
+                                        ev.noteOff.pitch = static_cast<float>(note);
+                                        ev.noteOff.velocity = 0.0f;
+                                        ev.noteOff.channel = static_cast<Steinberg::int16>(state.midiChannel);
+                                        ev.noteOff.noteId = -1;
+                                        host->queueNoteEvent(ev);
+                                    }
+                                }
+                                state.activeMidiNotes.clear();
+
+                                if (!playing) {
+                                    state.frozenSource = nullptr;
+                                } else {
+                                    const size_t frozenFrames = frozen->stem.frameCount();
+                                    // Re-sync to the sequencer at every step so
+                                    // resets and swing edits stay aligned.
+                                    if (state.frozenSource != frozen || state.frozenStep != stepIndex ||
+                                        state.frozenFrame >= frozenFrames) {
+                                        state.frozenSource = frozen;
+                                        state.frozenStep = stepIndex;
+                                        state.frozenFrame =
+                                            static_cast<size_t>(frozen->stepOffsets[static_cast<size_t>(stepIndex)]) %
+                                            frozenFrames;
+                                    }
+                                    const float* frame = frozen->stem.samples.data() + state.frozenFrame * 2;
+                                    trackLeft = static_cast<double>(frame[0]);
+                                    trackRight = static_cast<double>(frame[1]);
+                                    if (++state.frozenFrame >= frozenFrames)
+                                        state.frozenFrame = 0;
+                                }
+                            } else if (host && state.vstPrepared) {
                                 auto queueNoteOff = [&](int note) {
                                     Steinberg::Vst::Event ev {};
                                     ev.busIndex = 0;
@@ -2796,13 +3581,46 @@ void audioLoop() {
                                     state.activeMidiNotes = std::move(notesThisStep);
                                 }
 
-                                kj::VST3Host::HostTransportState transport {};
-                                transport.samplePosition = transportSamplePosition + static_cast<double>(i);
-                                transport.tempo = static_cast<double>(sequencerBPM.load(std::memory_order_relaxed));
-                                transport.timeSigNum = 4;
-                                transport.timeSigDen = 4;
-                                transport.playing = playing;
-                                host->setTransportState(transport);
+                                TransportPosition position = transport.positionAt(static_cast<int>(i));
+                                kj::VST3Host::HostTransportState hostTransport {};
+                                hostTransport.samplePosition = static_cast<double>(position.samplePosition);
+                                hostTransport.projectTimeMusic = position.beatPosition;
+                                hostTransport.barPositionMusic = position.barStartBeat;
+                                hostTransport.tempo = position.tempo;
+                                hostTransport.timeSigNum = position.timeSigNum;
+                                hostTransport.timeSigDen = position.timeSigDen;
+                                hostTransport.playing = playing;
+                                host->setTransportState(hostTransport);
+                                host->setAutomationLanes(trackIndex < automationByTrack.size()
+                                                             ? automationByTrack[trackIndex].get()
+                                                             : nullptr);
+
+                                const int sidechainBus = host->sidechainInputBus();
+                                if (sidechainBus >= 0) {
+                                    TrackPlaybackState* source = nullptr;
+                                    if (state.sidechain.enabled() && state.sidechain.sourceTrackId() != trackInfo.id) {
+                                        auto sourceIt = playbackStates.find(state.sidechain.sourceTrackId());
+                                        if (sourceIt != playbackStates.end())
+                                            source = &sourceIt->second;
+                                    }
+                                    if (source) {
+                                        float* tap[2] = { &source->sidechainTap[0], &source->sidechainTap[1] };
+                                        host->mapInputBus(sidechainBus, tap, 2);
+                                        sidechainInPlugin = true;
+                                    } else {
+                                        host->mapInputBus(sidechainBus, nullptr, 0);
+                                    }
+                                }
+
+                                // Auxiliary output buses render straight
+                                // into the frame below, bus 1 onto the first
+                                // aux bus and so on; a mono bus feeds both sides.
+                                const int auxOutputs = std::clamp(host->audioOutputBusCount() - 1, 0, kAuxBusCount);
+                                float auxFrame[kAuxBusCount][2] = {};
+                                for (int bus = 0; bus < auxOutputs; ++bus) {
+                                    float* auxChannels[2] = { &auxFrame[bus][0], &auxFrame[bus][1] };
+                                    host->mapOutputBus(bus + 1, auxChannels, 2);
+                                }
 
                                 float left = 0.0f;
                                 float right = 0.0f;
@@ -2810,6 +3628,17 @@ void audioLoop() {
                                 host->process(outputs, 2, 1);
                                 trackLeft = static_cast<double>(left);
                                 trackRight = static_cast<double>(right);
+
+                                for (int bus = 0; bus < auxOutputs; ++bus) {
+                                    host->mapOutputBus(bus + 1, nullptr, 0);
+                                    float auxLeft = auxFrame[bus][0];
+                                    float auxRight = host->audioOutputBusChannelCount(bus + 1) == 1 ? auxLeft : auxFrame[bus][1];
+                                    state.faultProbes[static_cast<std::size_t>(TrackFaultStage::Source)] +=
+                                        static_cast<double>((auxLeft - auxLeft) + (auxRight - auxRight));
+                                    state.pluginAuxLeft[static_cast<std::size_t>(bus)][i] = static_cast<MixSample>(auxLeft);
+                                    state.pluginAuxRight[static_cast<std::size_t>(bus)][i] = static_cast<MixSample>(auxRight);
+                                }
+                                state.pluginAuxOutputs = std::max(state.pluginAuxOutputs, auxOutputs);
                             } else {
                                 state.activeMidiNotes.clear();
                             }
@@ -2821,7 +3650,7 @@ void audioLoop() {
 
                             if (!gate) {
                                 state.sampleEnvelopeStage = EnvelopeStage::Idle;
-                                sendMidiNotesOffForState(state, state.midiPort, state.midiChannel);
+                                sendMidiNotesOffForState(state, state.midiPort, state.midiChannel, midiBlockFrame + i);
                             } else if (stepAdvanced) {
                                 std::vector<int> notesThisStep = notesPresent;
                                 std::sort(notesThisStep.begin(), notesThisStep.end());
@@ -2829,7 +3658,7 @@ void audioLoop() {
 
                                 for (int activeNote : state.activeMidiNotes) {
                                     if (!std::binary_search(notesThisStep.begin(), notesThisStep.end(), activeNote)) {
-                                        midiOutputSendNoteOff(state.midiPort, state.midiChannel, activeNote, 0);
+                                        midiOutputScheduleNoteOff(state.midiPort, state.midiChannel, activeNote, 0, midiBlockFrame + i);
                                     }
                                 }
 
@@ -2838,7 +3667,7 @@ void audioLoop() {
                                     auto wasActive = std::find(state.activeMidiNotes.begin(), state.activeMidiNotes.end(), note)
                                                          != state.activeMidiNotes.end();
                                     if (wasActive) {
-                                        midiOutputSendNoteOff(state.midiPort, state.midiChannel, note, 0);
+                                        midiOutputScheduleNoteOff(state.midiPort, state.midiChannel, note, 0, midiBlockFrame + i);
                                     }
                                 }
 
@@ -2851,7 +3680,7 @@ void audioLoop() {
                                     if (eventVelocity <= 0)
                                         continue;
                                     int note = std::clamp(noteInfo.midiNote, 0, 127);
-                                    midiOutputSendNoteOn(state.midiPort, state.midiChannel, note, eventVelocity);
+                                    midiOutputScheduleNoteOn(state.midiPort, state.midiChannel, note, eventVelocity, midiBlockFrame + i);
                                 }
 
                                 state.activeMidiNotes = std::move(notesThisStep);
@@ -2960,8 +3789,13 @@ void audioLoop() {
                                 double velocityMaxDelta = (kSynthEnvelopeSmoothingSeconds > 0.0)
                                     ? (1.0 / (kSynthEnvelopeSmoothingSeconds * sr))
                                     : 1.0;
-                                if (!std::isfinite(velocityMaxDelta) || velocityMaxDelta <= 0.0)
+                                if (velocityMaxDelta <= 0.0)
                                     velocityMaxDelta = 1.0;
+                                state.synthEnvelopeGenerator.configure(modulatedParams.synthAttack,
+                                                                       modulatedParams.synthDecay,
+                                                                       modulatedParams.synthSustain,
+                                                                       modulatedParams.synthRelease,
+                                                                       sampleRate);
                                 for (auto& voice : state.voices) {
                                     double noteWithPitch = static_cast<double>(voice.midiNote) + pitchOffset;
                                     double frequency = midiNoteToFrequency(noteWithPitch);
@@ -3004,18 +3838,13 @@ void audioLoop() {
                                     else if (velocityDelta < -velocityMaxDelta)
                                         velocityDelta = -velocityMaxDelta;
                                     voice.velocitySmoothed += velocityDelta;
-                                    if (!std::isfinite(voice.velocitySmoothed))
-                                        voice.velocitySmoothed = velocityTarget;
                                     voice.velocitySmoothed = std::clamp(voice.velocitySmoothed,
                                                                        static_cast<double>(kTrackStepVelocityMin),
                                                                        static_cast<double>(kTrackStepVelocityMax));
                                     double velocityGain = voice.velocitySmoothed;
-                                    double envelopeGain = advanceEnvelope(voice.envelopeStage, voice.envelope,
-                                                                          modulatedParams.synthAttack,
-                                                                          modulatedParams.synthDecay,
-                                                                          modulatedParams.synthSustain,
-                                                                          modulatedParams.synthRelease,
-                                                                          sampleRate);
+                                    double envelopeGain = state.synthEnvelopeGenerator.advance(voice.envelopeStage,
+                                                                                               voice.envelope,
+                                                                                               voice.envelopeSegment);
                                     voice.envelope = envelopeGain;
                                     modulationEnvelope += envelopeGain;
                                     sampleValue += waveform * velocityGain * envelopeGain;
@@ -3031,7 +3860,7 @@ void audioLoop() {
                                 double gainMaxDelta = (kSynthGainSmoothingSeconds > 0.0)
                                     ? (1.0 / (kSynthGainSmoothingSeconds * sr))
                                     : 1.0;
-                                if (!std::isfinite(gainMaxDelta) || gainMaxDelta <= 0.0)
+                                if (gainMaxDelta <= 0.0)
                                     gainMaxDelta = 1.0;
                                 double gainDelta = gainTarget - state.synthGainSmoothed;
                                 if (gainDelta > gainMaxDelta)
@@ -3039,14 +3868,10 @@ void audioLoop() {
                                 else if (gainDelta < -gainMaxDelta)
                                     gainDelta = -gainMaxDelta;
                                 state.synthGainSmoothed += gainDelta;
-                                if (!std::isfinite(state.synthGainSmoothed))
-                                    state.synthGainSmoothed = gainTarget;
                                 if (state.synthGainSmoothed < 0.0)
                                     state.synthGainSmoothed = 0.0;
                                 sampleValue *= state.synthGainSmoothed;
                                 double envelopeAverage = modulationEnvelope / static_cast<double>(state.voices.size());
-                                if (!std::isfinite(envelopeAverage))
-                                    envelopeAverage = 0.0;
                                 state.modulation.envelopeValue.store(envelopeAverage, std::memory_order_relaxed);
                                 if (state.pitchEnvelope > 0.0)
                                 {
@@ -3069,9 +3894,6 @@ void audioLoop() {
                                 state.currentMidiNote = state.voices.front().midiNote;
                                 state.currentFrequency = state.voices.front().frequency;
                             }
-                            trackLeft = sampleValue;
-                            trackRight = sampleValue;
-
                             double modFormant = std::clamp(modulatedParams.synthFormant, 0.0, 1.0);
                             double modResonance = std::clamp(modulatedParams.synthResonance, 0.0, 1.0);
                             bool formantNeedsUpdate = std::abs(modFormant - state.lastAppliedFormant) > 1e-4 ||
@@ -3083,15 +3905,20 @@ void audioLoop() {
                                 state.lastAppliedResonance = modResonance;
                             }
 
+                            // The synth is mono until the mixer pans it, so the
+                            // formant filter runs once.
                             double blend = std::clamp(modFormant, 0.0, 1.0);
                             if (blend < 1.0 || modResonance > 0.0) {
-                                double filteredLeft = processBiquadSample(state.formantFilter, trackLeft, false);
-                                double filteredRight = processBiquadSample(state.formantFilter, trackRight, true);
-                                trackLeft = filteredLeft * (1.0 - blend) + trackLeft * blend;
-                                trackRight = filteredRight * (1.0 - blend) + trackRight * blend;
+                                double filtered = state.formantFilter.process(sampleValue).low;
+                                sampleValue = filtered * (1.0 - blend) + sampleValue * blend;
                             }
+                            trackLeft = sampleValue;
+                            trackRight = sampleValue;
                         }
 
+                        state.faultProbes[static_cast<std::size_t>(TrackFaultStage::Source)] +=
+                            (trackLeft - trackLeft) + (trackRight - trackRight);
+
                         if (state.resetScheduled) {
                             trackLeft *= state.resetFadeGain;
                             trackRight *= state.resetFadeGain;
@@ -3121,60 +3948,38 @@ void audioLoop() {
                             }
                         }
 
+                        state.sleepMonitor.observeSource(trackLeft, trackRight);
+                        if (state.sleeping)
+                            continue;
+
                         double processedLeft = trackLeft;
                         double processedRight = trackRight;
-                        if (state.eqEnabled)
-                        {
-                            processedLeft = processBiquadSample(state.lowShelf, processedLeft, false);
-                            processedLeft = processBiquadSample(state.midPeak, processedLeft, false);
-                            processedLeft = processBiquadSample(state.highShelf, processedLeft, false);
-
-                            processedRight = processBiquadSample(state.lowShelf, processedRight, true);
-                            processedRight = processBiquadSample(state.midPeak, processedRight, true);
-                            processedRight = processBiquadSample(state.highShelf, processedRight, true);
-                        }
-
-                        if (state.compressorEnabled)
+                        for (std::size_t slot = 0; slot < state.insertPlan.count; ++slot)
                         {
-                            double inputLevel = std::max(std::abs(processedLeft), std::abs(processedRight));
-                            double inputDb = 20.0 * std::log10(inputLevel + 1e-12);
-                            double gainDb = 0.0;
-                            double compressorThreshold = modulatedParams.compressorThreshold;
-                            double compressorRatio = std::max(modulatedParams.compressorRatio, kCompressorRatioMin);
-                            if (inputDb > compressorThreshold)
+                            InsertEffect effect = state.insertPlan.effects[slot];
+                            switch (effect)
                             {
-                                double overDb = inputDb - compressorThreshold;
-                                double compressedDb = compressorThreshold + overDb / compressorRatio;
-                                gainDb = compressedDb - inputDb;
+                            case InsertEffect::Equalizer:
+                                processEqualizerInsert(state, processedLeft, processedRight);
+                                break;
+                            case InsertEffect::Compressor:
+                                processCompressorInsert(state, processedLeft, processedRight,
+                                                        modulatedParams.compressorThreshold,
+                                                        modulatedParams.compressorRatio);
+                                break;
+                            case InsertEffect::Delay:
+                                processDelayInsert(state, processedLeft, processedRight, modulatedParams.delayMix);
+                                break;
+                            case InsertEffect::Reverb:
+                                processReverbInsert(state, processedLeft, processedRight);
+                                break;
                             }
-                            double targetGain = std::pow(10.0, gainDb / 20.0);
-                            if (!std::isfinite(targetGain))
-                                targetGain = 1.0;
-                            double coeff = (targetGain < state.compressorGain) ? state.compressorAttackCoeff
-                                                                               : state.compressorReleaseCoeff;
-                            state.compressorGain = targetGain + coeff * (state.compressorGain - targetGain);
-                            if (!std::isfinite(state.compressorGain))
-                                state.compressorGain = 1.0;
-                            processedLeft *= state.compressorGain;
-                            processedRight *= state.compressorGain;
-                        }
-                        else
-                        {
-                            state.compressorGain = 1.0;
-                        }
-
-                        if (state.delayEnabled && state.delayEffect)
-                        {
-                            state.delayEffect->setMix(static_cast<float>(modulatedParams.delayMix));
-                            float delayLeft = static_cast<float>(processedLeft);
-                            float delayRight = static_cast<float>(processedRight);
-                            state.delayEffect->process(&delayLeft, &delayRight, 1);
-                            processedLeft = delayLeft;
-                            processedRight = delayRight;
+                            state.faultProbes[static_cast<std::size_t>(insertFaultStage(effect))] +=
+                                (processedLeft - processedLeft) + (processedRight - processedRight);
                         }
 
                         double sidechainGain = 1.0;
-                        if (state.sidechain.enabled())
+                        if (state.sidechain.enabled() && !sidechainInPlugin)
                         {
                             double sourceLevel = 0.0;
                             int sourceTrackId = state.sidechain.sourceTrackId();
@@ -3201,30 +4006,29 @@ void audioLoop() {
                         processedRight *= sidechainGain;
 
                         double combinedPan = std::clamp(modulatedParams.pan + state.stepPan, -1.0, 1.0);
-                        double panAmount = std::clamp((combinedPan + 1.0) * 0.5, 0.0, 1.0);
-                        double leftPanGain = std::cos(panAmount * (kPi * 0.5));
-                        double rightPanGain = std::sin(panAmount * (kPi * 0.5));
                         double volumeGain = std::clamp(modulatedParams.volume, 0.0, 1.0) * state.stepVelocity;
-
-                        double finalLeft = processedLeft * volumeGain * leftPanGain;
-                        double finalRight = processedRight * volumeGain * rightPanGain;
+                        state.panGain.setTarget(panLaw, volumeGain, combinedPan, panRampFrames);
+                        PanGains panGains = state.panGain.next();
+
+                        double finalLeft = processedLeft * panGains.left;
+                        double finalRight = processedRight * panGains.right;
+                        if (state.latencyCompensation)
+                            state.latencyCompensation->process(finalLeft, finalRight);
+                        state.faultProbes[static_cast<std::size_t>(TrackFaultStage::Output)] +=
+                            (finalLeft - finalLeft) + (finalRight - finalRight);
+                        state.outputLeft[i] = static_cast<MixSample>(finalLeft);
+                        state.outputRight[i] = static_cast<MixSample>(finalRight);
+                        state.sidechainTap[0] = static_cast<float>(finalLeft);
+                        state.sidechainTap[1] = static_cast<float>(finalRight);
 
                         leftValue += finalLeft;
                         rightValue += finalRight;
 
                         double detectionLevel = std::max(std::abs(finalLeft), std::abs(finalRight));
                         state.sidechain.setDetectorLevel(detectionLevel);
+                        state.sleepMonitor.observeOutput(detectionLevel);
                     }
 
-                    if (activeTrackHasSteps) {
-                        sequencerCurrentStep.store(activeTrackStep, std::memory_order_relaxed);
-                    } else {
-                        sequencerCurrentStep.store(0, std::memory_order_relaxed);
-                    }
-
-                    leftValue = std::clamp(leftValue, -1.0, 1.0);
-                    rightValue = std::clamp(rightValue, -1.0, 1.0);
-
 #ifdef DEBUG_AUDIO
                     mixSumAbs += std::abs(leftValue) + std::abs(rightValue);
                     double currentPeak = std::max(std::abs(leftValue), std::abs(rightValue));
@@ -3232,22 +4036,68 @@ void audioLoop() {
                         mixPeak = currentPeak;
 #endif
 
-                    if (playing)
-                        transportSamplePosition += 1.0;
+                    // Clamped once the aux returns are in.
+                    mixLeft[i] = static_cast<MixSample>(leftValue);
+                    mixRight[i] = static_cast<MixSample>(rightValue);
+                    continue;
+                }
+                mixLeft[i] = 0;
+                mixRight[i] = 0;
+            }
 
-                    float monoValue = static_cast<float>((leftValue + rightValue) * 0.5);
-                    if (capturedCount < capturedSamples.size())
-                        capturedSamples[capturedCount++] = monoValue;
-                    writeFrame(i, leftValue, rightValue);
+            bool trackFaulted = false;
+            for (auto& entry : playbackStates) {
+                auto& state = entry.second;
+                std::size_t faultStage = firstFaultStage(state);
+                state.faultProbes.fill(0.0);
+                if (faultStage == kTrackFaultStageCount) {
+                    state.faultMuted = false;
                     continue;
                 }
-                if (playing)
-                    transportSamplePosition += 1.0;
-                if (capturedCount < capturedSamples.size())
-                    capturedSamples[capturedCount++] = 0.0f;
-                writeFrame(i, 0.0, 0.0);
+                recordTrackFault(entry.first, static_cast<TrackFaultStage>(faultStage));
+                resetTrackAfterFault(state);
+                // The whole block of a faulted track is dropped: nothing of
+                // it reaches the aux buses, and the mix is rebuilt below.
+                state.faultMuted = true;
+                state.sending = false;
+                state.pluginAuxOutputs = 0;
+                trackFaulted = true;
+            }
+            if (trackFaulted)
+                remixWithoutFaultedTracks(trackInfos, playbackStates, mixLeft.data(), mixRight.data(), available);
+            int sleepingTracks = 0;
+            for (auto& entry : playbackStates) {
+                auto& state = entry.second;
+                if (!state.sleeping && playingNow && trackCanSleep(state, sampleRate))
+                    putTrackToSleep(state);
+                state.sleepMonitor.endBlock();
+                if (state.sleeping)
+                    ++sleepingTracks;
+            }
+            gSleepingTrackCount.store(sleepingTracks, std::memory_order_relaxed);
+
+            renderAuxBuses(auxBusStates, auxBusSettings, auxBusReverbs, trackInfos, playbackStates, mixLeft.data(),
+                           mixRight.data(), available, sampleRate);
+            dsp::clamp(mixLeft.data(), MixSample(-1), MixSample(1), available);
+            dsp::clamp(mixRight.data(), MixSample(-1), MixSample(1), available);
+            const std::size_t capturedCount = std::min<std::size_t>(available, capturedSamples.size());
+            dsp::downmixToMono(mixLeft.data(), mixRight.data(), capturedSamples.data(), capturedCount);
+
+            if (monitorFrames > 0) {
+                dsp::addInterleavedStereo(mixLeft.data(), mixRight.data(), monitorSamples.data(), monitorFrames);
+                dsp::clamp(mixLeft.data(), MixSample(-1), MixSample(1), monitorFrames);
+                dsp::clamp(mixRight.data(), MixSample(-1), MixSample(1), monitorFrames);
+            }
+            if (bufferIsFloat && floatSamples) {
+                dsp::interleaveToFloat(mixLeft.data(), mixRight.data(), floatSamples, available, channelCount);
+            } else if (bufferIsPcm16 && intSamples) {
+                dsp::interleaveToInt16(mixLeft.data(), mixRight.data(), intSamples, available, channelCount);
+            } else if (rawData && strideBytes > 0) {
+                std::memset(rawData, 0, static_cast<std::size_t>(available) * strideBytes);
             }
 
+            transport.endBlock();
+
             if (capturedCount > 0)
                 writeWaveformSamples(capturedSamples.data(), capturedCount);
 #ifdef DEBUG_AUDIO
@@ -3274,6 +4124,8 @@ void audioLoop() {
                       << std::endl;
 #endif
             deviceHandler->releaseBuffer(available);
+            renderFrameCounter += static_cast<std::int64_t>(available);
+            acknowledgedSnapshotGeneration.store(trackSnapshotGeneration, std::memory_order_release);
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
@@ -3288,8 +4140,8 @@ void audioLoop() {
     }
     for (auto& entry : playbackStates) {
         releaseDelayEffect(entry.second);
+        releaseReverbEffect(entry.second);
     }
-    audioSequencerReady.store(false, std::memory_order_release);
     CoUninitialize();
 }
 
@@ -3297,6 +4149,13 @@ void audioLoop() {
 // - audioLoop is the render-thread entry; it must remain allocation- and lock-free.
 // - Replaced mutex-protected audioThreadNotifications with an SPSC ring buffer to
 //   avoid locks and waits in the render path.
+// - MIDI out is pushed onto the scheduler's SPSC queue with render-frame
+//   timestamps; port opens and device calls happen on the scheduler thread.
+// - Plug-in loads build and prepare a new host on the loader pool and swap it
+//   into the track; the render thread never waits on a load, and retired hosts
+//   are unloaded off-thread.
+// - Track reverbs and aux bus convolution reverbs are built by the cache
+//   updater and handed over in the track snapshot.
 // - Additional legacy allocations and container mutations still exist in the
 //   render path and require follow-up passes to conform fully to the real-time
 //   design.
@@ -3319,27 +4178,45 @@ void initAudio() {
         }
     }
     running.store(true, std::memory_order_release);
-    audioSequencerReady.store(false, std::memory_order_release);
-    if (sequencerThread.joinable())
-        sequencerThread.join();
     if (audioThread.joinable())
         audioThread.join();
-    if (vstCommandThread.joinable())
-        vstCommandThread.join();
-    sequencerThread = std::thread(sequencerWarmupLoop);
-    vstCommandThread = std::thread(vstCommandLoop);
+    for (auto& thread : vstCommandThreads)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+    startMidiOutput();
+    startPluginScan();
+    const unsigned loadWorkers = std::clamp(std::thread::hardware_concurrency(), kMinVstLoadWorkers, kMaxVstLoadWorkers);
+    vstCommandThreads.clear();
+    for (unsigned i = 0; i < loadWorkers; ++i)
+        vstCommandThreads.emplace_back(vstCommandLoop);
     audioThread = std::thread(audioLoop);
 }
 
 void shutdownAudio() {
     running.store(false, std::memory_order_release);
-    audioSequencerReady.store(false, std::memory_order_release);
     isPlaying.store(false, std::memory_order_relaxed);
     vstCommandCv.notify_all();
     if (audioThread.joinable()) audioThread.join();
-    if (vstCommandThread.joinable()) vstCommandThread.join();
-    if (sequencerThread.joinable()) sequencerThread.join();
+    for (auto& thread : vstCommandThreads)
+    {
+        if (thread.joinable()) thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(vstCommandMutex);
+        vstRetiredHosts.clear();
+    }
+    stopTrackRecording();
+    setInputMonitoring(false);
     shutdownMidiOutput();
+    shutdownTrackFreeze();
+    getPluginDatabase().cancelScan();
+    getPluginDatabase().waitForScan();
+}
+
+double getAudioEngineSampleRate() {
+    return gEngineSampleRate.load(std::memory_order_acquire);
 }
 
 bool loadSampleFile(int trackId, const std::filesystem::path& path) {
@@ -3355,3 +4232,112 @@ bool loadSampleFile(int trackId, const std::filesystem::path& path) {
     trackSetSampleBuffer(trackId, std::move(immutableBuffer));
     return true;
 }
+
+bool setTrackAutomationRecording(int trackId, bool enabled) {
+    auto host = trackGetVstHost(trackId);
+    if (!host)
+        return false;
+
+    if (enabled) {
+        std::lock_guard<std::mutex> lock(gAutomationMutex);
+        if (gAutomationTakes.find(trackId) == gAutomationTakes.end()) {
+            host->automationCapture().clear();
+            gAutomationTakes.emplace(trackId, std::vector<kj::AutomationCapturePoint>{});
+        }
+        host->setAutomationRecording(true);
+        return true;
+    }
+
+    host->setAutomationRecording(false);
+    std::vector<kj::AutomationCapturePoint> take;
+    {
+        std::lock_guard<std::mutex> lock(gAutomationMutex);
+        auto it = gAutomationTakes.find(trackId);
+        if (it == gAutomationTakes.end())
+            return false;
+        drainAutomationCapturesLocked(trackId, it->second);
+        take = std::move(it->second);
+        gAutomationTakes.erase(it);
+    }
+
+    if (const auto dropped = host->automationCapture().droppedPoints())
+        std::cerr << "[VST] Automation recording on track " << trackId << " lost " << dropped << " points." << std::endl;
+    if (take.empty())
+        return true;
+
+    auto current = trackGetAutomation(trackId);
+    auto lanes = current ? std::make_shared<kj::AutomationLanes>(*current) : std::make_shared<kj::AutomationLanes>();
+    kj::mergeAutomationTake(*lanes, std::move(take), kAutomationThinTolerance);
+    trackSetAutomation(trackId, std::move(lanes));
+    return true;
+}
+
+bool trackAutomationRecording(int trackId) {
+    std::lock_guard<std::mutex> lock(gAutomationMutex);
+    return gAutomationTakes.find(trackId) != gAutomationTakes.end();
+}
+
+bool startTrackRecording(int trackId, const std::filesystem::path& path) {
+    if (trackId <= 0)
+        return false;
+
+    std::lock_guard<std::mutex> lock(gRecordingMutex);
+    if (gRecorder.recording() || !startInputCaptureLocked())
+        return false;
+
+    // Trim what the input device reports plus one output buffer, so the take
+    // lines up with what the performer heard.
+    const int captureRate = gCaptureBackend->sampleRate();
+    const double engineRate = gEngineSampleRate.load(std::memory_order_acquire);
+    std::uint32_t latencyFrames = gCaptureBackend->latencyFrames();
+    if (engineRate > 0.0)
+        latencyFrames += static_cast<std::uint32_t>(
+            std::lround(gEngineBlockSize.load(std::memory_order_acquire) * captureRate / engineRate));
+
+    if (!gRecorder.start(path, gCaptureBackend->channels(), captureRate, latencyFrames)) {
+        if (!gInputMonitoring.load(std::memory_order_acquire))
+            stopInputCaptureLocked();
+        return false;
+    }
+    gRecordingTrackId = trackId;
+    return true;
+}
+
+bool stopTrackRecording() {
+    std::lock_guard<std::mutex> lock(gRecordingMutex);
+    if (!gRecorder.recording())
+        return false;
+
+    // Stopping the device first guarantees no push is in flight while the
+    // recorder finalises.
+    stopInputCaptureLocked();
+    AudioRecorder::Take take;
+    bool saved = gRecorder.stop(take);
+    if (take.droppedFrames > 0)
+        std::cerr << "[Capture] Dropped " << take.droppedFrames << " frames while recording "
+                  << take.path.u8string() << std::endl;
+    if (take.buffer && take.frames > 0)
+        trackSetSampleBuffer(gRecordingTrackId, take.buffer);
+    gRecordingTrackId = 0;
+
+    if (gInputMonitoring.load(std::memory_order_acquire))
+        startInputCaptureLocked();
+    return saved;
+}
+
+bool isTrackRecording() {
+    return gRecorder.recording();
+}
+
+void setInputMonitoring(bool enabled) {
+    std::lock_guard<std::mutex> lock(gRecordingMutex);
+    gInputMonitoring.store(enabled, std::memory_order_release);
+    if (enabled)
+        startInputCaptureLocked();
+    else if (!gRecorder.recording())
+        stopInputCaptureLocked();
+}
+
+bool inputMonitoringEnabled() {
+    return gInputMonitoring.load(std::memory_order_acquire);
+}
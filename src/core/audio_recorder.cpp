@@ -0,0 +1,319 @@
+#include "core/audio_recorder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Header room in front of the sample data; padding chunks fill the rest
+    // so the data starts on a page boundary.
+    constexpr std::size_t kHeaderBytes = 4096;
+    constexpr std::size_t kBytesPerSample = sizeof(float);
+
+    class HeaderWriter
+    {
+    public:
+        void tag(const char (&id)[5]) { m_bytes.insert(m_bytes.end(), id, id + 4); }
+
+        void le16(std::uint16_t value) { put(value, 2, false); }
+        void le32(std::uint32_t value) { put(value, 4, false); }
+        void be16(std::uint16_t value) { put(value, 2, true); }
+        void be32(std::uint32_t value) { put(value, 4, true); }
+        void be64(std::uint64_t value) { put(value, 8, true); }
+        void zeros(std::size_t count) { m_bytes.insert(m_bytes.end(), count, 0); }
+
+        std::size_t size() const { return m_bytes.size(); }
+        const std::uint8_t* data() const { return m_bytes.data(); }
+
+    private:
+        void put(std::uint64_t value, int bytes, bool bigEndian)
+        {
+            for (int i = 0; i < bytes; ++i)
+            {
+                const int shift = 8 * (bigEndian ? bytes - 1 - i : i);
+                m_bytes.push_back(static_cast<std::uint8_t>((value >> shift) & 0xFF));
+            }
+        }
+
+        std::vector<std::uint8_t> m_bytes;
+    };
+
+    std::FILE* openForWriting(const std::filesystem::path& path)
+    {
+#if defined(_WIN32)
+        return _wfopen(path.c_str(), L"wb");
+#else
+        return std::fopen(path.c_str(), "wb");
+#endif
+    }
+} // namespace
+
+AudioRecorder::AudioRecorder() = default;
+
+AudioRecorder::~AudioRecorder()
+{
+    Take discarded;
+    stop(discarded);
+}
+
+AudioRecorder::FileFormat AudioRecorder::formatForPath(const std::filesystem::path& path)
+{
+    auto extension = path.extension().u8string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".caf" ? FileFormat::Caf : FileFormat::Wav;
+}
+
+bool AudioRecorder::start(const std::filesystem::path& path, int channels, int sampleRate,
+                          std::uint32_t latencyFrames, double ringSeconds)
+{
+    if (m_writer.joinable() || channels <= 0 || sampleRate <= 0)
+        return false;
+
+    std::error_code ec;
+    if (path.has_parent_path())
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+    m_file = openForWriting(path);
+    if (!m_file)
+    {
+        std::cerr << "[Recorder] Could not create " << path.u8string() << "\n";
+        return false;
+    }
+    // Chunks are already large; stdio buffering would only add a copy.
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+
+    m_path = path;
+    m_format = formatForPath(path);
+    m_channels = channels;
+    m_sampleRate = sampleRate;
+    m_dataOffset = kHeaderBytes;
+    m_preallocatedEnd = 0;
+    m_writeFailed = false;
+    if (!writeHeader(0, false) || !ensurePreallocated(m_dataOffset))
+    {
+        std::fclose(m_file);
+        m_file = nullptr;
+        std::filesystem::remove(path, ec);
+        return false;
+    }
+
+    const std::size_t chunkFrames =
+        std::max<std::size_t>(1, kWriteChunkBytes / (static_cast<std::size_t>(channels) * kBytesPerSample));
+    const auto ringFrames = std::max(static_cast<std::size_t>(ringSeconds * sampleRate), 4 * chunkFrames);
+    m_ring = std::make_unique<AudioFrameRing>(ringFrames, channels);
+    m_chunk.assign(chunkFrames * static_cast<std::size_t>(channels), 0.0f);
+
+    m_buffer = std::make_shared<SampleBuffer>();
+    m_buffer->channels = channels;
+    m_buffer->sampleRate = sampleRate;
+    m_buffer->samples.reserve(static_cast<std::size_t>(sampleRate) * static_cast<std::size_t>(channels) * 30);
+
+    m_latencyFrames = latencyFrames;
+    m_latencyToSkip.store(latencyFrames, std::memory_order_relaxed);
+    m_droppedFrames.store(0, std::memory_order_relaxed);
+    m_framesWritten.store(0, std::memory_order_relaxed);
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_writer = std::thread(&AudioRecorder::writerLoop, this);
+    m_recording.store(true, std::memory_order_release);
+    return true;
+}
+
+bool AudioRecorder::push(const float* interleaved, std::uint32_t frames)
+{
+    if (!m_recording.load(std::memory_order_acquire) || !interleaved)
+        return false;
+
+    const std::uint32_t toSkip = std::min(frames, m_latencyToSkip.load(std::memory_order_relaxed));
+    if (toSkip > 0)
+    {
+        m_latencyToSkip.store(m_latencyToSkip.load(std::memory_order_relaxed) - toSkip, std::memory_order_relaxed);
+        interleaved += static_cast<std::size_t>(toSkip) * static_cast<std::size_t>(m_channels);
+        frames -= toSkip;
+    }
+
+    if (m_ring->write(interleaved, frames))
+        return true;
+    m_droppedFrames.fetch_add(frames, std::memory_order_relaxed);
+    return false;
+}
+
+void AudioRecorder::writerLoop()
+{
+    const std::size_t chunkFrames = m_chunk.size() / static_cast<std::size_t>(m_channels);
+    for (;;)
+    {
+        const bool stopping = m_stopRequested.load(std::memory_order_acquire);
+        // Whole chunks while recording; whatever is left once stopping.
+        while (m_ring->availableFrames() >= chunkFrames || (stopping && m_ring->availableFrames() > 0))
+        {
+            const std::size_t frames = m_ring->read(m_chunk.data(), chunkFrames);
+            writeChunk(m_chunk.data(), frames);
+        }
+        if (stopping)
+            break;
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait_for(lock, std::chrono::milliseconds(5),
+                        [this] { return m_stopRequested.load(std::memory_order_acquire); });
+    }
+}
+
+bool AudioRecorder::writeChunk(const float* interleaved, std::size_t frames)
+{
+    const std::size_t samples = frames * static_cast<std::size_t>(m_channels);
+    m_buffer->samples.insert(m_buffer->samples.end(), interleaved, interleaved + samples);
+    const std::uint64_t written = m_framesWritten.load(std::memory_order_relaxed) + frames;
+    m_framesWritten.store(written, std::memory_order_release);
+
+    if (m_writeFailed)
+        return false;
+
+    const std::uint64_t dataBytes = written * static_cast<std::uint64_t>(m_channels) * kBytesPerSample;
+    if (m_format == FileFormat::Wav && m_dataOffset + dataBytes > std::numeric_limits<std::uint32_t>::max())
+    {
+        std::cerr << "[Recorder] WAV take reached 4 GiB; the rest stays in memory only. Record to .caf for longer takes.\n";
+        m_writeFailed = true;
+        return false;
+    }
+
+    if (!ensurePreallocated(m_dataOffset + dataBytes) ||
+        std::fwrite(interleaved, kBytesPerSample, samples, m_file) != samples)
+    {
+        std::cerr << "[Recorder] Writing " << m_path.u8string() << " failed; the take continues in memory only.\n";
+        m_writeFailed = true;
+        return false;
+    }
+    return true;
+}
+
+bool AudioRecorder::setFileSize(std::uint64_t size)
+{
+#if defined(_WIN32)
+    return _chsize_s(_fileno(m_file), static_cast<__int64>(size)) == 0;
+#else
+    return ftruncate(fileno(m_file), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+bool AudioRecorder::ensurePreallocated(std::uint64_t endOffset)
+{
+    if (endOffset <= m_preallocatedEnd)
+        return true;
+
+    // Grown in large steps so the file system can hand out contiguous space
+    // and the writer rarely pays for an extension.
+    const std::uint64_t target = endOffset + kPreallocateBytes;
+    if (!setFileSize(target))
+        return false;
+    m_preallocatedEnd = target;
+    return true;
+}
+
+bool AudioRecorder::writeHeader(std::uint64_t dataBytes, bool final)
+{
+    HeaderWriter header;
+    const auto channels = static_cast<std::uint32_t>(m_channels);
+    const auto bytesPerFrame = channels * static_cast<std::uint32_t>(kBytesPerSample);
+
+    if (m_format == FileFormat::Wav)
+    {
+        const auto frames = static_cast<std::uint32_t>(dataBytes / bytesPerFrame);
+        header.tag("RIFF");
+        header.le32(static_cast<std::uint32_t>(kHeaderBytes - 8 + dataBytes));
+        header.tag("WAVE");
+        header.tag("fmt ");
+        header.le32(18);
+        header.le16(3); // WAVE_FORMAT_IEEE_FLOAT
+        header.le16(static_cast<std::uint16_t>(channels));
+        header.le32(static_cast<std::uint32_t>(m_sampleRate));
+        header.le32(static_cast<std::uint32_t>(m_sampleRate) * bytesPerFrame);
+        header.le16(static_cast<std::uint16_t>(bytesPerFrame));
+        header.le16(32);
+        header.le16(0);
+        header.tag("fact");
+        header.le32(4);
+        header.le32(frames);
+        // Pad with a JUNK chunk so the data chunk header ends at kHeaderBytes.
+        const std::size_t padding = kHeaderBytes - header.size() - 8 - 8;
+        header.tag("JUNK");
+        header.le32(static_cast<std::uint32_t>(padding));
+        header.zeros(padding);
+        header.tag("data");
+        header.le32(static_cast<std::uint32_t>(dataBytes));
+    }
+    else
+    {
+        double rate = static_cast<double>(m_sampleRate);
+        std::uint64_t rateBits = 0;
+        std::memcpy(&rateBits, &rate, sizeof(rateBits));
+
+        header.tag("caff");
+        header.be16(1);
+        header.be16(0);
+        header.tag("desc");
+        header.be64(32);
+        header.be64(rateBits);
+        header.tag("lpcm");
+        header.be32(1 | 2); // kCAFLinearPCMFormatFlagIsFloat | IsLittleEndian
+        header.be32(bytesPerFrame);
+        header.be32(1);
+        header.be32(channels);
+        header.be32(32);
+        // The data chunk starts with a 4-byte edit count before the samples.
+        const std::size_t padding = kHeaderBytes - header.size() - 12 - 12 - 4;
+        header.tag("free");
+        header.be64(padding);
+        header.zeros(padding);
+        // -1 marks a data chunk that runs to the end of the file, so a take
+        // cut short by a crash still opens.
+        header.tag("data");
+        header.be64(final ? dataBytes + 4 : std::numeric_limits<std::uint64_t>::max());
+        header.be32(0);
+    }
+
+    return std::fseek(m_file, 0, SEEK_SET) == 0 && header.size() == kHeaderBytes &&
+           std::fwrite(header.data(), 1, header.size(), m_file) == header.size();
+}
+
+bool AudioRecorder::stop(Take& take)
+{
+    if (!m_writer.joinable())
+        return false;
+
+    m_recording.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopRequested.store(true, std::memory_order_release);
+    }
+    m_wake.notify_all();
+    m_writer.join();
+
+    const std::uint64_t frames = m_framesWritten.load(std::memory_order_acquire);
+    const std::uint64_t dataBytes = frames * static_cast<std::uint64_t>(m_channels) * kBytesPerSample;
+    bool ok = !m_writeFailed;
+    if (ok)
+        ok = writeHeader(dataBytes, true) && std::fflush(m_file) == 0 && setFileSize(m_dataOffset + dataBytes);
+    std::fclose(m_file);
+    m_file = nullptr;
+    if (!ok)
+        std::cerr << "[Recorder] " << m_path.u8string() << " is incomplete; the take is kept in memory.\n";
+
+    m_buffer->samples.shrink_to_fit();
+    take.path = m_path;
+    take.buffer = std::move(m_buffer);
+    take.frames = frames;
+    take.droppedFrames = m_droppedFrames.load(std::memory_order_relaxed);
+    take.compensatedFrames = m_latencyFrames - m_latencyToSkip.load(std::memory_order_relaxed);
+    return ok;
+}
@@ -0,0 +1,173 @@
+#include "core/aux_buses.h"
+
+#include "core/effects/convolution_reverb.h"
+#include "core/effects/delay_effect.h"
+#include "core/sample_loader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+
+namespace
+{
+struct AuxBusData
+{
+    std::atomic<float> returnLevel{1.0f};
+    std::atomic<bool> delayEnabled{true};
+    std::atomic<float> delayTimeMs{DelayEffect::kDefaultDelayTimeMs};
+    std::atomic<float> delayFeedback{DelayEffect::kDefaultDelayFeedback};
+    std::atomic<bool> reverbEnabled{true};
+    // Guarded by gReverbMutex.
+    std::shared_ptr<const SampleBuffer> reverbImpulse;
+    std::filesystem::path reverbPath;
+    std::shared_ptr<ConvolutionReverb> reverb;
+};
+
+std::array<AuxBusData, kAuxBusCount> gAuxBuses;
+std::mutex gReverbMutex;
+
+AuxBusData* findAuxBus(int busIndex)
+{
+    if (busIndex < 0 || busIndex >= kAuxBusCount)
+        return nullptr;
+    return &gAuxBuses[static_cast<size_t>(busIndex)];
+}
+
+float clampFinite(float value, float minValue, float maxValue, float fallback)
+{
+    return std::isfinite(value) ? std::clamp(value, minValue, maxValue) : fallback;
+}
+}
+
+std::array<AuxBus, kAuxBusCount> getAuxBuses()
+{
+    std::array<AuxBus, kAuxBusCount> result{};
+    for (int i = 0; i < kAuxBusCount; ++i)
+        result[static_cast<size_t>(i)] = auxBusGet(i);
+    return result;
+}
+
+AuxBus auxBusGet(int busIndex)
+{
+    AuxBus result;
+    const AuxBusData* bus = findAuxBus(busIndex);
+    if (!bus)
+        return result;
+
+    result.returnLevel = bus->returnLevel.load(std::memory_order_relaxed);
+    result.delayEnabled = bus->delayEnabled.load(std::memory_order_relaxed);
+    result.delayTimeMs = bus->delayTimeMs.load(std::memory_order_relaxed);
+    result.delayFeedback = bus->delayFeedback.load(std::memory_order_relaxed);
+    result.reverbEnabled = bus->reverbEnabled.load(std::memory_order_relaxed);
+    return result;
+}
+
+void auxBusSetReturnLevel(int busIndex, float level)
+{
+    if (AuxBusData* bus = findAuxBus(busIndex))
+        bus->returnLevel.store(clampFinite(level, 0.0f, 1.0f, 0.0f), std::memory_order_relaxed);
+}
+
+void auxBusSetDelayEnabled(int busIndex, bool enabled)
+{
+    if (AuxBusData* bus = findAuxBus(busIndex))
+        bus->delayEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void auxBusSetDelayTimeMs(int busIndex, float value)
+{
+    if (AuxBusData* bus = findAuxBus(busIndex))
+        bus->delayTimeMs.store(clampFinite(value, DelayEffect::kMinDelayTimeMs, DelayEffect::kMaxDelayTimeMs,
+                                           DelayEffect::kDefaultDelayTimeMs),
+                               std::memory_order_relaxed);
+}
+
+void auxBusSetDelayFeedback(int busIndex, float value)
+{
+    if (AuxBusData* bus = findAuxBus(busIndex))
+        bus->delayFeedback.store(clampFinite(value, DelayEffect::kMinFeedback, DelayEffect::kMaxFeedback,
+                                             DelayEffect::kDefaultDelayFeedback),
+                                 std::memory_order_relaxed);
+}
+
+void auxBusSetReverbEnabled(int busIndex, bool enabled)
+{
+    if (AuxBusData* bus = findAuxBus(busIndex))
+        bus->reverbEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool auxBusLoadReverbImpulse(int busIndex, const std::filesystem::path& path)
+{
+    AuxBusData* bus = findAuxBus(busIndex);
+    if (!bus)
+        return false;
+
+    auto impulse = std::make_shared<SampleBuffer>();
+    if (!loadSampleFromFile(path, *impulse) || impulse->frameCount() == 0)
+    {
+        std::cerr << "[KJ] Could not load impulse response " << path.u8string() << " for aux bus " << busIndex + 1
+                  << "." << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(gReverbMutex);
+    bus->reverbImpulse = std::move(impulse);
+    bus->reverbPath = path;
+    // Built by the next getAuxBusReverbs(), which knows the sample rate.
+    bus->reverb.reset();
+    return true;
+}
+
+void auxBusClearReverbImpulse(int busIndex)
+{
+    AuxBusData* bus = findAuxBus(busIndex);
+    if (!bus)
+        return;
+
+    std::lock_guard<std::mutex> lock(gReverbMutex);
+    bus->reverbImpulse.reset();
+    bus->reverbPath.clear();
+    bus->reverb.reset();
+}
+
+std::filesystem::path auxBusGetReverbImpulsePath(int busIndex)
+{
+    const AuxBusData* bus = findAuxBus(busIndex);
+    if (!bus)
+        return {};
+
+    std::lock_guard<std::mutex> lock(gReverbMutex);
+    return bus->reverbPath;
+}
+
+std::array<std::shared_ptr<ConvolutionReverb>, kAuxBusCount> getAuxBusReverbs(double sampleRate)
+{
+    std::array<std::shared_ptr<ConvolutionReverb>, kAuxBusCount> result{};
+    std::lock_guard<std::mutex> lock(gReverbMutex);
+    for (std::size_t i = 0; i < gAuxBuses.size(); ++i)
+    {
+        AuxBusData& bus = gAuxBuses[i];
+        if (!bus.reverbImpulse)
+            continue;
+        if (sampleRate > 0.0 && (!bus.reverb || std::abs(bus.reverb->sampleRate() - sampleRate) > 1e-6))
+            bus.reverb = std::make_shared<ConvolutionReverb>(*bus.reverbImpulse, sampleRate);
+        result[i] = bus.reverb;
+    }
+    return result;
+}
+
+void resetAuxBuses()
+{
+    const AuxBus defaults;
+    for (int i = 0; i < kAuxBusCount; ++i)
+    {
+        auxBusSetReturnLevel(i, defaults.returnLevel);
+        auxBusSetDelayEnabled(i, defaults.delayEnabled);
+        auxBusSetDelayTimeMs(i, defaults.delayTimeMs);
+        auxBusSetDelayFeedback(i, defaults.delayFeedback);
+        auxBusSetReverbEnabled(i, defaults.reverbEnabled);
+        auxBusClearReverbImpulse(i);
+    }
+}
@@ -0,0 +1,113 @@
+#include "core/aligned_buffer.h"
+#include "core/dsp_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    constexpr std::size_t kBlockFrames = 512;
+    constexpr int kBlocks = 200000;
+
+    // Millions of frames per second through body(), which processes one block.
+    template <typename Body>
+    double measure(Body&& body)
+    {
+        body();
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kBlocks; ++i)
+            body();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return static_cast<double>(kBlocks) * kBlockFrames / elapsed.count() / 1e6;
+    }
+
+    template <typename T>
+    struct Buffers
+    {
+        AlignedBuffer<T> left{kBlockFrames};
+        AlignedBuffer<T> right{kBlockFrames};
+        AlignedBuffer<T> source{kBlockFrames};
+        AlignedBuffer<float> device{kBlockFrames * 2};
+
+        Buffers()
+        {
+            for (std::size_t i = 0; i < kBlockFrames; ++i)
+            {
+                source[i] = static_cast<T>(std::sin(0.01 * static_cast<double>(i)));
+                left[i] = source[i];
+                right[i] = -source[i];
+            }
+        }
+    };
+
+    void report(const std::string& name, double floatRate, double doubleRate)
+    {
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << floatRate << std::setw(10) << doubleRate << std::setw(8)
+                  << std::setprecision(2) << floatRate / doubleRate << "x" << std::endl;
+    }
+
+    template <typename T>
+    double mixRate(Buffers<T>& buffers)
+    {
+        return measure([&] {
+            dsp::addScaled(buffers.left.data(), buffers.source.data(), T(0.25), kBlockFrames);
+            dsp::addScaled(buffers.right.data(), buffers.source.data(), T(-0.25), kBlockFrames);
+        });
+    }
+
+    template <typename T>
+    double gainRampRate(Buffers<T>& buffers)
+    {
+        // Reloaded every block; repeated ramps would decay the samples into
+        // denormals and time those instead.
+        return measure([&] {
+            std::copy(buffers.source.data(), buffers.source.data() + kBlockFrames, buffers.left.data());
+            std::copy(buffers.source.data(), buffers.source.data() + kBlockFrames, buffers.right.data());
+            dsp::applyGainRamp(buffers.left.data(), T(0.5), T(1), kBlockFrames);
+            dsp::applyGainRamp(buffers.right.data(), T(1), T(0.5), kBlockFrames);
+        });
+    }
+
+    template <typename T>
+    double outputRate(Buffers<T>& buffers)
+    {
+        return measure([&] {
+            dsp::clamp(buffers.left.data(), T(-1), T(1), kBlockFrames);
+            dsp::clamp(buffers.right.data(), T(-1), T(1), kBlockFrames);
+            dsp::interleaveToFloat(buffers.left.data(), buffers.right.data(), buffers.device.data(), kBlockFrames, 2);
+        });
+    }
+
+    template <typename T>
+    double biquadRate(Buffers<T>& buffers)
+    {
+        dsp::BiquadCoefficients coefficients{0.2, 0.4, 0.2, -0.6, 0.2};
+        dsp::BiquadState<T> left;
+        dsp::BiquadState<T> right;
+        return measure([&] {
+            dsp::processBiquad(coefficients, left, buffers.left.data(), kBlockFrames);
+            dsp::processBiquad(coefficients, right, buffers.right.data(), kBlockFrames);
+        });
+    }
+} // namespace
+
+int main()
+{
+    Buffers<float> floats;
+    Buffers<double> doubles;
+
+    std::cout << "Stereo frames per second, millions (" << kBlockFrames << "-frame blocks)\n"
+              << std::left << std::setw(22) << "kernel" << std::right << std::setw(10) << "float" << std::setw(10)
+              << "double" << std::setw(9) << "ratio" << std::endl;
+    report("mix (scaled add)", mixRate(floats), mixRate(doubles));
+    report("copy + gain ramp", gainRampRate(floats), gainRampRate(doubles));
+    report("clamp + interleave", outputRate(floats), outputRate(doubles));
+    report("biquad", biquadRate(floats), biquadRate(doubles));
+    return 0;
+}
@@ -0,0 +1,589 @@
+#include "core/effects/convolution_reverb.h"
+
+#include "core/denormals.h"
+#include "core/sample_loader.h"
+#include "core/thread_priority.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <complex>
+
+namespace
+{
+constexpr double kPi = 3.14159265358979323846264338327950288;
+constexpr double kDefaultSampleRate = 44100.0;
+
+using Complex = std::complex<float>;
+
+// Written out so that it compiles to four multiplies; operator* on
+// std::complex also checks for NaN and infinity.
+inline Complex multiply(Complex a, Complex b)
+{
+    return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+}
+
+// In-place radix-2 complex FFT of a fixed power-of-two size. The inverse is
+// unscaled.
+class Fft
+{
+public:
+    explicit Fft(std::size_t size)
+        : m_size(size)
+        , m_bitReverse(size)
+        , m_twiddles(size / 2)
+    {
+        std::size_t bits = 0;
+        while ((std::size_t{1} << bits) < size)
+            ++bits;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            std::size_t reversed = 0;
+            for (std::size_t bit = 0; bit < bits; ++bit)
+                reversed |= ((i >> bit) & 1u) << (bits - 1 - bit);
+            m_bitReverse[i] = reversed;
+        }
+        for (std::size_t k = 0; k < m_twiddles.size(); ++k)
+        {
+            double angle = -2.0 * kPi * static_cast<double>(k) / static_cast<double>(size);
+            m_twiddles[k] = Complex(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+        }
+    }
+
+    void transform(Complex* data, bool inverse) const
+    {
+        for (std::size_t i = 0; i < m_size; ++i)
+        {
+            std::size_t j = m_bitReverse[i];
+            if (i < j)
+                std::swap(data[i], data[j]);
+        }
+        const float sign = inverse ? -1.0f : 1.0f;
+        for (std::size_t length = 2; length <= m_size; length <<= 1)
+        {
+            std::size_t half = length / 2;
+            std::size_t step = m_size / length;
+            for (std::size_t start = 0; start < m_size; start += length)
+            {
+                for (std::size_t j = 0; j < half; ++j)
+                {
+                    const Complex& twiddle = m_twiddles[j * step];
+                    Complex w(twiddle.real(), sign * twiddle.imag());
+                    Complex u = data[start + j];
+                    Complex v = multiply(data[start + j + half], w);
+                    data[start + j] = u + v;
+                    data[start + j + half] = u - v;
+                }
+            }
+        }
+    }
+
+private:
+    std::size_t m_size;
+    std::vector<std::size_t> m_bitReverse;
+    std::vector<Complex> m_twiddles;
+};
+
+// Splits the transform of left + i*right into the transforms of the two
+// real signals, bins 0 to size / 2.
+void separateSpectra(const Complex* packed, std::size_t size, Complex* left, Complex* right, float scale)
+{
+    const float halfScale = 0.5f * scale;
+    for (std::size_t k = 0; k <= size / 2; ++k)
+    {
+        Complex value = packed[k];
+        Complex mirror = std::conj(packed[(size - k) & (size - 1)]);
+        Complex sum = value + mirror;
+        Complex difference = value - mirror;
+        left[k] = Complex(sum.real() * halfScale, sum.imag() * halfScale);
+        right[k] = Complex(difference.imag() * halfScale, -difference.real() * halfScale);
+    }
+}
+
+static_assert(ConvolutionReverb::kHeadLength % 4 == 0, "The head FIR is summed four taps at a time.");
+
+// Dot product over the head; count is a multiple of four.
+float dotProduct(const float* a, const float* b, std::size_t count)
+{
+    // Four partial sums; the compiler may not reorder a float reduction.
+    float sum0 = 0.0f;
+    float sum1 = 0.0f;
+    float sum2 = 0.0f;
+    float sum3 = 0.0f;
+    for (std::size_t i = 0; i < count; i += 4)
+    {
+        sum0 += a[i] * b[i];
+        sum1 += a[i + 1] * b[i + 1];
+        sum2 += a[i + 2] * b[i + 2];
+        sum3 += a[i + 3] * b[i + 3];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+std::vector<float> resampleChannel(const SampleBuffer& impulse, int channel, double ratio, std::size_t frames)
+{
+    const std::size_t sourceFrames = impulse.frameCount();
+    const auto channels = static_cast<std::size_t>(impulse.channels);
+    auto at = [&](std::size_t frame) {
+        return impulse.samples[std::min(frame, sourceFrames - 1) * channels + static_cast<std::size_t>(channel)];
+    };
+    std::vector<float> result(frames);
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        double position = static_cast<double>(i) * ratio;
+        auto index = static_cast<std::size_t>(position);
+        auto fraction = static_cast<float>(position - static_cast<double>(index));
+        result[i] = at(index) + (at(index + 1) - at(index)) * fraction;
+    }
+    return result;
+}
+}
+
+// One uniformly partitioned stage: overlap-save with a frequency-domain
+// delay line. Left and right go through one complex transform as the real
+// and imaginary parts.
+struct ConvolutionReverb::Stage
+{
+    Stage(const std::vector<float>& left, const std::vector<float>& right, std::size_t begin, std::size_t end,
+          std::size_t partitionSize)
+        : partition(partitionSize)
+        , fftSize(2 * partitionSize)
+        , bins(partitionSize + 1)
+        , count((end - begin + partitionSize - 1) / partitionSize)
+        , fft(2 * partitionSize)
+        , filtersLeft(count * bins)
+        , filtersRight(count * bins)
+        , spectraLeft(count * bins)
+        , spectraRight(count * bins)
+        , inputLeft(partition)
+        , inputRight(partition)
+        , previousLeft(partition)
+        , previousRight(partition)
+        , outputLeft(partition)
+        , outputRight(partition)
+        , buffer(fftSize)
+        , sumLeft(bins)
+        , sumRight(bins)
+    {
+        // The 1 / size of the inverse transform is folded into the filters.
+        const float scale = 1.0f / static_cast<float>(fftSize);
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            std::fill(buffer.begin(), buffer.end(), Complex());
+            std::size_t first = begin + index * partition;
+            std::size_t last = std::min(end, first + partition);
+            for (std::size_t i = first; i < last; ++i)
+                buffer[i - first] = Complex(left[i], right[i]);
+            fft.transform(buffer.data(), false);
+            separateSpectra(buffer.data(), fftSize, &filtersLeft[index * bins], &filtersRight[index * bins], scale);
+        }
+    }
+
+    // Convolves the partition in inputLeft / inputRight into outputLeft /
+    // outputRight.
+    void convolve()
+    {
+        for (std::size_t i = 0; i < partition; ++i)
+        {
+            buffer[i] = Complex(previousLeft[i], previousRight[i]);
+            buffer[partition + i] = Complex(inputLeft[i], inputRight[i]);
+        }
+        std::copy(inputLeft.begin(), inputLeft.end(), previousLeft.begin());
+        std::copy(inputRight.begin(), inputRight.end(), previousRight.begin());
+        fft.transform(buffer.data(), false);
+
+        newest = (newest + count - 1) % count;
+        separateSpectra(buffer.data(), fftSize, &spectraLeft[newest * bins], &spectraRight[newest * bins], 1.0f);
+
+        std::fill(sumLeft.begin(), sumLeft.end(), Complex());
+        std::fill(sumRight.begin(), sumRight.end(), Complex());
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            std::size_t slot = (newest + index) % count;
+            const Complex* inLeft = &spectraLeft[slot * bins];
+            const Complex* inRight = &spectraRight[slot * bins];
+            const Complex* filterLeft = &filtersLeft[index * bins];
+            const Complex* filterRight = &filtersRight[index * bins];
+            for (std::size_t k = 0; k < bins; ++k)
+            {
+                sumLeft[k] += multiply(inLeft[k], filterLeft[k]);
+                sumRight[k] += multiply(inRight[k], filterRight[k]);
+            }
+        }
+
+        // Repack as left + i*right, filling in the mirrored bins.
+        for (std::size_t k = 0; k < bins; ++k)
+        {
+            buffer[k] = Complex(sumLeft[k].real() - sumRight[k].imag(), sumLeft[k].imag() + sumRight[k].real());
+            if (k > 0 && k < partition)
+                buffer[fftSize - k] =
+                    Complex(sumLeft[k].real() + sumRight[k].imag(), sumRight[k].real() - sumLeft[k].imag());
+        }
+        fft.transform(buffer.data(), true);
+        for (std::size_t i = 0; i < partition; ++i)
+        {
+            outputLeft[i] = buffer[partition + i].real();
+            outputRight[i] = buffer[partition + i].imag();
+        }
+    }
+
+    void reset()
+    {
+        std::fill(spectraLeft.begin(), spectraLeft.end(), Complex());
+        std::fill(spectraRight.begin(), spectraRight.end(), Complex());
+        std::fill(previousLeft.begin(), previousLeft.end(), 0.0f);
+        std::fill(previousRight.begin(), previousRight.end(), 0.0f);
+        newest = 0;
+    }
+
+    std::size_t partition;
+    std::size_t fftSize;
+    std::size_t bins;
+    std::size_t count;
+    Fft fft;
+    std::vector<Complex> filtersLeft;
+    std::vector<Complex> filtersRight;
+    // Spectra of the last count input partitions; newest is the latest.
+    std::vector<Complex> spectraLeft;
+    std::vector<Complex> spectraRight;
+    std::size_t newest = 0;
+    std::vector<float> inputLeft;
+    std::vector<float> inputRight;
+    std::vector<float> previousLeft;
+    std::vector<float> previousRight;
+    std::vector<float> outputLeft;
+    std::vector<float> outputRight;
+    std::vector<Complex> buffer;
+    std::vector<Complex> sumLeft;
+    std::vector<Complex> sumRight;
+};
+
+// Wakes the tail worker when the job word changes. The word is the source of
+// truth and wake-ups may be spurious; posting one never takes a lock. On
+// Linux the word itself is the futex; Windows gets an unnamed semaphore.
+struct ConvolutionReverb::TailSignal
+{
+#ifdef _WIN32
+    TailSignal()
+        : semaphore(CreateSemaphoreW(nullptr, 0, 0x7fffffff, nullptr))
+    {
+    }
+    ~TailSignal()
+    {
+        if (semaphore)
+            CloseHandle(semaphore);
+    }
+    TailSignal(const TailSignal&) = delete;
+    TailSignal& operator=(const TailSignal&) = delete;
+
+    void wake(std::atomic<std::uint32_t>&) { ReleaseSemaphore(semaphore, 1, nullptr); }
+    void wait(std::atomic<std::uint32_t>& word, std::uint32_t seen)
+    {
+        if (word.load(std::memory_order_acquire) == seen)
+            WaitForSingleObject(semaphore, INFINITE);
+    }
+
+    HANDLE semaphore;
+#else
+    void wake(std::atomic<std::uint32_t>& word)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+        (void)word;
+#endif
+    }
+    void wait(std::atomic<std::uint32_t>& word, std::uint32_t seen)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, seen, nullptr, nullptr, 0);
+#else
+        if (word.load(std::memory_order_acquire) == seen)
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+#endif
+    }
+#endif
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "The tail job word is waited on as a futex.");
+
+ConvolutionReverb::ConvolutionReverb(const SampleBuffer& impulse, double sampleRate, bool backgroundTail)
+    : m_sampleRate(sampleRate > 0.0 ? sampleRate : kDefaultSampleRate)
+    , m_headLeft(kHeadLength, 0.0f)
+    , m_headRight(kHeadLength, 0.0f)
+    , m_historyLeft(2 * kHeadLength, 0.0f)
+    , m_historyRight(2 * kHeadLength, 0.0f)
+    , m_tailInputLeft(kTailPartition, 0.0f)
+    , m_tailInputRight(kTailPartition, 0.0f)
+    , m_heldInputLeft(kTailPartition, 0.0f)
+    , m_heldInputRight(kTailPartition, 0.0f)
+    , m_outputLeft(2 * kTailPartition, 0.0f)
+    , m_outputRight(2 * kTailPartition, 0.0f)
+    , m_outputMask(2 * kTailPartition - 1)
+    , m_backgroundTail(backgroundTail)
+{
+    const std::size_t sourceFrames = impulse.frameCount();
+    if (sourceFrames == 0)
+    {
+        m_backgroundTail = false;
+        return;
+    }
+
+    double ratio = impulse.sampleRate > 0 ? impulse.sampleRate / m_sampleRate : 1.0;
+    auto frames = static_cast<std::size_t>(std::ceil(static_cast<double>(sourceFrames) / ratio));
+    frames = std::clamp<std::size_t>(frames, 1, static_cast<std::size_t>(kMaxImpulseSeconds * m_sampleRate));
+    std::vector<float> left = resampleChannel(impulse, 0, ratio, frames);
+    std::vector<float> right = impulse.channels > 1 ? resampleChannel(impulse, 1, ratio, frames) : left;
+
+    double energyLeft = 0.0;
+    double energyRight = 0.0;
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        energyLeft += static_cast<double>(left[i]) * left[i];
+        energyRight += static_cast<double>(right[i]) * right[i];
+    }
+    double energy = std::max(energyLeft, energyRight);
+    if (energy > 0.0)
+    {
+        auto scale = static_cast<float>(1.0 / std::sqrt(energy));
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+            left[i] *= scale;
+            right[i] *= scale;
+        }
+    }
+    m_impulseLength = frames;
+
+    // Reversed, so the FIR is a dot product with the history in time order.
+    for (std::size_t i = 0; i < std::min(frames, kHeadLength); ++i)
+    {
+        m_headLeft[kHeadLength - 1 - i] = left[i];
+        m_headRight[kHeadLength - 1 - i] = right[i];
+    }
+    if (frames > kHeadLength)
+        m_body = std::make_unique<Stage>(left, right, kHeadLength, std::min(frames, kTailOffset), kHeadLength);
+    if (frames > kTailOffset)
+        m_tail = std::make_unique<Stage>(left, right, kTailOffset, frames, kTailPartition);
+
+    if (!m_tail)
+        m_backgroundTail = false;
+    if (m_backgroundTail)
+    {
+        m_signal = std::make_unique<TailSignal>();
+        m_worker = std::thread([this]() { workerLoop(); });
+    }
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+    if (!m_worker.joinable())
+        return;
+    // Lets a job the worker has started run out, then parks the word on
+    // stop; the worker sees it on its next look.
+    while (true)
+    {
+        std::uint32_t state = m_tailJob.load(std::memory_order_acquire);
+        if (state != kTailRunning && m_tailJob.compare_exchange_weak(state, kTailStop, std::memory_order_acq_rel))
+            break;
+        std::this_thread::yield();
+    }
+    m_signal->wake(m_tailJob);
+    m_worker.join();
+}
+
+void ConvolutionReverb::process(float* left, float* right, std::size_t frameCount)
+{
+    std::size_t done = 0;
+    while (done < frameCount)
+    {
+        // Runs up to the next partition boundary. The tail partition is a
+        // multiple of the head, so its boundaries fall on one of these.
+        std::size_t frames = std::min(frameCount - done, kHeadLength - m_bodyFill);
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+            float inLeft = left[done + i];
+            float inRight = right[done + i];
+            m_historyLeft[m_historyIndex] = inLeft;
+            m_historyLeft[m_historyIndex + kHeadLength] = inLeft;
+            m_historyRight[m_historyIndex] = inRight;
+            m_historyRight[m_historyIndex + kHeadLength] = inRight;
+            float wetLeft = dotProduct(m_headLeft.data(), &m_historyLeft[m_historyIndex + 1], kHeadLength);
+            float wetRight = dotProduct(m_headRight.data(), &m_historyRight[m_historyIndex + 1], kHeadLength);
+            m_historyIndex = (m_historyIndex + 1) % kHeadLength;
+
+            if (m_body)
+            {
+                m_body->inputLeft[m_bodyFill + i] = inLeft;
+                m_body->inputRight[m_bodyFill + i] = inRight;
+            }
+            m_tailInputLeft[m_tailFill + i] = inLeft;
+            m_tailInputRight[m_tailFill + i] = inRight;
+
+            left[done + i] = wetLeft + m_outputLeft[m_outputIndex];
+            right[done + i] = wetRight + m_outputRight[m_outputIndex];
+            m_outputLeft[m_outputIndex] = 0.0f;
+            m_outputRight[m_outputIndex] = 0.0f;
+            m_outputIndex = (m_outputIndex + 1) & m_outputMask;
+        }
+        done += frames;
+        m_bodyFill += frames;
+        m_tailFill += frames;
+
+        // A partition that ended at frame t starts contributing at t + 1,
+        // which is where the output index is now.
+        if (m_bodyFill != kHeadLength)
+            continue;
+        m_bodyFill = 0;
+        if (m_body)
+        {
+            m_body->convolve();
+            addToOutput(m_body->outputLeft.data(), m_body->outputRight.data(), kHeadLength);
+        }
+        bool tailBoundary = m_tailFill == kTailPartition;
+        if (tailBoundary)
+            m_tailFill = 0;
+        if (!m_tail)
+            continue;
+        if (tailBoundary)
+        {
+            // The tail starts kTailPartition after the partition its input
+            // came from, so the job started one partition ago is due now.
+            // Should the worker still be on an earlier one, this partition
+            // waits behind it; one already waiting is dropped.
+            if (releaseHeldTail() || m_tailHeld || !collectTailJob())
+            {
+                std::copy(m_tailInputLeft.begin(), m_tailInputLeft.end(), m_heldInputLeft.begin());
+                std::copy(m_tailInputRight.begin(), m_tailInputRight.end(), m_heldInputRight.begin());
+                m_tailHeld = true;
+            }
+            else
+            {
+                startTailJob(m_tailInputLeft.data(), m_tailInputRight.data());
+            }
+        }
+        else
+        {
+            // A late job is picked up at the first head boundary after it
+            // finishes.
+            releaseHeldTail();
+        }
+    }
+}
+
+void ConvolutionReverb::reset()
+{
+    m_tailHeld = false;
+    std::uint32_t expected = kTailQueued;
+    if (!m_tailJob.compare_exchange_strong(expected, kTailIdle, std::memory_order_acq_rel) &&
+        expected == kTailRunning)
+    {
+        m_tailDiscard = true;
+    }
+    else
+    {
+        m_tailJob.store(kTailIdle, std::memory_order_relaxed);
+        m_tailDiscard = false;
+        if (m_tail)
+            m_tail->reset();
+    }
+    std::fill(m_historyLeft.begin(), m_historyLeft.end(), 0.0f);
+    std::fill(m_historyRight.begin(), m_historyRight.end(), 0.0f);
+    std::fill(m_outputLeft.begin(), m_outputLeft.end(), 0.0f);
+    std::fill(m_outputRight.begin(), m_outputRight.end(), 0.0f);
+    m_historyIndex = 0;
+    m_outputIndex = 0;
+    m_bodyFill = 0;
+    m_tailFill = 0;
+    if (m_body)
+        m_body->reset();
+}
+
+void ConvolutionReverb::addToOutput(const float* left, const float* right, std::size_t frameCount)
+{
+    for (std::size_t i = 0; i < frameCount; ++i)
+    {
+        std::size_t index = (m_outputIndex + i) & m_outputMask;
+        m_outputLeft[index] += left[i];
+        m_outputRight[index] += right[i];
+    }
+}
+
+// Adds the output of a finished tail job. Returns false, without waiting,
+// while the worker has yet to start or finish it; the job is then late and
+// is collected at a later head boundary.
+bool ConvolutionReverb::collectTailJob()
+{
+    const std::uint32_t state = m_tailJob.load(std::memory_order_acquire);
+    if (state == kTailQueued || state == kTailRunning)
+        return false;
+    if (state == kTailDone)
+    {
+        if (m_tailDiscard)
+            m_tail->reset();
+        else
+            addToOutput(m_tail->outputLeft.data(), m_tail->outputRight.data(), kTailPartition);
+    }
+    m_tailDiscard = false;
+    m_tailJob.store(kTailIdle, std::memory_order_relaxed);
+    return true;
+}
+
+// Once the late job is collected, starts the partition held back behind it.
+// Returns whether it did.
+bool ConvolutionReverb::releaseHeldTail()
+{
+    if ((!m_tailHeld && !m_tailDiscard) || !collectTailJob() || !m_tailHeld)
+        return false;
+    m_tailHeld = false;
+    startTailJob(m_heldInputLeft.data(), m_heldInputRight.data());
+    return true;
+}
+
+void ConvolutionReverb::startTailJob(const float* left, const float* right)
+{
+    std::copy(left, left + kTailPartition, m_tail->inputLeft.begin());
+    std::copy(right, right + kTailPartition, m_tail->inputRight.begin());
+    if (!m_backgroundTail)
+    {
+        m_tail->convolve();
+        m_tailJob.store(kTailDone, std::memory_order_relaxed);
+        return;
+    }
+    m_tailJob.store(kTailQueued, std::memory_order_release);
+    m_signal->wake(m_tailJob);
+}
+
+void ConvolutionReverb::workerLoop()
+{
+    ScopedDenormalFlush denormalFlush;
+    // The render thread counts on each job finishing within a partition.
+    raiseThreadToAudioPriority();
+    while (true)
+    {
+        std::uint32_t state = m_tailJob.load(std::memory_order_acquire);
+        if (state == kTailStop)
+            return;
+        if (state == kTailQueued)
+        {
+            if (m_tailJob.compare_exchange_strong(state, kTailRunning, std::memory_order_acq_rel))
+            {
+                m_tail->convolve();
+                m_tailJob.store(kTailDone, std::memory_order_release);
+            }
+            continue;
+        }
+        m_signal->wait(m_tailJob, state);
+    }
+}
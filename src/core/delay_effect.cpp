@@ -6,6 +6,7 @@
 namespace
 {
 constexpr double kDefaultSampleRate = 44100.0;
+constexpr double kTailThreshold = 1e-6;
 
 std::size_t computeRequiredSamples(double sampleRate)
 {
@@ -98,6 +99,16 @@ void DelayEffect::process(float* left, float* right, std::size_t frameCount)
     }
 }
 
+std::size_t DelayEffect::tailSamples() const noexcept
+{
+    // The buffer holds the last input for one delay period; every further
+    // repeat is scaled by the feedback again.
+    std::size_t repeats = 1;
+    if (m_feedback > 0.0f)
+        repeats += static_cast<std::size_t>(std::ceil(std::log(kTailThreshold) / std::log(static_cast<double>(m_feedback))));
+    return m_delaySamples * repeats;
+}
+
 void DelayEffect::resizeBuffer(std::size_t requiredSamples)
 {
     if (requiredSamples < 1)
@@ -0,0 +1,177 @@
+#include "core/dsp_kernels.h"
+
+#include <algorithm>
+
+namespace dsp
+{
+    template <typename T>
+    void add(T* KJ_RESTRICT destination, const T* KJ_RESTRICT source, std::size_t frames)
+    {
+        for (std::size_t i = 0; i < frames; ++i)
+            destination[i] += source[i];
+    }
+
+    template <typename T>
+    void addScaled(T* KJ_RESTRICT destination, const T* KJ_RESTRICT source, T gain, std::size_t frames)
+    {
+        for (std::size_t i = 0; i < frames; ++i)
+            destination[i] += source[i] * gain;
+    }
+
+    template <typename T>
+    void applyGain(T* samples, T gain, std::size_t frames)
+    {
+        for (std::size_t i = 0; i < frames; ++i)
+            samples[i] *= gain;
+    }
+
+    template <typename T>
+    void applyGainRamp(T* samples, T startGain, T endGain, std::size_t frames)
+    {
+        if (frames == 0)
+            return;
+        // Computed from the index rather than accumulated, so lanes do not
+        // depend on each other and the ramp does not drift. The index is
+        // signed because unsigned-to-float conversion does not vectorise.
+        const T step = (endGain - startGain) / static_cast<T>(frames);
+        const auto count = static_cast<std::int32_t>(frames);
+        for (std::int32_t i = 0; i < count; ++i)
+            samples[i] *= startGain + step * static_cast<T>(i);
+    }
+
+    template <typename T>
+    void clamp(T* samples, T low, T high, std::size_t frames)
+    {
+        for (std::size_t i = 0; i < frames; ++i)
+            samples[i] = std::min(std::max(samples[i], low), high);
+    }
+
+    template <typename T>
+    std::size_t replaceNonFinite(T* samples, std::size_t frames)
+    {
+        // x - x is 0 for every finite x and NaN for NaN and infinity.
+        std::size_t replaced = 0;
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+            const bool finite = samples[i] - samples[i] == T(0);
+            replaced += finite ? 0 : 1;
+            samples[i] = finite ? samples[i] : T(0);
+        }
+        return replaced;
+    }
+
+    template <typename T>
+    void addInterleavedStereo(T* KJ_RESTRICT left, T* KJ_RESTRICT right, const float* KJ_RESTRICT interleaved,
+                              std::size_t frames)
+    {
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+            left[i] += static_cast<T>(interleaved[i * 2]);
+            right[i] += static_cast<T>(interleaved[i * 2 + 1]);
+        }
+    }
+
+    template <typename T>
+    void interleaveToFloat(const T* KJ_RESTRICT left, const T* KJ_RESTRICT right, float* KJ_RESTRICT output,
+                           std::size_t frames, std::size_t channels)
+    {
+        if (channels == 2)
+        {
+            for (std::size_t i = 0; i < frames; ++i)
+            {
+                output[i * 2] = static_cast<float>(left[i]);
+                output[i * 2 + 1] = static_cast<float>(right[i]);
+            }
+            return;
+        }
+        if (channels == 1)
+        {
+            downmixToMono(left, right, output, frames);
+            return;
+        }
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+            float* frame = output + i * channels;
+            frame[0] = static_cast<float>(left[i]);
+            frame[1] = static_cast<float>(right[i]);
+            std::fill(frame + 2, frame + channels, 0.0f);
+        }
+    }
+
+    template <typename T>
+    void interleaveToInt16(const T* KJ_RESTRICT left, const T* KJ_RESTRICT right, std::int16_t* KJ_RESTRICT output,
+                           std::size_t frames, std::size_t channels)
+    {
+        // Rounds half away from zero, like lround(), without a library call.
+        auto toInt16 = [](T value) {
+            const T scaled = value * static_cast<T>(32767);
+            return static_cast<std::int16_t>(scaled + (scaled < 0 ? static_cast<T>(-0.5) : static_cast<T>(0.5)));
+        };
+        if (channels == 1)
+        {
+            for (std::size_t i = 0; i < frames; ++i)
+                output[i] = toInt16((left[i] + right[i]) * static_cast<T>(0.5));
+            return;
+        }
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+            std::int16_t* frame = output + i * channels;
+            frame[0] = toInt16(left[i]);
+            frame[1] = toInt16(right[i]);
+            for (std::size_t ch = 2; ch < channels; ++ch)
+                frame[ch] = 0;
+        }
+    }
+
+    template <typename T>
+    void downmixToMono(const T* KJ_RESTRICT left, const T* KJ_RESTRICT right, float* KJ_RESTRICT output,
+                       std::size_t frames)
+    {
+        for (std::size_t i = 0; i < frames; ++i)
+            output[i] = static_cast<float>((left[i] + right[i]) * static_cast<T>(0.5));
+    }
+
+    template <typename T, typename S>
+    void processBiquad(const BiquadCoefficients& coefficients, BiquadState<S>& state, T* samples,
+                       std::size_t frames)
+    {
+        const auto b0 = static_cast<S>(coefficients.b0);
+        const auto b1 = static_cast<S>(coefficients.b1);
+        const auto b2 = static_cast<S>(coefficients.b2);
+        const auto a1 = static_cast<S>(coefficients.a1);
+        const auto a2 = static_cast<S>(coefficients.a2);
+        S z1 = state.z1;
+        S z2 = state.z2;
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+            const S input = static_cast<S>(samples[i]);
+            const S output = b0 * input + z1;
+            z1 = b1 * input + z2 - a1 * output;
+            z2 = b2 * input - a2 * output;
+            samples[i] = static_cast<T>(output);
+        }
+        state.z1 = z1;
+        state.z2 = z2;
+    }
+
+#define KJ_INSTANTIATE_DSP_KERNELS(T)                                                                             \
+    template void add<T>(T* KJ_RESTRICT, const T* KJ_RESTRICT, std::size_t);                                     \
+    template void addScaled<T>(T* KJ_RESTRICT, const T* KJ_RESTRICT, T, std::size_t);                            \
+    template void applyGain<T>(T*, T, std::size_t);                                                              \
+    template void applyGainRamp<T>(T*, T, T, std::size_t);                                                       \
+    template void clamp<T>(T*, T, T, std::size_t);                                                               \
+    template std::size_t replaceNonFinite<T>(T*, std::size_t);                                                   \
+    template void addInterleavedStereo<T>(T* KJ_RESTRICT, T* KJ_RESTRICT, const float* KJ_RESTRICT, std::size_t); \
+    template void interleaveToFloat<T>(const T* KJ_RESTRICT, const T* KJ_RESTRICT, float* KJ_RESTRICT,           \
+                                       std::size_t, std::size_t);                                                 \
+    template void interleaveToInt16<T>(const T* KJ_RESTRICT, const T* KJ_RESTRICT, std::int16_t* KJ_RESTRICT,    \
+                                       std::size_t, std::size_t);                                                 \
+    template void downmixToMono<T>(const T* KJ_RESTRICT, const T* KJ_RESTRICT, float* KJ_RESTRICT, std::size_t);  \
+    template void processBiquad<T, float>(const BiquadCoefficients&, BiquadState<float>&, T*, std::size_t);      \
+    template void processBiquad<T, double>(const BiquadCoefficients&, BiquadState<double>&, T*, std::size_t);
+
+    KJ_INSTANTIATE_DSP_KERNELS(float)
+    KJ_INSTANTIATE_DSP_KERNELS(double)
+
+#undef KJ_INSTANTIATE_DSP_KERNELS
+} // namespace dsp
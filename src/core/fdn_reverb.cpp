@@ -0,0 +1,266 @@
+#include "core/effects/fdn_reverb.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr double kDefaultSampleRate = 44100.0;
+constexpr double kPi = 3.14159265358979323846;
+
+using LineValues = std::array<float, FdnReverb::kLineCount>;
+
+// Line lengths of the largest room. No two share a factor that would line
+// their echoes up; smaller rooms scale all of them down together.
+constexpr std::array<double, FdnReverb::kLineCount> kBaseDelayMs = {43.1, 49.7, 55.3, 61.9, 67.3, 73.7, 79.1, 87.7};
+constexpr double kMinRoomScale = 0.15;
+
+// Slow, slightly detuned wobble of every read position; enough to break up
+// the metallic ringing of a static network without audible pitch change.
+constexpr double kModulationDepthMs = 0.3;
+constexpr std::array<double, FdnReverb::kLineCount> kModulationRatesHz = {0.31, 0.37, 0.43, 0.53,
+                                                                          0.59, 0.67, 0.73, 0.83};
+
+constexpr double kSmoothingSeconds = 0.05;
+// Damping at its maximum still lets the low end through the feedback path.
+constexpr float kMaxDampingCoeff = 0.85f;
+constexpr double kTailThresholdDecays = 2.0;
+
+// Left feeds the even lines and right the odd ones, with alternating signs
+// so the two sides do not start out correlated; each output taps all lines.
+constexpr LineValues kInputLeft = {0.5f, 0.0f, -0.5f, 0.0f, 0.5f, 0.0f, -0.5f, 0.0f};
+constexpr LineValues kInputRight = {0.0f, 0.5f, 0.0f, -0.5f, 0.0f, 0.5f, 0.0f, -0.5f};
+constexpr LineValues kOutputLeft = {0.35f, 0.35f, 0.35f, 0.35f, -0.35f, -0.35f, -0.35f, -0.35f};
+constexpr LineValues kOutputRight = {0.35f, -0.35f, 0.35f, -0.35f, 0.35f, -0.35f, 0.35f, -0.35f};
+
+// 1 / sqrt(kLineCount).
+constexpr float kHadamardScale = 0.353553390593273762f;
+
+// In-place Hadamard transform scaled to be orthonormal, so the mix neither
+// adds nor removes energy. Three butterfly passes of fixed width.
+inline void hadamardMix(LineValues& values)
+{
+    for (std::size_t span = 1; span < FdnReverb::kLineCount; span *= 2)
+    {
+        for (std::size_t start = 0; start < FdnReverb::kLineCount; start += span * 2)
+        {
+            for (std::size_t i = start; i < start + span; ++i)
+            {
+                float a = values[i];
+                float b = values[i + span];
+                values[i] = a + b;
+                values[i + span] = a - b;
+            }
+        }
+    }
+    for (float& value : values)
+        value *= kHadamardScale;
+}
+}
+
+FdnReverb::FdnReverb(double sampleRate)
+{
+    prepare(sampleRate);
+}
+
+void FdnReverb::prepare(double sampleRate)
+{
+    double sr = sampleRate > 0.0 ? sampleRate : kDefaultSampleRate;
+    if (!m_ring.empty() && std::abs(m_sampleRate - sr) < 1e-6)
+        return;
+
+    m_sampleRate = sr;
+    m_modulationDepth = static_cast<float>(kModulationDepthMs * 0.001 * sr);
+
+    double longestMs = *std::max_element(kBaseDelayMs.begin(), kBaseDelayMs.end());
+    auto longest = static_cast<std::size_t>(std::ceil(longestMs * 0.001 * sr + m_modulationDepth)) + 2;
+    std::size_t ringFrames = 1;
+    while (ringFrames < longest)
+        ringFrames *= 2;
+    m_ring.resize(ringFrames * kLineCount);
+    m_ringMask = ringFrames - 1;
+
+    for (std::size_t line = 0; line < kLineCount; ++line)
+    {
+        double angle = 2.0 * kPi * kModulationRatesHz[line] / sr;
+        m_lfoRotateCos[line] = static_cast<float>(std::cos(angle));
+        m_lfoRotateSin[line] = static_cast<float>(std::sin(angle));
+    }
+    reset();
+}
+
+void FdnReverb::setSize(float value)
+{
+    m_size = std::clamp(value, kMinSize, kMaxSize);
+}
+
+void FdnReverb::setDecay(float seconds)
+{
+    m_decaySeconds = std::clamp(seconds, kMinDecaySeconds, kMaxDecaySeconds);
+}
+
+void FdnReverb::setDamping(float value)
+{
+    m_damping = std::clamp(value, kMinDamping, kMaxDamping);
+}
+
+void FdnReverb::setMix(float value)
+{
+    m_mix = std::clamp(value, kMinMix, kMaxMix);
+}
+
+// Clears the network and jumps straight to the targets; there is nothing
+// left to glide over.
+void FdnReverb::reset()
+{
+    m_ring.clear();
+    m_writeFrame = 0;
+    m_lowpass.fill(0.0f);
+    for (std::size_t line = 0; line < kLineCount; ++line)
+    {
+        double phase = 2.0 * kPi * static_cast<double>(line) / static_cast<double>(kLineCount);
+        m_lfoCos[line] = static_cast<float>(std::cos(phase));
+        m_lfoSin[line] = static_cast<float>(std::sin(phase));
+    }
+
+    m_smoothedSize = m_size;
+    m_smoothedDecay = m_decaySeconds;
+    m_smoothedDamping = m_damping;
+    m_smoothedMix = m_mix;
+    computeTargets(m_smoothedSize, m_smoothedDecay, m_delay, m_gain);
+    m_delayStep.fill(0.0f);
+    m_gainStep.fill(0.0f);
+    m_dampingCoeff = m_smoothedDamping * kMaxDampingCoeff;
+    m_dampingStep = 0.0f;
+    m_wet = m_smoothedMix;
+    m_wetStep = 0.0f;
+    m_rampFrames = 0;
+}
+
+void FdnReverb::computeTargets(float size, float decaySeconds, LineValues& delays, LineValues& gains) const
+{
+    double scale = kMinRoomScale + (1.0 - kMinRoomScale) * static_cast<double>(size);
+    double decayFrames = std::max(static_cast<double>(decaySeconds), 1e-3) * m_sampleRate;
+    for (std::size_t line = 0; line < kLineCount; ++line)
+    {
+        double frames = kBaseDelayMs[line] * scale * 0.001 * m_sampleRate;
+        delays[line] = static_cast<float>(frames);
+        // -60 dB over the decay time, spread over the trips through this line.
+        gains[line] = static_cast<float>(std::pow(10.0, -3.0 * frames / decayFrames));
+    }
+}
+
+void FdnReverb::beginBlock(std::size_t frameCount)
+{
+    if (frameCount == 0)
+        return;
+
+    float coeff = static_cast<float>(1.0 - std::exp(-static_cast<double>(frameCount) / (kSmoothingSeconds * m_sampleRate)));
+    auto smooth = [coeff](float& current, float target) {
+        current += (target - current) * coeff;
+        if (std::abs(target - current) < 1e-5f)
+            current = target;
+    };
+    smooth(m_smoothedSize, m_size);
+    smooth(m_smoothedDecay, m_decaySeconds);
+    smooth(m_smoothedDamping, m_damping);
+    smooth(m_smoothedMix, m_mix);
+
+    alignas(32) LineValues delays{};
+    alignas(32) LineValues gains{};
+    computeTargets(m_smoothedSize, m_smoothedDecay, delays, gains);
+
+    const float inverse = 1.0f / static_cast<float>(frameCount);
+    for (std::size_t line = 0; line < kLineCount; ++line)
+    {
+        m_delayStep[line] = (delays[line] - m_delay[line]) * inverse;
+        m_gainStep[line] = (gains[line] - m_gain[line]) * inverse;
+    }
+    m_dampingStep = (m_smoothedDamping * kMaxDampingCoeff - m_dampingCoeff) * inverse;
+    m_wetStep = (m_smoothedMix - m_wet) * inverse;
+    m_rampFrames = frameCount;
+
+    // The rotation drifts off the unit circle in float; pull it back once a
+    // block with a first-order correction.
+    for (std::size_t line = 0; line < kLineCount; ++line)
+    {
+        float correction = 1.5f - 0.5f * (m_lfoCos[line] * m_lfoCos[line] + m_lfoSin[line] * m_lfoSin[line]);
+        m_lfoCos[line] *= correction;
+        m_lfoSin[line] *= correction;
+    }
+}
+
+void FdnReverb::processFrame(float& left, float& right)
+{
+    if (m_rampFrames > 0)
+    {
+        for (std::size_t line = 0; line < kLineCount; ++line)
+        {
+            m_delay[line] += m_delayStep[line];
+            m_gain[line] += m_gainStep[line];
+        }
+        m_dampingCoeff += m_dampingStep;
+        m_wet += m_wetStep;
+        --m_rampFrames;
+    }
+
+    alignas(32) LineValues position{};
+    for (std::size_t line = 0; line < kLineCount; ++line)
+    {
+        float cosValue = m_lfoCos[line] * m_lfoRotateCos[line] - m_lfoSin[line] * m_lfoRotateSin[line];
+        m_lfoSin[line] = m_lfoSin[line] * m_lfoRotateCos[line] + m_lfoCos[line] * m_lfoRotateSin[line];
+        m_lfoCos[line] = cosValue;
+        position[line] = m_delay[line] + m_modulationDepth * m_lfoSin[line];
+    }
+
+    // The reads are the one gather in the frame; linear interpolation
+    // between the two frames around each position.
+    const float* ring = m_ring.data();
+    alignas(32) LineValues delayed{};
+    for (std::size_t line = 0; line < kLineCount; ++line)
+    {
+        auto whole = static_cast<std::size_t>(position[line]);
+        float fraction = position[line] - static_cast<float>(whole);
+        std::size_t newer = ((m_writeFrame - whole) & m_ringMask) * kLineCount + line;
+        std::size_t older = ((m_writeFrame - whole - 1) & m_ringMask) * kLineCount + line;
+        delayed[line] = ring[newer] + fraction * (ring[older] - ring[newer]);
+    }
+
+    float wetLeft = 0.0f;
+    float wetRight = 0.0f;
+    alignas(32) LineValues feedback{};
+    for (std::size_t line = 0; line < kLineCount; ++line)
+    {
+        wetLeft += delayed[line] * kOutputLeft[line];
+        wetRight += delayed[line] * kOutputRight[line];
+        m_lowpass[line] = delayed[line] + m_dampingCoeff * (m_lowpass[line] - delayed[line]);
+        feedback[line] = m_lowpass[line] * m_gain[line];
+    }
+    hadamardMix(feedback);
+
+    float* write = m_ring.data() + (m_writeFrame & m_ringMask) * kLineCount;
+    for (std::size_t line = 0; line < kLineCount; ++line)
+        write[line] = feedback[line] + left * kInputLeft[line] + right * kInputRight[line];
+    ++m_writeFrame;
+
+    const float dry = 1.0f - m_wet;
+    left = left * dry + wetLeft * m_wet;
+    right = right * dry + wetRight * m_wet;
+}
+
+void FdnReverb::process(float* left, float* right, std::size_t frameCount)
+{
+    if (!left || !right || frameCount == 0)
+        return;
+
+    beginBlock(frameCount);
+    for (std::size_t i = 0; i < frameCount; ++i)
+        processFrame(left[i], right[i]);
+}
+
+std::size_t FdnReverb::tailSamples() const noexcept
+{
+    double decaySeconds = std::max(m_decaySeconds, m_smoothedDecay);
+    double longestMs = *std::max_element(kBaseDelayMs.begin(), kBaseDelayMs.end());
+    return static_cast<std::size_t>(std::ceil((kTailThresholdDecays * decaySeconds + longestMs * 0.001) * m_sampleRate));
+}
@@ -0,0 +1,42 @@
+#include "core/track_freeze.h"
+
+#include "core/transport.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool FrozenTrackKey::operator==(const FrozenTrackKey& other) const noexcept
+{
+    return host == other.host && hostEditGeneration == other.hostEditGeneration &&
+           patternVersion == other.patternVersion && stepCount == other.stepCount &&
+           midiChannel == other.midiChannel && bpm == other.bpm &&
+           swing == other.swing && std::abs(sampleRate - other.sampleRate) < 1e-6;
+}
+
+std::vector<double> computeFrozenStepStarts(const FrozenTrackKey& key)
+{
+    const double straight = key.sampleRate * 60.0 / (key.bpm * static_cast<double>(TransportClock::kStepsPerBeat));
+    std::vector<double> starts(static_cast<std::size_t>(std::max(key.stepCount, 0)) + 1, 0.0);
+    for (int step = 0; step < key.stepCount; ++step)
+    {
+        double factor = (step % 2 == 0) ? (1.0 + key.swing) : (1.0 - key.swing);
+        starts[static_cast<std::size_t>(step) + 1] = starts[static_cast<std::size_t>(step)] + std::max(1.0, straight * factor);
+    }
+    return starts;
+}
+
+void addToFrozenStem(std::vector<float>& stem, std::int64_t loopFrames, std::int64_t latency, std::int64_t frame,
+                     const float* left, const float* right, int frameCount)
+{
+    if (loopFrames <= 0 || stem.size() < static_cast<std::size_t>(loopFrames) * 2)
+        return;
+    for (int i = 0; i < frameCount; ++i)
+    {
+        std::int64_t stemFrame = frame + i - latency;
+        if (stemFrame < 0)
+            continue;
+        auto index = static_cast<std::size_t>(stemFrame % loopFrames) * 2;
+        stem[index] += left[i];
+        stem[index + 1] += right[i];
+    }
+}
@@ -0,0 +1,82 @@
+#include "core/effects/insert_chain.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr std::uint32_t kSlotBits = 2;
+constexpr std::uint32_t kSlotMask = (1u << kSlotBits) - 1u;
+
+constexpr std::array<const char*, kInsertEffectCount> kInsertEffectKeys = {"equalizer", "compressor", "delay", "reverb"};
+}
+
+bool isValidInsertOrder(const InsertOrder& order)
+{
+    std::array<bool, kInsertEffectCount> seen{};
+    for (InsertEffect effect : order)
+    {
+        auto index = static_cast<std::size_t>(effect);
+        if (index >= seen.size() || seen[index])
+            return false;
+        seen[index] = true;
+    }
+    return true;
+}
+
+bool moveInsert(InsertOrder& order, int from, int to)
+{
+    if (from < 0 || from >= kInsertEffectCount || to < 0 || to >= kInsertEffectCount)
+        return false;
+    if (from < to)
+        std::rotate(order.begin() + from, order.begin() + from + 1, order.begin() + to + 1);
+    else if (to < from)
+        std::rotate(order.begin() + to, order.begin() + from, order.begin() + from + 1);
+    return true;
+}
+
+std::uint32_t packInsertOrder(const InsertOrder& order)
+{
+    std::uint32_t packed = 0;
+    for (std::size_t slot = 0; slot < order.size(); ++slot)
+        packed |= (static_cast<std::uint32_t>(order[slot]) & kSlotMask) << (slot * kSlotBits);
+    return packed;
+}
+
+InsertOrder unpackInsertOrder(std::uint32_t packed)
+{
+    InsertOrder order{};
+    for (std::size_t slot = 0; slot < order.size(); ++slot)
+        order[slot] = static_cast<InsertEffect>((packed >> (slot * kSlotBits)) & kSlotMask);
+    return isValidInsertOrder(order) ? order : kDefaultInsertOrder;
+}
+
+const char* insertEffectKey(InsertEffect effect)
+{
+    auto index = static_cast<std::size_t>(effect);
+    return index < kInsertEffectKeys.size() ? kInsertEffectKeys[index] : "";
+}
+
+bool insertEffectFromKey(const std::string& key, InsertEffect& effect)
+{
+    for (std::size_t index = 0; index < kInsertEffectKeys.size(); ++index)
+    {
+        if (key == kInsertEffectKeys[index])
+        {
+            effect = static_cast<InsertEffect>(index);
+            return true;
+        }
+    }
+    return false;
+}
+
+InsertPlan compileInsertPlan(const InsertOrder& order, const std::array<bool, kInsertEffectCount>& enabled)
+{
+    InsertPlan plan;
+    for (InsertEffect effect : order)
+    {
+        auto index = static_cast<std::size_t>(effect);
+        if (index < enabled.size() && enabled[index])
+            plan.effects[plan.count++] = effect;
+    }
+    return plan;
+}
@@ -0,0 +1,64 @@
+#include "core/effects/latency_compensation.h"
+
+#include <algorithm>
+
+void LatencyCompensationDelay::prepare(int maxDelaySamples)
+{
+    m_maxDelaySamples = std::max(maxDelaySamples, 0);
+
+    std::size_t size = 1;
+    while (size < static_cast<std::size_t>(m_maxDelaySamples) + 1)
+        size <<= 1;
+
+    m_bufferLeft.assign(size, 0.0);
+    m_bufferRight.assign(size, 0.0);
+    m_mask = size - 1;
+    m_writeIndex = 0;
+    m_delaySamples = std::min(m_delaySamples, m_maxDelaySamples);
+}
+
+void LatencyCompensationDelay::reset()
+{
+    std::fill(m_bufferLeft.begin(), m_bufferLeft.end(), 0.0);
+    std::fill(m_bufferRight.begin(), m_bufferRight.end(), 0.0);
+    m_writeIndex = 0;
+}
+
+void LatencyCompensationDelay::setDelay(int samples) noexcept
+{
+    m_delaySamples = std::clamp(samples, 0, m_maxDelaySamples);
+}
+
+void LatencyCompensationDelay::process(double& left, double& right) noexcept
+{
+    if (m_bufferLeft.empty())
+        return;
+
+    m_bufferLeft[m_writeIndex] = left;
+    m_bufferRight[m_writeIndex] = right;
+
+    if (m_delaySamples > 0)
+    {
+        const std::size_t readIndex = (m_writeIndex - static_cast<std::size_t>(m_delaySamples)) & m_mask;
+        left = m_bufferLeft[readIndex];
+        right = m_bufferRight[readIndex];
+    }
+
+    m_writeIndex = (m_writeIndex + 1) & m_mask;
+}
+
+std::shared_ptr<LatencyCompensationDelay> LatencyCompensationPool::acquire(int trackId, int maxDelaySamples)
+{
+    maxDelaySamples = std::clamp(maxDelaySamples, 0, LatencyCompensationDelay::kMaxDelaySamples);
+    auto* delay = find(trackId, maxDelaySamples > 0);
+    if (!delay)
+        return nullptr;
+
+    if (!*delay || (*delay)->maxDelay() < maxDelaySamples)
+    {
+        auto grown = std::make_shared<LatencyCompensationDelay>();
+        grown->prepare(maxDelaySamples);
+        replace(*delay, std::move(grown));
+    }
+    return *delay;
+}
@@ -1,94 +1,462 @@
 #include "core/midi_output.h"
-
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN
-#endif
-#ifndef NOMINMAX
-#define NOMINMAX
-#endif
-#include <windows.h>
-#include <mmsystem.h>
+#include "core/midi_output_backend.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <limits>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace
 {
-    std::mutex gMidiMutex;
-    std::unordered_map<int, HMIDIOUT> gMidiOutPorts;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t kMidiEventQueueCapacity = 4096;
+    constexpr std::int64_t kImmediateFrame = std::numeric_limits<std::int64_t>::min();
+    // The scheduler sleeps in short slices so freshly queued events are seen
+    // quickly, then spins for the last stretch before a due time.
+    constexpr auto kSchedulerSleepSlice = std::chrono::milliseconds(1);
+    constexpr auto kSchedulerSpinWindow = std::chrono::microseconds(1500);
 
-    HMIDIOUT ensurePortLocked(int portId)
+    struct ScheduledMidiEvent
     {
-        if (portId < 0)
-            return nullptr;
+        std::int64_t renderFrame = kImmediateFrame;
+        int portId = -1;
+        std::uint32_t message = 0;
+    };
 
-        auto it = gMidiOutPorts.find(portId);
-        if (it != gMidiOutPorts.end())
-            return it->second;
+    // Single producer (render thread), single consumer (scheduler thread).
+    std::array<ScheduledMidiEvent, kMidiEventQueueCapacity> gMidiEventQueue{};
+    std::atomic<std::size_t> gMidiEventHead{0};
+    std::atomic<std::size_t> gMidiEventTail{0};
+    std::atomic<bool> gMidiEventOverflow{false};
 
-        HMIDIOUT handle = nullptr;
-        MMRESULT result = midiOutOpen(&handle, static_cast<UINT>(portId), 0, 0, CALLBACK_NULL);
-        if (result != MMSYSERR_NOERROR || !handle)
-            return nullptr;
+    struct RenderClock
+    {
+        std::int64_t blockStartFrame = 0;
+        std::int64_t queuedFrames = 0;
+        double sampleRate = 0.0;
+        Clock::rep publishTicks = 0;
+    };
 
-        gMidiOutPorts.emplace(portId, handle);
-        return handle;
-    }
+    // Seqlock: the render thread is the only writer.
+    std::atomic<std::uint32_t> gRenderClockSequence{0};
+    std::atomic<std::int64_t> gRenderClockBlockStart{0};
+    std::atomic<std::int64_t> gRenderClockQueued{0};
+    std::atomic<double> gRenderClockSampleRate{0.0};
+    std::atomic<Clock::rep> gRenderClockTicks{0};
 
-    void sendShortMessage(int portId, DWORD message)
+    bool loadRenderClock(RenderClock& clock)
     {
-        if (portId < 0)
-            return;
+        for (int attempt = 0; attempt < 8; ++attempt)
+        {
+            std::uint32_t begin = gRenderClockSequence.load(std::memory_order_acquire);
+            if (begin & 1u)
+                continue;
 
-        std::lock_guard<std::mutex> lock(gMidiMutex);
-        HMIDIOUT handle = ensurePortLocked(portId);
-        if (!handle)
-            return;
+            clock.blockStartFrame = gRenderClockBlockStart.load(std::memory_order_relaxed);
+            clock.queuedFrames = gRenderClockQueued.load(std::memory_order_relaxed);
+            clock.sampleRate = gRenderClockSampleRate.load(std::memory_order_relaxed);
+            clock.publishTicks = gRenderClockTicks.load(std::memory_order_relaxed);
 
-        midiOutShortMsg(handle, message);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (gRenderClockSequence.load(std::memory_order_relaxed) == begin)
+                return clock.sampleRate > 0.0;
+        }
+        return false;
     }
 
-    DWORD makeShortMessage(int status, int data1, int data2)
+    // Non-real-time state, guarded by gControlMutex.
+    std::mutex gControlMutex;
+    std::condition_variable gControlCv;
+    std::vector<ScheduledMidiEvent> gImmediateEvents;
+    std::vector<int> gPortsToPrepare;
+    std::unique_ptr<MidiOutputBackend> gBackend;
+    std::thread gSchedulerThread;
+    bool gSchedulerRunning = false;
+    bool gStopRequested = false;
+
+    std::uint32_t makeShortMessage(int status, int data1, int data2)
     {
         status = std::clamp(status, 0, 0xFF);
         data1 = std::clamp(data1, 0, 0x7F);
         data2 = std::clamp(data2, 0, 0x7F);
-        return static_cast<DWORD>(status | (data1 << 8) | (data2 << 16));
+        return static_cast<std::uint32_t>(status | (data1 << 8) | (data2 << 16));
+    }
+
+    std::uint32_t makeNoteMessage(bool noteOn, int channel, int note, int velocity)
+    {
+        channel = std::clamp(channel, 0, 15);
+        note = std::clamp(note, 0, 127);
+        velocity = std::clamp(velocity, 0, 127);
+        int status = (noteOn ? 0x90 : 0x80) | channel;
+        return makeShortMessage(status, note, velocity);
+    }
+
+    bool pushRenderEvent(const ScheduledMidiEvent& event)
+    {
+        const std::size_t tail = gMidiEventTail.load(std::memory_order_relaxed);
+        const std::size_t nextTail = (tail + 1) % kMidiEventQueueCapacity;
+        const std::size_t head = gMidiEventHead.load(std::memory_order_acquire);
+
+        // The render thread must never block; flag the overflow so the
+        // scheduler silences anything that might now miss its note-off.
+        if (nextTail == head)
+        {
+            gMidiEventOverflow.store(true, std::memory_order_release);
+            return false;
+        }
+
+        gMidiEventQueue[tail] = event;
+        gMidiEventTail.store(nextTail, std::memory_order_release);
+        return true;
+    }
+
+    class MidiScheduler
+    {
+    public:
+        explicit MidiScheduler(MidiOutputBackend& backend) : m_backend(backend)
+        {
+            m_pending.reserve(kMidiEventQueueCapacity);
+            m_immediate.reserve(64);
+        }
+
+        void run()
+        {
+            while (true)
+            {
+                if (!pollControl())
+                    break;
+
+                drainRenderQueue();
+                if (gMidiEventOverflow.exchange(false, std::memory_order_acq_rel))
+                    silenceActiveNotes();
+
+                Clock::time_point nextDue = dispatchDueEvents();
+                waitUntil(nextDue);
+            }
+
+            drainRenderQueue();
+            dispatchAll();
+            silenceActiveNotes();
+            m_backend.closeAllPorts();
+        }
+
+    private:
+        struct PortNotes
+        {
+            std::array<std::bitset<128>, 16> active{};
+        };
+
+        // Returns false once shutdown was requested.
+        bool pollControl()
+        {
+            std::vector<int> ports;
+            bool stop = false;
+            {
+                std::lock_guard<std::mutex> lock(gControlMutex);
+                ports.swap(gPortsToPrepare);
+                m_immediate.insert(m_immediate.end(), gImmediateEvents.begin(), gImmediateEvents.end());
+                gImmediateEvents.clear();
+                stop = gStopRequested;
+            }
+
+            for (int portId : ports)
+                ensurePort(portId);
+
+            for (const auto& event : m_immediate)
+                dispatch(event);
+            m_immediate.clear();
+
+            return !stop;
+        }
+
+        void drainRenderQueue()
+        {
+            std::size_t head = gMidiEventHead.load(std::memory_order_relaxed);
+            const std::size_t tail = gMidiEventTail.load(std::memory_order_acquire);
+            bool appended = false;
+            while (head != tail)
+            {
+                m_pending.push_back(gMidiEventQueue[head]);
+                head = (head + 1) % kMidiEventQueueCapacity;
+                appended = true;
+            }
+            gMidiEventHead.store(head, std::memory_order_release);
+
+            if (appended)
+            {
+                // Blocks arrive in order, but keep ties stable so a note-off
+                // queued before a note-on at the same frame goes out first.
+                std::stable_sort(m_pending.begin(), m_pending.end(),
+                                 [](const ScheduledMidiEvent& a, const ScheduledMidiEvent& b) {
+                                     return a.renderFrame < b.renderFrame;
+                                 });
+            }
+        }
+
+        Clock::time_point dueTime(const ScheduledMidiEvent& event, const RenderClock& clock, bool hasClock) const
+        {
+            if (!hasClock || event.renderFrame == kImmediateFrame)
+                return Clock::time_point{};
+
+            double framesAhead = static_cast<double>(event.renderFrame - clock.blockStartFrame + clock.queuedFrames);
+            auto offset = std::chrono::duration<double>(framesAhead / clock.sampleRate);
+            return Clock::time_point(Clock::duration(clock.publishTicks)) +
+                   std::chrono::duration_cast<Clock::duration>(offset);
+        }
+
+        // Dispatches everything that is due and returns the due time of the
+        // next pending event (or time_point::max when idle).
+        Clock::time_point dispatchDueEvents()
+        {
+            RenderClock clock{};
+            bool hasClock = loadRenderClock(clock);
+
+            std::size_t dispatched = 0;
+            Clock::time_point nextDue = Clock::time_point::max();
+            for (const auto& event : m_pending)
+            {
+                Clock::time_point due = dueTime(event, clock, hasClock);
+                auto now = Clock::now();
+                if (due > now + kSchedulerSpinWindow)
+                {
+                    nextDue = due;
+                    break;
+                }
+
+                while (due > now)
+                {
+                    std::this_thread::yield();
+                    now = Clock::now();
+                }
+
+                dispatch(event);
+                ++dispatched;
+            }
+
+            if (dispatched > 0)
+                m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<std::ptrdiff_t>(dispatched));
+            return nextDue;
+        }
+
+        void dispatchAll()
+        {
+            for (const auto& event : m_pending)
+                dispatch(event);
+            m_pending.clear();
+        }
+
+        void waitUntil(Clock::time_point nextDue)
+        {
+            auto wake = Clock::now() + kSchedulerSleepSlice;
+            if (nextDue != Clock::time_point::max())
+                wake = std::min(wake, nextDue - kSchedulerSpinWindow);
+
+            std::unique_lock<std::mutex> lock(gControlMutex);
+            gControlCv.wait_until(lock, wake, []() {
+                return gStopRequested || !gImmediateEvents.empty() || !gPortsToPrepare.empty();
+            });
+        }
+
+        bool ensurePort(int portId)
+        {
+            if (portId < 0)
+                return false;
+
+            auto it = m_openPorts.find(portId);
+            if (it != m_openPorts.end())
+                return it->second;
+
+            bool opened = m_backend.openPort(portId);
+            m_openPorts.emplace(portId, opened);
+            return opened;
+        }
+
+        void dispatch(const ScheduledMidiEvent& event)
+        {
+            if (!ensurePort(event.portId))
+                return;
+
+            m_backend.sendShortMessage(event.portId, event.message);
+            trackNoteState(event);
+        }
+
+        void trackNoteState(const ScheduledMidiEvent& event)
+        {
+            int status = static_cast<int>(event.message & 0xF0u);
+            int channel = static_cast<int>(event.message & 0x0Fu);
+            int note = static_cast<int>((event.message >> 8) & 0x7Fu);
+            int velocity = static_cast<int>((event.message >> 16) & 0x7Fu);
+
+            if (status != 0x90 && status != 0x80)
+                return;
+
+            auto& notes = m_activeNotes[event.portId].active[static_cast<std::size_t>(channel)];
+            notes.set(static_cast<std::size_t>(note), status == 0x90 && velocity > 0);
+        }
+
+        void silenceActiveNotes()
+        {
+            for (auto& entry : m_activeNotes)
+            {
+                for (int channel = 0; channel < 16; ++channel)
+                {
+                    auto& notes = entry.second.active[static_cast<std::size_t>(channel)];
+                    for (int note = 0; note < 128; ++note)
+                    {
+                        if (notes.test(static_cast<std::size_t>(note)))
+                            m_backend.sendShortMessage(entry.first, makeNoteMessage(false, channel, note, 0));
+                    }
+                    notes.reset();
+                }
+            }
+        }
+
+        MidiOutputBackend& m_backend;
+        std::vector<ScheduledMidiEvent> m_pending;
+        std::vector<ScheduledMidiEvent> m_immediate;
+        std::unordered_map<int, bool> m_openPorts;
+        std::unordered_map<int, PortNotes> m_activeNotes;
+    };
+
+    void startSchedulerLocked()
+    {
+        if (gSchedulerRunning)
+            return;
+
+        if (!gBackend)
+            gBackend = createDefaultMidiOutputBackend();
+
+        gStopRequested = false;
+        gSchedulerRunning = true;
+        MidiOutputBackend* backend = gBackend.get();
+        gSchedulerThread = std::thread([backend]() {
+            MidiScheduler scheduler(*backend);
+            scheduler.run();
+        });
+    }
+
+    void stopScheduler()
+    {
+        std::thread worker;
+        {
+            std::lock_guard<std::mutex> lock(gControlMutex);
+            if (!gSchedulerRunning)
+                return;
+            gStopRequested = true;
+            worker = std::move(gSchedulerThread);
+        }
+        gControlCv.notify_all();
+        if (worker.joinable())
+            worker.join();
+
+        std::lock_guard<std::mutex> lock(gControlMutex);
+        gSchedulerRunning = false;
+        gStopRequested = false;
+    }
+
+    void sendImmediate(int portId, std::uint32_t message)
+    {
+        if (portId < 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(gControlMutex);
+            ScheduledMidiEvent event{};
+            event.portId = portId;
+            event.message = message;
+            gImmediateEvents.push_back(event);
+            startSchedulerLocked();
+        }
+        gControlCv.notify_all();
     }
 }
 
 void midiOutputSendNoteOn(int portId, int channel, int note, int velocity)
 {
-    channel = std::clamp(channel, 0, 15);
-    note = std::clamp(note, 0, 127);
-    velocity = std::clamp(velocity, 0, 127);
-    int status = 0x90 | channel;
-    sendShortMessage(portId, makeShortMessage(status, note, velocity));
+    sendImmediate(portId, makeNoteMessage(true, channel, note, velocity));
 }
 
 void midiOutputSendNoteOff(int portId, int channel, int note, int velocity)
 {
-    channel = std::clamp(channel, 0, 15);
-    note = std::clamp(note, 0, 127);
-    velocity = std::clamp(velocity, 0, 127);
-    int status = 0x80 | channel;
-    sendShortMessage(portId, makeShortMessage(status, note, velocity));
+    sendImmediate(portId, makeNoteMessage(false, channel, note, velocity));
 }
 
-void shutdownMidiOutput()
+bool midiOutputScheduleNoteOn(int portId, int channel, int note, int velocity, std::int64_t renderFrame)
+{
+    if (portId < 0)
+        return false;
+
+    ScheduledMidiEvent event{};
+    event.renderFrame = renderFrame;
+    event.portId = portId;
+    event.message = makeNoteMessage(true, channel, note, velocity);
+    return pushRenderEvent(event);
+}
+
+bool midiOutputScheduleNoteOff(int portId, int channel, int note, int velocity, std::int64_t renderFrame)
+{
+    if (portId < 0)
+        return false;
+
+    ScheduledMidiEvent event{};
+    event.renderFrame = renderFrame;
+    event.portId = portId;
+    event.message = makeNoteMessage(false, channel, note, velocity);
+    return pushRenderEvent(event);
+}
+
+void midiOutputPublishRenderClock(std::int64_t blockStartFrame, double sampleRate, std::int64_t queuedFrames)
 {
-    std::lock_guard<std::mutex> lock(gMidiMutex);
-    for (auto& entry : gMidiOutPorts)
+    std::uint32_t sequence = gRenderClockSequence.load(std::memory_order_relaxed);
+    gRenderClockSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    gRenderClockBlockStart.store(blockStartFrame, std::memory_order_relaxed);
+    gRenderClockQueued.store(std::max<std::int64_t>(queuedFrames, 0), std::memory_order_relaxed);
+    gRenderClockSampleRate.store(sampleRate, std::memory_order_relaxed);
+    gRenderClockTicks.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+
+    gRenderClockSequence.store(sequence + 2, std::memory_order_release);
+}
+
+void midiOutputPreparePort(int portId)
+{
+    if (portId < 0)
+        return;
+
     {
-        HMIDIOUT handle = entry.second;
-        if (handle)
-        {
-            midiOutReset(handle);
-            midiOutClose(handle);
-        }
+        std::lock_guard<std::mutex> lock(gControlMutex);
+        gPortsToPrepare.push_back(portId);
+        startSchedulerLocked();
     }
+    gControlCv.notify_all();
+}
+
+void setMidiOutputBackend(std::unique_ptr<MidiOutputBackend> backend)
+{
+    stopScheduler();
 
-    gMidiOutPorts.clear();
+    std::lock_guard<std::mutex> lock(gControlMutex);
+    gBackend = std::move(backend);
+}
+
+void startMidiOutput()
+{
+    std::lock_guard<std::mutex> lock(gControlMutex);
+    startSchedulerLocked();
+}
+
+void shutdownMidiOutput()
+{
+    stopScheduler();
 }
@@ -0,0 +1,137 @@
+#include "core/midi_output_backend.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+#if defined(_WIN32)
+    class WinMmMidiOutputBackend : public MidiOutputBackend
+    {
+    public:
+        WinMmMidiOutputBackend()
+        {
+            // 1 ms scheduler granularity keeps sleep_until close to the target.
+            timeBeginPeriod(1);
+        }
+
+        ~WinMmMidiOutputBackend() override
+        {
+            closeAllPorts();
+            timeEndPeriod(1);
+        }
+
+        bool openPort(int portId) override
+        {
+            if (portId < 0)
+                return false;
+
+            if (m_ports.find(portId) != m_ports.end())
+                return true;
+
+            HMIDIOUT handle = nullptr;
+            MMRESULT result = midiOutOpen(&handle, static_cast<UINT>(portId), 0, 0, CALLBACK_NULL);
+            if (result != MMSYSERR_NOERROR || !handle)
+                return false;
+
+            m_ports.emplace(portId, handle);
+            return true;
+        }
+
+        void sendShortMessage(int portId, std::uint32_t message) override
+        {
+            auto it = m_ports.find(portId);
+            if (it == m_ports.end() || !it->second)
+                return;
+
+            midiOutShortMsg(it->second, static_cast<DWORD>(message));
+        }
+
+        void closeAllPorts() override
+        {
+            for (auto& entry : m_ports)
+            {
+                HMIDIOUT handle = entry.second;
+                if (handle)
+                {
+                    midiOutReset(handle);
+                    midiOutClose(handle);
+                }
+            }
+
+            m_ports.clear();
+        }
+
+    private:
+        std::unordered_map<int, HMIDIOUT> m_ports;
+    };
+#else
+    class NullMidiOutputBackend : public MidiOutputBackend
+    {
+    public:
+        bool openPort(int portId) override { return portId >= 0; }
+        void sendShortMessage(int, std::uint32_t) override {}
+        void closeAllPorts() override {}
+    };
+#endif
+}
+
+std::unique_ptr<MidiOutputBackend> createDefaultMidiOutputBackend()
+{
+#if defined(_WIN32)
+    return std::make_unique<WinMmMidiOutputBackend>();
+#else
+    return std::make_unique<NullMidiOutputBackend>();
+#endif
+}
+
+bool LoopbackMidiOutputBackend::openPort(int portId)
+{
+    if (portId < 0)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (std::find(m_openPorts.begin(), m_openPorts.end(), portId) == m_openPorts.end())
+        m_openPorts.push_back(portId);
+    return true;
+}
+
+void LoopbackMidiOutputBackend::sendShortMessage(int portId, std::uint32_t message)
+{
+    Message entry{};
+    entry.portId = portId;
+    entry.message = message;
+    entry.dispatchTime = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_messages.push_back(entry);
+}
+
+void LoopbackMidiOutputBackend::closeAllPorts()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_openPorts.clear();
+}
+
+std::vector<LoopbackMidiOutputBackend::Message> LoopbackMidiOutputBackend::messages() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_messages;
+}
+
+std::vector<int> LoopbackMidiOutputBackend::openPorts() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_openPorts;
+}
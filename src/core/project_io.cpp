@@ -1,5 +1,7 @@
 #include "core/project_io.h"
 
+#include "core/audio_engine.h"
+#include "core/aux_buses.h"
 #include "core/mod_matrix.h"
 #include "core/mod_matrix_parameters.h"
 #include "core/sequencer.h"
@@ -7,14 +9,20 @@
 #include "core/track_type_midi.h"
 #include "core/track_type_sample.h"
 #include "core/track_type_synth.h"
+#include "core/track_type_vst.h"
+#include "hosting/PluginDatabase.h"
+#include "hosting/VST3Host.h"
 
 #include <algorithm>
 #include <cctype>
 #include <cmath>
 #include <codecvt>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
@@ -97,6 +105,88 @@ std::string wideToUtf8(const std::wstring& value)
     }
 }
 
+constexpr char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string encodeBase64(const std::vector<std::uint8_t>& data)
+{
+    std::string encoded;
+    encoded.reserve((data.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < data.size(); i += 3)
+    {
+        const size_t remaining = data.size() - i;
+        std::uint32_t chunk = static_cast<std::uint32_t>(data[i]) << 16;
+        if (remaining > 1)
+            chunk |= static_cast<std::uint32_t>(data[i + 1]) << 8;
+        if (remaining > 2)
+            chunk |= data[i + 2];
+
+        encoded.push_back(kBase64Alphabet[(chunk >> 18) & 0x3F]);
+        encoded.push_back(kBase64Alphabet[(chunk >> 12) & 0x3F]);
+        encoded.push_back(remaining > 1 ? kBase64Alphabet[(chunk >> 6) & 0x3F] : '=');
+        encoded.push_back(remaining > 2 ? kBase64Alphabet[chunk & 0x3F] : '=');
+    }
+    return encoded;
+}
+
+bool decodeBase64(const std::string& text, std::vector<std::uint8_t>& out)
+{
+    out.clear();
+    out.reserve(text.size() / 4 * 3);
+    std::uint32_t chunk = 0;
+    int bits = 0;
+    for (char ch : text)
+    {
+        if (ch == '=')
+            break;
+        const char* found = std::strchr(kBase64Alphabet, ch);
+        if (!found || ch == '\0')
+        {
+            if (std::isspace(static_cast<unsigned char>(ch)))
+                continue;
+            return false;
+        }
+
+        chunk = (chunk << 6) | static_cast<std::uint32_t>(found - kBase64Alphabet);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out.push_back(static_cast<std::uint8_t>((chunk >> bits) & 0xFF));
+        }
+    }
+    return true;
+}
+
+// Class id of the plug-in's audio processor, from the plug-in database. Hosts
+// keep the resolved binary path, so the bundle is found by walking up from it.
+std::string pluginClassIdFor(const std::filesystem::path& pluginPath)
+{
+    auto candidate = pluginPath;
+    for (int depth = 0; depth < 4 && !candidate.empty(); ++depth)
+    {
+        if (auto bundle = getPluginDatabase().findBundle(candidate))
+        {
+            for (const auto& cls : bundle->classes)
+            {
+                if (cls.category == kVstAudioEffectClass)
+                    return cls.classId;
+            }
+            return {};
+        }
+        if (candidate == candidate.parent_path())
+            break;
+        candidate = candidate.parent_path();
+    }
+    return {};
+}
+
+struct PluginRestore
+{
+    int trackId = 0;
+    std::filesystem::path path;
+    std::vector<std::uint8_t> state;
+};
+
 std::string trackTypeToString(TrackType type)
 {
     switch (type)
@@ -650,13 +740,37 @@ bool saveProjectToFile(const std::filesystem::path& path)
         return false;
     }
 
-    int bpm = sequencerBPM.load(std::memory_order_relaxed);
+    double bpm = sequencerBPM.load(std::memory_order_relaxed);
+    double swing = sequencerSwing.load(std::memory_order_relaxed);
+    TempoSchedule tempoSchedule = getSequencerTempoSchedule();
     auto tracks = getTracks();
     auto assignments = modMatrixGetAssignments();
 
     stream << "{\n";
     stream << "  \"version\": 1,\n";
     stream << "  \"bpm\": " << bpm << ",\n";
+    stream << "  \"swing\": " << swing << ",\n";
+    stream << "  \"panLaw\": " << static_cast<int>(getPanLaw()) << ",\n";
+    stream << "  \"auxBuses\": [";
+    for (int busIndex = 0; busIndex < kAuxBusCount; ++busIndex)
+    {
+        AuxBus bus = auxBusGet(busIndex);
+        stream << (busIndex > 0 ? ", " : "") << "{\"returnLevel\": " << formatFloat(bus.returnLevel)
+               << ", \"delayEnabled\": " << (bus.delayEnabled ? "true" : "false")
+               << ", \"delayTimeMs\": " << formatFloat(bus.delayTimeMs)
+               << ", \"delayFeedback\": " << formatFloat(bus.delayFeedback)
+               << ", \"reverbEnabled\": " << (bus.reverbEnabled ? "true" : "false")
+               << ", \"reverbImpulse\": \"" << escapeJsonString(auxBusGetReverbImpulsePath(busIndex).u8string())
+               << "\"}";
+    }
+    stream << "],\n";
+    stream << "  \"tempoChanges\": [";
+    for (std::size_t i = 0; i < tempoSchedule.count; ++i)
+    {
+        const TempoChange& change = tempoSchedule.changes[i];
+        stream << (i > 0 ? ", " : "") << "{\"beat\": " << change.beat << ", \"bpm\": " << change.bpm << "}";
+    }
+    stream << "],\n";
     stream << "  \"tracks\": [\n";
 
     for (size_t i = 0; i < tracks.size(); ++i)
@@ -674,11 +788,17 @@ bool saveProjectToFile(const std::filesystem::path& path)
         float delayTimeMs = trackGetDelayTimeMs(track.id);
         float delayFeedback = trackGetDelayFeedback(track.id);
         float delayMix = trackGetDelayMix(track.id);
+        bool reverbEnabled = trackGetReverbEnabled(track.id);
+        float reverbSize = trackGetReverbSize(track.id);
+        float reverbDecay = trackGetReverbDecay(track.id);
+        float reverbDamping = trackGetReverbDamping(track.id);
+        float reverbMix = trackGetReverbMix(track.id);
         bool compressorEnabled = trackGetCompressorEnabled(track.id);
         float compressorThreshold = trackGetCompressorThresholdDb(track.id);
         float compressorRatio = trackGetCompressorRatio(track.id);
         float compressorAttack = trackGetCompressorAttack(track.id);
         float compressorRelease = trackGetCompressorRelease(track.id);
+        InsertOrder insertOrder = trackGetInsertOrder(track.id);
         float formant = trackGetSynthFormant(track.id);
         float resonance = trackGetSynthResonance(track.id);
         float feedback = trackGetSynthFeedback(track.id);
@@ -696,6 +816,21 @@ bool saveProjectToFile(const std::filesystem::path& path)
         std::wstring midiPortName = trackGetMidiPortName(track.id);
         std::string midiPortNameUtf8 = wideToUtf8(midiPortName);
         bool hasSample = trackGetSampleBuffer(track.id) != nullptr;
+        std::string pluginPath;
+        std::string pluginClassId;
+        std::vector<std::uint8_t> pluginState;
+        auto automation = trackGetAutomation(track.id);
+        if (auto host = trackGetVstHost(track.id); host && host->isPluginLoaded())
+        {
+            pluginPath = host->pluginPath().u8string();
+            pluginClassId = pluginClassIdFor(host->pluginPath());
+            if (!host->saveState(pluginState))
+            {
+                std::cerr << "[VST] Could not read plug-in state for track " << track.id
+                          << "; saving the plug-in without it." << std::endl;
+                pluginState.clear();
+            }
+        }
         int stepCount = trackGetStepCount(track.id);
 
         stream << "    {\n";
@@ -713,11 +848,20 @@ bool saveProjectToFile(const std::filesystem::path& path)
         stream << "      \"delayTimeMs\": " << formatFloat(delayTimeMs) << ",\n";
         stream << "      \"delayFeedback\": " << formatFloat(delayFeedback) << ",\n";
         stream << "      \"delayMix\": " << formatFloat(delayMix) << ",\n";
+        stream << "      \"reverbEnabled\": " << (reverbEnabled ? "true" : "false") << ",\n";
+        stream << "      \"reverbSize\": " << formatFloat(reverbSize) << ",\n";
+        stream << "      \"reverbDecay\": " << formatFloat(reverbDecay) << ",\n";
+        stream << "      \"reverbDamping\": " << formatFloat(reverbDamping) << ",\n";
+        stream << "      \"reverbMix\": " << formatFloat(reverbMix) << ",\n";
         stream << "      \"compressorEnabled\": " << (compressorEnabled ? "true" : "false") << ",\n";
         stream << "      \"compressorThresholdDb\": " << formatFloat(compressorThreshold) << ",\n";
         stream << "      \"compressorRatio\": " << formatFloat(compressorRatio) << ",\n";
         stream << "      \"compressorAttack\": " << formatFloat(compressorAttack) << ",\n";
         stream << "      \"compressorRelease\": " << formatFloat(compressorRelease) << ",\n";
+        stream << "      \"insertOrder\": [";
+        for (size_t slot = 0; slot < insertOrder.size(); ++slot)
+            stream << (slot > 0 ? ", " : "") << "\"" << insertEffectKey(insertOrder[slot]) << "\"";
+        stream << "],\n";
         stream << "      \"formant\": " << formatFloat(formant) << ",\n";
         stream << "      \"resonance\": " << formatFloat(resonance) << ",\n";
         stream << "      \"feedback\": " << formatFloat(feedback) << ",\n";
@@ -730,6 +874,10 @@ bool saveProjectToFile(const std::filesystem::path& path)
         stream << "      \"phaseSync\": " << (synthPhaseSync ? "true" : "false") << ",\n";
         stream << "      \"sampleAttack\": " << formatFloat(sampleAttack) << ",\n";
         stream << "      \"sampleRelease\": " << formatFloat(sampleRelease) << ",\n";
+        stream << "      \"sends\": [";
+        for (int busIndex = 0; busIndex < kAuxBusCount; ++busIndex)
+            stream << (busIndex > 0 ? ", " : "") << formatFloat(trackGetSendLevel(track.id, busIndex));
+        stream << "],\n";
         stream << "      \"lfos\": [\n";
         for (size_t lfoIndex = 0; lfoIndex < track.lfoSettings.size(); ++lfoIndex)
         {
@@ -748,6 +896,23 @@ bool saveProjectToFile(const std::filesystem::path& path)
         stream << "      \"midiChannel\": " << midiChannel << ",\n";
         stream << "      \"midiPort\": " << midiPort << ",\n";
         stream << "      \"midiPortName\": \"" << escapeJsonString(midiPortNameUtf8) << "\",\n";
+        if (!pluginPath.empty())
+        {
+            stream << "      \"plugin\": {\n";
+            stream << "        \"path\": \"" << escapeJsonString(pluginPath) << "\",\n";
+            stream << "        \"classId\": \"" << pluginClassId << "\",\n";
+            stream << "        \"state\": \"" << encodeBase64(pluginState) << "\",\n";
+            // Breakpoints are packed binary so dense lanes stay small.
+            stream << "        \"automation\": [";
+            for (size_t laneIndex = 0; automation && laneIndex < automation->size(); ++laneIndex)
+            {
+                const auto& lane = (*automation)[laneIndex];
+                stream << (laneIndex > 0 ? ", " : "") << "{\"param\": " << lane.paramId << ", \"points\": \""
+                       << encodeBase64(kj::encodeAutomationPoints(lane.points)) << "\"}";
+            }
+            stream << "]\n";
+            stream << "      },\n";
+        }
         stream << "      \"hasSample\": " << (hasSample ? "true" : "false") << ",\n";
         stream << "      \"stepCount\": " << stepCount << ",\n";
         stream << "      \"steps\": [\n";
@@ -876,11 +1041,28 @@ bool loadProjectFromFile(const std::filesystem::path& path)
         return false;
     }
 
-    int bpmValue = jsonToInt(findMember(rootObject, "bpm"), 120);
+    double bpmValue = jsonToFloat(findMember(rootObject, "bpm"), 120.0f);
+    double swingValue = jsonToFloat(findMember(rootObject, "swing"), 0.0f);
+    int panLawValue = jsonToInt(findMember(rootObject, "panLaw"), static_cast<int>(PanLaw::ConstantPower));
+    std::vector<TempoChange> tempoChanges;
+    if (const JsonValue* changesValue = findMember(rootObject, "tempoChanges"); changesValue && changesValue->isArray())
+    {
+        for (const auto& changeValue : changesValue->asArray())
+        {
+            if (!changeValue.isObject())
+                continue;
+            const auto& changeObject = changeValue.asObject();
+            TempoChange change;
+            change.beat = jsonToFloat(findMember(changeObject, "beat"), 0.0f);
+            change.bpm = jsonToFloat(findMember(changeObject, "bpm"), 120.0f);
+            tempoChanges.push_back(change);
+        }
+    }
     int version = jsonToInt(findMember(rootObject, "version"), 1);
     (void)version; // Future compatibility.
 
     const auto& tracksArray = tracksValue->asArray();
+    std::vector<PluginRestore> pluginRestores;
 
     initTracks();
     modMatrixClearAssignments();
@@ -960,6 +1142,21 @@ bool loadProjectFromFile(const std::filesystem::path& path)
         trackSetDelayTimeMs(trackId, jsonToFloat(findMember(trackObject, "delayTimeMs"), trackGetDelayTimeMs(trackId)));
         trackSetDelayFeedback(trackId, jsonToFloat(findMember(trackObject, "delayFeedback"), trackGetDelayFeedback(trackId)));
         trackSetDelayMix(trackId, jsonToFloat(findMember(trackObject, "delayMix"), trackGetDelayMix(trackId)));
+        trackSetReverbEnabled(trackId, jsonToBool(findMember(trackObject, "reverbEnabled"), trackGetReverbEnabled(trackId)));
+        trackSetReverbSize(trackId, jsonToFloat(findMember(trackObject, "reverbSize"), trackGetReverbSize(trackId)));
+        trackSetReverbDecay(trackId, jsonToFloat(findMember(trackObject, "reverbDecay"), trackGetReverbDecay(trackId)));
+        trackSetReverbDamping(trackId,
+                              jsonToFloat(findMember(trackObject, "reverbDamping"), trackGetReverbDamping(trackId)));
+        trackSetReverbMix(trackId, jsonToFloat(findMember(trackObject, "reverbMix"), trackGetReverbMix(trackId)));
+        // Projects from before aux buses have no sends.
+        const JsonValue* sendsValue = findMember(trackObject, "sends");
+        for (int busIndex = 0; busIndex < kAuxBusCount; ++busIndex)
+        {
+            const JsonValue* levelValue = nullptr;
+            if (sendsValue && sendsValue->isArray() && static_cast<size_t>(busIndex) < sendsValue->asArray().size())
+                levelValue = &sendsValue->asArray()[static_cast<size_t>(busIndex)];
+            trackSetSendLevel(trackId, busIndex, jsonToFloat(levelValue, 0.0f));
+        }
         trackSetCompressorEnabled(trackId,
                                   jsonToBool(findMember(trackObject, "compressorEnabled"),
                                              trackGetCompressorEnabled(trackId)));
@@ -975,11 +1172,96 @@ bool loadProjectFromFile(const std::filesystem::path& path)
         trackSetCompressorRelease(trackId,
                                    jsonToFloat(findMember(trackObject, "compressorRelease"),
                                                trackGetCompressorRelease(trackId)));
+        // Projects from before the insert chain could be reordered, or with an
+        // order that names an effect twice, get the default order. Inserts
+        // added since the project was saved go after the saved ones.
+        InsertOrder insertOrder = kDefaultInsertOrder;
+        const JsonValue* insertOrderValue = findMember(trackObject, "insertOrder");
+        if (insertOrderValue && insertOrderValue->isArray() && insertOrderValue->asArray().size() <= insertOrder.size())
+        {
+            InsertOrder parsed{};
+            size_t count = 0;
+            bool parsedAll = true;
+            for (const JsonValue& entry : insertOrderValue->asArray())
+            {
+                parsedAll = insertEffectFromKey(jsonToString(&entry), parsed[count++]);
+                if (!parsedAll)
+                    break;
+            }
+            for (InsertEffect effect : kDefaultInsertOrder)
+            {
+                if (parsedAll && count < parsed.size() &&
+                    std::find(parsed.begin(), parsed.begin() + count, effect) == parsed.begin() + count)
+                    parsed[count++] = effect;
+            }
+            if (parsedAll && count == parsed.size() && isValidInsertOrder(parsed))
+                insertOrder = parsed;
+        }
+        trackSetInsertOrder(trackId, insertOrder);
         trackSetMidiChannel(trackId, jsonToInt(findMember(trackObject, "midiChannel"), trackGetMidiChannel(trackId)));
         int midiPort = jsonToInt(findMember(trackObject, "midiPort"), trackGetMidiPort(trackId));
         std::wstring midiPortName = utf8ToWide(jsonToString(findMember(trackObject, "midiPortName")));
         trackSetMidiPort(trackId, midiPort, midiPortName);
 
+        if (const JsonValue* pluginValue = findMember(trackObject, "plugin"); pluginValue && pluginValue->isObject())
+        {
+            const auto& pluginObject = pluginValue->asObject();
+            PluginRestore restore;
+            restore.trackId = trackId;
+            restore.path = std::filesystem::u8path(jsonToString(findMember(pluginObject, "path")));
+
+            // Fall back to the class id when the plug-in moved since saving.
+            std::error_code ec;
+            const std::string classId = jsonToString(findMember(pluginObject, "classId"));
+            if (!classId.empty() && (restore.path.empty() || !std::filesystem::exists(restore.path, ec)))
+            {
+                if (auto bundle = getPluginDatabase().findClass(classId))
+                    restore.path = std::filesystem::u8path(bundle->path);
+            }
+
+            if (!decodeBase64(jsonToString(findMember(pluginObject, "state")), restore.state))
+            {
+                std::cerr << "[VST] Ignoring malformed plug-in state for track " << trackId << std::endl;
+                restore.state.clear();
+            }
+
+            std::shared_ptr<kj::AutomationLanes> lanes;
+            if (const JsonValue* automationValue = findMember(pluginObject, "automation");
+                automationValue && automationValue->isArray())
+            {
+                lanes = std::make_shared<kj::AutomationLanes>();
+                for (const auto& laneValue : automationValue->asArray())
+                {
+                    if (!laneValue.isObject())
+                        continue;
+                    const auto& laneObject = laneValue.asObject();
+                    // ParamIDs use the full unsigned 32-bit range.
+                    const JsonValue* paramValue = findMember(laneObject, "param");
+                    kj::AutomationLane lane;
+                    std::vector<std::uint8_t> packed;
+                    if (paramValue && paramValue->isNumber())
+                        lane.paramId = static_cast<std::uint32_t>(paramValue->asNumber());
+                    if (!paramValue || !paramValue->isNumber() ||
+                        !decodeBase64(jsonToString(findMember(laneObject, "points")), packed) ||
+                        !kj::decodeAutomationPoints(packed, lane.points))
+                    {
+                        std::cerr << "[VST] Ignoring malformed automation lane on track " << trackId << std::endl;
+                        continue;
+                    }
+                    lanes->push_back(std::move(lane));
+                }
+                std::sort(lanes->begin(), lanes->end(), [](const kj::AutomationLane& a, const kj::AutomationLane& b) {
+                    return a.paramId < b.paramId;
+                });
+            }
+            trackSetAutomation(trackId, std::move(lanes));
+
+            if (restore.path.empty())
+                std::cerr << "[VST] Plug-in for track " << trackId << " was not found." << std::endl;
+            else
+                pluginRestores.push_back(std::move(restore));
+        }
+
         int stepCount = jsonToInt(findMember(trackObject, "stepCount"), trackGetStepCount(trackId));
         trackSetStepCount(trackId, stepCount);
         stepCount = trackGetStepCount(trackId);
@@ -1106,8 +1388,33 @@ bool loadProjectFromFile(const std::filesystem::path& path)
         modMatrixSetAssignments(assignments);
     }
 
-    int clampedBpm = std::clamp(bpmValue, 40, 240);
-    sequencerBPM.store(clampedBpm, std::memory_order_relaxed);
+    sequencerBPM.store(std::clamp(bpmValue, 40.0, kSequencerMaxBpm), std::memory_order_relaxed);
+    sequencerSwing.store(std::clamp(swingValue, 0.0, kSequencerMaxSwing), std::memory_order_relaxed);
+    setSequencerTempoSchedule(std::move(tempoChanges));
+    resetAuxBuses();
+    if (const JsonValue* busesValue = findMember(rootObject, "auxBuses"); busesValue && busesValue->isArray())
+    {
+        const auto& busesArray = busesValue->asArray();
+        for (size_t i = 0; i < busesArray.size() && i < static_cast<size_t>(kAuxBusCount); ++i)
+        {
+            if (!busesArray[i].isObject())
+                continue;
+            const auto& busObject = busesArray[i].asObject();
+            const int busIndex = static_cast<int>(i);
+            const AuxBus current = auxBusGet(busIndex);
+            auxBusSetReturnLevel(busIndex, jsonToFloat(findMember(busObject, "returnLevel"), current.returnLevel));
+            auxBusSetDelayEnabled(busIndex, jsonToBool(findMember(busObject, "delayEnabled"), current.delayEnabled));
+            auxBusSetDelayTimeMs(busIndex, jsonToFloat(findMember(busObject, "delayTimeMs"), current.delayTimeMs));
+            auxBusSetDelayFeedback(busIndex,
+                                   jsonToFloat(findMember(busObject, "delayFeedback"), current.delayFeedback));
+            auxBusSetReverbEnabled(busIndex,
+                                   jsonToBool(findMember(busObject, "reverbEnabled"), current.reverbEnabled));
+            const std::string impulsePath = jsonToString(findMember(busObject, "reverbImpulse"));
+            if (!impulsePath.empty() && !auxBusLoadReverbImpulse(busIndex, std::filesystem::u8path(impulsePath)))
+                std::cerr << "[KJ] Aux bus " << busIndex + 1 << " loads without its reverb." << std::endl;
+        }
+    }
+    setPanLaw(panLawValue >= 0 && panLawValue < kPanLawCount ? static_cast<PanLaw>(panLawValue) : PanLaw::ConstantPower);
 
     int activeTrackId = 0;
     if (!trackIds.empty())
@@ -1123,6 +1430,14 @@ bool loadProjectFromFile(const std::filesystem::path& path)
     setActiveSequencerTrackId(activeTrackId);
     requestSequencerReset();
 
+    // All plug-ins load on the loader pool at once; each track comes online
+    // as soon as its own plug-in is ready.
+    for (auto& restore : pluginRestores)
+    {
+        if (!requestTrackVstRestore(restore.trackId, restore.path, std::move(restore.state)))
+            std::cerr << "[VST] Could not queue plug-in restore for track " << restore.trackId << std::endl;
+    }
+
     return true;
 }
 
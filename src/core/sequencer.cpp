@@ -1,10 +1,12 @@
 #include "core/sequencer.h"
+#include "core/seqlock.h"
 #include "core/tracks.h"
 
 #include <algorithm>
+#include <mutex>
 
-std::atomic<int> sequencerCurrentStep{0};
-std::atomic<int> sequencerBPM{120};
+std::atomic<double> sequencerBPM{120.0};
+std::atomic<double> sequencerSwing{0.0};
 std::atomic<bool> sequencerResetRequested{false};
 std::atomic<SequencerResetReason> sequencerResetReason{SequencerResetReason::Manual};
 
@@ -12,13 +14,16 @@ namespace
 {
 
 std::atomic<int> gActiveTrackId{0};
+std::mutex gTempoScheduleWriteMutex;
+SeqLockValue<TempoSchedule> gTempoSchedule{TempoSchedule{}};
 
 } // namespace
 
 void initSequencer()
 {
-    sequencerCurrentStep.store(0, std::memory_order_relaxed);
-    sequencerBPM.store(120, std::memory_order_relaxed);
+    sequencerBPM.store(120.0, std::memory_order_relaxed);
+    sequencerSwing.store(0.0, std::memory_order_relaxed);
+    setSequencerTempoSchedule({});
     requestSequencerReset();
 
     int activeTrackId = 0;
@@ -64,19 +69,7 @@ void setSequencerStepCount(int trackId, int count)
     if (trackId <= 0)
         return;
 
-    int previous = trackGetStepCount(trackId);
     trackSetStepCount(trackId, count);
-    int current = trackGetStepCount(trackId);
-
-    if (trackId == gActiveTrackId.load(std::memory_order_relaxed))
-    {
-        int currentStep = sequencerCurrentStep.load(std::memory_order_relaxed);
-        if (currentStep >= current)
-        {
-            int clampedStep = current > 0 ? std::min(currentStep, current - 1) : 0;
-            sequencerCurrentStep.store(clampedStep, std::memory_order_relaxed);
-        }
-    }
 }
 
 int getSequencerStepCount(int trackId)
@@ -106,3 +99,30 @@ void setActiveSequencerTrackId(int trackId)
         gActiveTrackId.store(0, std::memory_order_relaxed);
     }
 }
+
+void setSequencerTempoSchedule(std::vector<TempoChange> changes)
+{
+    changes.erase(std::remove_if(changes.begin(), changes.end(),
+                                 [](const TempoChange& change) { return !(change.beat >= 0.0) || !(change.bpm > 0.0); }),
+                  changes.end());
+    std::stable_sort(changes.begin(), changes.end(),
+                     [](const TempoChange& a, const TempoChange& b) { return a.beat < b.beat; });
+
+    TempoSchedule schedule{};
+    for (const auto& change : changes)
+    {
+        if (schedule.count >= schedule.changes.size())
+            break;
+        TempoChange clamped = change;
+        clamped.bpm = std::clamp(clamped.bpm, kSequencerMinBpm, kSequencerMaxBpm);
+        schedule.changes[schedule.count++] = clamped;
+    }
+
+    std::lock_guard<std::mutex> lock(gTempoScheduleWriteMutex);
+    gTempoSchedule.store(schedule);
+}
+
+TempoSchedule getSequencerTempoSchedule()
+{
+    return gTempoSchedule.load();
+}
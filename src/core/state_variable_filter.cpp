@@ -0,0 +1,110 @@
+#include "core/effects/state_variable_filter.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+constexpr double kDefaultSampleRate = 44100.0;
+constexpr double kPi = 3.14159265358979323846264338327950288;
+constexpr double kMinNormalizedFrequency = 1e-5;
+constexpr double kMaxNormalizedFrequency = 0.49;
+constexpr std::size_t kPrewarpTableSize = 4096;
+
+// Linear interpolation between these points stays within 4e-5 of tan()
+// relative, right up to the clamp.
+const std::array<double, kPrewarpTableSize + 2>& prewarpTable()
+{
+    static const auto table = [] {
+        std::array<double, kPrewarpTableSize + 2> values{};
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            double normalized = kMaxNormalizedFrequency * static_cast<double>(i) / kPrewarpTableSize;
+            values[i] = std::tan(kPi * normalized);
+        }
+        return values;
+    }();
+    return table;
+}
+}
+
+StateVariableFilter::StateVariableFilter(double sampleRate)
+    : m_sampleRate(sampleRate > 0.0 ? sampleRate : kDefaultSampleRate)
+    , m_cutoff(1000.0)
+    , m_q(0.7071067811865476)
+    , m_g(0.0)
+    , m_k(0.0)
+    , m_a1(0.0)
+    , m_a2(0.0)
+    , m_a3(0.0)
+    , m_ic1eq(0.0)
+    , m_ic2eq(0.0)
+{
+    updateCoefficients();
+}
+
+double StateVariableFilter::prewarp(double normalizedFrequency)
+{
+    const auto& table = prewarpTable();
+    double clamped = std::clamp(normalizedFrequency, kMinNormalizedFrequency, kMaxNormalizedFrequency);
+    double position = clamped * (kPrewarpTableSize / kMaxNormalizedFrequency);
+    auto index = static_cast<std::size_t>(position);
+    double fraction = position - static_cast<double>(index);
+    return table[index] + (table[index + 1] - table[index]) * fraction;
+}
+
+void StateVariableFilter::setSampleRate(double sampleRate)
+{
+    double sr = sampleRate > 0.0 ? sampleRate : kDefaultSampleRate;
+    if (sr == m_sampleRate)
+        return;
+    m_sampleRate = sr;
+    updateCoefficients();
+    reset();
+}
+
+void StateVariableFilter::setParameters(double cutoffHz, double q)
+{
+    if (!std::isfinite(cutoffHz) || !std::isfinite(q))
+        return;
+    m_cutoff = cutoffHz;
+    m_q = std::max(q, kMinQ);
+    updateCoefficients();
+}
+
+void StateVariableFilter::updateCoefficients()
+{
+    m_g = prewarp(m_cutoff / m_sampleRate);
+    m_k = 1.0 / m_q;
+    m_a1 = 1.0 / (1.0 + m_g * (m_g + m_k));
+    m_a2 = m_g * m_a1;
+    m_a3 = m_g * m_a2;
+}
+
+void StateVariableFilter::reset()
+{
+    m_ic1eq = 0.0;
+    m_ic2eq = 0.0;
+}
+
+StateVariableFilter::Outputs StateVariableFilter::process(double input)
+{
+    double v3 = input - m_ic2eq;
+    double v1 = m_a1 * m_ic1eq + m_a2 * v3;
+    double v2 = m_ic2eq + m_a2 * m_ic1eq + m_a3 * v3;
+    m_ic1eq = 2.0 * v1 - m_ic1eq;
+    m_ic2eq = 2.0 * v2 - m_ic2eq;
+    if (!std::isfinite(m_ic1eq) || !std::isfinite(m_ic2eq))
+    {
+        reset();
+        return {};
+    }
+
+    Outputs outputs;
+    outputs.low = v2;
+    outputs.band = v1;
+    outputs.high = input - m_k * v1 - v2;
+    outputs.notch = outputs.low + outputs.high;
+    return outputs;
+}
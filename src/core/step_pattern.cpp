@@ -0,0 +1,88 @@
+#include "core/step_pattern.h"
+
+#include <algorithm>
+
+namespace
+{
+
+bool eventBeforeStep(const StepNoteEvent& event, int step)
+{
+    return event.step < step;
+}
+
+bool stepBeforeEvent(int step, const StepNoteEvent& event)
+{
+    return step < event.step;
+}
+
+bool parametersBeforeStep(const StepParameters& parameters, int step)
+{
+    return parameters.step < step;
+}
+
+} // namespace
+
+bool StepParameters::isDefault() const noexcept
+{
+    return velocity == kTrackStepVelocityMax && pan == 0.0f && pitch == 0.0f && lastNote == kDefaultLastNote;
+}
+
+StepNoteRange StepPattern::notesForStep(int step) const noexcept
+{
+    auto first = std::lower_bound(m_events.begin(), m_events.end(), step, eventBeforeStep);
+    auto last = std::upper_bound(first, m_events.end(), step, stepBeforeEvent);
+    if (first == last)
+        return {};
+    return StepNoteRange(&*first, &*first + (last - first));
+}
+
+StepParameters StepPattern::parametersForStep(int step) const noexcept
+{
+    auto it = std::lower_bound(m_parameters.begin(), m_parameters.end(), step, parametersBeforeStep);
+    if (it != m_parameters.end() && it->step == step)
+        return *it;
+
+    StepParameters defaults{};
+    defaults.step = step;
+    return defaults;
+}
+
+void StepPattern::setStepNotes(int step, std::vector<StepNoteEvent> notes)
+{
+    for (auto& note : notes)
+        note.step = step;
+    std::sort(notes.begin(), notes.end(),
+              [](const StepNoteEvent& a, const StepNoteEvent& b) { return a.midiNote < b.midiNote; });
+    notes.erase(std::unique(notes.begin(), notes.end(),
+                            [](const StepNoteEvent& a, const StepNoteEvent& b) { return a.midiNote == b.midiNote; }),
+                notes.end());
+
+    auto first = std::lower_bound(m_events.begin(), m_events.end(), step, eventBeforeStep);
+    auto last = std::upper_bound(first, m_events.end(), step, stepBeforeEvent);
+    first = m_events.erase(first, last);
+    m_events.insert(first, notes.begin(), notes.end());
+}
+
+void StepPattern::setStepParameters(const StepParameters& parameters)
+{
+    auto it = std::lower_bound(m_parameters.begin(), m_parameters.end(), parameters.step, parametersBeforeStep);
+    bool exists = it != m_parameters.end() && it->step == parameters.step;
+    if (parameters.isDefault())
+    {
+        if (exists)
+            m_parameters.erase(it);
+        return;
+    }
+
+    if (exists)
+        *it = parameters;
+    else
+        m_parameters.insert(it, parameters);
+}
+
+void StepPattern::clearFrom(int firstStep)
+{
+    m_events.erase(std::lower_bound(m_events.begin(), m_events.end(), firstStep, eventBeforeStep), m_events.end());
+    m_parameters.erase(std::lower_bound(m_parameters.begin(), m_parameters.end(), firstStep, parametersBeforeStep),
+                       m_parameters.end());
+}
@@ -0,0 +1,160 @@
+#include "core/adsr_envelope.h"
+#include "core/tests/TestSupport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    // The per-sample curve the engine used before the generator: the ratio
+    // is recomputed every call and the segment ends when the value is within
+    // tolerance of its target.
+    double referenceAdvance(EnvelopeStage& stage, double value, double attack, double decay, double sustain,
+                            double release, double sampleRate)
+    {
+        auto advanceCurved = [&](double target, double timeSeconds) {
+            if (timeSeconds <= 0.0)
+            {
+                value = target;
+                return true;
+            }
+            double coefficient = std::exp(std::log(1e-5) / std::max(timeSeconds * sampleRate, 1.0));
+            value += (target - value) * (1.0 - coefficient);
+            if (std::abs(value - target) <= std::max(1e-5, std::abs(target) * 1e-5))
+            {
+                value = target;
+                return true;
+            }
+            return false;
+        };
+
+        switch (stage)
+        {
+        case EnvelopeStage::Idle:
+            value = 0.0;
+            break;
+        case EnvelopeStage::Attack:
+            if (advanceCurved(1.0, attack))
+                stage = EnvelopeStage::Decay;
+            break;
+        case EnvelopeStage::Decay:
+            if (advanceCurved(sustain, decay))
+                stage = EnvelopeStage::Sustain;
+            break;
+        case EnvelopeStage::Sustain:
+            value = sustain;
+            break;
+        case EnvelopeStage::Release:
+            if (advanceCurved(0.0, release))
+            {
+                stage = EnvelopeStage::Idle;
+                value = 0.0;
+            }
+            break;
+        }
+        return value;
+    }
+} // namespace
+
+int main()
+{
+    constexpr double kSampleRate = 48000.0;
+    constexpr double kAttack = 0.01;
+    constexpr double kDecay = 0.2;
+    constexpr double kSustain = 0.6;
+    constexpr double kRelease = 0.3;
+    constexpr int kGateSamples = 20000;
+
+    AdsrEnvelope envelope;
+    envelope.configure(kAttack, kDecay, kSustain, kRelease, kSampleRate);
+    const std::uint32_t generation = envelope.generation();
+    envelope.configure(kAttack, kDecay, kSustain, kRelease, kSampleRate);
+    if (!expect(generation != 0 && envelope.generation() == generation,
+                "Expected unchanged settings to keep the cached ratios."))
+        return 1;
+
+    // Same curve and the same stage changes, sample for sample.
+    EnvelopeStage stage = EnvelopeStage::Attack;
+    EnvelopeStage referenceStage = EnvelopeStage::Attack;
+    AdsrSegment segment;
+    double value = 0.0;
+    double referenceValue = 0.0;
+    double worst = 0.0;
+    int stageChanges = 0;
+    bool sameStages = true;
+    for (int i = 0; referenceStage != EnvelopeStage::Idle || stage != EnvelopeStage::Idle; ++i)
+    {
+        if (i == kGateSamples)
+        {
+            stage = EnvelopeStage::Release;
+            referenceStage = EnvelopeStage::Release;
+        }
+        const EnvelopeStage before = stage;
+        value = envelope.advance(stage, value, segment);
+        referenceValue = referenceAdvance(referenceStage, referenceValue, kAttack, kDecay, kSustain, kRelease,
+                                          kSampleRate);
+        worst = std::max(worst, std::abs(value - referenceValue));
+        sameStages = sameStages && stage == referenceStage;
+        stageChanges += stage != before ? 1 : 0;
+        if (i > kGateSamples + 10 * static_cast<int>(kRelease * kSampleRate))
+            break;
+    }
+    if (!expect(sameStages && stageChanges == 3 && worst < 1e-9 && value == 0.0,
+                "Expected the cached envelope to follow the per-sample reference."))
+        return 1;
+
+    // Rendering a block stops right after the sample that ends the stage, at
+    // the position the countdown predicted.
+    stage = EnvelopeStage::Attack;
+    value = 0.0;
+    segment = {};
+    const std::uint64_t attackSamples = envelope.samplesUntilStageEnd(stage, value, segment);
+    std::vector<float> block(4096, -1.0f);
+    const std::size_t rendered = envelope.render(stage, value, segment, block.data(), block.size());
+    if (!expect(attackSamples > 1 && rendered == attackSamples && stage == EnvelopeStage::Decay &&
+                    value == 1.0 && block[rendered - 1] == 1.0f && block[rendered] == -1.0f,
+                "Expected the attack to end at the predicted sample."))
+        return 1;
+
+    // Blocks match single samples, including across a mid-segment change.
+    EnvelopeStage single = EnvelopeStage::Decay;
+    AdsrSegment singleSegment;
+    double singleValue = 1.0;
+    std::vector<float> expected;
+    for (int i = 0; i < 3000; ++i)
+        expected.push_back(static_cast<float>(singleValue = envelope.advance(single, singleValue, singleSegment)));
+    std::vector<float> actual(expected.size());
+    std::size_t offset = 0;
+    for (std::size_t chunk : {37u, 501u, 1u, 64u})
+        offset += envelope.render(stage, value, segment, actual.data() + offset, chunk);
+    while (offset < actual.size())
+        offset += envelope.render(stage, value, segment, actual.data() + offset, actual.size() - offset);
+    float blockError = 0.0f;
+    for (std::size_t i = 0; i < actual.size(); ++i)
+        blockError = std::max(blockError, std::abs(actual[i] - expected[i]));
+    if (!expect(blockError < 1e-6f && stage == single, "Expected block rendering to match per-sample advance."))
+        return 1;
+
+    // A faster release mid-segment recounts from where the voice is.
+    stage = EnvelopeStage::Release;
+    value = 0.5;
+    segment = {};
+    const std::uint64_t slow = envelope.samplesUntilStageEnd(stage, value, segment);
+    envelope.configure(kAttack, kDecay, kSustain, kRelease / 4.0, kSampleRate);
+    const std::uint64_t fast = envelope.samplesUntilStageEnd(stage, value, segment);
+    std::uint64_t counted = 0;
+    while (stage == EnvelopeStage::Release)
+    {
+        value = envelope.advance(stage, value, segment);
+        ++counted;
+    }
+    if (!expect(fast < slow && counted == fast && stage == EnvelopeStage::Idle && value == 0.0,
+                "Expected a settings change to recount the segment."))
+        return 1;
+
+    std::cout << "[Test] ADSR envelope checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "core/audio_capture.h"
+#include "core/audio_recorder.h"
+#include "core/sample_loader.h"
+#include "core/tests/TestSupport.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::shared_ptr<const SampleBuffer> makeSource(int channels, int sampleRate, std::size_t frames)
+    {
+        auto buffer = std::make_shared<SampleBuffer>();
+        buffer->channels = channels;
+        buffer->sampleRate = sampleRate;
+        buffer->samples.resize(frames * static_cast<std::size_t>(channels));
+        for (std::size_t frame = 0; frame < frames; ++frame)
+        {
+            for (int ch = 0; ch < channels; ++ch)
+                buffer->samples[frame * channels + ch] = static_cast<float>(frame % 1000) / 1000.0f - 0.5f * ch;
+        }
+        return buffer;
+    }
+
+    bool record(const std::shared_ptr<const SampleBuffer>& source, const std::filesystem::path& path,
+                std::uint32_t latencyFrames, AudioRecorder::Take& take)
+    {
+        BufferAudioCaptureBackend capture(source, 480, latencyFrames, false);
+        AudioRecorder recorder;
+        if (!recorder.start(path, source->channels, source->sampleRate, capture.latencyFrames()))
+            return false;
+        capture.start([&](const float* interleaved, std::uint32_t frames) {
+            // Faster than realtime, so give the writer room instead of dropping.
+            while (!recorder.push(interleaved, frames))
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+        while (!capture.finished())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        capture.stop();
+        return recorder.stop(take);
+    }
+
+    std::vector<unsigned char> readFile(const std::filesystem::path& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<unsigned char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+} // namespace
+
+int main()
+{
+    const auto directory = std::filesystem::temp_directory_path() / "kj_audio_recorder_tests";
+    std::filesystem::create_directories(directory);
+
+    // Three seconds of stereo, enough to cross several write chunks.
+    constexpr int kSampleRate = 48000;
+    constexpr std::size_t kFrames = 3 * kSampleRate;
+    constexpr std::uint32_t kLatency = 256;
+    auto source = makeSource(2, kSampleRate, kFrames);
+
+    AudioRecorder::Take wavTake;
+    const auto wavPath = directory / "take.wav";
+    if (!expect(record(source, wavPath, kLatency, wavTake), "Expected the WAV take to be written."))
+        return 1;
+    if (!expect(wavTake.frames == kFrames - kLatency && wavTake.compensatedFrames == kLatency &&
+                    wavTake.droppedFrames == 0,
+                "Expected the take to drop exactly the reported input latency."))
+        return 1;
+    if (!expect(wavTake.buffer && wavTake.buffer->samples.size() == (kFrames - kLatency) * 2 &&
+                    wavTake.buffer->samples[0] == source->samples[kLatency * 2],
+                "Expected the in-memory take to start after the latency."))
+        return 1;
+    if (!expect(std::filesystem::file_size(wavPath) == 4096 + (kFrames - kLatency) * 2 * sizeof(float),
+                "Expected the preallocated tail to be trimmed and data to start at 4 KiB."))
+        return 1;
+
+    SampleBuffer reloaded;
+    if (!expect(loadSampleFromFile(wavPath, reloaded) && reloaded.channels == 2 &&
+                    reloaded.sampleRate == kSampleRate && reloaded.samples == wavTake.buffer->samples,
+                "Expected the WAV file to reload to the same samples."))
+        return 1;
+
+    AudioRecorder::Take cafTake;
+    const auto cafPath = directory / "take.caf";
+    if (!expect(record(makeSource(1, kSampleRate, kFrames), cafPath, 0, cafTake) && cafTake.frames == kFrames,
+                "Expected the CAF take to be written."))
+        return 1;
+    auto caf = readFile(cafPath);
+    const std::uint64_t dataBytes = kFrames * sizeof(float);
+    std::uint64_t chunkSize = 0;
+    for (int i = 0; i < 8; ++i)
+        chunkSize = (chunkSize << 8) | caf[4080 + 4 + i];
+    if (!expect(caf.size() == 4096 + dataBytes && std::string(caf.begin(), caf.begin() + 4) == "caff" &&
+                    std::string(caf.begin() + 4080, caf.begin() + 4084) == "data" && chunkSize == dataBytes + 4,
+                "Expected a finalised CAF data chunk at 4 KiB."))
+        return 1;
+
+    // A packet larger than the ring can ever hold is dropped and counted.
+    AudioRecorder overflow;
+    constexpr std::uint32_t kOversized = 4 * kSampleRate;
+    std::vector<float> packet(static_cast<std::size_t>(kOversized) * 2, 0.25f);
+    if (!expect(overflow.start(directory / "overflow.wav", 2, kSampleRate, 0, 1.0) &&
+                    overflow.push(packet.data(), 4800) && !overflow.push(packet.data(), kOversized),
+                "Expected a full ring to reject the packet."))
+        return 1;
+    AudioRecorder::Take overflowTake;
+    if (!expect(overflow.stop(overflowTake) && overflowTake.droppedFrames == kOversized && overflowTake.frames == 4800,
+                "Expected dropped frames to be reported."))
+        return 1;
+
+    std::error_code ec;
+    std::filesystem::remove_all(directory, ec);
+    std::cout << "[Test] Audio recorder checks passed." << std::endl;
+    return 0;
+}
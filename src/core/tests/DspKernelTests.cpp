@@ -0,0 +1,103 @@
+#include "core/aligned_buffer.h"
+#include "core/denormals.h"
+#include "core/dsp_kernels.h"
+#include "core/tests/TestSupport.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    template <typename T>
+    bool checkKernels()
+    {
+        // Odd length so every kernel also runs its scalar tail.
+        constexpr std::size_t kFrames = 67;
+        AlignedBuffer<T> left(kFrames);
+        AlignedBuffer<T> right(kFrames);
+        if (!expect(reinterpret_cast<std::uintptr_t>(left.data()) % AlignedBuffer<T>::kAlignment == 0,
+                    "Expected 64-byte aligned storage."))
+            return false;
+
+        for (std::size_t i = 0; i < kFrames; ++i)
+        {
+            left[i] = static_cast<T>(i) / kFrames;
+            right[i] = -left[i];
+        }
+        dsp::addScaled(left.data(), right.data(), T(0.5), kFrames);
+        dsp::applyGainRamp(right.data(), T(0), T(1), kFrames);
+        if (!expect(std::abs(left[66] - T(33) / kFrames) < 1e-6 && right[0] == 0 &&
+                        std::abs(right[66] - T(-66) / kFrames * T(66) / kFrames) < 1e-6,
+                    "Expected scaled add and gain ramp to match the scalar result."))
+            return false;
+
+        std::vector<float> monitor(kFrames * 2, 2.0f);
+        dsp::addInterleavedStereo(left.data(), right.data(), monitor.data(), kFrames);
+        dsp::clamp(left.data(), T(-1), T(1), kFrames);
+        if (!expect(left[66] == 1 && right[0] == 2, "Expected the monitor feed added and the mix clamped."))
+            return false;
+
+        left[3] = std::numeric_limits<T>::quiet_NaN();
+        left[5] = -std::numeric_limits<T>::infinity();
+        if (!expect(dsp::replaceNonFinite(left.data(), kFrames) == 2 && left[3] == 0 && left[5] == 0 &&
+                        left[4] == 1,
+                    "Expected NaN and infinity, and nothing else, replaced with silence."))
+            return false;
+
+        left[0] = T(0.5);
+        right[0] = T(-0.25);
+        std::vector<float> device(kFrames * 4, 9.0f);
+        dsp::interleaveToFloat(left.data(), right.data(), device.data(), kFrames, 4);
+        std::vector<std::int16_t> pcm(kFrames, 9);
+        dsp::interleaveToInt16(left.data(), right.data(), pcm.data(), kFrames, 1);
+        if (!expect(device[0] == 0.5f && device[1] == -0.25f && device[2] == 0.0f && device[3] == 0.0f &&
+                        pcm[0] == static_cast<std::int16_t>(std::lround(0.125 * 32767.0)),
+                    "Expected interleaved device frames with the extra channels silenced."))
+            return false;
+
+        // A 30 Hz low-pass at 48 kHz is where float state loses precision;
+        // with StateSample state it settles at unity whatever the sample type.
+        const double w0 = 2.0 * 3.14159265358979323846 * 30.0 / 48000.0;
+        const double alpha = std::sin(w0) / std::sqrt(2.0);
+        const double a0 = 1.0 + alpha;
+        dsp::BiquadCoefficients lowPass;
+        lowPass.b0 = (1.0 - std::cos(w0)) * 0.5 / a0;
+        lowPass.b1 = (1.0 - std::cos(w0)) / a0;
+        lowPass.b2 = lowPass.b0;
+        lowPass.a1 = -2.0 * std::cos(w0) / a0;
+        lowPass.a2 = (1.0 - alpha) / a0;
+        dsp::BiquadState<StateSample> state;
+        AlignedBuffer<T> dc(4800);
+        for (int block = 0; block < 20; ++block)
+        {
+            for (std::size_t i = 0; i < dc.size(); ++i)
+                dc[i] = T(0.5);
+            dsp::processBiquad(lowPass, state, dc.data(), dc.size());
+        }
+        return expect(std::abs(dc[dc.size() - 1] - T(0.5)) < 1e-4, "Expected a low biquad to settle at DC gain.");
+    }
+} // namespace
+
+int main()
+{
+    if (!checkKernels<float>() || !checkKernels<double>())
+        return 1;
+
+    volatile float smallest = std::numeric_limits<float>::min();
+    {
+        ScopedDenormalFlush flush;
+        volatile float subnormal = smallest * 0.5f;
+        if (!expect(!ScopedDenormalFlush::active() || subnormal == 0.0f,
+                    "Expected subnormal results to flush to zero."))
+            return 1;
+    }
+    volatile float restored = smallest * 0.5f;
+    if (!expect(restored != 0.0f, "Expected the previous floating-point mode back after the scope."))
+        return 1;
+
+    std::cout << "[Test] DSP kernel checks passed." << std::endl;
+    return 0;
+}
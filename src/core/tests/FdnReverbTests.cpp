@@ -0,0 +1,171 @@
+#include "core/effects/fdn_reverb.h"
+#include "core/tests/TestSupport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    double energy(const std::vector<float>& left, const std::vector<float>& right, std::size_t begin, std::size_t end)
+    {
+        double sum = 0.0;
+        for (std::size_t i = begin; i < end && i < left.size(); ++i)
+            sum += static_cast<double>(left[i]) * left[i] + static_cast<double>(right[i]) * right[i];
+        return sum;
+    }
+}
+
+int main()
+{
+    constexpr double kSampleRate = 48000.0;
+    constexpr std::size_t kBlock = 256;
+
+    // Fully wet, undamped impulse response: silent until the shortest line
+    // comes round, then decaying by about 60 dB over the decay time.
+    FdnReverb reverb(kSampleRate);
+    reverb.setSize(0.5f);
+    reverb.setDecay(1.0f);
+    reverb.setDamping(0.0f);
+    reverb.setMix(1.0f);
+    reverb.reset();
+
+    std::vector<float> left(static_cast<std::size_t>(kSampleRate * 1.5), 0.0f);
+    std::vector<float> right(left.size(), 0.0f);
+    left[0] = 1.0f;
+    right[0] = 1.0f;
+    for (std::size_t position = 0; position < left.size(); position += kBlock)
+        reverb.process(&left[position], &right[position], std::min(kBlock, left.size() - position));
+
+    if (!expect(std::all_of(left.begin(), left.end(), [](float value) { return std::isfinite(value); }),
+                "Expected a finite response."))
+        return 1;
+    if (!expect(left[0] == 0.0f && left[100] == 0.0f, "Expected no wet output before the shortest line."))
+        return 1;
+
+    const std::size_t window = static_cast<std::size_t>(kSampleRate * 0.1);
+    double early = energy(left, right, 0, window);
+    double late = energy(left, right, static_cast<std::size_t>(kSampleRate), static_cast<std::size_t>(kSampleRate) + window);
+    double dropDb = 10.0 * std::log10(early / std::max(late, 1e-30));
+    if (!expect(early > 0.0 && dropDb > 50.0 && dropDb < 70.0, "Expected the response to fall about 60 dB over the decay time."))
+    {
+        std::cerr << "[Test] Drop was " << dropDb << " dB." << std::endl;
+        return 1;
+    }
+
+    // Damping takes the high end out of the tail faster than the low end.
+    auto tailEnergy = [&](float damping) {
+        FdnReverb damped(kSampleRate);
+        damped.setDecay(1.0f);
+        damped.setDamping(damping);
+        damped.setMix(1.0f);
+        damped.reset();
+        std::vector<float> l(static_cast<std::size_t>(kSampleRate * 0.5), 0.0f);
+        std::vector<float> r(l.size(), 0.0f);
+        l[0] = 1.0f;
+        damped.process(l.data(), r.data(), l.size());
+        return energy(l, r, l.size() / 2, l.size());
+    };
+    if (!expect(tailEnergy(1.0f) < tailEnergy(0.0f), "Expected damping to shorten the tail."))
+        return 1;
+
+    // The engine drives the reverb a frame at a time between beginBlock
+    // calls; that has to match whole-block processing.
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> inputLeft(20000);
+    std::vector<float> inputRight(inputLeft.size());
+    for (std::size_t i = 0; i < inputLeft.size(); ++i)
+    {
+        inputLeft[i] = noise(random);
+        inputRight[i] = noise(random);
+    }
+    FdnReverb blockReverb(kSampleRate);
+    FdnReverb frameReverb(kSampleRate);
+    std::vector<float> blockLeft = inputLeft;
+    std::vector<float> blockRight = inputRight;
+    std::vector<float> frameLeft = inputLeft;
+    std::vector<float> frameRight = inputRight;
+    for (std::size_t position = 0; position < inputLeft.size(); position += kBlock)
+    {
+        std::size_t frames = std::min(kBlock, inputLeft.size() - position);
+        if (position == kBlock * 20)
+        {
+            // A parameter change mid-stream glides on both paths alike.
+            for (FdnReverb* target : {&blockReverb, &frameReverb})
+            {
+                target->setSize(1.0f);
+                target->setMix(0.8f);
+            }
+        }
+        blockReverb.process(&blockLeft[position], &blockRight[position], frames);
+        frameReverb.beginBlock(frames);
+        for (std::size_t i = position; i < position + frames; ++i)
+            frameReverb.processFrame(frameLeft[i], frameRight[i]);
+    }
+    if (!expect(blockLeft == frameLeft && blockRight == frameRight, "Expected frame and block processing to agree."))
+        return 1;
+
+    double largestStep = 0.0;
+    for (std::size_t i = kBlock * 20; i < kBlock * 40; ++i)
+        largestStep = std::max(largestStep, static_cast<double>(std::abs(blockLeft[i] - blockLeft[i - 1])));
+    if (!expect(largestStep < 3.0 && std::all_of(blockLeft.begin(), blockLeft.end(), [](float value) { return std::isfinite(value); }),
+                "Expected the size change to glide rather than jump."))
+        return 1;
+
+    // Dry at zero mix, whatever is in the network.
+    FdnReverb dry(kSampleRate);
+    dry.setMix(0.0f);
+    dry.reset();
+    std::vector<float> dryLeft = inputLeft;
+    std::vector<float> dryRight = inputRight;
+    dry.process(dryLeft.data(), dryRight.data(), dryLeft.size());
+    if (!expect(dryLeft == inputLeft && dryRight == inputRight, "Expected zero mix to pass the input through."))
+        return 1;
+
+    // Longest decay, no damping, loud noise: the network must stay bounded.
+    FdnReverb longest(kSampleRate);
+    longest.setSize(1.0f);
+    longest.setDecay(FdnReverb::kMaxDecaySeconds);
+    longest.setDamping(0.0f);
+    longest.setMix(1.0f);
+    longest.reset();
+    float peak = 0.0f;
+    std::vector<float> blockL(kBlock);
+    std::vector<float> blockR(kBlock);
+    for (std::size_t block = 0; block < static_cast<std::size_t>(kSampleRate * 10.0) / kBlock; ++block)
+    {
+        for (std::size_t i = 0; i < kBlock; ++i)
+        {
+            blockL[i] = noise(random);
+            blockR[i] = noise(random);
+        }
+        longest.process(blockL.data(), blockR.data(), kBlock);
+        for (std::size_t i = 0; i < kBlock; ++i)
+            peak = std::max({peak, std::abs(blockL[i]), std::abs(blockR[i])});
+    }
+    if (!expect(std::isfinite(peak) && peak < 50.0f, "Expected the longest decay to stay bounded."))
+        return 1;
+
+    longest.reset();
+    std::fill(blockL.begin(), blockL.end(), 0.0f);
+    std::fill(blockR.begin(), blockR.end(), 0.0f);
+    longest.process(blockL.data(), blockR.data(), kBlock);
+    if (!expect(std::all_of(blockL.begin(), blockL.end(), [](float value) { return value == 0.0f; }),
+                "Expected silence after reset."))
+        return 1;
+
+    // Memory is sized for the largest room at prepare; the tail follows the
+    // rate and decay.
+    FdnReverb resampled(kSampleRate);
+    std::size_t tailAt48k = resampled.tailSamples();
+    resampled.prepare(96000.0);
+    if (!expect(resampled.tailSamples() > tailAt48k * 19 / 10 && resampled.sampleRate() == 96000.0,
+                "Expected the tail to follow the prepared rate."))
+        return 1;
+
+    std::cout << "[Test] FDN reverb checks passed." << std::endl;
+    return 0;
+}
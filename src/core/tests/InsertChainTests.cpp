@@ -0,0 +1,46 @@
+#include "core/effects/insert_chain.h"
+#include "core/tests/TestSupport.h"
+
+#include <iostream>
+
+int main()
+{
+    InsertOrder order = kDefaultInsertOrder;
+    if (!expect(moveInsert(order, 2, 0) && order[0] == InsertEffect::Delay && order[1] == InsertEffect::Equalizer &&
+                    order[2] == InsertEffect::Compressor,
+                "Expected the delay moved to the front and the others shifted down."))
+        return 1;
+    if (!expect(moveInsert(order, 0, 1) && order[0] == InsertEffect::Equalizer && order[1] == InsertEffect::Delay,
+                "Expected a move towards the end to shift the others up."))
+        return 1;
+    if (!expect(!moveInsert(order, 0, kInsertEffectCount) && order[0] == InsertEffect::Equalizer,
+                "Expected a slot out of range refused."))
+        return 1;
+
+    if (!expect(unpackInsertOrder(packInsertOrder(order)) == order, "Expected the order to survive packing."))
+        return 1;
+    InsertOrder duplicated = {InsertEffect::Delay, InsertEffect::Delay, InsertEffect::Compressor, InsertEffect::Reverb};
+    if (!expect(!isValidInsertOrder(duplicated) &&
+                    unpackInsertOrder(packInsertOrder(duplicated)) == kDefaultInsertOrder &&
+                    unpackInsertOrder(0xFFFFFFFFu) == kDefaultInsertOrder,
+                "Expected an invalid packed order to come back as the default."))
+        return 1;
+
+    InsertEffect parsed = InsertEffect::Equalizer;
+    if (!expect(insertEffectFromKey(insertEffectKey(InsertEffect::Reverb), parsed) &&
+                    parsed == InsertEffect::Reverb && !insertEffectFromKey("chorus", parsed),
+                "Expected project keys to round-trip and unknown ones refused."))
+        return 1;
+
+    // Bypassed inserts are left out and the rest keep their order.
+    InsertPlan plan = compileInsertPlan(order, {true, false, true, true});
+    if (!expect(plan.count == 3 && plan.effects[0] == InsertEffect::Equalizer && plan.effects[1] == InsertEffect::Delay &&
+                    plan.effects[2] == InsertEffect::Reverb,
+                "Expected the plan to hold only the enabled inserts, in chain order."))
+        return 1;
+    if (!expect(compileInsertPlan(order, {false, false, false, false}).count == 0, "Expected an empty plan with all bypassed."))
+        return 1;
+
+    std::cout << "[Test] Insert chain checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "core/effects/latency_compensation.h"
+#include "core/tests/TestSupport.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Feeds a ramp through the delay and returns what came out.
+    std::vector<double> runRamp(LatencyCompensationDelay& delay, int frames, int start = 1)
+    {
+        std::vector<double> output;
+        for (int i = 0; i < frames; ++i)
+        {
+            double left = static_cast<double>(start + i);
+            double right = -left;
+            delay.process(left, right);
+            if (right != -left)
+                return {};
+            output.push_back(left);
+        }
+        return output;
+    }
+}
+
+int main()
+{
+    // An unprepared delay passes the signal through untouched.
+    LatencyCompensationDelay unprepared;
+    if (!expect(!unprepared.prepared() && runRamp(unprepared, 4) == std::vector<double>{1.0, 2.0, 3.0, 4.0},
+                "Expected an unprepared delay to pass through."))
+        return 1;
+
+    // Delays by exactly the set amount, both channels alike.
+    LatencyCompensationDelay delay;
+    delay.prepare(100);
+    if (!expect(delay.prepared() && delay.maxDelay() == 100 && delay.delay() == 0,
+                "Expected the prepared size and no delay yet."))
+        return 1;
+    delay.setDelay(3);
+    if (!expect(runRamp(delay, 6) == std::vector<double>{0.0, 0.0, 0.0, 1.0, 2.0, 3.0},
+                "Expected the output three frames late."))
+        return 1;
+
+    // Requests beyond the prepared size are clamped.
+    delay.setDelay(1000);
+    if (!expect(delay.delay() == 100, "Expected the delay clamped to the prepared size."))
+        return 1;
+    delay.setDelay(-5);
+    if (!expect(delay.delay() == 0, "Expected a negative delay clamped to zero."))
+        return 1;
+
+    // The full prepared size works, across many wraps of the buffer.
+    delay.reset();
+    delay.setDelay(100);
+    std::vector<double> longRun = runRamp(delay, 1000);
+    bool delayed = longRun.size() == 1000;
+    for (int i = 0; delayed && i < 1000; ++i)
+        delayed = longRun[static_cast<std::size_t>(i)] == (i < 100 ? 0.0 : static_cast<double>(i - 99));
+    if (!expect(delayed, "Expected the largest delay to hold across wraps."))
+        return 1;
+
+    // Reset clears what is in flight.
+    delay.reset();
+    delay.setDelay(2);
+    if (!expect(runRamp(delay, 3, 50) == std::vector<double>{0.0, 0.0, 50.0}, "Expected reset to clear the history."))
+        return 1;
+
+    // The pool sizes each delay from the latency asked for and keeps it
+    // while it fits. Each pass builds one snapshot generation; the render
+    // thread has acknowledged none of them yet.
+    LatencyCompensationPool pool;
+    pool.beginPass(1);
+    if (!expect(pool.acquire(1, 0) == nullptr, "Expected no delay while nothing needs compensating."))
+        return 1;
+    auto first = pool.acquire(1, 256);
+    if (!expect(first && first->prepared() && first->maxDelay() == 256, "Expected a delay sized to the latency."))
+        return 1;
+    pool.endPass(0);
+    pool.beginPass(2);
+    if (!expect(pool.acquire(1, 128) == first && pool.acquire(1, 0) == first,
+                "Expected a delay that fits to be kept."))
+        return 1;
+    pool.endPass(0);
+
+    // Growing replaces the delay; the old one stays alive until the render
+    // thread has moved on to a snapshot without it, however many passes
+    // that takes.
+    pool.beginPass(3);
+    auto grown = pool.acquire(1, 1024);
+    pool.endPass(0);
+    if (!expect(grown && grown != first && grown->maxDelay() == 1024 && pool.retiredCount() == 1,
+                "Expected a larger latency to replace the delay and retire the old one."))
+        return 1;
+    std::weak_ptr<LatencyCompensationDelay> retired = first;
+    first.reset();
+    for (std::uint64_t generation = 4; generation < 400; ++generation)
+    {
+        pool.beginPass(generation);
+        pool.acquire(1, 1024);
+        pool.endPass(2);
+    }
+    if (!expect(!retired.expired(), "Expected the retired delay kept while an older snapshot may run."))
+        return 1;
+    pool.beginPass(400);
+    pool.acquire(1, 1024);
+    pool.endPass(3);
+    if (!expect(retired.expired() && pool.retiredCount() == 0,
+                "Expected the retired delay freed once its generation is acknowledged."))
+        return 1;
+
+    // Latency beyond the supported maximum is capped.
+    pool.beginPass(401);
+    if (!expect(pool.acquire(2, 1 << 20)->maxDelay() == LatencyCompensationDelay::kMaxDelaySamples,
+                "Expected the size capped at the maximum."))
+        return 1;
+    pool.acquire(1, 1024);
+    pool.endPass(400);
+
+    // A track that is gone has its delay retired.
+    pool.beginPass(402);
+    pool.acquire(1, 1024);
+    pool.endPass(400);
+    if (!expect(pool.retiredCount() == 1, "Expected a removed track's delay retired."))
+        return 1;
+    pool.beginPass(403);
+    pool.acquire(1, 1024);
+    pool.endPass(402);
+    if (!expect(pool.retiredCount() == 0, "Expected the removed track's delay freed after acknowledgement."))
+        return 1;
+
+    std::cout << "[Test] Latency compensation checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include "core/midi_output.h"
+#include "core/midi_output_backend.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+int main()
+{
+    auto loopback = std::make_unique<LoopbackMidiOutputBackend>();
+    LoopbackMidiOutputBackend* recorder = loopback.get();
+    setMidiOutputBackend(std::move(loopback));
+
+    midiOutputPreparePort(3);
+    startMidiOutput();
+
+    // 48 kHz render clock with 480 frames (10 ms) still queued in the device.
+    constexpr double kSampleRate = 48000.0;
+    midiOutputPublishRenderClock(0, kSampleRate, 480);
+    auto clockOrigin = std::chrono::steady_clock::now();
+
+    // Note-on at frame 960 (10 ms queue + 20 ms), note-off at frame 1440.
+    midiOutputScheduleNoteOn(3, 0, 60, 100, 960);
+    midiOutputScheduleNoteOff(3, 0, 60, 0, 1440);
+    // A note that never receives its note-off must be silenced on shutdown.
+    midiOutputScheduleNoteOn(3, 1, 64, 90, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    shutdownMidiOutput();
+
+    auto messages = recorder->messages();
+    if (messages.size() != 4)
+    {
+        std::cerr << "[Test] Expected 4 MIDI messages, got " << messages.size() << "." << std::endl;
+        return 1;
+    }
+
+    if (messages[0].message != 0x5A4091u || messages[1].message != 0x643C90u || messages[2].message != 0x003C80u)
+    {
+        std::cerr << "[Test] Expected MIDI messages in timestamp order." << std::endl;
+        return 1;
+    }
+
+    if (messages[3].message != 0x004081u)
+    {
+        std::cerr << "[Test] Expected a note-off for the hanging note on shutdown." << std::endl;
+        return 1;
+    }
+
+    auto noteOnMs = std::chrono::duration<double, std::milli>(messages[1].dispatchTime - clockOrigin).count();
+    auto gapMs = std::chrono::duration<double, std::milli>(messages[2].dispatchTime - messages[1].dispatchTime).count();
+    if (noteOnMs < 28.0 || noteOnMs > 32.0 || gapMs < 9.0 || gapMs > 11.0)
+    {
+        std::cerr << "[Test] MIDI dispatch timing off: note-on at " << noteOnMs << " ms, gap " << gapMs
+                  << " ms." << std::endl;
+        return 1;
+    }
+
+    std::cout << "[Test] MIDI scheduler ordering and timing checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "core/effects/pan_gain_stage.h"
+#include "core/tests/TestSupport.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    constexpr double kPi = 3.14159265358979323846264338327950288;
+
+    double toDb(double gain) { return 20.0 * std::log10(gain); }
+}
+
+int main()
+{
+    // Centre levels name the laws; the extremes are the same for all of them.
+    PanGains constantPower = panLawGains(PanLaw::ConstantPower, 0.0);
+    PanGains compromise = panLawGains(PanLaw::Compromise, 0.0);
+    PanGains linear = panLawGains(PanLaw::Linear, 0.0);
+    if (!expect(std::abs(toDb(constantPower.left) + 3.01) < 0.01 && std::abs(toDb(compromise.left) + 4.52) < 0.01 &&
+                    std::abs(toDb(linear.right) + 6.02) < 0.01,
+                "Expected -3, -4.5 and -6 dB at the centre."))
+        return 1;
+    for (PanLaw law : {PanLaw::ConstantPower, PanLaw::Compromise, PanLaw::Linear})
+    {
+        PanGains left = panLawGains(law, -1.0);
+        PanGains right = panLawGains(law, 2.0);
+        if (!expect(left.left == 1.0 && left.right < 1e-12 && right.left < 1e-12 && right.right == 1.0,
+                    "Expected hard pans to silence the other side."))
+            return 1;
+    }
+
+    double worstError = 0.0;
+    for (int i = 0; i <= 1000; ++i)
+    {
+        double pan = -1.0 + 2.0 * i / 1000.0;
+        PanGains gains = panLawGains(PanLaw::ConstantPower, pan);
+        double angle = (pan + 1.0) * 0.25 * kPi;
+        worstError = std::max(worstError, std::abs(gains.left - std::cos(angle)));
+        worstError = std::max(worstError, std::abs(gains.right - std::sin(angle)));
+    }
+    if (!expect(worstError < 1e-5, "Expected the table to follow cos/sin between its points."))
+        return 1;
+
+    // First target jumps; later ones ramp linearly and land exactly.
+    PanGainStage stage;
+    stage.setTarget(PanLaw::Linear, 1.0, -1.0, 64);
+    PanGains first = stage.next();
+    if (!expect(first.left == 1.0 && first.right == 0.0 && !stage.ramping(), "Expected the first target applied at once."))
+        return 1;
+    stage.setTarget(PanLaw::Linear, 0.5, 1.0, 4);
+    double previousRight = 0.0;
+    bool monotonic = true;
+    for (int i = 0; i < 4; ++i)
+    {
+        PanGains gains = stage.next();
+        monotonic = monotonic && gains.right >= previousRight && gains.right < 0.5;
+        previousRight = gains.right;
+    }
+    PanGains settled = stage.next();
+    if (!expect(monotonic && settled.left == 0.0 && settled.right == 0.5 && !stage.ramping(),
+                "Expected a four-frame ramp ending on the target."))
+        return 1;
+
+    stage.setTarget(PanLaw::Linear, 0.5, 1.0, 4);
+    if (!expect(!stage.ramping(), "Expected an unchanged target to leave the gains alone."))
+        return 1;
+
+    std::cout << "[Test] Pan gain stage checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "core/sequencer.h"
+#include "core/step_pattern.h"
+#include "core/tests/TestSupport.h"
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    StepNoteEvent note(int midiNote, float velocity = kTrackStepVelocityMax)
+    {
+        StepNoteEvent event;
+        event.midiNote = midiNote;
+        event.velocity = velocity;
+        return event;
+    }
+
+    std::vector<int> notesOf(const StepPattern& pattern, int step)
+    {
+        std::vector<int> notes;
+        for (const auto& event : pattern.notesForStep(step))
+            notes.push_back(event.midiNote);
+        return notes;
+    }
+}
+
+int main()
+{
+    StepPattern pattern;
+    if (!expect(pattern.events().empty() && !pattern.stepEnabled(0) && pattern.notesForStep(5).empty(),
+                "Expected an empty pattern to have no notes."))
+        return 1;
+
+    // Notes come back sorted by pitch, without duplicates and stamped with
+    // their step, whatever order they were written in.
+    pattern.setStepNotes(4, {note(67), note(60, 0.5f), note(64), note(60)});
+    pattern.setStepNotes(0, {note(48)});
+    pattern.setStepNotes(9, {note(72)});
+    if (!expect(notesOf(pattern, 4) == std::vector<int>{60, 64, 67}, "Expected the step's notes sorted and unique."))
+        return 1;
+    if (!expect(pattern.notesForStep(4).begin()->velocity == 0.5f && pattern.notesForStep(4).begin()->step == 4,
+                "Expected the first of duplicate notes kept and stamped with its step."))
+        return 1;
+    if (!expect(pattern.stepEnabled(0) && !pattern.stepEnabled(1) && pattern.stepEnabled(9),
+                "Expected only steps with notes enabled."))
+        return 1;
+    bool ordered = true;
+    for (std::size_t i = 1; i < pattern.events().size(); ++i)
+    {
+        const auto& previous = pattern.events()[i - 1];
+        const auto& current = pattern.events()[i];
+        ordered = ordered && (previous.step < current.step ||
+                              (previous.step == current.step && previous.midiNote < current.midiNote));
+    }
+    if (!expect(ordered && pattern.events().size() == 5, "Expected the events sorted by step and note."))
+        return 1;
+
+    // Rewriting a step replaces its notes and leaves its neighbours alone;
+    // writing no notes switches it off.
+    pattern.setStepNotes(4, {note(62)});
+    if (!expect(notesOf(pattern, 4) == std::vector<int>{62} && notesOf(pattern, 0) == std::vector<int>{48} &&
+                    notesOf(pattern, 9) == std::vector<int>{72},
+                "Expected a rewrite to touch only its own step."))
+        return 1;
+    pattern.setStepNotes(0, {});
+    if (!expect(!pattern.stepEnabled(0) && pattern.events().size() == 2, "Expected an empty write to clear the step."))
+        return 1;
+
+    // Parameters: only overrides are stored, and writing the defaults back
+    // removes the entry.
+    StepParameters accent;
+    accent.step = 4;
+    accent.velocity = 0.25f;
+    accent.pan = -0.5f;
+    pattern.setStepParameters(accent);
+    StepParameters later;
+    later.step = 12;
+    later.pitch = 7.0f;
+    pattern.setStepParameters(later);
+    StepParameters earlier;
+    earlier.step = 2;
+    earlier.lastNote = 50;
+    pattern.setStepParameters(earlier);
+    if (!expect(pattern.parameters().size() == 3 && pattern.parameters()[0].step == 2 &&
+                    pattern.parameters()[1].step == 4 && pattern.parameters()[2].step == 12,
+                "Expected the overrides sorted by step."))
+        return 1;
+    StepParameters read = pattern.parametersForStep(4);
+    if (!expect(read.velocity == 0.25f && read.pan == -0.5f && read.pitch == 0.0f, "Expected the override read back."))
+        return 1;
+    StepParameters missing = pattern.parametersForStep(7);
+    if (!expect(missing.step == 7 && missing.isDefault(), "Expected defaults for a step without an override."))
+        return 1;
+    accent.velocity = 0.75f;
+    pattern.setStepParameters(accent);
+    if (!expect(pattern.parameters().size() == 3 && pattern.parametersForStep(4).velocity == 0.75f,
+                "Expected a second write to replace the override."))
+        return 1;
+    StepParameters reset;
+    reset.step = 4;
+    pattern.setStepParameters(reset);
+    if (!expect(pattern.parameters().size() == 2 && pattern.parametersForStep(4).isDefault(),
+                "Expected writing the defaults to drop the override."))
+        return 1;
+
+    // Published patterns are copied before editing; the copy must not share
+    // storage with the original.
+    StepPattern published = pattern;
+    published.setVersion(1);
+    StepPattern edited = published;
+    edited.setStepNotes(4, {note(30)});
+    edited.setVersion(2);
+    if (!expect(notesOf(published, 4) == std::vector<int>{62} && notesOf(edited, 4) == std::vector<int>{30} &&
+                    published.version() == 1 && edited.version() == 2,
+                "Expected editing a copy to leave the original alone."))
+        return 1;
+
+    // Shrinking the step count drops everything on and after the new end;
+    // growing it again brings back empty steps, not the old notes.
+    pattern.setStepNotes(15, {note(80)});
+    pattern.clearFrom(9);
+    if (!expect(!pattern.stepEnabled(9) && !pattern.stepEnabled(15) && pattern.stepEnabled(4) &&
+                    pattern.events().size() == 1,
+                "Expected a shrink to drop the notes past the end."))
+        return 1;
+    if (!expect(pattern.parameters().size() == 1 && pattern.parameters()[0].step == 2 &&
+                    pattern.parametersForStep(12).isDefault(),
+                "Expected a shrink to drop the overrides past the end."))
+        return 1;
+    pattern.clearFrom(kMaxSequencerSteps);
+    if (!expect(pattern.events().size() == 1 && pattern.parameters().size() == 1,
+                "Expected clearing past the last step to keep everything."))
+        return 1;
+    pattern.clearFrom(0);
+    if (!expect(pattern.events().empty() && pattern.parameters().empty(), "Expected clearing from zero to empty it."))
+        return 1;
+
+    // Memory follows the notes, not the step count: the last possible step
+    // works like any other.
+    pattern.setStepNotes(kMaxSequencerSteps - 1, {note(60)});
+    if (!expect(pattern.events().size() == 1 && pattern.stepEnabled(kMaxSequencerSteps - 1),
+                "Expected the last step to hold notes."))
+        return 1;
+
+    std::cout << "[Test] Step pattern checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <iostream>
+
+// Shared check for the test executables: reports message when condition is
+// false and passes condition through, so a check reads
+// `if (!expect(..., "...")) return 1;`.
+inline bool expect(bool condition, const char* message)
+{
+    if (!condition)
+        std::cerr << "[Test] " << message << std::endl;
+    return condition;
+}
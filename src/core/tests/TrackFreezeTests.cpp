@@ -0,0 +1,114 @@
+#include "core/tests/TestSupport.h"
+#include "core/track_freeze.h"
+#include "core/transport.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+int main()
+{
+    constexpr double kSampleRate = 48000.0;
+
+    FrozenTrackKey key;
+    key.host = reinterpret_cast<const kj::VST3Host*>(&key);
+    key.hostEditGeneration = 3;
+    key.patternVersion = 7;
+    key.stepCount = 16;
+    key.midiChannel = 0;
+    key.bpm = 120.0;
+    key.swing = 0.0;
+    key.sampleRate = kSampleRate;
+
+    // Anything the render depends on drops the freeze when it changes.
+    FrozenTrackKey same = key;
+    if (!expect(same == key, "Expected an unchanged key to keep the freeze."))
+        return 1;
+    FrozenTrackKey changed = key;
+    changed.host = nullptr;
+    if (!expect(changed != key, "Expected a different plug-in to drop the freeze."))
+        return 1;
+    changed = key;
+    changed.hostEditGeneration++;
+    if (!expect(changed != key, "Expected a plug-in edit to drop the freeze."))
+        return 1;
+    changed = key;
+    changed.patternVersion++;
+    if (!expect(changed != key, "Expected a pattern edit to drop the freeze."))
+        return 1;
+    changed = key;
+    changed.stepCount = 32;
+    if (!expect(changed != key, "Expected a new pattern length to drop the freeze."))
+        return 1;
+    changed = key;
+    changed.bpm = 121.0;
+    if (!expect(changed != key, "Expected a tempo change to drop the freeze."))
+        return 1;
+    changed = key;
+    changed.swing = 0.1;
+    if (!expect(changed != key, "Expected a swing change to drop the freeze."))
+        return 1;
+    changed = key;
+    changed.sampleRate = 44100.0;
+    if (!expect(changed != key, "Expected a new sample rate to drop the freeze."))
+        return 1;
+
+    // Straight steps at 120 bpm are a sixteenth, 6000 frames at 48 kHz.
+    const double straight = kSampleRate * 60.0 / (key.bpm * TransportClock::kStepsPerBeat);
+    std::vector<double> starts = computeFrozenStepStarts(key);
+    if (!expect(starts.size() == 17 && std::abs(starts.back() - straight * 16.0) < 1e-6,
+                "Expected straight steps to fill the loop evenly."))
+        return 1;
+
+    // Swing moves the odd steps late without changing the loop length.
+    FrozenTrackKey swung = key;
+    swung.swing = 0.25;
+    starts = computeFrozenStepStarts(swung);
+    for (int step = 0; step + 1 < swung.stepCount; step += 2)
+    {
+        const double even = starts[step + 1] - starts[step];
+        const double odd = starts[step + 2] - starts[step + 1];
+        if (!expect(even > odd && std::abs(even + odd - 2.0 * straight) < 1e-6,
+                    "Expected swing to lengthen even steps and shorten odd ones."))
+            return 1;
+    }
+    if (!expect(std::abs(starts[1] - straight * 1.25) < 1e-6 && std::abs(starts.back() - straight * 16.0) < 1e-6,
+                "Expected swung steps to keep the loop length."))
+        return 1;
+
+    // The plug-in's latency is cut from the front of the render.
+    constexpr std::int64_t kLoopFrames = 8;
+    constexpr std::int64_t kLatency = 3;
+    std::vector<float> stem(static_cast<std::size_t>(kLoopFrames) * 2, 0.0f);
+    std::vector<float> left(static_cast<std::size_t>(kLoopFrames + kLatency));
+    std::vector<float> right(left.size());
+    for (std::size_t i = 0; i < left.size(); ++i)
+    {
+        left[i] = static_cast<float>(i + 1);
+        right[i] = -static_cast<float>(i + 1);
+    }
+    addToFrozenStem(stem, kLoopFrames, kLatency, 0, left.data(), right.data(), static_cast<int>(left.size()));
+    for (std::int64_t i = 0; i < kLoopFrames; ++i)
+    {
+        const auto index = static_cast<std::size_t>(i) * 2;
+        if (!expect(stem[index] == static_cast<float>(i + kLatency + 1) &&
+                        stem[index + 1] == -static_cast<float>(i + kLatency + 1),
+                    "Expected the latency frames to be dropped from the stem."))
+            return 1;
+    }
+
+    // A tail past the loop end rings into the start of the next pass.
+    std::fill(stem.begin(), stem.end(), 0.0f);
+    const float note[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    const float tail[4] = {0.5f, 0.25f, 0.125f, 0.0625f};
+    addToFrozenStem(stem, kLoopFrames, 0, 0, note, note, 4);
+    addToFrozenStem(stem, kLoopFrames, 0, kLoopFrames - 2, tail, tail, 4);
+    if (!expect(stem[12] == 0.5f && stem[14] == 0.25f, "Expected the tail to stay in place before the loop end."))
+        return 1;
+    if (!expect(stem[0] == 1.125f && stem[2] == 1.0625f && stem[4] == 1.0f,
+                "Expected the tail past the loop end to fold onto the start."))
+        return 1;
+
+    std::cout << "[Test] Track freeze checks passed." << std::endl;
+    return 0;
+}
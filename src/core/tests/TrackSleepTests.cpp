@@ -0,0 +1,115 @@
+#include "core/effects/fdn_reverb.h"
+#include "core/tests/TestSupport.h"
+#include "core/track_sleep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+int main()
+{
+    constexpr double kSampleRate = 48000.0;
+    constexpr std::size_t kBlock = 256;
+    const auto settleFrames = static_cast<std::size_t>(TrackSleepMonitor::kSettleSeconds * kSampleRate);
+
+    // A dry track sleeps once its source has been silent for the settle time.
+    TrackSleepMonitor dry;
+    dry.observeSource(0.5, -0.5);
+    for (std::size_t i = 0; i + 1 < settleFrames; ++i)
+        dry.observeSource(0.0, 0.0);
+    if (!expect(!dry.canSleep(true, 0, kSampleRate), "Expected no sleep before the settle time is up."))
+        return 1;
+    dry.observeSource(0.0, 0.0);
+    if (!expect(dry.canSleep(true, 0, kSampleRate), "Expected sleep once the settle time is up."))
+        return 1;
+    if (!expect(!dry.canSleep(false, 0, kSampleRate), "Expected a busy source to keep the track awake."))
+        return 1;
+    if (!expect(!dry.canSleep(true, 1, kSampleRate), "Expected a tail to add to the silence needed."))
+        return 1;
+
+    // A single non-zero frame starts the count over.
+    dry.observeSource(0.0, 1e-9);
+    if (!expect(dry.silentInputFrames() == 0 && !dry.canSleep(true, 0, kSampleRate),
+                "Expected any input to restart the silence count."))
+        return 1;
+
+    // Output above the threshold keeps the track awake for that block only.
+    TrackSleepMonitor loud;
+    for (std::size_t i = 0; i < settleFrames; ++i)
+        loud.observeSource(0.0, 0.0);
+    loud.observeOutput(TrackSleepMonitor::kThreshold * 2.0);
+    if (!expect(!loud.canSleep(true, 0, kSampleRate), "Expected a block over the threshold to keep the track awake."))
+        return 1;
+    loud.endBlock();
+    loud.observeOutput(TrackSleepMonitor::kThreshold * 0.5);
+    if (!expect(loud.canSleep(true, 0, kSampleRate), "Expected a quiet block to let the track sleep."))
+        return 1;
+    loud.reset();
+    if (!expect(loud.silentInputFrames() == 0 && loud.blockPeak() == 0.0 && !loud.canSleep(true, 0, kSampleRate),
+                "Expected reset to forget the silence."))
+        return 1;
+
+    // Run the way the engine does, with a reverb behind a burst of input:
+    // the track must stay awake while the tail is audible, fall asleep
+    // within the tail estimate, and whatever the reverb would still have
+    // played after that has to be below the threshold.
+    FdnReverb reverb(kSampleRate);
+    reverb.setDecay(0.5f);
+    reverb.setDamping(0.0f);
+    reverb.setMix(1.0f);
+    reverb.reset();
+    TrackSleepMonitor wet;
+    std::vector<float> left(kBlock);
+    std::vector<float> right(kBlock);
+    std::size_t frame = 0;
+    std::size_t burstFrames = kBlock * 4;
+    std::size_t sleptAt = 0;
+    double peakWhileAwake = 0.0;
+    while (frame < static_cast<std::size_t>(kSampleRate * 10.0))
+    {
+        for (std::size_t i = 0; i < kBlock; ++i)
+        {
+            float input = frame + i < burstFrames ? (((frame + i) / 7) % 2 ? 0.5f : -0.5f) : 0.0f;
+            left[i] = input;
+            right[i] = input;
+            wet.observeSource(input, input);
+        }
+        reverb.process(left.data(), right.data(), kBlock);
+        for (std::size_t i = 0; i < kBlock; ++i)
+            wet.observeOutput(std::max(std::abs(left[i]), std::abs(right[i])));
+        peakWhileAwake = std::max(peakWhileAwake, wet.blockPeak());
+        frame += kBlock;
+        bool canSleep = wet.canSleep(true, reverb.tailSamples(), kSampleRate);
+        wet.endBlock();
+        if (canSleep)
+        {
+            sleptAt = frame;
+            break;
+        }
+    }
+    if (!expect(sleptAt > burstFrames + reverb.tailSamples() && peakWhileAwake > 0.01,
+                "Expected the reverb tail to keep the track awake."))
+        return 1;
+    if (!expect(sleptAt <= burstFrames + settleFrames + reverb.tailSamples() + kBlock,
+                "Expected the track to sleep once the tail estimate ran out."))
+        return 1;
+
+    double leftover = 0.0;
+    for (std::size_t block = 0; block < static_cast<std::size_t>(kSampleRate) / kBlock; ++block)
+    {
+        std::fill(left.begin(), left.end(), 0.0f);
+        std::fill(right.begin(), right.end(), 0.0f);
+        reverb.process(left.data(), right.data(), kBlock);
+        for (std::size_t i = 0; i < kBlock; ++i)
+            leftover = std::max({leftover, static_cast<double>(std::abs(left[i])), static_cast<double>(std::abs(right[i]))});
+    }
+    if (!expect(leftover <= TrackSleepMonitor::kThreshold, "Expected nothing audible left in the tail after sleeping."))
+    {
+        std::cerr << "[Test] Leftover peak was " << leftover << "." << std::endl;
+        return 1;
+    }
+
+    std::cout << "[Test] Track sleep checks passed." << std::endl;
+    return 0;
+}
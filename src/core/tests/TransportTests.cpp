@@ -0,0 +1,158 @@
+#include "core/tests/TestSupport.h"
+#include "core/transport.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    constexpr double kSampleRate = 48000.0;
+    constexpr int kBlock = 500;
+
+    // Runs whole blocks and returns the absolute frame of every step
+    // boundary in them. restartFrame, if not negative, restarts the grid at
+    // that frame the way a sequencer reset does.
+    std::vector<std::int64_t> run(TransportClock& clock, const TransportTempo& tempo, int blocks,
+                                  std::int64_t& frame, std::int64_t restartFrame = -1)
+    {
+        std::vector<std::int64_t> boundaries;
+        for (int block = 0; block < blocks; ++block)
+        {
+            clock.beginBlock(kBlock, true, tempo);
+            if (restartFrame >= frame && restartFrame < frame + kBlock)
+                clock.restartStepsAt(static_cast<int>(restartFrame - frame));
+            for (std::size_t i = 0; i < clock.stepBoundaryCount(); ++i)
+                boundaries.push_back(frame + clock.stepBoundaryOffset(i));
+            clock.endBlock();
+            frame += kBlock;
+        }
+        return boundaries;
+    }
+
+    bool near(double a, double b, double tolerance = 1e-6)
+    {
+        return std::abs(a - b) <= tolerance;
+    }
+}
+
+int main()
+{
+    // 120 BPM: a sixteenth is 6000 frames, and the grid lands on them
+    // exactly whatever the block size.
+    TransportClock clock;
+    clock.prepare(kSampleRate);
+    TransportTempo straight;
+    straight.bpm = 120.0;
+    std::int64_t frame = 0;
+    auto boundaries = run(clock, straight, 97, frame);
+    if (!expect(boundaries.size() == 8 && boundaries[0] == 6000 && boundaries[7] == 48000,
+                "Expected a step boundary every 6000 frames."))
+        return 1;
+
+    TransportPosition published = transportGetPosition();
+    if (!expect(published.playing && published.samplePosition == 48500 && near(published.beatPosition, 48500.0 / 24000.0) &&
+                    published.step == 8 && published.bar == 0,
+                "Expected the published position at the end of the last block."))
+        return 1;
+    if (!expect(transportPatternStep(published, 16) == 8 && transportPatternStep(published, 3) == 2,
+                "Expected the pattern step to wrap at the pattern length."))
+        return 1;
+
+    // Fractional tempo is kept, not rounded to a whole BPM.
+    TransportClock fractional;
+    fractional.prepare(kSampleRate);
+    TransportTempo odd;
+    odd.bpm = 123.4;
+    frame = 0;
+    boundaries = run(fractional, odd, 200, frame);
+    double stepFrames = kSampleRate * 60.0 / (odd.bpm * TransportClock::kStepsPerBeat);
+    bool onGrid = !boundaries.empty();
+    for (std::size_t i = 0; i < boundaries.size(); ++i)
+        onGrid = onGrid && boundaries[i] == static_cast<std::int64_t>(std::ceil(stepFrames * static_cast<double>(i + 1) - 1e-9));
+    if (!expect(onGrid, "Expected fractional tempo without drift."))
+        return 1;
+
+    // Swing lengthens the even step and shortens the odd one; each pair
+    // still spans an eighth.
+    TransportClock swung;
+    swung.prepare(kSampleRate);
+    TransportTempo swing = straight;
+    swing.swing = 0.5;
+    frame = 0;
+    boundaries = run(swung, swing, 96, frame);
+    if (!expect(boundaries.size() >= 4 && boundaries[0] == 9000 && boundaries[1] == 12000 && boundaries[2] == 21000 &&
+                    boundaries[3] == 24000,
+                "Expected swung sixteenths in eighth-note pairs."))
+        return 1;
+
+    // A tempo change applies from the first step at or after its beat.
+    TransportClock scheduled;
+    scheduled.prepare(kSampleRate);
+    TransportTempo change = straight;
+    change.schedule.changes[0] = TempoChange{1.0, 240.0};
+    change.schedule.count = 1;
+    frame = 0;
+    boundaries = run(scheduled, change, 61, frame);
+    if (!expect(boundaries.size() >= 6 && boundaries[3] == 24000 && boundaries[4] == 27000 && boundaries[5] == 30000,
+                "Expected the new tempo from the step on its beat."))
+        return 1;
+
+    // A sequencer reset restarts the steps, not the timeline: the grid's
+    // origin is the timeline beat of the reset, and scheduled changes still
+    // land on their own beat rather than one counted from the reset.
+    TransportClock restarted;
+    restarted.prepare(kSampleRate);
+    TransportTempo later = straight;
+    later.schedule.changes[0] = TempoChange{6.0, 240.0};
+    later.schedule.count = 1;
+    frame = 0;
+    boundaries = run(restarted, later, 320, frame, 60000);
+    published = transportGetPosition();
+    if (!expect(near(published.stepOriginBeat, 2.5) && near(published.beatPosition, 6.0 + 16000.0 / 12000.0) &&
+                    published.step == 19,
+                "Expected the reset to restart the steps at the timeline beat."))
+        return 1;
+    double stepStartBeat = published.stepOriginBeat + static_cast<double>(published.step) / TransportClock::kStepsPerBeat;
+    if (!expect(stepStartBeat <= published.beatPosition &&
+                    published.beatPosition < stepStartBeat + 1.0 / TransportClock::kStepsPerBeat,
+                "Expected steps and beats to agree after a reset."))
+        return 1;
+    std::vector<std::int64_t> afterReset;
+    for (auto boundary : boundaries)
+    {
+        if (boundary > 60000)
+            afterReset.push_back(boundary);
+    }
+    // Step 14 of the new grid starts on beat 6 (frame 144000); it and every
+    // step after it run at 240 BPM.
+    if (!expect(afterReset.size() >= 16 && afterReset[0] == 66000 && afterReset[13] == 144000 &&
+                    afterReset[14] == 147000 && afterReset[15] == 150000,
+                "Expected the tempo change on its timeline beat after a reset."))
+        return 1;
+
+    // Delay compensation moves the published position back to what is
+    // heard; steps stay on the engine grid.
+    TransportClock compensated;
+    compensated.prepare(kSampleRate);
+    compensated.setLatencyCompensation(2400);
+    frame = 0;
+    run(compensated, straight, 97, frame);
+    published = transportGetPosition();
+    if (!expect(published.samplePosition == 46100 && near(published.beatPosition, 46100.0 / 24000.0) && published.step == 8 &&
+                    published.latencySamples == 2400,
+                "Expected the published position moved back by the compensation."))
+        return 1;
+
+    // Stopping clears the grid; a stopped position has no pattern step.
+    compensated.beginBlock(kBlock, false, straight);
+    compensated.endBlock();
+    published = transportGetPosition();
+    if (!expect(!published.playing && published.samplePosition == 0 && transportPatternStep(published, 16) == -1,
+                "Expected a stopped transport to report no step."))
+        return 1;
+
+    std::cout << "[Test] Transport checks passed." << std::endl;
+    return 0;
+}
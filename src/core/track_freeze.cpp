@@ -0,0 +1,365 @@
+#include "core/track_freeze.h"
+
+#include "core/audio_engine.h"
+#include "core/denormals.h"
+#include "core/sequencer.h"
+#include "core/step_pattern.h"
+#include "core/track_type_midi.h"
+#include "core/track_type_vst.h"
+#include "core/tracks_internal.h"
+#include "hosting/VST3Host.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+using namespace track_internal;
+
+namespace
+{
+
+// Offline renders use large blocks; the plug-in runs with kOffline and may
+// take as long as it needs.
+constexpr int kFreezeBlockSize = 4096;
+constexpr double kMaxTailSeconds = 10.0;
+constexpr double kTailSilenceSeconds = 0.25;
+constexpr double kTailSilenceThreshold = 1.0e-5; // about -100 dB
+
+struct FreezeJob
+{
+    int trackId = 0;
+    std::function<void(bool)> onFinished;
+};
+
+std::mutex gFreezeMutex;
+std::condition_variable gFreezeCv;
+std::deque<FreezeJob> gFreezeJobs;
+std::thread gFreezeThread;
+bool gFreezeStop = false;
+
+bool tempoScheduleActive()
+{
+    return getSequencerTempoSchedule().count > 0;
+}
+
+// Lanes follow the project timeline, which a looped stem cannot; freezing an
+// automated track would bake in the lanes' values at the loop's beats only.
+bool trackHasAutomation(int trackId)
+{
+    auto lanes = trackGetAutomation(trackId);
+    return lanes && std::any_of(lanes->begin(), lanes->end(),
+                                [](const kj::AutomationLane& lane) { return !lane.points.empty(); });
+}
+
+// Key for the track as it is now. Returns false for tracks that cannot be
+// frozen at all.
+bool currentFrozenKey(int trackId, double sampleRate, FrozenTrackKey& key)
+{
+    if (trackGetType(trackId) != TrackType::VST || sampleRate <= 0.0)
+        return false;
+
+    auto host = trackGetVstHost(trackId);
+    if (!host || !host->isPluginLoaded() || trackHasAutomation(trackId))
+        return false;
+
+    auto pattern = trackGetStepPattern(trackId);
+    key.host = host.get();
+    key.hostEditGeneration = host->editGeneration();
+    key.patternVersion = pattern ? pattern->version() : 0;
+    key.stepCount = getSequencerStepCount(trackId);
+    key.midiChannel = std::clamp(trackGetMidiChannel(trackId), 1, 16) - 1;
+    key.bpm = std::clamp(sequencerBPM.load(std::memory_order_relaxed), kSequencerMinBpm, kSequencerMaxBpm);
+    key.swing = std::clamp(sequencerSwing.load(std::memory_order_relaxed), 0.0, kSequencerMaxSwing);
+    key.sampleRate = sampleRate;
+    return true;
+}
+
+void queueNoteOff(kj::VST3Host& host, int channel, int note)
+{
+    Steinberg::Vst::Event ev {};
+    ev.busIndex = 0;
+    ev.sampleOffset = 0;
+    ev.type = Steinberg::Vst::Event::kNoteOffEvent;
+    ev.noteOff.pitch = static_cast<Steinberg::int16>(note);
+    ev.noteOff.velocity = 0.0f;
+    ev.noteOff.channel = static_cast<Steinberg::int16>(channel);
+    ev.noteOff.noteId = -1;
+    host.queueNoteEvent(ev);
+}
+
+void queueNoteOn(kj::VST3Host& host, int channel, int note, float velocity)
+{
+    Steinberg::Vst::Event onEvent {};
+    onEvent.busIndex = 0;
+    onEvent.sampleOffset = 0;
+    onEvent.type = Steinberg::Vst::Event::kNoteOnEvent;
+    onEvent.noteOn.pitch = static_cast<Steinberg::int16>(note);
+    onEvent.noteOn.velocity = velocity;
+    onEvent.noteOn.channel = static_cast<Steinberg::int16>(channel);
+    onEvent.noteOn.noteId = -1;
+    host.queueNoteEvent(onEvent);
+
+    Steinberg::Vst::Event pressureEvent {};
+    pressureEvent.busIndex = 0;
+    pressureEvent.sampleOffset = 0;
+    pressureEvent.type = Steinberg::Vst::Event::kPolyPressureEvent;
+    pressureEvent.polyPressure.pitch = static_cast<Steinberg::int16>(note);
+    pressureEvent.polyPressure.pressure = velocity;
+    pressureEvent.polyPressure.channel = static_cast<Steinberg::int16>(channel);
+    host.queueNoteEvent(pressureEvent);
+}
+
+// Queues the note changes the engine's VST branch sends when the step starts.
+void queueStepNotes(kj::VST3Host& host, int channel, const StepPattern* pattern, int step,
+                    std::vector<int>& activeNotes)
+{
+    StepNoteRange notes = pattern ? pattern->notesForStep(step) : StepNoteRange{};
+    if (notes.empty())
+    {
+        for (int note : activeNotes)
+            queueNoteOff(host, channel, note);
+        activeNotes.clear();
+        return;
+    }
+
+    std::vector<int> present;
+    std::vector<const StepNoteEvent*> noteOns;
+    for (const auto& event : notes)
+    {
+        float velocity = std::clamp(event.velocity, kTrackStepVelocityMin, kTrackStepVelocityMax);
+        if (event.sustain || velocity > 0.0f)
+            present.push_back(std::clamp(event.midiNote, 0, 127));
+        if (!event.sustain && velocity > 0.0f)
+            noteOns.push_back(&event);
+    }
+    std::sort(present.begin(), present.end());
+    present.erase(std::unique(present.begin(), present.end()), present.end());
+
+    for (int note : activeNotes)
+    {
+        if (!std::binary_search(present.begin(), present.end(), note))
+            queueNoteOff(host, channel, note);
+    }
+
+    for (const auto* event : noteOns)
+    {
+        int note = std::clamp(event->midiNote, 0, 127);
+        if (std::find(activeNotes.begin(), activeNotes.end(), note) != activeNotes.end())
+            queueNoteOff(host, channel, note);
+        queueNoteOn(host, channel, note, std::clamp(event->velocity, kTrackStepVelocityMin, kTrackStepVelocityMax));
+    }
+
+    activeNotes = std::move(present);
+}
+
+std::shared_ptr<FrozenTrack> renderFrozenTrack(int trackId, const FrozenTrackKey& key)
+{
+    auto liveHost = trackGetVstHost(trackId);
+    if (!liveHost || liveHost.get() != key.host)
+        return nullptr;
+
+    // Render on a separate instance so the live plug-in keeps playing.
+    auto offline = std::make_shared<kj::VST3Host>();
+    if (!offline->load(liveHost->pluginPath().string()))
+    {
+        std::cerr << "[Freeze] Failed to load plug-in for track " << trackId << std::endl;
+        return nullptr;
+    }
+
+    std::vector<uint8_t> state;
+    if (liveHost->saveState(state) && !state.empty())
+        offline->loadState(state.data(), state.size());
+
+    if (!offline->prepare(key.sampleRate, kFreezeBlockSize, Steinberg::Vst::kOffline))
+    {
+        std::cerr << "[Freeze] Failed to prepare plug-in for offline rendering on track " << trackId << std::endl;
+        return nullptr;
+    }
+
+    auto pattern = trackGetStepPattern(trackId);
+    const std::vector<double> stepStarts = computeFrozenStepStarts(key);
+    const auto loopFrames = static_cast<std::int64_t>(std::ceil(stepStarts.back() - 1e-9));
+    const auto latency = static_cast<std::int64_t>(std::max<Steinberg::int32>(offline->latencySamples(), 0));
+    const auto maxTailFrames = static_cast<std::int64_t>(kMaxTailSeconds * key.sampleRate);
+    const auto silenceFrames = static_cast<std::int64_t>(kTailSilenceSeconds * key.sampleRate);
+    if (loopFrames <= 0)
+        return nullptr;
+
+    auto frozen = std::make_shared<FrozenTrack>();
+    frozen->key = key;
+    frozen->stem.channels = 2;
+    frozen->stem.sampleRate = static_cast<int>(std::lround(key.sampleRate));
+    frozen->stem.samples.assign(static_cast<std::size_t>(loopFrames) * 2, 0.0f);
+    frozen->stepOffsets.resize(static_cast<std::size_t>(key.stepCount));
+    for (int step = 0; step < key.stepCount; ++step)
+        frozen->stepOffsets[static_cast<std::size_t>(step)] =
+            static_cast<std::int64_t>(std::ceil(stepStarts[static_cast<std::size_t>(step)] - 1e-9));
+
+    std::vector<float> left(static_cast<std::size_t>(kFreezeBlockSize), 0.0f);
+    std::vector<float> right(static_cast<std::size_t>(kFreezeBlockSize), 0.0f);
+    std::vector<int> activeNotes;
+
+    std::int64_t frame = 0;
+    int nextStep = 0;
+    std::int64_t lastAudibleFrame = 0;
+    const std::int64_t loopEnd = loopFrames + latency;
+    while (true)
+    {
+        // Step starts (and the note-offs at the loop end) fall on chunk
+        // boundaries, so every event goes out at offset 0.
+        std::int64_t nextEvent = std::numeric_limits<std::int64_t>::max();
+        if (nextStep < key.stepCount)
+        {
+            std::int64_t stepFrame = frozen->stepOffsets[static_cast<std::size_t>(nextStep)];
+            if (stepFrame <= frame)
+            {
+                queueStepNotes(*offline, key.midiChannel, pattern.get(), nextStep, activeNotes);
+                ++nextStep;
+                continue;
+            }
+            nextEvent = stepFrame;
+        }
+        else if (!activeNotes.empty())
+        {
+            if (frame >= loopFrames)
+            {
+                for (int note : activeNotes)
+                    queueNoteOff(*offline, key.midiChannel, note);
+                activeNotes.clear();
+                continue;
+            }
+            nextEvent = loopFrames;
+        }
+
+        if (frame >= loopEnd && (frame - lastAudibleFrame >= silenceFrames || frame - loopEnd >= maxTailFrames))
+            break;
+
+        auto chunk = static_cast<int>(std::min<std::int64_t>(kFreezeBlockSize, nextEvent - frame));
+        kj::VST3Host::HostTransportState transport {};
+        transport.samplePosition = static_cast<double>(frame);
+        transport.tempo = key.bpm;
+        transport.playing = true;
+        offline->setTransportState(transport);
+
+        float* outputs[2] = {left.data(), right.data()};
+        offline->process(outputs, 2, chunk);
+
+        for (int i = 0; i < chunk; ++i)
+        {
+            if (std::max(std::abs(left[static_cast<std::size_t>(i)]), std::abs(right[static_cast<std::size_t>(i)])) >
+                kTailSilenceThreshold)
+                lastAudibleFrame = frame + i;
+        }
+        addToFrozenStem(frozen->stem.samples, loopFrames, latency, frame, left.data(), right.data(), chunk);
+        frame += chunk;
+    }
+
+    offline->unload();
+    return frozen;
+}
+
+void freezeWorkerLoop()
+{
+    ScopedDenormalFlush denormalFlush;
+    while (true)
+    {
+        FreezeJob job;
+        {
+            std::unique_lock<std::mutex> lock(gFreezeMutex);
+            gFreezeCv.wait(lock, [] { return gFreezeStop || !gFreezeJobs.empty(); });
+            if (gFreezeStop)
+                return;
+            job = std::move(gFreezeJobs.front());
+            gFreezeJobs.pop_front();
+        }
+
+        bool success = false;
+        FrozenTrackKey key;
+        if (currentFrozenKey(job.trackId, getAudioEngineSampleRate(), key) && !tempoScheduleActive())
+        {
+            auto frozen = renderFrozenTrack(job.trackId, key);
+            auto track = findTrackData(job.trackId);
+            FrozenTrackKey after;
+            // Drop the render if the track was edited while it ran.
+            if (frozen && track && currentFrozenKey(job.trackId, key.sampleRate, after) && after == key)
+            {
+                std::atomic_store(&track->frozen, std::shared_ptr<const FrozenTrack>(std::move(frozen)));
+                success = true;
+            }
+        }
+
+        if (!success)
+            std::cerr << "[Freeze] Track " << job.trackId << " was not frozen." << std::endl;
+        if (job.onFinished)
+            job.onFinished(success);
+    }
+}
+
+} // namespace
+
+bool requestTrackFreeze(int trackId, std::function<void(bool)> onFinished)
+{
+    FrozenTrackKey key;
+    if (!currentFrozenKey(trackId, getAudioEngineSampleRate(), key))
+        return false;
+    // Tempo changes and odd-length swung loops do not repeat sample-exactly.
+    if (tempoScheduleActive() || (key.swing > 0.0 && key.stepCount % 2 != 0))
+        return false;
+
+    std::lock_guard<std::mutex> lock(gFreezeMutex);
+    if (gFreezeStop)
+        return false;
+    if (!gFreezeThread.joinable())
+        gFreezeThread = std::thread(freezeWorkerLoop);
+    gFreezeJobs.push_back(FreezeJob{trackId, std::move(onFinished)});
+    gFreezeCv.notify_one();
+    return true;
+}
+
+void trackUnfreeze(int trackId)
+{
+    if (auto track = findTrackData(trackId))
+        std::atomic_store(&track->frozen, std::shared_ptr<const FrozenTrack>());
+}
+
+std::shared_ptr<const FrozenTrack> trackGetFrozen(int trackId)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return {};
+
+    auto frozen = std::atomic_load(&track->frozen);
+    if (!frozen)
+        return {};
+
+    FrozenTrackKey key;
+    if (currentFrozenKey(trackId, frozen->key.sampleRate, key) && key == frozen->key && !tempoScheduleActive() &&
+        std::abs(getAudioEngineSampleRate() - frozen->key.sampleRate) < 1e-6)
+        return frozen;
+
+    std::atomic_compare_exchange_strong(&track->frozen, &frozen, std::shared_ptr<const FrozenTrack>());
+    std::cerr << "[Freeze] Track " << trackId << " unfrozen after an edit." << std::endl;
+    return {};
+}
+
+bool trackIsFrozen(int trackId)
+{
+    return trackGetFrozen(trackId) != nullptr;
+}
+
+void shutdownTrackFreeze()
+{
+    {
+        std::lock_guard<std::mutex> lock(gFreezeMutex);
+        gFreezeStop = true;
+        gFreezeJobs.clear();
+    }
+    gFreezeCv.notify_all();
+    if (gFreezeThread.joinable())
+        gFreezeThread.join();
+}
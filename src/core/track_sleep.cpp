@@ -0,0 +1,22 @@
+#include "core/track_sleep.h"
+
+namespace
+{
+constexpr double kDefaultSampleRate = 44100.0;
+}
+
+bool TrackSleepMonitor::canSleep(bool sourceIdle, std::size_t tailFrames, double sampleRate) const noexcept
+{
+    if (!sourceIdle || m_blockPeak > kThreshold)
+        return false;
+
+    double sr = sampleRate > 0.0 ? sampleRate : kDefaultSampleRate;
+    std::size_t settleFrames = static_cast<std::size_t>(kSettleSeconds * sr);
+    return m_silentInputFrames >= settleFrames + tailFrames;
+}
+
+void TrackSleepMonitor::reset() noexcept
+{
+    m_silentInputFrames = 0;
+    m_blockPeak = 0.0;
+}
@@ -1,5 +1,6 @@
 #include "core/track_type_midi.h"
 #include "core/tracks_internal.h"
+#include "core/midi_output.h"
 
 #include <algorithm>
 #include <mutex>
@@ -29,6 +30,7 @@ void trackSetMidiChannel(int trackId, int channel)
     int clamped = std::clamp(channel, kMinMidiChannel, kMaxMidiChannel);
     track->midiChannel.store(clamped, std::memory_order_relaxed);
     track->track.midiChannel = clamped;
+    markTrackSettingsChanged();
 }
 
 int trackGetMidiPort(int trackId)
@@ -67,5 +69,9 @@ void trackSetMidiPort(int trackId, int portId, const std::wstring& portName)
     }
     track->track.midiPort = sanitized;
     track->track.midiPortName = portName;
+    markTrackSettingsChanged();
+
+    // Open the device now so the scheduler never opens it in the dispatch path.
+    midiOutputPreparePort(sanitized);
 }
 
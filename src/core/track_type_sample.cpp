@@ -1,8 +1,16 @@
 #include "core/track_type_sample.h"
 #include "core/tracks.h"
+#include "core/tracks_internal.h"
+
+#include <memory>
+#include <shared_mutex>
+#include <utility>
 
 // Legacy sampler track logic has been moved to track_type_sample_legacy_unused.cpp
-// leaving this active implementation as a no-op while sampler tracks are removed.
+// leaving the envelope controls as no-ops while sampler tracks are removed. The
+// sample buffer itself is still stored, since recorded takes land there.
+
+using namespace track_internal;
 
 float trackGetSampleAttack(int)
 {
@@ -22,11 +30,28 @@ void trackSetSampleRelease(int, float)
 {
 }
 
-std::shared_ptr<const SampleBuffer> trackGetSampleBuffer(int)
+std::shared_ptr<const SampleBuffer> trackGetSampleBuffer(int trackId)
 {
+    std::shared_lock<std::shared_mutex> lock(gTrackMutex);
+    for (const auto& track : gTracks)
+    {
+        if (track->track.id == trackId)
+        {
+            return track->sampleBuffer;
+        }
+    }
     return {};
 }
 
-void trackSetSampleBuffer(int, std::shared_ptr<const SampleBuffer>)
+void trackSetSampleBuffer(int trackId, std::shared_ptr<const SampleBuffer> buffer)
 {
+    std::unique_lock<std::shared_mutex> lock(gTrackMutex);
+    for (auto& track : gTracks)
+    {
+        if (track->track.id == trackId)
+        {
+            track->sampleBuffer = std::move(buffer);
+            return;
+        }
+    }
 }
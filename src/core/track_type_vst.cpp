@@ -6,6 +6,7 @@
 #include <iostream>
 #include <memory>
 #include <shared_mutex>
+#include <utility>
 
 using namespace track_internal;
 
@@ -45,3 +46,38 @@ std::shared_ptr<kj::VST3Host> trackEnsureVstHost(int trackId)
     return {};
 }
 
+
+bool trackPublishVstHost(int trackId, std::shared_ptr<kj::VST3Host> host, std::shared_ptr<kj::VST3Host>& previous)
+{
+    std::unique_lock<std::shared_mutex> lock(gTrackMutex);
+    for (auto& track : gTracks)
+    {
+        if (track->track.id != trackId)
+            continue;
+
+        if (track->type.load(std::memory_order_relaxed) != TrackType::VST)
+            return false;
+
+        if (host)
+            host->setOwningTrackId(trackId);
+        previous = std::move(track->vstHost);
+        track->vstHost = std::move(host);
+        track->track.vstHost = track->vstHost;
+        return true;
+    }
+    return false;
+}
+
+std::shared_ptr<const kj::AutomationLanes> trackGetAutomation(int trackId)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return {};
+    return std::atomic_load(&track->automation);
+}
+
+void trackSetAutomation(int trackId, std::shared_ptr<const kj::AutomationLanes> lanes)
+{
+    if (auto track = findTrackData(trackId))
+        std::atomic_store(&track->automation, std::move(lanes));
+}
@@ -20,6 +20,7 @@ namespace track_internal
 std::vector<std::shared_ptr<TrackData>> gTracks;
 std::shared_mutex gTrackMutex;
 int gNextTrackId = 1;
+std::atomic<std::uint64_t> gTrackSettingsVersion{0};
 
 std::shared_ptr<TrackData> makeTrackData(const std::string& name)
 {
@@ -38,11 +39,17 @@ std::shared_ptr<TrackData> makeTrackData(const std::string& name)
     baseTrack.delayTimeMs = kDefaultDelayTimeMs;
     baseTrack.delayFeedback = kDefaultDelayFeedback;
     baseTrack.delayMix = kDefaultDelayMix;
+    baseTrack.reverbEnabled = false;
+    baseTrack.reverbSize = kDefaultReverbSize;
+    baseTrack.reverbDecaySeconds = kDefaultReverbDecay;
+    baseTrack.reverbDamping = kDefaultReverbDamping;
+    baseTrack.reverbMix = kDefaultReverbMix;
     baseTrack.compressorEnabled = false;
     baseTrack.compressorThresholdDb = kDefaultCompressorThresholdDb;
     baseTrack.compressorRatio = kDefaultCompressorRatio;
     baseTrack.compressorAttack = kDefaultCompressorAttack;
     baseTrack.compressorRelease = kDefaultCompressorRelease;
+    baseTrack.insertOrder = kDefaultInsertOrder;
     baseTrack.sidechainEnabled = false;
     baseTrack.sidechainSourceTrackId = kDefaultSidechainSourceTrack;
     baseTrack.sidechainAmount = kDefaultSidechainAmount;
@@ -89,6 +96,7 @@ void initTracks()
     gTracks.clear();
     gNextTrackId = 1;
     gTracks.push_back(makeTrackData({}));
+    markTrackSettingsChanged();
 }
 
 Track addTrack(const std::string& name)
@@ -99,6 +107,7 @@ Track addTrack(const std::string& name)
         trackData = makeTrackData(name);
         gTracks.push_back(trackData);
     }
+    markTrackSettingsChanged();
     if (!trackData)
     {
         return {};
@@ -136,11 +145,17 @@ std::vector<Track> getTracks()
         info.delayTimeMs = track->delayTimeMs.load(std::memory_order_relaxed);
         info.delayFeedback = track->delayFeedback.load(std::memory_order_relaxed);
         info.delayMix = track->delayMix.load(std::memory_order_relaxed);
+        info.reverbEnabled = track->reverbEnabled.load(std::memory_order_relaxed);
+        info.reverbSize = track->reverbSize.load(std::memory_order_relaxed);
+        info.reverbDecaySeconds = track->reverbDecay.load(std::memory_order_relaxed);
+        info.reverbDamping = track->reverbDamping.load(std::memory_order_relaxed);
+        info.reverbMix = track->reverbMix.load(std::memory_order_relaxed);
         info.compressorEnabled = track->compressorEnabled.load(std::memory_order_relaxed);
         info.compressorThresholdDb = track->compressorThresholdDb.load(std::memory_order_relaxed);
         info.compressorRatio = track->compressorRatio.load(std::memory_order_relaxed);
         info.compressorAttack = track->compressorAttack.load(std::memory_order_relaxed);
         info.compressorRelease = track->compressorRelease.load(std::memory_order_relaxed);
+        info.insertOrder = unpackInsertOrder(track->insertOrder.load(std::memory_order_relaxed));
         info.sidechainEnabled = track->sidechainEnabled.load(std::memory_order_relaxed);
         info.sidechainSourceTrackId = track->sidechainSourceTrackId.load(std::memory_order_relaxed);
         info.sidechainAmount = track->sidechainAmount.load(std::memory_order_relaxed);
@@ -164,6 +179,8 @@ std::vector<Track> getTracks()
             info.lfoSettings[i].shape = track->lfoShape[i].load(std::memory_order_relaxed);
             info.lfoSettings[i].deform = track->lfoDeform[i].load(std::memory_order_relaxed);
         }
+        for (size_t i = 0; i < info.sendLevels.size(); ++i)
+            info.sendLevels[i] = track->sendLevels[i].load(std::memory_order_relaxed);
         info.midiChannel = track->midiChannel.load(std::memory_order_relaxed);
         info.midiPort = track->midiPort.load(std::memory_order_relaxed);
         {
@@ -182,6 +199,11 @@ size_t getTrackCount()
     return gTracks.size();
 }
 
+std::uint64_t getTrackSettingsVersion()
+{
+    return gTrackSettingsVersion.load(std::memory_order_acquire);
+}
+
 void trackSetName(int trackId, const std::string& name)
 {
     std::unique_lock<std::shared_mutex> lock(gTrackMutex);
@@ -194,25 +216,63 @@ void trackSetName(int trackId, const std::string& name)
             {
                 track->track.name = "Track " + std::to_string(track->track.id);
             }
+            markTrackSettingsChanged();
             return;
         }
     }
 }
 
-bool trackGetStepState(int trackId, int stepIndex)
+namespace
 {
-    if (stepIndex < 0 || stepIndex >= kMaxSequencerSteps)
-        return false;
 
+std::shared_ptr<const StepPattern> loadStepPattern(const TrackData& track)
+{
+    return std::atomic_load(&track.stepPattern);
+}
+
+// Copies the current pattern, applies the edit and publishes the copy as a new
+// version. Readers keep whichever version they loaded.
+template <typename Edit>
+void editStepPattern(TrackData& track, Edit&& edit)
+{
+    std::lock_guard<std::mutex> lock(track.noteMutex);
+    auto next = std::make_shared<StepPattern>(*loadStepPattern(track));
+    edit(*next);
+    next->setVersion(++track.stepPatternVersion);
+    std::atomic_store(&track.stepPattern, std::shared_ptr<const StepPattern>(std::move(next)));
+}
+
+std::vector<StepNoteEvent> copyStepNotes(const StepPattern& pattern, int stepIndex)
+{
+    StepNoteRange range = pattern.notesForStep(stepIndex);
+    return std::vector<StepNoteEvent>(range.begin(), range.end());
+}
+
+bool isStepInRange(const TrackData& track, int stepIndex)
+{
+    return stepIndex < track.stepCount.load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+std::shared_ptr<const StepPattern> trackGetStepPattern(int trackId)
+{
     auto track = findTrackData(trackId);
     if (!track)
+        return {};
+    return loadStepPattern(*track);
+}
+
+bool trackGetStepState(int trackId, int stepIndex)
+{
+    if (stepIndex < 0 || stepIndex >= kMaxSequencerSteps)
         return false;
 
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
+    auto track = findTrackData(trackId);
+    if (!track || !isStepInRange(*track, stepIndex))
         return false;
 
-    return track->steps[stepIndex].load(std::memory_order_relaxed);
+    return loadStepPattern(*track)->stepEnabled(stepIndex);
 }
 
 void trackSetStepState(int trackId, int stepIndex, bool enabled)
@@ -221,32 +281,23 @@ void trackSetStepState(int trackId, int stepIndex, bool enabled)
         return;
 
     auto track = findTrackData(trackId);
-    if (!track)
+    if (!track || !isStepInRange(*track, stepIndex))
         return;
 
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
-        return;
-
-    {
-        std::lock_guard<std::mutex> lock(track->noteMutex);
-        auto& notes = track->stepNotes[stepIndex];
+    editStepPattern(*track, [&](StepPattern& pattern) {
         if (!enabled)
         {
-            notes.clear();
+            pattern.setStepNotes(stepIndex, {});
         }
-        else if (notes.empty())
+        else if (!pattern.stepEnabled(stepIndex))
         {
-            int note = track->notes[stepIndex].load(std::memory_order_relaxed);
-            TrackData::StepNoteEntry entry{};
-            entry.midiNote = clampMidiNote(note);
-            entry.velocity = track->stepVelocity[stepIndex].load(std::memory_order_relaxed);
-            entry.sustain = false;
-            notes.push_back(entry);
+            StepParameters parameters = pattern.parametersForStep(stepIndex);
+            StepNoteEvent event{};
+            event.midiNote = clampMidiNote(parameters.lastNote);
+            event.velocity = parameters.velocity;
+            pattern.setStepNotes(stepIndex, {event});
         }
-    }
-
-    track->steps[stepIndex].store(enabled, std::memory_order_relaxed);
+    });
 }
 
 void trackToggleStepState(int trackId, int stepIndex)
@@ -255,14 +306,10 @@ void trackToggleStepState(int trackId, int stepIndex)
         return;
 
     auto track = findTrackData(trackId);
-    if (!track)
+    if (!track || !isStepInRange(*track, stepIndex))
         return;
 
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
-        return;
-
-    bool current = track->steps[stepIndex].load(std::memory_order_relaxed);
+    bool current = loadStepPattern(*track)->stepEnabled(stepIndex);
     trackSetStepState(trackId, stepIndex, !current);
 }
 
@@ -272,23 +319,14 @@ int trackGetStepNote(int trackId, int stepIndex)
         return kDefaultMidiNote;
 
     auto track = findTrackData(trackId);
-    if (!track)
+    if (!track || !isStepInRange(*track, stepIndex))
         return kDefaultMidiNote;
 
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
-        return kDefaultMidiNote;
-
-    int note = track->notes[stepIndex].load(std::memory_order_relaxed);
-    {
-        std::lock_guard<std::mutex> lock(track->noteMutex);
-        const auto& notes = track->stepNotes[stepIndex];
-        if (!notes.empty())
-        {
-            note = notes.front().midiNote;
-        }
-    }
-    return clampMidiNote(note);
+    auto pattern = loadStepPattern(*track);
+    StepNoteRange notes = pattern->notesForStep(stepIndex);
+    if (!notes.empty())
+        return clampMidiNote(notes.begin()->midiNote);
+    return clampMidiNote(pattern->parametersForStep(stepIndex).lastNote);
 }
 
 void trackSetStepNote(int trackId, int stepIndex, int midiNote)
@@ -297,26 +335,20 @@ void trackSetStepNote(int trackId, int stepIndex, int midiNote)
         return;
 
     auto track = findTrackData(trackId);
-    if (!track)
-        return;
-
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
+    if (!track || !isStepInRange(*track, stepIndex))
         return;
 
     int clamped = clampMidiNote(midiNote);
-    track->notes[stepIndex].store(clamped, std::memory_order_relaxed);
-    {
-        std::lock_guard<std::mutex> lock(track->noteMutex);
-        auto& notes = track->stepNotes[stepIndex];
-        notes.clear();
-        TrackData::StepNoteEntry entry{};
-        entry.midiNote = clamped;
-        entry.velocity = track->stepVelocity[stepIndex].load(std::memory_order_relaxed);
-        entry.sustain = false;
-        notes.push_back(entry);
-    }
-    track->steps[stepIndex].store(true, std::memory_order_relaxed);
+    editStepPattern(*track, [&](StepPattern& pattern) {
+        StepParameters parameters = pattern.parametersForStep(stepIndex);
+        parameters.lastNote = clamped;
+        pattern.setStepParameters(parameters);
+
+        StepNoteEvent event{};
+        event.midiNote = clamped;
+        event.velocity = parameters.velocity;
+        pattern.setStepNotes(stepIndex, {event});
+    });
 }
 
 std::vector<int> trackGetStepNotes(int trackId, int stepIndex)
@@ -325,32 +357,17 @@ std::vector<int> trackGetStepNotes(int trackId, int stepIndex)
         return {};
 
     auto track = findTrackData(trackId);
-    if (!track)
-        return {};
-
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
+    if (!track || !isStepInRange(*track, stepIndex))
         return {};
 
+    auto pattern = loadStepPattern(*track);
+    StepNoteRange notes = pattern->notesForStep(stepIndex);
     std::vector<int> result;
+    result.reserve(notes.size());
+    for (const auto& entry : notes)
     {
-        std::lock_guard<std::mutex> lock(track->noteMutex);
-        const auto& entries = track->stepNotes[stepIndex];
-        result.reserve(entries.size());
-        for (const auto& entry : entries)
-        {
-            int clamped = clampMidiNote(entry.midiNote);
-            if (clamped >= kMinMidiNote && clamped <= kMaxMidiNote)
-            {
-                result.push_back(clamped);
-            }
-        }
+        result.push_back(clampMidiNote(entry.midiNote));
     }
-    result.erase(std::remove_if(result.begin(), result.end(), [](int value) {
-        return value < kMinMidiNote || value > kMaxMidiNote;
-    }), result.end());
-    std::sort(result.begin(), result.end());
-    result.erase(std::unique(result.begin(), result.end()), result.end());
     return result;
 }
 
@@ -360,18 +377,14 @@ void trackToggleStepNote(int trackId, int stepIndex, int midiNote)
         return;
 
     auto track = findTrackData(trackId);
-    if (!track)
-        return;
-
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
+    if (!track || !isStepInRange(*track, stepIndex))
         return;
 
     int clamped = clampMidiNote(midiNote);
-    {
-        std::lock_guard<std::mutex> lock(track->noteMutex);
-        auto& notes = track->stepNotes[stepIndex];
-        auto it = std::find_if(notes.begin(), notes.end(), [clamped](const TrackData::StepNoteEntry& entry) {
+    editStepPattern(*track, [&](StepPattern& pattern) {
+        StepParameters parameters = pattern.parametersForStep(stepIndex);
+        auto notes = copyStepNotes(pattern, stepIndex);
+        auto it = std::find_if(notes.begin(), notes.end(), [clamped](const StepNoteEvent& entry) {
             return entry.midiNote == clamped;
         });
         if (it != notes.end())
@@ -380,27 +393,17 @@ void trackToggleStepNote(int trackId, int stepIndex, int midiNote)
         }
         else
         {
-            TrackData::StepNoteEntry entry{};
+            StepNoteEvent entry{};
             entry.midiNote = clamped;
-            entry.velocity = track->stepVelocity[stepIndex].load(std::memory_order_relaxed);
-            entry.sustain = false;
+            entry.velocity = parameters.velocity;
             notes.push_back(entry);
-            std::sort(notes.begin(), notes.end(), [](const TrackData::StepNoteEntry& a, const TrackData::StepNoteEntry& b) {
-                return a.midiNote < b.midiNote;
-            });
         }
 
-        bool enabled = !notes.empty();
-        if (enabled)
-        {
-            track->notes[stepIndex].store(notes.front().midiNote, std::memory_order_relaxed);
-        }
-        else
-        {
-            track->notes[stepIndex].store(kDefaultMidiNote, std::memory_order_relaxed);
-        }
-        track->steps[stepIndex].store(enabled, std::memory_order_relaxed);
-    }
+        pattern.setStepNotes(stepIndex, std::move(notes));
+        StepNoteRange updated = pattern.notesForStep(stepIndex);
+        parameters.lastNote = updated.empty() ? kDefaultMidiNote : updated.begin()->midiNote;
+        pattern.setStepParameters(parameters);
+    });
 }
 
 float trackGetStepVelocity(int trackId, int stepIndex)
@@ -412,7 +415,7 @@ float trackGetStepVelocity(int trackId, int stepIndex)
     if (!track)
         return kTrackStepVelocityMax;
 
-    float value = track->stepVelocity[stepIndex].load(std::memory_order_relaxed);
+    float value = loadStepPattern(*track)->parametersForStep(stepIndex).velocity;
     return std::clamp(value, kTrackStepVelocityMin, kTrackStepVelocityMax);
 }
 
@@ -426,15 +429,20 @@ void trackSetStepVelocity(int trackId, int stepIndex, float value)
         return;
 
     float clamped = std::clamp(value, kTrackStepVelocityMin, kTrackStepVelocityMax);
-    track->stepVelocity[stepIndex].store(clamped, std::memory_order_relaxed);
-    {
-        std::lock_guard<std::mutex> lock(track->noteMutex);
-        auto& notes = track->stepNotes[stepIndex];
+    editStepPattern(*track, [&](StepPattern& pattern) {
+        StepParameters parameters = pattern.parametersForStep(stepIndex);
+        parameters.velocity = clamped;
+        pattern.setStepParameters(parameters);
+
+        auto notes = copyStepNotes(pattern, stepIndex);
+        if (notes.empty())
+            return;
         for (auto& entry : notes)
         {
             entry.velocity = clamped;
         }
-    }
+        pattern.setStepNotes(stepIndex, std::move(notes));
+    });
 }
 
 float trackGetStepNoteVelocity(int trackId, int stepIndex, int midiNote)
@@ -443,24 +451,20 @@ float trackGetStepNoteVelocity(int trackId, int stepIndex, int midiNote)
         return kTrackStepVelocityMax;
 
     auto track = findTrackData(trackId);
-    if (!track)
-        return kTrackStepVelocityMax;
-
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
+    if (!track || !isStepInRange(*track, stepIndex))
         return kTrackStepVelocityMax;
 
     int clampedNote = clampMidiNote(midiNote);
-    float fallback = track->stepVelocity[stepIndex].load(std::memory_order_relaxed);
-    std::lock_guard<std::mutex> lock(track->noteMutex);
-    const auto& notes = track->stepNotes[stepIndex];
-    auto it = std::find_if(notes.begin(), notes.end(), [clampedNote](const TrackData::StepNoteEntry& entry) {
+    auto pattern = loadStepPattern(*track);
+    StepNoteRange notes = pattern->notesForStep(stepIndex);
+    auto it = std::find_if(notes.begin(), notes.end(), [clampedNote](const StepNoteEvent& entry) {
         return entry.midiNote == clampedNote;
     });
     if (it != notes.end())
     {
         return std::clamp(it->velocity, kTrackStepVelocityMin, kTrackStepVelocityMax);
     }
+    float fallback = pattern->parametersForStep(stepIndex).velocity;
     return std::clamp(fallback, kTrackStepVelocityMin, kTrackStepVelocityMax);
 }
 
@@ -470,16 +474,12 @@ std::vector<StepNoteInfo> trackGetStepNoteInfo(int trackId, int stepIndex)
         return {};
 
     auto track = findTrackData(trackId);
-    if (!track)
-        return {};
-
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
+    if (!track || !isStepInRange(*track, stepIndex))
         return {};
 
+    auto pattern = loadStepPattern(*track);
+    StepNoteRange notes = pattern->notesForStep(stepIndex);
     std::vector<StepNoteInfo> result;
-    std::lock_guard<std::mutex> lock(track->noteMutex);
-    const auto& notes = track->stepNotes[stepIndex];
     result.reserve(notes.size());
     for (const auto& entry : notes)
     {
@@ -487,21 +487,8 @@ std::vector<StepNoteInfo> trackGetStepNoteInfo(int trackId, int stepIndex)
         info.midiNote = clampMidiNote(entry.midiNote);
         info.velocity = std::clamp(entry.velocity, kTrackStepVelocityMin, kTrackStepVelocityMax);
         info.sustain = entry.sustain;
-        if (info.midiNote >= kMinMidiNote && info.midiNote <= kMaxMidiNote)
-        {
-            result.push_back(info);
-        }
+        result.push_back(info);
     }
-    std::sort(result.begin(), result.end(), [](const StepNoteInfo& a, const StepNoteInfo& b) {
-        if (a.midiNote != b.midiNote)
-            return a.midiNote < b.midiNote;
-        if (a.sustain != b.sustain)
-            return a.sustain < b.sustain;
-        return a.velocity < b.velocity;
-    });
-    result.erase(std::unique(result.begin(), result.end(), [](const StepNoteInfo& a, const StepNoteInfo& b) {
-        return a.midiNote == b.midiNote;
-    }), result.end());
     return result;
 }
 
@@ -511,17 +498,13 @@ bool trackGetStepNoteSustain(int trackId, int stepIndex, int midiNote)
         return false;
 
     auto track = findTrackData(trackId);
-    if (!track)
-        return false;
-
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
+    if (!track || !isStepInRange(*track, stepIndex))
         return false;
 
     int clampedNote = clampMidiNote(midiNote);
-    std::lock_guard<std::mutex> lock(track->noteMutex);
-    const auto& notes = track->stepNotes[stepIndex];
-    auto it = std::find_if(notes.begin(), notes.end(), [clampedNote](const TrackData::StepNoteEntry& entry) {
+    auto pattern = loadStepPattern(*track);
+    StepNoteRange notes = pattern->notesForStep(stepIndex);
+    auto it = std::find_if(notes.begin(), notes.end(), [clampedNote](const StepNoteEvent& entry) {
         return entry.midiNote == clampedNote;
     });
     if (it != notes.end())
@@ -535,23 +518,20 @@ void trackSetStepNoteSustain(int trackId, int stepIndex, int midiNote, bool sust
         return;
 
     auto track = findTrackData(trackId);
-    if (!track)
-        return;
-
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
+    if (!track || !isStepInRange(*track, stepIndex))
         return;
 
     int clampedNote = clampMidiNote(midiNote);
-    std::lock_guard<std::mutex> lock(track->noteMutex);
-    auto& notes = track->stepNotes[stepIndex];
-    auto it = std::find_if(notes.begin(), notes.end(), [clampedNote](const TrackData::StepNoteEntry& entry) {
-        return entry.midiNote == clampedNote;
-    });
-    if (it != notes.end())
-    {
+    editStepPattern(*track, [&](StepPattern& pattern) {
+        auto notes = copyStepNotes(pattern, stepIndex);
+        auto it = std::find_if(notes.begin(), notes.end(), [clampedNote](const StepNoteEvent& entry) {
+            return entry.midiNote == clampedNote;
+        });
+        if (it == notes.end())
+            return;
         it->sustain = sustain;
-    }
+        pattern.setStepNotes(stepIndex, std::move(notes));
+    });
 }
 
 void trackSetStepNoteVelocity(int trackId, int stepIndex, int midiNote, float value)
@@ -560,28 +540,27 @@ void trackSetStepNoteVelocity(int trackId, int stepIndex, int midiNote, float va
         return;
 
     auto track = findTrackData(trackId);
-    if (!track)
-        return;
-
-    int stepCount = track->stepCount.load(std::memory_order_relaxed);
-    if (stepIndex >= stepCount)
+    if (!track || !isStepInRange(*track, stepIndex))
         return;
 
     int clampedNote = clampMidiNote(midiNote);
     float clampedValue = std::clamp(value, kTrackStepVelocityMin, kTrackStepVelocityMax);
-    std::lock_guard<std::mutex> lock(track->noteMutex);
-    auto& notes = track->stepNotes[stepIndex];
-    auto it = std::find_if(notes.begin(), notes.end(), [clampedNote](const TrackData::StepNoteEntry& entry) {
-        return entry.midiNote == clampedNote;
-    });
-    if (it != notes.end())
-    {
+    editStepPattern(*track, [&](StepPattern& pattern) {
+        auto notes = copyStepNotes(pattern, stepIndex);
+        auto it = std::find_if(notes.begin(), notes.end(), [clampedNote](const StepNoteEvent& entry) {
+            return entry.midiNote == clampedNote;
+        });
+        if (it == notes.end())
+            return;
         it->velocity = clampedValue;
         if (notes.size() == 1)
         {
-            track->stepVelocity[stepIndex].store(clampedValue, std::memory_order_relaxed);
+            StepParameters parameters = pattern.parametersForStep(stepIndex);
+            parameters.velocity = clampedValue;
+            pattern.setStepParameters(parameters);
         }
-    }
+        pattern.setStepNotes(stepIndex, std::move(notes));
+    });
 }
 
 float trackGetStepPan(int trackId, int stepIndex)
@@ -593,7 +572,7 @@ float trackGetStepPan(int trackId, int stepIndex)
     if (!track)
         return 0.0f;
 
-    float value = track->stepPan[stepIndex].load(std::memory_order_relaxed);
+    float value = loadStepPattern(*track)->parametersForStep(stepIndex).pan;
     return std::clamp(value, kTrackStepPanMin, kTrackStepPanMax);
 }
 
@@ -607,7 +586,11 @@ void trackSetStepPan(int trackId, int stepIndex, float value)
         return;
 
     float clamped = std::clamp(value, kTrackStepPanMin, kTrackStepPanMax);
-    track->stepPan[stepIndex].store(clamped, std::memory_order_relaxed);
+    editStepPattern(*track, [&](StepPattern& pattern) {
+        StepParameters parameters = pattern.parametersForStep(stepIndex);
+        parameters.pan = clamped;
+        pattern.setStepParameters(parameters);
+    });
 }
 
 float trackGetStepPitchOffset(int trackId, int stepIndex)
@@ -619,7 +602,7 @@ float trackGetStepPitchOffset(int trackId, int stepIndex)
     if (!track)
         return 0.0f;
 
-    float value = track->stepPitch[stepIndex].load(std::memory_order_relaxed);
+    float value = loadStepPattern(*track)->parametersForStep(stepIndex).pitch;
     return std::clamp(value, kTrackStepPitchMin, kTrackStepPitchMax);
 }
 
@@ -633,7 +616,11 @@ void trackSetStepPitchOffset(int trackId, int stepIndex, float value)
         return;
 
     float clamped = std::clamp(value, kTrackStepPitchMin, kTrackStepPitchMax);
-    track->stepPitch[stepIndex].store(clamped, std::memory_order_relaxed);
+    editStepPattern(*track, [&](StepPattern& pattern) {
+        StepParameters parameters = pattern.parametersForStep(stepIndex);
+        parameters.pitch = clamped;
+        pattern.setStepParameters(parameters);
+    });
 }
 
 int trackGetStepCount(int trackId)
@@ -662,16 +649,8 @@ void trackSetStepCount(int trackId, int count)
         int maxInitialized = track->maxInitializedStepCount.load(std::memory_order_relaxed);
         if (clamped > maxInitialized)
         {
-            std::lock_guard<std::mutex> lock(track->noteMutex);
-            for (int i = maxInitialized; i < clamped; ++i)
-            {
-                track->steps[i].store(false, std::memory_order_relaxed);
-                track->notes[i].store(kDefaultMidiNote, std::memory_order_relaxed);
-                track->stepNotes[i].clear();
-                track->stepVelocity[i].store(kTrackStepVelocityMax, std::memory_order_relaxed);
-                track->stepPan[i].store(0.0f, std::memory_order_relaxed);
-                track->stepPitch[i].store(0.0f, std::memory_order_relaxed);
-            }
+            // Steps past the furthest count ever used start empty.
+            editStepPattern(*track, [maxInitialized](StepPattern& pattern) { pattern.clearFrom(maxInitialized); });
             track->maxInitializedStepCount.store(clamped, std::memory_order_relaxed);
         }
     }
@@ -690,35 +669,39 @@ TrackType trackGetType(int trackId)
 
 void trackSetType(int trackId, TrackType type)
 {
-    std::unique_lock<std::shared_mutex> lock(gTrackMutex);
-    for (auto& track : gTracks)
+    std::shared_ptr<kj::VST3Host> retiredHost;
     {
-        if (track->track.id == trackId)
+        std::unique_lock<std::shared_mutex> lock(gTrackMutex);
+        for (auto& track : gTracks)
         {
-            track->type.store(type, std::memory_order_relaxed);
-            track->track.type = type;
-
-            if (type == TrackType::VST)
+            if (track->track.id == trackId)
             {
-                if (!track->vstHost)
+                track->type.store(type, std::memory_order_relaxed);
+                track->track.type = type;
+
+                if (type == TrackType::VST)
                 {
-                    track->vstHost = std::make_shared<kj::VST3Host>();
-                    std::cout << "VST track initialized" << std::endl;
+                    if (!track->vstHost)
+                    {
+                        track->vstHost = std::make_shared<kj::VST3Host>();
+                        std::cout << "VST track initialized" << std::endl;
+                    }
+                    track->track.vstHost = track->vstHost;
                 }
-                track->track.vstHost = track->vstHost;
-            }
-            else
-            {
-                if (track->vstHost)
+                else
                 {
-                    requestTrackVstUnload(trackId);
+                    retiredHost = std::move(track->vstHost);
+                    track->vstHost.reset();
+                    track->track.vstHost.reset();
                 }
-                track->vstHost.reset();
-                track->track.vstHost.reset();
+                markTrackSettingsChanged();
+                break;
             }
-            return;
         }
     }
+
+    // The plug-in is unloaded on a loader thread once the engine has let go of it.
+    retireVstHost(std::move(retiredHost));
 }
 
 float trackGetVolume(int trackId)
@@ -739,6 +722,7 @@ void trackSetVolume(int trackId, float volume)
 
     float clamped = std::clamp(volume, kMinVolume, kMaxVolume);
     track->volume.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetPan(int trackId)
@@ -759,6 +743,7 @@ void trackSetPan(int trackId, float pan)
 
     float clamped = std::clamp(pan, kMinPan, kMaxPan);
     track->pan.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetEqLowGain(int trackId)
@@ -808,6 +793,7 @@ void trackSetEqLowGain(int trackId, float gainDb)
 
     float clamped = std::clamp(gainDb, kMinEqGainDb, kMaxEqGainDb);
     track->lowGainDb.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 void trackSetEqMidGain(int trackId, float gainDb)
@@ -818,6 +804,7 @@ void trackSetEqMidGain(int trackId, float gainDb)
 
     float clamped = std::clamp(gainDb, kMinEqGainDb, kMaxEqGainDb);
     track->midGainDb.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 void trackSetEqHighGain(int trackId, float gainDb)
@@ -828,6 +815,7 @@ void trackSetEqHighGain(int trackId, float gainDb)
 
     float clamped = std::clamp(gainDb, kMinEqGainDb, kMaxEqGainDb);
     track->highGainDb.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 void trackSetEqEnabled(int trackId, bool enabled)
@@ -837,6 +825,7 @@ void trackSetEqEnabled(int trackId, bool enabled)
         return;
 
     track->eqEnabled.store(enabled, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 bool trackGetDelayEnabled(int trackId)
@@ -855,6 +844,7 @@ void trackSetDelayEnabled(int trackId, bool enabled)
         return;
 
     track->delayEnabled.store(enabled, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetDelayTimeMs(int trackId)
@@ -875,6 +865,7 @@ void trackSetDelayTimeMs(int trackId, float value)
 
     float clamped = std::clamp(value, kMinDelayTimeMs, kMaxDelayTimeMs);
     track->delayTimeMs.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetDelayFeedback(int trackId)
@@ -895,6 +886,7 @@ void trackSetDelayFeedback(int trackId, float value)
 
     float clamped = std::clamp(value, kMinDelayFeedback, kMaxDelayFeedback);
     track->delayFeedback.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetDelayMix(int trackId)
@@ -915,6 +907,130 @@ void trackSetDelayMix(int trackId, float value)
 
     float clamped = std::clamp(value, kMinDelayMix, kMaxDelayMix);
     track->delayMix.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
+}
+
+bool trackGetReverbEnabled(int trackId)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return false;
+
+    return track->reverbEnabled.load(std::memory_order_relaxed);
+}
+
+void trackSetReverbEnabled(int trackId, bool enabled)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return;
+
+    track->reverbEnabled.store(enabled, std::memory_order_relaxed);
+    markTrackSettingsChanged();
+}
+
+float trackGetReverbSize(int trackId)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return kDefaultReverbSize;
+
+    float value = track->reverbSize.load(std::memory_order_relaxed);
+    return std::clamp(value, kMinReverbSize, kMaxReverbSize);
+}
+
+void trackSetReverbSize(int trackId, float value)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return;
+
+    float clamped = std::clamp(value, kMinReverbSize, kMaxReverbSize);
+    track->reverbSize.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
+}
+
+float trackGetReverbDecay(int trackId)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return kDefaultReverbDecay;
+
+    float value = track->reverbDecay.load(std::memory_order_relaxed);
+    return std::clamp(value, kMinReverbDecay, kMaxReverbDecay);
+}
+
+void trackSetReverbDecay(int trackId, float seconds)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return;
+
+    float clamped = std::clamp(seconds, kMinReverbDecay, kMaxReverbDecay);
+    track->reverbDecay.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
+}
+
+float trackGetReverbDamping(int trackId)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return kDefaultReverbDamping;
+
+    float value = track->reverbDamping.load(std::memory_order_relaxed);
+    return std::clamp(value, kMinReverbDamping, kMaxReverbDamping);
+}
+
+void trackSetReverbDamping(int trackId, float value)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return;
+
+    float clamped = std::clamp(value, kMinReverbDamping, kMaxReverbDamping);
+    track->reverbDamping.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
+}
+
+float trackGetReverbMix(int trackId)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return kDefaultReverbMix;
+
+    float value = track->reverbMix.load(std::memory_order_relaxed);
+    return std::clamp(value, kMinReverbMix, kMaxReverbMix);
+}
+
+void trackSetReverbMix(int trackId, float value)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return;
+
+    float clamped = std::clamp(value, kMinReverbMix, kMaxReverbMix);
+    track->reverbMix.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
+}
+
+float trackGetSendLevel(int trackId, int busIndex)
+{
+    auto track = findTrackData(trackId);
+    if (!track || busIndex < 0 || busIndex >= kAuxBusCount)
+        return 0.0f;
+
+    return track->sendLevels[static_cast<size_t>(busIndex)].load(std::memory_order_relaxed);
+}
+
+void trackSetSendLevel(int trackId, int busIndex, float level)
+{
+    auto track = findTrackData(trackId);
+    if (!track || busIndex < 0 || busIndex >= kAuxBusCount)
+        return;
+
+    float clamped = std::isfinite(level) ? std::clamp(level, 0.0f, 1.0f) : 0.0f;
+    track->sendLevels[static_cast<size_t>(busIndex)].store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 bool trackGetCompressorEnabled(int trackId)
@@ -933,6 +1049,7 @@ void trackSetCompressorEnabled(int trackId, bool enabled)
         return;
 
     track->compressorEnabled.store(enabled, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetCompressorThresholdDb(int trackId)
@@ -953,6 +1070,7 @@ void trackSetCompressorThresholdDb(int trackId, float value)
 
     float clamped = std::clamp(value, kMinCompressorThresholdDb, kMaxCompressorThresholdDb);
     track->compressorThresholdDb.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetCompressorRatio(int trackId)
@@ -973,6 +1091,7 @@ void trackSetCompressorRatio(int trackId, float value)
 
     float clamped = std::clamp(value, kMinCompressorRatio, kMaxCompressorRatio);
     track->compressorRatio.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetCompressorAttack(int trackId)
@@ -993,6 +1112,7 @@ void trackSetCompressorAttack(int trackId, float value)
 
     float clamped = std::clamp(value, kMinCompressorAttack, kMaxCompressorAttack);
     track->compressorAttack.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetCompressorRelease(int trackId)
@@ -1013,6 +1133,47 @@ void trackSetCompressorRelease(int trackId, float value)
 
     float clamped = std::clamp(value, kMinCompressorRelease, kMaxCompressorRelease);
     track->compressorRelease.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
+}
+
+InsertOrder trackGetInsertOrder(int trackId)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return kDefaultInsertOrder;
+
+    return unpackInsertOrder(track->insertOrder.load(std::memory_order_relaxed));
+}
+
+void trackSetInsertOrder(int trackId, const InsertOrder& order)
+{
+    auto track = findTrackData(trackId);
+    if (!track || !isValidInsertOrder(order))
+        return;
+
+    track->insertOrder.store(packInsertOrder(order), std::memory_order_relaxed);
+    markTrackSettingsChanged();
+}
+
+bool trackMoveInsert(int trackId, int fromSlot, int toSlot)
+{
+    auto track = findTrackData(trackId);
+    if (!track)
+        return false;
+
+    // Compare-exchange so two moves at once cannot drop an insert.
+    std::uint32_t packed = track->insertOrder.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        InsertOrder order = unpackInsertOrder(packed);
+        if (!moveInsert(order, fromSlot, toSlot))
+            return false;
+        if (track->insertOrder.compare_exchange_weak(packed, packInsertOrder(order), std::memory_order_relaxed))
+        {
+            markTrackSettingsChanged();
+            return true;
+        }
+    }
 }
 
 bool trackGetSidechainEnabled(int trackId)
@@ -1031,6 +1192,7 @@ void trackSetSidechainEnabled(int trackId, bool enabled)
         return;
 
     track->sidechainEnabled.store(enabled, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 int trackGetSidechainSourceTrack(int trackId)
@@ -1049,6 +1211,7 @@ void trackSetSidechainSourceTrack(int trackId, int sourceTrackId)
         return;
 
     track->sidechainSourceTrackId.store(sourceTrackId, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetSidechainAmount(int trackId)
@@ -1069,6 +1232,7 @@ void trackSetSidechainAmount(int trackId, float value)
 
     float clamped = std::clamp(value, kMinSidechainAmount, kMaxSidechainAmount);
     track->sidechainAmount.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetSidechainAttack(int trackId)
@@ -1089,6 +1253,7 @@ void trackSetSidechainAttack(int trackId, float value)
 
     float clamped = std::clamp(value, kMinSynthEnvelopeTime, kMaxSynthEnvelopeTime);
     track->sidechainAttack.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
 float trackGetSidechainRelease(int trackId)
@@ -1109,5 +1274,6 @@ void trackSetSidechainRelease(int trackId, float value)
 
     float clamped = std::clamp(value, kMinSynthEnvelopeTime, kMaxSynthEnvelopeTime);
     track->sidechainRelease.store(clamped, std::memory_order_relaxed);
+    markTrackSettingsChanged();
 }
 
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "core/sequencer.h"
+#include "core/step_pattern.h"
 #include "core/tracks.h"
+#include "hosting/AutomationLane.h"
 
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
@@ -13,6 +16,8 @@
 #include <utility>
 #include <vector>
 
+struct FrozenTrack;
+
 namespace track_internal
 {
 
@@ -31,6 +36,18 @@ inline constexpr float kDefaultDelayFeedback = 0.35f;
 inline constexpr float kMinDelayMix = 0.0f;
 inline constexpr float kMaxDelayMix = 1.0f;
 inline constexpr float kDefaultDelayMix = 0.4f;
+inline constexpr float kMinReverbSize = 0.0f;
+inline constexpr float kMaxReverbSize = 1.0f;
+inline constexpr float kDefaultReverbSize = 0.3f;
+inline constexpr float kMinReverbDecay = 0.1f;
+inline constexpr float kMaxReverbDecay = 10.0f;
+inline constexpr float kDefaultReverbDecay = 1.2f;
+inline constexpr float kMinReverbDamping = 0.0f;
+inline constexpr float kMaxReverbDamping = 1.0f;
+inline constexpr float kDefaultReverbDamping = 0.4f;
+inline constexpr float kMinReverbMix = 0.0f;
+inline constexpr float kMaxReverbMix = 1.0f;
+inline constexpr float kDefaultReverbMix = 0.25f;
 inline constexpr float kMinCompressorThresholdDb = -60.0f;
 inline constexpr float kMaxCompressorThresholdDb = 0.0f;
 inline constexpr float kDefaultCompressorThresholdDb = -12.0f;
@@ -116,11 +133,17 @@ struct TrackData
     std::atomic<float> delayTimeMs{kDefaultDelayTimeMs};
     std::atomic<float> delayFeedback{kDefaultDelayFeedback};
     std::atomic<float> delayMix{kDefaultDelayMix};
+    std::atomic<bool> reverbEnabled{false};
+    std::atomic<float> reverbSize{kDefaultReverbSize};
+    std::atomic<float> reverbDecay{kDefaultReverbDecay};
+    std::atomic<float> reverbDamping{kDefaultReverbDamping};
+    std::atomic<float> reverbMix{kDefaultReverbMix};
     std::atomic<bool> compressorEnabled{false};
     std::atomic<float> compressorThresholdDb{kDefaultCompressorThresholdDb};
     std::atomic<float> compressorRatio{kDefaultCompressorRatio};
     std::atomic<float> compressorAttack{kDefaultCompressorAttack};
     std::atomic<float> compressorRelease{kDefaultCompressorRelease};
+    std::atomic<std::uint32_t> insertOrder{packInsertOrder(kDefaultInsertOrder)};
     std::atomic<bool> sidechainEnabled{false};
     std::atomic<int> sidechainSourceTrackId{kDefaultSidechainSourceTrack};
     std::atomic<float> sidechainAmount{kDefaultSidechainAmount};
@@ -141,22 +164,18 @@ struct TrackData
     std::array<std::atomic<float>, kDefaultLfoRatesHz.size()> lfoRateHz;
     std::array<std::atomic<LfoShape>, kDefaultLfoShapes.size()> lfoShape;
     std::array<std::atomic<float>, kDefaultLfoRatesHz.size()> lfoDeform;
-    std::array<std::atomic<bool>, kMaxSequencerSteps> steps{};
-    std::array<std::atomic<int>, kMaxSequencerSteps> notes{};
-    struct StepNoteEntry
-    {
-        int midiNote = kDefaultMidiNote;
-        float velocity = kTrackStepVelocityMax;
-        bool sustain = false;
-    };
-    std::array<std::vector<StepNoteEntry>, kMaxSequencerSteps> stepNotes{};
-    std::array<std::atomic<float>, kMaxSequencerSteps> stepVelocity{};
-    std::array<std::atomic<float>, kMaxSequencerSteps> stepPan{};
-    std::array<std::atomic<float>, kMaxSequencerSteps> stepPitch{};
+    std::array<std::atomic<float>, kAuxBusCount> sendLevels;
+    // Current pattern; read with std::atomic_load, replaced under noteMutex.
+    std::shared_ptr<const StepPattern> stepPattern;
+    std::uint64_t stepPatternVersion = 0;
     std::atomic<int> stepCount{1};
     std::atomic<int> maxInitializedStepCount{kSequencerStepsPerPage};
     std::shared_ptr<const SampleBuffer> sampleBuffer;
     std::shared_ptr<kj::VST3Host> vstHost;
+    // Offline render used instead of the plug-in; read with std::atomic_load.
+    std::shared_ptr<const FrozenTrack> frozen;
+    // Automation lanes of the plug-in; read with std::atomic_load.
+    std::shared_ptr<const kj::AutomationLanes> automation;
     std::mutex noteMutex;
     std::atomic<int> midiChannel{kDefaultMidiChannel};
     std::atomic<int> midiPort{kDefaultMidiPort};
@@ -184,11 +203,17 @@ inline TrackData::TrackData(Track baseTrack)
     track.delayTimeMs = kDefaultDelayTimeMs;
     track.delayFeedback = kDefaultDelayFeedback;
     track.delayMix = kDefaultDelayMix;
+    track.reverbEnabled = false;
+    track.reverbSize = kDefaultReverbSize;
+    track.reverbDecaySeconds = kDefaultReverbDecay;
+    track.reverbDamping = kDefaultReverbDamping;
+    track.reverbMix = kDefaultReverbMix;
     track.compressorEnabled = false;
     track.compressorThresholdDb = kDefaultCompressorThresholdDb;
     track.compressorRatio = kDefaultCompressorRatio;
     track.compressorAttack = kDefaultCompressorAttack;
     track.compressorRelease = kDefaultCompressorRelease;
+    track.insertOrder = kDefaultInsertOrder;
     track.sidechainEnabled = false;
     track.sidechainSourceTrackId = kDefaultSidechainSourceTrack;
     track.sidechainAmount = kDefaultSidechainAmount;
@@ -225,23 +250,18 @@ inline TrackData::TrackData(Track baseTrack)
         lfoShape[i].store(kDefaultLfoShapes[i], std::memory_order_relaxed);
         lfoDeform[i].store(kDefaultLfoDeform, std::memory_order_relaxed);
     }
-    for (int i = 0; i < kMaxSequencerSteps; ++i)
+    for (auto& level : sendLevels)
+        level.store(0.0f, std::memory_order_relaxed);
+    auto pattern = std::make_shared<StepPattern>();
+    for (int i = 0; i < kSequencerStepsPerPage; i += 4)
     {
-        bool enabled = (i < kSequencerStepsPerPage) ? (i % 4 == 0) : false;
-        steps[i].store(enabled, std::memory_order_relaxed);
-        notes[i].store(kDefaultMidiNote, std::memory_order_relaxed);
-        if (enabled)
-        {
-            StepNoteEntry entry{};
-            entry.midiNote = kDefaultMidiNote;
-            entry.velocity = kTrackStepVelocityMax;
-            entry.sustain = false;
-            stepNotes[i].push_back(entry);
-        }
-        stepVelocity[i].store(kTrackStepVelocityMax, std::memory_order_relaxed);
-        stepPan[i].store(0.0f, std::memory_order_relaxed);
-        stepPitch[i].store(0.0f, std::memory_order_relaxed);
+        StepNoteEvent event{};
+        event.midiNote = kDefaultMidiNote;
+        event.velocity = kTrackStepVelocityMax;
+        pattern->setStepNotes(i, {event});
     }
+    pattern->setVersion(++stepPatternVersion);
+    stepPattern = std::move(pattern);
 }
 
 std::shared_ptr<TrackData> makeTrackData(const std::string& name);
@@ -250,6 +270,14 @@ std::shared_ptr<TrackData> findTrackData(int trackId);
 extern std::vector<std::shared_ptr<TrackData>> gTracks;
 extern std::shared_mutex gTrackMutex;
 extern int gNextTrackId;
+extern std::atomic<std::uint64_t> gTrackSettingsVersion;
+
+// Called by every setter that changes what getTracks() reports, other than
+// the steps; they carry their own pattern version.
+inline void markTrackSettingsChanged()
+{
+    gTrackSettingsVersion.fetch_add(1, std::memory_order_release);
+}
 
 } // namespace track_internal
 
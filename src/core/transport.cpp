@@ -0,0 +1,228 @@
+#include "core/transport.h"
+
+#include "core/seqlock.h"
+#include "core/sequencer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+
+SeqLockValue<TransportPosition> gPublishedPosition{TransportPosition{}};
+
+void updateBar(TransportPosition& position)
+{
+    const double beatsPerBar = static_cast<double>(position.timeSigNum) * 4.0 / static_cast<double>(position.timeSigDen);
+    position.bar = static_cast<std::int32_t>(std::floor(position.beatPosition / beatsPerBar));
+    position.barStartBeat = static_cast<double>(position.bar) * beatsPerBar;
+}
+
+} // namespace
+
+TransportPosition transportGetPosition()
+{
+    return gPublishedPosition.load();
+}
+
+int transportPatternStep(const TransportPosition& position, int stepCount) noexcept
+{
+    if (!position.playing || stepCount <= 0)
+        return -1;
+    return static_cast<int>(position.step % stepCount);
+}
+
+void TransportClock::prepare(double sampleRate)
+{
+    m_sampleRate = sampleRate > 0.0 ? sampleRate : 44100.0;
+    stop();
+}
+
+void TransportClock::stop()
+{
+    m_playing = false;
+    m_blockStartSample = 0;
+    m_blockStartBeat = 0.0;
+    m_blockFrames = 0;
+    m_stepOriginBeat = 0.0;
+    m_step = 0;
+    m_blockStartStep = 0;
+    m_stepStartSample = 0.0;
+    m_stepLength = 0.0;
+    m_boundaryCount = 0;
+}
+
+double TransportClock::tempoForBeat(double beat) const noexcept
+{
+    double tempo = m_tempo;
+    for (std::size_t i = 0; i < m_schedule.count; ++i)
+    {
+        if (m_schedule.changes[i].beat > beat)
+            break;
+        tempo = m_schedule.changes[i].bpm;
+    }
+    return std::clamp(tempo, kSequencerMinBpm, kSequencerMaxBpm);
+}
+
+double TransportClock::beatAfter(double beat, double frames) const noexcept
+{
+    // Walks the scheduled changes inside the span, so the timeline turns
+    // on the same beats as the step grid instead of once per block.
+    const double beatsPerFrameAtOneBpm = 1.0 / (60.0 * m_sampleRate);
+    for (std::size_t i = 0; i < m_schedule.count && frames > 0.0; ++i)
+    {
+        double changeBeat = m_schedule.changes[i].beat;
+        if (changeBeat <= beat)
+            continue;
+        double framesToChange = (changeBeat - beat) / (tempoForBeat(beat) * beatsPerFrameAtOneBpm);
+        if (framesToChange >= frames)
+            break;
+        beat = changeBeat;
+        frames -= framesToChange;
+    }
+    return beat + frames * tempoForBeat(beat) * beatsPerFrameAtOneBpm;
+}
+
+double TransportClock::stepBeat(std::int64_t step) const noexcept
+{
+    return m_stepOriginBeat + static_cast<double>(step) / static_cast<double>(kStepsPerBeat);
+}
+
+double TransportClock::stepLengthSamples(std::int64_t step, double tempo) const noexcept
+{
+    double straight = m_sampleRate * 60.0 / (tempo * static_cast<double>(kStepsPerBeat));
+    // Swing lengthens the on-beat sixteenth and shortens the following one, so
+    // each pair still spans an eighth note.
+    double factor = (step % 2 == 0) ? (1.0 + m_swing) : (1.0 - m_swing);
+    return std::max(1.0, straight * factor);
+}
+
+void TransportClock::beginBlock(int numFrames, bool playing, const TransportTempo& tempo)
+{
+    m_boundaryCount = 0;
+    m_tempo = std::clamp(tempo.bpm, kSequencerMinBpm, kSequencerMaxBpm);
+    m_swing = std::clamp(tempo.swing, 0.0, kSequencerMaxSwing);
+    m_schedule = tempo.schedule;
+
+    if (!playing)
+    {
+        if (m_playing || m_blockStartSample != 0)
+            stop();
+        m_blockFrames = std::max(numFrames, 0);
+        return;
+    }
+
+    if (!m_playing)
+    {
+        stop();
+        m_playing = true;
+        m_stepLength = stepLengthSamples(0, tempoForBeat(stepBeat(0)));
+    }
+
+    m_blockFrames = std::max(numFrames, 0);
+    m_blockStartStep = m_step;
+    computeBoundaries(0);
+}
+
+void TransportClock::computeBoundaries(int fromFrame)
+{
+    const double blockEnd = static_cast<double>(m_blockStartSample + m_blockFrames);
+    while (true)
+    {
+        double boundary = m_stepStartSample + m_stepLength;
+        double boundaryFrame = std::ceil(boundary - 1e-9);
+        if (boundaryFrame >= blockEnd)
+            break;
+
+        int offset = static_cast<int>(boundaryFrame - static_cast<double>(m_blockStartSample));
+        offset = std::max(offset, fromFrame);
+        if (m_boundaryCount < m_boundaryOffsets.size())
+            m_boundaryOffsets[m_boundaryCount++] = offset;
+
+        ++m_step;
+        m_stepStartSample = boundary;
+        m_stepLength = stepLengthSamples(m_step, tempoForBeat(stepBeat(m_step)));
+    }
+}
+
+void TransportClock::restartStepsAt(int frameOffset)
+{
+    if (!m_playing)
+        return;
+
+    frameOffset = std::clamp(frameOffset, 0, m_blockFrames);
+
+    // Drop boundaries that were scheduled from this frame on.
+    std::size_t kept = 0;
+    while (kept < m_boundaryCount && m_boundaryOffsets[kept] < frameOffset)
+        ++kept;
+    m_boundaryCount = kept;
+
+    // The new grid starts where the timeline is, so tempo changes keep
+    // landing on the beat they were scheduled for.
+    m_stepOriginBeat = positionAt(frameOffset).beatPosition;
+    m_step = 0;
+    m_blockStartStep = -static_cast<std::int64_t>(kept);
+    m_stepStartSample = static_cast<double>(m_blockStartSample + frameOffset);
+    m_stepLength = stepLengthSamples(0, tempoForBeat(m_stepOriginBeat));
+    computeBoundaries(frameOffset);
+}
+
+bool TransportClock::isStepBoundary(int frameOffset) const noexcept
+{
+    for (std::size_t i = 0; i < m_boundaryCount; ++i)
+    {
+        if (m_boundaryOffsets[i] == frameOffset)
+            return true;
+        if (m_boundaryOffsets[i] > frameOffset)
+            break;
+    }
+    return false;
+}
+
+TransportPosition TransportClock::positionAt(int frameOffset) const noexcept
+{
+    TransportPosition position{};
+    position.sampleRate = m_sampleRate;
+    position.playing = m_playing;
+    position.tempo = m_tempo;
+    position.timeSigNum = 4;
+    position.timeSigDen = 4;
+    if (!m_playing)
+        return position;
+
+    frameOffset = std::clamp(frameOffset, 0, m_blockFrames);
+    position.samplePosition = m_blockStartSample + frameOffset;
+    position.beatPosition = beatAfter(m_blockStartBeat, static_cast<double>(frameOffset));
+    position.tempo = tempoForBeat(position.beatPosition);
+
+    std::int64_t step = m_blockStartStep;
+    for (std::size_t i = 0; i < m_boundaryCount && m_boundaryOffsets[i] <= frameOffset; ++i)
+        ++step;
+    position.step = std::max<std::int64_t>(step, 0);
+    position.stepOriginBeat = m_stepOriginBeat;
+    updateBar(position);
+    return position;
+}
+
+void TransportClock::endBlock()
+{
+    TransportPosition position = positionAt(m_blockFrames);
+    if (m_playing)
+    {
+        m_blockStartSample += m_blockFrames;
+        m_blockStartBeat = position.beatPosition;
+        m_blockStartStep = m_step;
+    }
+
+    position.latencySamples = m_latencyCompensation;
+    if (m_playing && m_latencyCompensation > 0)
+    {
+        position.samplePosition = std::max<std::int64_t>(position.samplePosition - m_latencyCompensation, 0);
+        position.beatPosition = std::max(0.0, position.beatPosition - static_cast<double>(m_latencyCompensation) *
+                                                                           position.tempo / (60.0 * m_sampleRate));
+        updateBar(position);
+    }
+    gPublishedPosition.store(position);
+}
@@ -0,0 +1,647 @@
+#include "gui/aux_bus_window.h"
+
+#include "core/aux_buses.h"
+#include "core/effects/delay_effect.h"
+#include "core/sequencer.h"
+#include "core/tracks.h"
+#include "gui/gui_main.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <commctrl.h>
+#include <commdlg.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+extern HWND gMainWindow;
+void notifyEffectsWindowTrackValuesChanged(int trackId);
+
+namespace
+{
+
+constexpr wchar_t kAuxBusWindowClassName[] = L"KJAuxBusWindow";
+constexpr int kDefaultWindowWidth = 380;
+constexpr int kDefaultWindowHeight = 580;
+
+constexpr UINT WM_AUX_BUS_SET_TRACK = WM_APP + 140;
+constexpr UINT WM_AUX_BUS_REFRESH_VALUES = WM_APP + 141;
+
+constexpr int kComboDropdownHeight = 160;
+
+HWND gAuxBusWindow = nullptr;
+bool gAuxBusWindowClassRegistered = false;
+
+struct AuxBusWindowState
+{
+    int trackId = 0;
+    // Bus the lower half of the window edits.
+    int busIndex = 0;
+    HWND trackLabel = nullptr;
+    std::array<HWND, kAuxBusCount> sendLabels {};
+    std::array<HWND, kAuxBusCount> sendSliders {};
+    std::array<HWND, kAuxBusCount> sendValueLabels {};
+    HWND busCombo = nullptr;
+    HWND returnLabel = nullptr;
+    HWND returnSlider = nullptr;
+    HWND returnValueLabel = nullptr;
+    HWND delayCheckbox = nullptr;
+    HWND delayTimeLabel = nullptr;
+    HWND delayTimeSlider = nullptr;
+    HWND delayTimeValueLabel = nullptr;
+    HWND feedbackLabel = nullptr;
+    HWND feedbackSlider = nullptr;
+    HWND feedbackValueLabel = nullptr;
+    HWND reverbCheckbox = nullptr;
+    HWND impulseLabel = nullptr;
+    HWND loadImpulseButton = nullptr;
+    HWND clearImpulseButton = nullptr;
+};
+
+const Track* findTrackById(const std::vector<Track>& tracks, int trackId)
+{
+    for (const auto& track : tracks)
+    {
+        if (track.id == trackId)
+            return &track;
+    }
+    return nullptr;
+}
+
+std::wstring toWide(const std::string& value)
+{
+    return std::wstring(value.begin(), value.end());
+}
+
+std::wstring busName(int busIndex)
+{
+    return L"Bus " + std::to_wstring(busIndex + 1);
+}
+
+std::wstring percentText(float value)
+{
+    return std::to_wstring(static_cast<int>(std::lround(value * 100.0f))) + L"%";
+}
+
+AuxBusWindowState* getAuxBusWindowState(HWND hwnd)
+{
+    return reinterpret_cast<AuxBusWindowState*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+}
+
+void auxBusWindowApplyFont(const AuxBusWindowState& state, HFONT font)
+{
+    std::vector<HWND> controls = {
+        state.trackLabel,
+        state.busCombo,
+        state.returnLabel,
+        state.returnSlider,
+        state.returnValueLabel,
+        state.delayCheckbox,
+        state.delayTimeLabel,
+        state.delayTimeSlider,
+        state.delayTimeValueLabel,
+        state.feedbackLabel,
+        state.feedbackSlider,
+        state.feedbackValueLabel,
+        state.reverbCheckbox,
+        state.impulseLabel,
+        state.loadImpulseButton,
+        state.clearImpulseButton,
+    };
+    for (int i = 0; i < kAuxBusCount; ++i)
+    {
+        controls.push_back(state.sendLabels[static_cast<size_t>(i)]);
+        controls.push_back(state.sendSliders[static_cast<size_t>(i)]);
+        controls.push_back(state.sendValueLabels[static_cast<size_t>(i)]);
+    }
+    for (HWND control : controls)
+    {
+        if (control)
+            SendMessageW(control, WM_SETFONT, reinterpret_cast<WPARAM>(font), TRUE);
+    }
+}
+
+void auxBusWindowLayout(HWND hwnd, AuxBusWindowState* state, int width, int height)
+{
+    if (!state)
+        return;
+
+    const int padding = 12;
+    const int labelHeight = 20;
+    const int checkboxHeight = 22;
+    const int sliderHeight = 28;
+    const int labelWidth = 70;
+    const int valueLabelWidth = 60;
+    const int controlSpacing = 6;
+    const int sectionSpacing = 14;
+
+    int contentWidth = std::max(width - padding * 2, 160);
+    int sliderWidth = std::max(60, contentWidth - labelWidth - valueLabelWidth - padding);
+    int currentY = padding;
+
+    auto layoutRow = [&](HWND label, HWND slider, HWND valueLabel)
+    {
+        if (!label || !slider || !valueLabel)
+            return;
+        MoveWindow(label, padding, currentY + 4, labelWidth, labelHeight, TRUE);
+        MoveWindow(slider, padding + labelWidth, currentY, sliderWidth, sliderHeight, TRUE);
+        MoveWindow(valueLabel, padding + labelWidth + sliderWidth + padding, currentY + 4, valueLabelWidth, labelHeight,
+                   TRUE);
+        currentY += sliderHeight + controlSpacing;
+    };
+    auto layoutFullWidth = [&](HWND control, int controlHeight, int spacing)
+    {
+        if (!control)
+            return;
+        MoveWindow(control, padding, currentY, contentWidth, controlHeight, TRUE);
+        currentY += controlHeight + spacing;
+    };
+
+    layoutFullWidth(state->trackLabel, labelHeight, controlSpacing);
+    for (int i = 0; i < kAuxBusCount; ++i)
+    {
+        auto index = static_cast<size_t>(i);
+        layoutRow(state->sendLabels[index], state->sendSliders[index], state->sendValueLabels[index]);
+    }
+    currentY += sectionSpacing;
+
+    if (state->busCombo)
+    {
+        MoveWindow(state->busCombo, padding, currentY, contentWidth, labelHeight + kComboDropdownHeight, TRUE);
+        currentY += labelHeight + 4 + controlSpacing;
+    }
+    layoutRow(state->returnLabel, state->returnSlider, state->returnValueLabel);
+    layoutFullWidth(state->delayCheckbox, checkboxHeight, controlSpacing);
+    layoutRow(state->delayTimeLabel, state->delayTimeSlider, state->delayTimeValueLabel);
+    layoutRow(state->feedbackLabel, state->feedbackSlider, state->feedbackValueLabel);
+    layoutFullWidth(state->reverbCheckbox, checkboxHeight, controlSpacing);
+    layoutFullWidth(state->impulseLabel, labelHeight, controlSpacing);
+    if (state->loadImpulseButton && state->clearImpulseButton)
+    {
+        const int buttonWidth = (contentWidth - padding) / 2;
+        MoveWindow(state->loadImpulseButton, padding, currentY, buttonWidth, checkboxHeight + 4, TRUE);
+        MoveWindow(state->clearImpulseButton, padding * 2 + buttonWidth, currentY, buttonWidth, checkboxHeight + 4,
+                   TRUE);
+    }
+
+    InvalidateRect(hwnd, nullptr, TRUE);
+}
+
+void setSlider(HWND slider, HWND valueLabel, bool enabled, int pos, const std::wstring& text)
+{
+    if (slider)
+    {
+        EnableWindow(slider, enabled ? TRUE : FALSE);
+        SendMessageW(slider, TBM_SETPOS, TRUE, pos);
+    }
+    if (valueLabel)
+        SetWindowTextW(valueLabel, text.c_str());
+}
+
+void auxBusWindowSyncControls(HWND hwnd, AuxBusWindowState* state)
+{
+    if (!state)
+        return;
+
+    auto tracks = getTracks();
+    const Track* track = state->trackId > 0 ? findTrackById(tracks, state->trackId) : nullptr;
+    if (!track)
+    {
+        state->trackId = 0;
+        if (state->trackLabel)
+            SetWindowTextW(state->trackLabel, L"No track selected");
+        for (int i = 0; i < kAuxBusCount; ++i)
+        {
+            auto index = static_cast<size_t>(i);
+            setSlider(state->sendSliders[index], state->sendValueLabels[index], false, 0, L"-");
+        }
+    }
+    else
+    {
+        std::wstring labelText = toWide(track->name);
+        if (labelText.empty())
+            labelText = L"Unnamed Track";
+        labelText += L" - Sends";
+        if (state->trackLabel)
+            SetWindowTextW(state->trackLabel, labelText.c_str());
+        for (int i = 0; i < kAuxBusCount; ++i)
+        {
+            auto index = static_cast<size_t>(i);
+            float level = std::clamp(track->sendLevels[index], 0.0f, 1.0f);
+            setSlider(state->sendSliders[index], state->sendValueLabels[index], true,
+                      static_cast<int>(std::lround(level * 100.0f)), percentText(level));
+        }
+    }
+
+    // The buses are shared, so they stay editable without a track.
+    if (state->busCombo)
+        SendMessageW(state->busCombo, CB_SETCURSEL, static_cast<WPARAM>(state->busIndex), 0);
+    AuxBus bus = auxBusGet(state->busIndex);
+    setSlider(state->returnSlider, state->returnValueLabel, true,
+              static_cast<int>(std::lround(bus.returnLevel * 100.0f)), percentText(bus.returnLevel));
+    if (state->delayCheckbox)
+        SendMessageW(state->delayCheckbox, BM_SETCHECK, bus.delayEnabled ? BST_CHECKED : BST_UNCHECKED, 0);
+    int delayMs = static_cast<int>(std::lround(bus.delayTimeMs));
+    setSlider(state->delayTimeSlider, state->delayTimeValueLabel, bus.delayEnabled, delayMs,
+              std::to_wstring(delayMs) + L" ms");
+    setSlider(state->feedbackSlider, state->feedbackValueLabel, bus.delayEnabled,
+              static_cast<int>(std::lround(bus.delayFeedback * 100.0f)), percentText(bus.delayFeedback));
+    if (state->reverbCheckbox)
+        SendMessageW(state->reverbCheckbox, BM_SETCHECK, bus.reverbEnabled ? BST_CHECKED : BST_UNCHECKED, 0);
+
+    std::filesystem::path impulsePath = auxBusGetReverbImpulsePath(state->busIndex);
+    if (state->impulseLabel)
+    {
+        std::wstring text = impulsePath.empty() ? L"No impulse response" : L"Impulse: " + impulsePath.filename().wstring();
+        SetWindowTextW(state->impulseLabel, text.c_str());
+    }
+    if (state->clearImpulseButton)
+        EnableWindow(state->clearImpulseButton, impulsePath.empty() ? FALSE : TRUE);
+}
+
+// Asks for an impulse response file and gives the bus a reverb built from
+// it. The convolution reverb itself is built off the render thread by the
+// engine's cache updater.
+void chooseImpulseResponse(HWND hwnd, int busIndex)
+{
+    wchar_t fileBuffer[MAX_PATH] = {0};
+    OPENFILENAMEW ofn = {0};
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = hwnd;
+    ofn.lpstrFilter = L"WAV Files\0*.wav\0All Files\0*.*\0";
+    ofn.lpstrFile = fileBuffer;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST;
+    ofn.lpstrDefExt = L"wav";
+
+    if (!GetOpenFileNameW(&ofn))
+        return;
+    if (!auxBusLoadReverbImpulse(busIndex, std::filesystem::path(fileBuffer)))
+    {
+        MessageBoxW(hwnd,
+                    L"Failed to load the selected impulse response.",
+                    L"Load Impulse Response",
+                    MB_OK | MB_ICONERROR);
+    }
+}
+
+HWND createStatic(HWND parent, HINSTANCE instance, const wchar_t* text, DWORD extraStyle = 0)
+{
+    return CreateWindowExW(0,
+                           L"STATIC",
+                           text,
+                           WS_CHILD | WS_VISIBLE | extraStyle,
+                           0,
+                           0,
+                           100,
+                           20,
+                           parent,
+                           nullptr,
+                           instance,
+                           nullptr);
+}
+
+HWND createCheckbox(HWND parent, HINSTANCE instance, const wchar_t* text)
+{
+    return CreateWindowExW(0,
+                           L"BUTTON",
+                           text,
+                           WS_CHILD | WS_VISIBLE | WS_TABSTOP | BS_AUTOCHECKBOX,
+                           0,
+                           0,
+                           140,
+                           22,
+                           parent,
+                           nullptr,
+                           instance,
+                           nullptr);
+}
+
+void createSliderRow(HWND parent,
+                     HINSTANCE instance,
+                     const wchar_t* labelText,
+                     HWND& label,
+                     HWND& slider,
+                     HWND& valueLabel,
+                     int rangeMin,
+                     int rangeMax,
+                     int ticFreq)
+{
+    label = createStatic(parent, instance, labelText);
+    valueLabel = createStatic(parent, instance, L"-", SS_RIGHT);
+    slider = CreateWindowExW(0,
+                             TRACKBAR_CLASSW,
+                             L"",
+                             WS_CHILD | WS_VISIBLE | WS_TABSTOP | TBS_AUTOTICKS,
+                             0,
+                             0,
+                             100,
+                             28,
+                             parent,
+                             nullptr,
+                             instance,
+                             nullptr);
+    if (slider)
+    {
+        SendMessageW(slider, TBM_SETRANGE, TRUE, MAKELPARAM(rangeMin, rangeMax));
+        SendMessageW(slider, TBM_SETTICFREQ, ticFreq, 0);
+    }
+}
+
+void notifyTrackSendsChanged(int trackId)
+{
+    notifyEffectsWindowTrackValuesChanged(trackId);
+    if (gMainWindow && IsWindow(gMainWindow))
+        InvalidateRect(gMainWindow, nullptr, FALSE);
+}
+
+LRESULT CALLBACK AuxBusWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    AuxBusWindowState* state = getAuxBusWindowState(hwnd);
+
+    switch (msg)
+    {
+    case WM_CREATE:
+    {
+        auto* newState = new AuxBusWindowState();
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(newState));
+        state = newState;
+
+        HINSTANCE instance = reinterpret_cast<LPCREATESTRUCT>(lParam)->hInstance;
+
+        state->trackLabel = createStatic(hwnd, instance, L"Sends");
+        for (int i = 0; i < kAuxBusCount; ++i)
+        {
+            auto index = static_cast<size_t>(i);
+            std::wstring label = L"Send " + std::to_wstring(i + 1);
+            createSliderRow(hwnd, instance, label.c_str(), state->sendLabels[index], state->sendSliders[index],
+                            state->sendValueLabels[index], 0, 100, 10);
+        }
+
+        state->busCombo = CreateWindowExW(0,
+                                          WC_COMBOBOXW,
+                                          L"",
+                                          WS_CHILD | WS_VISIBLE | WS_TABSTOP | CBS_DROPDOWNLIST | WS_VSCROLL,
+                                          0,
+                                          0,
+                                          100,
+                                          kComboDropdownHeight,
+                                          hwnd,
+                                          nullptr,
+                                          instance,
+                                          nullptr);
+        for (int i = 0; i < kAuxBusCount; ++i)
+        {
+            std::wstring name = busName(i);
+            SendMessageW(state->busCombo, CB_ADDSTRING, 0, reinterpret_cast<LPARAM>(name.c_str()));
+        }
+
+        createSliderRow(hwnd, instance, L"Return", state->returnLabel, state->returnSlider, state->returnValueLabel, 0,
+                        100, 10);
+        state->delayCheckbox = createCheckbox(hwnd, instance, L"Delay");
+        createSliderRow(hwnd,
+                        instance,
+                        L"Time",
+                        state->delayTimeLabel,
+                        state->delayTimeSlider,
+                        state->delayTimeValueLabel,
+                        static_cast<int>(DelayEffect::kMinDelayTimeMs),
+                        static_cast<int>(DelayEffect::kMaxDelayTimeMs),
+                        100);
+        createSliderRow(hwnd,
+                        instance,
+                        L"Feedback",
+                        state->feedbackLabel,
+                        state->feedbackSlider,
+                        state->feedbackValueLabel,
+                        static_cast<int>(DelayEffect::kMinFeedback * 100.0f),
+                        static_cast<int>(DelayEffect::kMaxFeedback * 100.0f),
+                        10);
+        state->reverbCheckbox = createCheckbox(hwnd, instance, L"Convolution reverb");
+        state->impulseLabel = createStatic(hwnd, instance, L"No impulse response", SS_PATHELLIPSIS);
+        state->loadImpulseButton = CreateWindowExW(0,
+                                                   L"BUTTON",
+                                                   L"Load Impulse...",
+                                                   WS_CHILD | WS_VISIBLE | WS_TABSTOP | BS_PUSHBUTTON,
+                                                   0,
+                                                   0,
+                                                   100,
+                                                   26,
+                                                   hwnd,
+                                                   nullptr,
+                                                   instance,
+                                                   nullptr);
+        state->clearImpulseButton = CreateWindowExW(0,
+                                                    L"BUTTON",
+                                                    L"Clear Impulse",
+                                                    WS_CHILD | WS_VISIBLE | WS_TABSTOP | BS_PUSHBUTTON,
+                                                    0,
+                                                    0,
+                                                    100,
+                                                    26,
+                                                    hwnd,
+                                                    nullptr,
+                                                    instance,
+                                                    nullptr);
+
+        HFONT font = static_cast<HFONT>(GetStockObject(DEFAULT_GUI_FONT));
+        auxBusWindowApplyFont(*state, font);
+
+        RECT client {0, 0, 0, 0};
+        GetClientRect(hwnd, &client);
+        auxBusWindowLayout(hwnd, state, client.right - client.left, client.bottom - client.top);
+        auxBusWindowSyncControls(hwnd, state);
+        return 0;
+    }
+    case WM_SIZE:
+        if (state)
+            auxBusWindowLayout(hwnd, state, LOWORD(lParam), HIWORD(lParam));
+        return 0;
+    case WM_COMMAND:
+        if (!state)
+            break;
+        if (reinterpret_cast<HWND>(lParam) == state->busCombo && HIWORD(wParam) == CBN_SELCHANGE)
+        {
+            auto selection = static_cast<int>(SendMessageW(state->busCombo, CB_GETCURSEL, 0, 0));
+            if (selection >= 0 && selection < kAuxBusCount)
+                state->busIndex = selection;
+            auxBusWindowSyncControls(hwnd, state);
+            return 0;
+        }
+        if (HIWORD(wParam) == BN_CLICKED && reinterpret_cast<HWND>(lParam) == state->loadImpulseButton)
+        {
+            chooseImpulseResponse(hwnd, state->busIndex);
+            auxBusWindowSyncControls(hwnd, state);
+            return 0;
+        }
+        if (HIWORD(wParam) == BN_CLICKED && reinterpret_cast<HWND>(lParam) == state->clearImpulseButton)
+        {
+            auxBusClearReverbImpulse(state->busIndex);
+            auxBusWindowSyncControls(hwnd, state);
+            return 0;
+        }
+        if (HIWORD(wParam) == BN_CLICKED)
+        {
+            HWND control = reinterpret_cast<HWND>(lParam);
+            bool checked = SendMessageW(control, BM_GETCHECK, 0, 0) == BST_CHECKED;
+            if (control == state->delayCheckbox)
+                auxBusSetDelayEnabled(state->busIndex, checked);
+            else if (control == state->reverbCheckbox)
+                auxBusSetReverbEnabled(state->busIndex, checked);
+            else
+                break;
+            auxBusWindowSyncControls(hwnd, state);
+            return 0;
+        }
+        break;
+    case WM_HSCROLL:
+        if (state)
+        {
+            HWND control = reinterpret_cast<HWND>(lParam);
+            if (!control)
+                control = GetFocus();
+            int pos = static_cast<int>(SendMessageW(control, TBM_GETPOS, 0, 0));
+
+            for (int i = 0; i < kAuxBusCount; ++i)
+            {
+                if (control != state->sendSliders[static_cast<size_t>(i)])
+                    continue;
+                if (state->trackId > 0)
+                {
+                    trackSetSendLevel(state->trackId, i, static_cast<float>(pos) / 100.0f);
+                    notifyTrackSendsChanged(state->trackId);
+                }
+                auxBusWindowSyncControls(hwnd, state);
+                return 0;
+            }
+
+            if (control == state->returnSlider)
+                auxBusSetReturnLevel(state->busIndex, static_cast<float>(pos) / 100.0f);
+            else if (control == state->delayTimeSlider)
+                auxBusSetDelayTimeMs(state->busIndex, static_cast<float>(pos));
+            else if (control == state->feedbackSlider)
+                auxBusSetDelayFeedback(state->busIndex, static_cast<float>(pos) / 100.0f);
+            else
+                return 0;
+            auxBusWindowSyncControls(hwnd, state);
+        }
+        return 0;
+    case WM_AUX_BUS_SET_TRACK:
+        if (state)
+        {
+            state->trackId = static_cast<int>(wParam);
+            auxBusWindowSyncControls(hwnd, state);
+        }
+        return 0;
+    case WM_AUX_BUS_REFRESH_VALUES:
+        if (state)
+            auxBusWindowSyncControls(hwnd, state);
+        return 0;
+    case WM_CLOSE:
+        DestroyWindow(hwnd);
+        return 0;
+    case WM_DESTROY:
+    {
+        if (state)
+        {
+            delete state;
+            SetWindowLongPtr(hwnd, GWLP_USERDATA, 0);
+        }
+        if (hwnd == gAuxBusWindow)
+        {
+            gAuxBusWindow = nullptr;
+            requestMainMenuRefresh();
+        }
+        return 0;
+    }
+    }
+
+    return DefWindowProcW(hwnd, msg, wParam, lParam);
+}
+
+void registerAuxBusWindowClass()
+{
+    if (gAuxBusWindowClassRegistered)
+        return;
+
+    WNDCLASSW wc = {0};
+    wc.lpfnWndProc = AuxBusWndProc;
+    wc.hInstance = GetModuleHandle(nullptr);
+    wc.lpszClassName = kAuxBusWindowClassName;
+    wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+    wc.hbrBackground = reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1);
+    if (RegisterClassW(&wc))
+        gAuxBusWindowClassRegistered = true;
+}
+
+} // namespace
+
+void toggleAuxBusWindow(HWND parent)
+{
+    if (isAuxBusWindowOpen())
+    {
+        closeAuxBusWindow();
+        return;
+    }
+
+    registerAuxBusWindowClass();
+    if (!gAuxBusWindowClassRegistered)
+        return;
+
+    RECT parentRect {0, 0, 0, 0};
+    if (parent && IsWindow(parent))
+        GetWindowRect(parent, &parentRect);
+
+    int x = CW_USEDEFAULT;
+    int y = CW_USEDEFAULT;
+    if (parentRect.right > parentRect.left && parentRect.bottom > parentRect.top)
+    {
+        x = parentRect.left + 80;
+        y = parentRect.top + 80;
+    }
+
+    HWND hwnd = CreateWindowExW(WS_EX_TOOLWINDOW,
+                                kAuxBusWindowClassName,
+                                L"Sends & Aux Buses",
+                                WS_OVERLAPPEDWINDOW,
+                                x,
+                                y,
+                                kDefaultWindowWidth,
+                                kDefaultWindowHeight,
+                                parent,
+                                nullptr,
+                                GetModuleHandle(nullptr),
+                                nullptr);
+    if (hwnd)
+    {
+        gAuxBusWindow = hwnd;
+        ShowWindow(hwnd, SW_SHOW);
+        UpdateWindow(hwnd);
+        PostMessageW(hwnd, WM_AUX_BUS_SET_TRACK, static_cast<WPARAM>(getActiveSequencerTrackId()), 0);
+        requestMainMenuRefresh();
+    }
+}
+
+void closeAuxBusWindow()
+{
+    if (gAuxBusWindow && IsWindow(gAuxBusWindow))
+        DestroyWindow(gAuxBusWindow);
+}
+
+bool isAuxBusWindowOpen()
+{
+    return gAuxBusWindow && IsWindow(gAuxBusWindow);
+}
+
+void notifyAuxBusWindowTrackChanged(int trackId)
+{
+    if (isAuxBusWindowOpen())
+        PostMessageW(gAuxBusWindow, WM_AUX_BUS_SET_TRACK, static_cast<WPARAM>(trackId), 0);
+}
+
+void notifyAuxBusWindowValuesChanged()
+{
+    if (isAuxBusWindowOpen())
+        PostMessageW(gAuxBusWindow, WM_AUX_BUS_REFRESH_VALUES, 0, 0);
+}
@@ -4,14 +4,18 @@
 #include "core/sequencer.h"
 #include "core/midi_ports.h"
 #include "core/tracks.h"
+#include "core/track_freeze.h"
 #include "core/track_type_midi.h"
 #include "core/track_type_sample.h"
 #include "core/track_type_synth.h"
 #include "core/track_type_vst.h"
+#include "core/transport.h"
 #include "gui/gui_refresh.h"
 #include "gui/menu_commands.h"
 #include "gui/compressor_window.h"
+#include "gui/aux_bus_window.h"
 #include "gui/mod_matrix_window.h"
+#include "gui/retained_widget_layer.h"
 #include "gui/waveform_window.h"
 #include "hosting/VSTGuiThread.h"
 #include "wdl/lice/lice.h"
@@ -32,6 +36,9 @@
 #include <atomic>
 #include <filesystem>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <memory>
@@ -58,6 +65,8 @@ HWND gEqWindow = nullptr;
 bool gEqWindowClassRegistered = false;
 HWND gDelayWindow = nullptr;
 bool gDelayWindowClassRegistered = false;
+HWND gReverbWindow = nullptr;
+bool gReverbWindowClassRegistered = false;
 
 namespace {
 
@@ -116,6 +125,13 @@ std::string formatDelayPercentValue(float value)
     return stream.str();
 }
 
+std::string formatReverbDecayValue(float seconds)
+{
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(1) << seconds << " s";
+    return stream.str();
+}
+
 std::string formatNormalizedValue(float value)
 {
     std::ostringstream stream;
@@ -240,9 +256,12 @@ void notifyEqWindowTrackChanged(int trackId);
 void notifyEqWindowValuesChanged(int trackId);
 void notifyDelayWindowTrackChanged(int trackId);
 void notifyDelayWindowValuesChanged(int trackId);
+void notifyReverbWindowTrackChanged(int trackId);
+void notifyReverbWindowValuesChanged(int trackId);
 void openSidechainWindow(HWND parent, int trackId);
 void openEqWindow(HWND parent, int trackId);
 void openDelayWindow(HWND parent, int trackId);
+void openReverbWindow(HWND parent, int trackId);
 
 constexpr UINT kMenuCommandLoadProject = 1001;
 constexpr UINT kMenuCommandSaveProject = 1002;
@@ -326,6 +345,8 @@ constexpr UINT WM_DELAY_SET_TRACK = WM_APP + 21;
 constexpr UINT WM_SIDECHAIN_REFRESH_VALUES = WM_APP + 30;
 constexpr UINT WM_SIDECHAIN_SET_TRACK = WM_APP + 31;
 constexpr UINT WM_SIDECHAIN_RELOAD_TRACKS = WM_APP + 32;
+constexpr UINT WM_REVERB_REFRESH_VALUES = WM_APP + 40;
+constexpr UINT WM_REVERB_SET_TRACK = WM_APP + 41;
 
 struct PianoRollLayout
 {
@@ -867,6 +888,8 @@ void pianoRollApplyMenuParameter(int parameterIndex,
 } // namespace
 
 std::unique_ptr<LICE_SysBitmap> gSurface;
+bool gSurfaceNeedsFullRender = true;
+std::uint64_t gMainWindowChromeVersion = 0;
 
 struct AudioDeviceDropdownOption
 {
@@ -937,6 +960,8 @@ constexpr float kMixerDelayFeedbackMin = 0.0f;
 constexpr float kMixerDelayFeedbackMax = 0.95f;
 constexpr float kMixerDelayMixMin = 0.0f;
 constexpr float kMixerDelayMixMax = 1.0f;
+constexpr float kMixerReverbDecayMin = 0.1f;
+constexpr float kMixerReverbDecayMax = 10.0f;
 constexpr float kSynthFormantMin = 0.0f;
 constexpr float kSynthFormantMax = 1.0f;
 constexpr float kSynthResonanceMin = 0.0f;
@@ -1007,7 +1032,7 @@ inline LICE_pixel LICE_ColorFromCOLORREF(COLORREF color, int alpha = 255)
     return LICE_RGBA(GetRValue(color), GetGValue(color), GetBValue(color), alpha);
 }
 
-void drawText(LICE_SysBitmap& surface, const RECT& rect, const char* text, COLORREF color,
+void drawText(LICE_IBitmap& surface, const RECT& rect, const char* text, COLORREF color,
               UINT format = DT_CENTER | DT_VCENTER | DT_SINGLELINE)
 {
     if (!text)
@@ -1367,10 +1392,15 @@ void ensureSurfaceSize(int width, int height)
     if (!gSurface)
     {
         gSurface = std::make_unique<LICE_SysBitmap>(width, height);
+        gSurfaceNeedsFullRender = true;
         return;
     }
 
-    gSurface->resize(width, height);
+    if (gSurface->getWidth() != width || gSurface->getHeight() != height)
+    {
+        gSurface->resize(width, height);
+        gSurfaceNeedsFullRender = true;
+    }
 }
 
 void closePianoRollWindow()
@@ -1406,6 +1436,8 @@ void showLoadProjectDialog(HWND hwnd)
                         MB_OK | MB_ICONERROR);
             return;
         }
+        CheckMenuRadioItem(GetMenu(hwnd), kMenuCommandPanLawConstantPower, kMenuCommandPanLawLinear,
+                           kMenuCommandPanLawConstantPower + static_cast<int>(getPanLaw()), MF_BYCOMMAND);
 
         auto tracks = getTracks();
         if (!tracks.empty())
@@ -1434,6 +1466,7 @@ void showLoadProjectDialog(HWND hwnd)
             notifyEffectsWindowTrackValuesChanged(selectedTrackId);
         }
 
+        notifyAuxBusWindowValuesChanged();
         invalidatePianoRollWindow();
         if (hwnd && IsWindow(hwnd))
         {
@@ -1483,6 +1516,82 @@ void showSaveProjectDialog(HWND hwnd)
     }
 }
 
+void freezeActiveTrack(HWND hwnd)
+{
+    int trackId = getActiveSequencerTrackId();
+    if (!requestTrackFreeze(trackId))
+    {
+        MessageBoxW(hwnd,
+                    L"Only plug-in tracks without automation can be frozen, and not while a tempo change "
+                    L"is scheduled or swing is used with an odd number of steps.",
+                    L"Freeze Track",
+                    MB_OK | MB_ICONWARNING);
+    }
+}
+
+// Starts recording the audio input into the active sample track, asking
+// where to keep the take, or stops the take in progress.
+void toggleActiveTrackRecording(HWND hwnd)
+{
+    if (isTrackRecording())
+    {
+        if (!stopTrackRecording())
+        {
+            MessageBoxW(hwnd,
+                        L"The take could not be saved.",
+                        L"Record Input",
+                        MB_OK | MB_ICONERROR);
+        }
+    }
+    else
+    {
+        int trackId = getActiveSequencerTrackId();
+        if (trackId <= 0 || trackGetType(trackId) != TrackType::Sample)
+        {
+            MessageBoxW(hwnd,
+                        L"Select a sample track to record into.",
+                        L"Record Input",
+                        MB_OK | MB_ICONWARNING);
+            return;
+        }
+
+        wchar_t fileBuffer[MAX_PATH] = {0};
+        OPENFILENAMEW ofn = {0};
+        ofn.lStructSize = sizeof(ofn);
+        ofn.hwndOwner = hwnd;
+        ofn.lpstrFilter = L"WAV Files (*.wav)\0*.wav\0CAF Files (*.caf)\0*.caf\0";
+        ofn.lpstrFile = fileBuffer;
+        ofn.nMaxFile = MAX_PATH;
+        ofn.Flags = OFN_OVERWRITEPROMPT | OFN_PATHMUSTEXIST;
+        ofn.lpstrDefExt = L"wav";
+        if (!GetSaveFileNameW(&ofn))
+            return;
+
+        if (!startTrackRecording(trackId, std::filesystem::path(fileBuffer)))
+        {
+            MessageBoxW(hwnd,
+                        L"Recording could not start. Check that an audio input is available.",
+                        L"Record Input",
+                        MB_OK | MB_ICONERROR);
+        }
+    }
+}
+
+// Check marks of the Track menu items that follow engine state or the active
+// track, refreshed whenever the menu opens.
+void updateTrackMenuChecks(HMENU menu)
+{
+    CheckMenuItem(menu, kMenuCommandRecordInput, MF_BYCOMMAND | (isTrackRecording() ? MF_CHECKED : MF_UNCHECKED));
+    CheckMenuItem(menu, kMenuCommandToggleInputMonitoring,
+                  MF_BYCOMMAND | (inputMonitoringEnabled() ? MF_CHECKED : MF_UNCHECKED));
+
+    int trackId = getActiveSequencerTrackId();
+    bool pluginTrack = trackId > 0 && trackGetType(trackId) == TrackType::VST;
+    EnableMenuItem(menu, kMenuCommandToggleAutomationRecording, MF_BYCOMMAND | (pluginTrack ? MF_ENABLED : MF_GRAYED));
+    CheckMenuItem(menu, kMenuCommandToggleAutomationRecording,
+                  MF_BYCOMMAND | (pluginTrack && trackAutomationRecording(trackId) ? MF_CHECKED : MF_UNCHECKED));
+}
+
 LRESULT CALLBACK PianoRollWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
     switch (msg)
@@ -2066,7 +2175,7 @@ LRESULT CALLBACK PianoRollWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPa
             DeleteObject(disabledBrush);
         }
 
-        int playingStep = sequencerCurrentStep.load(std::memory_order_relaxed);
+        int playingStep = transportPatternStep(transportGetPosition(), totalSteps);
         if (playingStep >= startStep && playingStep < endStep)
         {
             int column = playingStep - startStep;
@@ -2549,6 +2658,8 @@ enum
     kEffectsVolumeToggleId = 1010,
     kEffectsPanToggleId = 1011,
     kEffectsListViewId = 1050,
+    kEffectsMoveInsertUpId = 1051,
+    kEffectsMoveInsertDownId = 1052,
 };
 
 enum class EffectListItemType
@@ -2556,6 +2667,7 @@ enum class EffectListItemType
     Eq,
     Delay,
     Compressor,
+    Reverb,
     Sidechain,
 };
 
@@ -2588,6 +2700,47 @@ EffectsWindowState* getEffectsWindowState(HWND hwnd)
     return reinterpret_cast<EffectsWindowState*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
 }
 
+EffectListEntry effectListEntryForInsert(InsertEffect effect)
+{
+    switch (effect)
+    {
+    case InsertEffect::Equalizer:
+        return {EffectListItemType::Eq, L"Equalizer"};
+    case InsertEffect::Compressor:
+        return {EffectListItemType::Compressor, L"Compressor"};
+    case InsertEffect::Delay:
+        return {EffectListItemType::Delay, L"Delay"};
+    case InsertEffect::Reverb:
+        return {EffectListItemType::Reverb, L"Reverb"};
+    }
+    return {EffectListItemType::Eq, L"Equalizer"};
+}
+
+// The first rows of the effect list are the track's inserts in processing
+// order; the sidechain row stays below them.
+void effectsWindowApplyInsertOrder(EffectsWindowState* state, const InsertOrder& order)
+{
+    if (!state)
+        return;
+
+    for (size_t slot = 0; slot < order.size() && slot < state->effectEntries.size(); ++slot)
+    {
+        EffectListEntry entry = effectListEntryForInsert(order[slot]);
+        if (state->effectEntries[slot].type == entry.type)
+            continue;
+        state->effectEntries[slot] = entry;
+        if (!state->effectList)
+            continue;
+
+        LVITEMW item {0};
+        item.mask = LVIF_TEXT | LVIF_PARAM;
+        item.iItem = static_cast<int>(slot);
+        item.pszText = const_cast<LPWSTR>(state->effectEntries[slot].name.c_str());
+        item.lParam = static_cast<LPARAM>(static_cast<int>(entry.type));
+        ListView_SetItem(state->effectList, &item);
+    }
+}
+
 void effectsWindowApplyFont(const EffectsWindowState& state, HFONT font)
 {
     const HWND controls[] = {
@@ -2784,11 +2937,13 @@ void effectsWindowSyncControls(HWND hwnd, EffectsWindowState* state)
             fallbackTrack.delayTimeMs = trackGetDelayTimeMs(state->selectedTrackId);
             fallbackTrack.delayFeedback = trackGetDelayFeedback(state->selectedTrackId);
             fallbackTrack.delayMix = trackGetDelayMix(state->selectedTrackId);
+            fallbackTrack.reverbEnabled = trackGetReverbEnabled(state->selectedTrackId);
             fallbackTrack.compressorEnabled = trackGetCompressorEnabled(state->selectedTrackId);
             fallbackTrack.compressorThresholdDb = trackGetCompressorThresholdDb(state->selectedTrackId);
             fallbackTrack.compressorRatio = trackGetCompressorRatio(state->selectedTrackId);
             fallbackTrack.compressorAttack = trackGetCompressorAttack(state->selectedTrackId);
             fallbackTrack.compressorRelease = trackGetCompressorRelease(state->selectedTrackId);
+            fallbackTrack.insertOrder = trackGetInsertOrder(state->selectedTrackId);
             fallbackTrack.formant = trackGetSynthFormant(state->selectedTrackId);
             fallbackTrack.resonance = trackGetSynthResonance(state->selectedTrackId);
             fallbackTrack.feedback = trackGetSynthFeedback(state->selectedTrackId);
@@ -2833,6 +2988,7 @@ void effectsWindowSyncControls(HWND hwnd, EffectsWindowState* state)
         {
             EnableWindow(state->effectList, TRUE);
             state->effectListUpdating = true;
+            effectsWindowApplyInsertOrder(state, trackPtr->insertOrder);
             for (size_t i = 0; i < state->effectEntries.size(); ++i)
             {
                 bool checked = false;
@@ -2847,6 +3003,9 @@ void effectsWindowSyncControls(HWND hwnd, EffectsWindowState* state)
                 case EffectListItemType::Compressor:
                     checked = trackPtr->compressorEnabled;
                     break;
+                case EffectListItemType::Reverb:
+                    checked = trackPtr->reverbEnabled;
+                    break;
                 case EffectListItemType::Sidechain:
                     checked = trackPtr->sidechainEnabled;
                     break;
@@ -4373,6 +4532,447 @@ void notifyDelayWindowValuesChanged(int trackId)
     }
 }
 
+struct ReverbWindowState
+{
+    int trackId = 0;
+    HWND trackLabel = nullptr;
+    HWND enableCheckbox = nullptr;
+    HWND sizeSlider = nullptr;
+    HWND sizeValueLabel = nullptr;
+    HWND decaySlider = nullptr;
+    HWND decayValueLabel = nullptr;
+    HWND dampingSlider = nullptr;
+    HWND dampingValueLabel = nullptr;
+    HWND mixSlider = nullptr;
+    HWND mixValueLabel = nullptr;
+};
+
+ReverbWindowState* getReverbWindowState(HWND hwnd)
+{
+    return reinterpret_cast<ReverbWindowState*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+}
+
+void reverbWindowApplyFont(const ReverbWindowState& state, HFONT font)
+{
+    const HWND controls[] = {
+        state.trackLabel,
+        state.enableCheckbox,
+        state.sizeSlider,
+        state.sizeValueLabel,
+        state.decaySlider,
+        state.decayValueLabel,
+        state.dampingSlider,
+        state.dampingValueLabel,
+        state.mixSlider,
+        state.mixValueLabel,
+    };
+    for (HWND control : controls)
+    {
+        if (control)
+            SendMessageW(control, WM_SETFONT, reinterpret_cast<WPARAM>(font), TRUE);
+    }
+}
+
+void reverbWindowLayout(HWND hwnd, ReverbWindowState* state, int width, int height)
+{
+    if (!state)
+        return;
+
+    const int padding = 12;
+    const int headerHeight = 24;
+    const int sliderHeight = 32;
+    const int controlSpacing = 12;
+    const int valueLabelWidth = 100;
+
+    int currentY = padding;
+
+    if (state->trackLabel)
+    {
+        MoveWindow(state->trackLabel, padding, currentY, width - padding * 2, headerHeight, TRUE);
+        currentY += headerHeight + controlSpacing;
+    }
+
+    if (state->enableCheckbox)
+    {
+        MoveWindow(state->enableCheckbox, padding, currentY, width - padding * 2, headerHeight, TRUE);
+        currentY += headerHeight + controlSpacing;
+    }
+
+    auto layoutSlider = [&](HWND slider, HWND valueLabel)
+    {
+        if (!slider)
+            return;
+        int sliderWidth = std::max(100, width - padding * 3 - valueLabelWidth);
+        MoveWindow(slider, padding, currentY, sliderWidth, sliderHeight, TRUE);
+        if (valueLabel)
+        {
+            MoveWindow(valueLabel,
+                       padding + sliderWidth + padding,
+                       currentY,
+                       valueLabelWidth,
+                       sliderHeight,
+                       TRUE);
+        }
+        currentY += sliderHeight + controlSpacing;
+    };
+
+    layoutSlider(state->sizeSlider, state->sizeValueLabel);
+    layoutSlider(state->decaySlider, state->decayValueLabel);
+    layoutSlider(state->dampingSlider, state->dampingValueLabel);
+    layoutSlider(state->mixSlider, state->mixValueLabel);
+}
+
+void reverbWindowSyncControls(HWND hwnd, ReverbWindowState* state)
+{
+    if (!state)
+        return;
+
+    int trackId = state->trackId;
+    if (trackId <= 0)
+    {
+        if (state->trackLabel)
+            SetWindowTextW(state->trackLabel, L"No track selected");
+        if (state->enableCheckbox)
+            EnableWindow(state->enableCheckbox, FALSE);
+        const HWND sliders[] = {state->sizeSlider, state->decaySlider, state->dampingSlider, state->mixSlider};
+        const HWND labels[] = {state->sizeValueLabel, state->decayValueLabel, state->dampingValueLabel, state->mixValueLabel};
+        for (HWND slider : sliders)
+        {
+            if (slider)
+            {
+                EnableWindow(slider, FALSE);
+                SendMessageW(slider, TBM_SETPOS, TRUE, 0);
+            }
+        }
+        for (HWND label : labels)
+        {
+            if (label)
+                SetWindowTextW(label, L"-");
+        }
+        return;
+    }
+
+    Track fallbackTrack {};
+    const Track* trackPtr = nullptr;
+    auto tracks = getTracks();
+    trackPtr = findTrackById(tracks, trackId);
+    if (!trackPtr)
+    {
+        fallbackTrack.id = trackId;
+        fallbackTrack.name = "Track " + std::to_string(trackId);
+        fallbackTrack.reverbEnabled = trackGetReverbEnabled(trackId);
+        fallbackTrack.reverbSize = trackGetReverbSize(trackId);
+        fallbackTrack.reverbDecaySeconds = trackGetReverbDecay(trackId);
+        fallbackTrack.reverbDamping = trackGetReverbDamping(trackId);
+        fallbackTrack.reverbMix = trackGetReverbMix(trackId);
+        trackPtr = &fallbackTrack;
+    }
+
+    std::wstring labelText = ToWideString(trackPtr->name);
+    if (labelText.empty())
+        labelText = L"Unnamed Track";
+    labelText += L" - Reverb";
+    if (state->trackLabel)
+        SetWindowTextW(state->trackLabel, labelText.c_str());
+
+    bool reverbEnabled = trackPtr->reverbEnabled;
+    if (state->enableCheckbox)
+    {
+        EnableWindow(state->enableCheckbox, TRUE);
+        SendMessageW(state->enableCheckbox, BM_SETCHECK, reverbEnabled ? BST_CHECKED : BST_UNCHECKED, 0);
+    }
+
+    if (state->decaySlider)
+    {
+        EnableWindow(state->decaySlider, reverbEnabled ? TRUE : FALSE);
+        float decay = std::clamp(trackPtr->reverbDecaySeconds, kMixerReverbDecayMin, kMixerReverbDecayMax);
+        SendMessageW(state->decaySlider, TBM_SETPOS, TRUE, static_cast<int>(std::lround(decay * 10.0f)));
+        if (state->decayValueLabel)
+        {
+            std::wstring text = ToWideString(formatReverbDecayValue(decay));
+            SetWindowTextW(state->decayValueLabel, text.c_str());
+        }
+    }
+
+    auto syncPercentSlider = [&](HWND slider, HWND valueLabel, float value)
+    {
+        if (!slider)
+            return;
+        EnableWindow(slider, reverbEnabled ? TRUE : FALSE);
+        float clamped = std::clamp(value, 0.0f, 1.0f);
+        int pos = static_cast<int>(std::lround(clamped * 100.0f));
+        SendMessageW(slider, TBM_SETPOS, TRUE, pos);
+        if (valueLabel)
+        {
+            std::wstring text = ToWideString(formatDelayPercentValue(clamped));
+            SetWindowTextW(valueLabel, text.c_str());
+        }
+    };
+
+    syncPercentSlider(state->sizeSlider, state->sizeValueLabel, trackPtr->reverbSize);
+    syncPercentSlider(state->dampingSlider, state->dampingValueLabel, trackPtr->reverbDamping);
+    syncPercentSlider(state->mixSlider, state->mixValueLabel, trackPtr->reverbMix);
+}
+
+LRESULT CALLBACK ReverbWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    ReverbWindowState* state = getReverbWindowState(hwnd);
+
+    switch (msg)
+    {
+    case WM_CREATE:
+    {
+        auto* create = reinterpret_cast<LPCREATESTRUCT>(lParam);
+        auto* newState = new ReverbWindowState();
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(newState));
+
+        HINSTANCE instance = create->hInstance;
+        DWORD staticStyle = WS_CHILD | WS_VISIBLE;
+
+        newState->trackLabel = CreateWindowExW(0,
+                                               L"STATIC",
+                                               L"Reverb",
+                                               staticStyle,
+                                               0,
+                                               0,
+                                               100,
+                                               20,
+                                               hwnd,
+                                               nullptr,
+                                               instance,
+                                               nullptr);
+        newState->enableCheckbox = CreateWindowExW(0,
+                                                   L"BUTTON",
+                                                   L"Enable Reverb",
+                                                   staticStyle | BS_AUTOCHECKBOX | WS_TABSTOP,
+                                                   0,
+                                                   0,
+                                                   150,
+                                                   24,
+                                                   hwnd,
+                                                   nullptr,
+                                                   instance,
+                                                   nullptr);
+
+        auto createSlider = [&](HWND& slider, HWND& valueLabel, int rangeMin, int rangeMax, int ticFreq)
+        {
+            slider = CreateWindowExW(0,
+                                      TRACKBAR_CLASSW,
+                                      L"",
+                                      WS_CHILD | WS_VISIBLE | TBS_AUTOTICKS,
+                                      0,
+                                      0,
+                                      100,
+                                      30,
+                                      hwnd,
+                                      nullptr,
+                                      instance,
+                                      nullptr);
+            SendMessageW(slider, TBM_SETRANGE, TRUE, MAKELPARAM(rangeMin, rangeMax));
+            SendMessageW(slider, TBM_SETTICFREQ, ticFreq, 0);
+            valueLabel = CreateWindowExW(0,
+                                         L"STATIC",
+                                         L"-",
+                                         staticStyle | SS_RIGHT,
+                                         0,
+                                         0,
+                                         80,
+                                         20,
+                                         hwnd,
+                                         nullptr,
+                                         instance,
+                                         nullptr);
+        };
+
+        createSlider(newState->sizeSlider, newState->sizeValueLabel, 0, 100, 10);
+        // Decay in tenths of a second.
+        createSlider(newState->decaySlider,
+                     newState->decayValueLabel,
+                     static_cast<int>(kMixerReverbDecayMin * 10.0f),
+                     static_cast<int>(kMixerReverbDecayMax * 10.0f),
+                     10);
+        createSlider(newState->dampingSlider, newState->dampingValueLabel, 0, 100, 10);
+        createSlider(newState->mixSlider, newState->mixValueLabel, 0, 100, 10);
+
+        HFONT font = static_cast<HFONT>(GetStockObject(DEFAULT_GUI_FONT));
+        reverbWindowApplyFont(*newState, font);
+
+        RECT client {0, 0, 0, 0};
+        GetClientRect(hwnd, &client);
+        reverbWindowLayout(hwnd, newState, client.right - client.left, client.bottom - client.top);
+        reverbWindowSyncControls(hwnd, newState);
+        return 0;
+    }
+    case WM_SIZE:
+        if (state)
+            reverbWindowLayout(hwnd, state, LOWORD(lParam), HIWORD(lParam));
+        return 0;
+    case WM_COMMAND:
+        if (state && reinterpret_cast<HWND>(lParam) == state->enableCheckbox && HIWORD(wParam) == BN_CLICKED)
+        {
+            int trackId = state->trackId;
+            if (trackId > 0)
+            {
+                bool enabled = SendMessageW(state->enableCheckbox, BM_GETCHECK, 0, 0) == BST_CHECKED;
+                trackSetReverbEnabled(trackId, enabled);
+                reverbWindowSyncControls(hwnd, state);
+                notifyEffectsWindowTrackValuesChanged(trackId);
+                if (gMainWindow && IsWindow(gMainWindow))
+                    InvalidateRect(gMainWindow, nullptr, FALSE);
+            }
+            return 0;
+        }
+        break;
+    case WM_HSCROLL:
+        if (state)
+        {
+            int trackId = state->trackId;
+            if (trackId <= 0)
+                return 0;
+
+            HWND control = reinterpret_cast<HWND>(lParam);
+            if (!control)
+                control = GetFocus();
+
+            if (control == state->decaySlider)
+            {
+                int pos = static_cast<int>(SendMessageW(control, TBM_GETPOS, 0, 0));
+                float newValue = std::clamp(static_cast<float>(pos) / 10.0f, kMixerReverbDecayMin, kMixerReverbDecayMax);
+                trackSetReverbDecay(trackId, newValue);
+                reverbWindowSyncControls(hwnd, state);
+                notifyEffectsWindowTrackValuesChanged(trackId);
+                if (gMainWindow && IsWindow(gMainWindow))
+                    InvalidateRect(gMainWindow, nullptr, FALSE);
+                return 0;
+            }
+
+            auto handlePercentSlider = [&](HWND slider, auto setter)
+            {
+                if (control != slider)
+                    return false;
+                int pos = static_cast<int>(SendMessageW(slider, TBM_GETPOS, 0, 0));
+                float value = std::clamp(static_cast<float>(pos) / 100.0f, 0.0f, 1.0f);
+                setter(trackId, value);
+                reverbWindowSyncControls(hwnd, state);
+                notifyEffectsWindowTrackValuesChanged(trackId);
+                if (gMainWindow && IsWindow(gMainWindow))
+                    InvalidateRect(gMainWindow, nullptr, FALSE);
+                return true;
+            };
+
+            if (handlePercentSlider(state->sizeSlider, trackSetReverbSize))
+                return 0;
+            if (handlePercentSlider(state->dampingSlider, trackSetReverbDamping))
+                return 0;
+            if (handlePercentSlider(state->mixSlider, trackSetReverbMix))
+                return 0;
+        }
+        return 0;
+    case WM_REVERB_SET_TRACK:
+        if (state)
+        {
+            state->trackId = static_cast<int>(wParam);
+            reverbWindowSyncControls(hwnd, state);
+        }
+        return 0;
+    case WM_REVERB_REFRESH_VALUES:
+        if (state)
+            reverbWindowSyncControls(hwnd, state);
+        return 0;
+    case WM_DESTROY:
+    {
+        auto* toDelete = state;
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, 0);
+        delete toDelete;
+        if (hwnd == gReverbWindow)
+        {
+            gReverbWindow = nullptr;
+            requestMainMenuRefresh();
+        }
+        return 0;
+    }
+    }
+
+    return DefWindowProcW(hwnd, msg, wParam, lParam);
+}
+
+void ensureReverbWindowClass()
+{
+    if (gReverbWindowClassRegistered)
+        return;
+
+    WNDCLASSW wc = {0};
+    wc.lpfnWndProc = ReverbWndProc;
+    wc.hInstance = GetModuleHandle(nullptr);
+    wc.lpszClassName = L"KJReverbWindow";
+    wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+    wc.hbrBackground = reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1);
+    if (RegisterClassW(&wc))
+        gReverbWindowClassRegistered = true;
+}
+
+void openReverbWindow(HWND parent, int trackId)
+{
+    ensureReverbWindowClass();
+    if (!gReverbWindowClassRegistered)
+        return;
+
+    if (gReverbWindow && IsWindow(gReverbWindow))
+    {
+        ShowWindow(gReverbWindow, SW_SHOWNORMAL);
+        SetForegroundWindow(gReverbWindow);
+        PostMessageW(gReverbWindow, WM_REVERB_SET_TRACK, static_cast<WPARAM>(trackId), 0);
+        return;
+    }
+
+    int x = CW_USEDEFAULT;
+    int y = CW_USEDEFAULT;
+    if (parent && IsWindow(parent))
+    {
+        RECT rect {0, 0, 0, 0};
+        GetWindowRect(parent, &rect);
+        x = rect.right + 20;
+        y = rect.top + 20;
+    }
+
+    HWND hwnd = CreateWindowExW(WS_EX_TOOLWINDOW,
+                                L"KJReverbWindow",
+                                L"Track Reverb",
+                                WS_OVERLAPPEDWINDOW ^ WS_THICKFRAME,
+                                x,
+                                y,
+                                380,
+                                330,
+                                parent,
+                                nullptr,
+                                GetModuleHandle(nullptr),
+                                nullptr);
+    if (hwnd)
+    {
+        gReverbWindow = hwnd;
+        ShowWindow(hwnd, SW_SHOWNORMAL);
+        UpdateWindow(hwnd);
+        PostMessageW(hwnd, WM_REVERB_SET_TRACK, static_cast<WPARAM>(trackId), 0);
+        requestMainMenuRefresh();
+    }
+}
+
+void notifyReverbWindowTrackChanged(int trackId)
+{
+    if (gReverbWindow && IsWindow(gReverbWindow))
+        PostMessageW(gReverbWindow, WM_REVERB_SET_TRACK, static_cast<WPARAM>(trackId), 0);
+}
+
+void notifyReverbWindowValuesChanged(int trackId)
+{
+    if (gReverbWindow && IsWindow(gReverbWindow))
+    {
+        ReverbWindowState* state = getReverbWindowState(gReverbWindow);
+        if (!state || state->trackId == trackId)
+            PostMessageW(gReverbWindow, WM_REVERB_REFRESH_VALUES, 0, 0);
+    }
+}
+
 void closeEffectsWindow()
 {
     if (gEffectsWindow && IsWindow(gEffectsWindow))
@@ -4466,7 +5066,9 @@ void notifyEffectsWindowTrackListChanged()
     notifySidechainWindowTrackChanged(activeTrack);
     notifyEqWindowTrackChanged(activeTrack);
     notifyDelayWindowTrackChanged(activeTrack);
+    notifyReverbWindowTrackChanged(activeTrack);
     notifyModMatrixWindowTrackListChanged();
+    notifyAuxBusWindowTrackChanged(activeTrack);
 }
 
 void notifyEffectsWindowActiveTrackChanged(int trackId)
@@ -4479,6 +5081,8 @@ void notifyEffectsWindowActiveTrackChanged(int trackId)
     notifySidechainWindowTrackChanged(trackId);
     notifyEqWindowTrackChanged(trackId);
     notifyDelayWindowTrackChanged(trackId);
+    notifyReverbWindowTrackChanged(trackId);
+    notifyAuxBusWindowTrackChanged(trackId);
 }
 
 void notifyEffectsWindowTrackValuesChanged(int trackId)
@@ -4626,12 +5230,10 @@ LRESULT CALLBACK EffectsWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
             column.pszText = const_cast<LPWSTR>(L"Container");
             ListView_InsertColumn(newState->effectList, 1, &column);
 
-            newState->effectEntries = {
-                {EffectListItemType::Eq, L"Equalizer"},
-                {EffectListItemType::Delay, L"Delay"},
-                {EffectListItemType::Compressor, L"Compressor"},
-                {EffectListItemType::Sidechain, L"Sidechain"},
-            };
+            newState->effectEntries.clear();
+            for (InsertEffect effect : kDefaultInsertOrder)
+                newState->effectEntries.push_back(effectListEntryForInsert(effect));
+            newState->effectEntries.push_back({EffectListItemType::Sidechain, L"Sidechain"});
 
             LVITEMW item {0};
             item.mask = LVIF_TEXT | LVIF_PARAM;
@@ -4651,6 +5253,7 @@ LRESULT CALLBACK EffectsWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                     case EffectListItemType::Eq:
                     case EffectListItemType::Delay:
                     case EffectListItemType::Compressor:
+                    case EffectListItemType::Reverb:
                     case EffectListItemType::Sidechain:
                         containerText = L"Open";
                         break;
@@ -4718,6 +5321,7 @@ LRESULT CALLBACK EffectsWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                     notifyCompressorWindowTrackChanged(trackId);
                     notifyEqWindowTrackChanged(trackId);
                     notifyDelayWindowTrackChanged(trackId);
+                    notifyReverbWindowTrackChanged(trackId);
                     if (selectedTrackId != trackId)
                     {
                         selectedTrackId = trackId;
@@ -4806,6 +5410,10 @@ LRESULT CALLBACK EffectsWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                             trackSetCompressorEnabled(trackId, checked);
                             notifyCompressorWindowValuesChanged(trackId);
                             break;
+                        case EffectListItemType::Reverb:
+                            trackSetReverbEnabled(trackId, checked);
+                            notifyReverbWindowValuesChanged(trackId);
+                            break;
                         case EffectListItemType::Sidechain:
                             trackSetSidechainEnabled(trackId, checked);
                             notifySidechainWindowValuesChanged(trackId);
@@ -4839,6 +5447,9 @@ LRESULT CALLBACK EffectsWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                         case EffectListItemType::Compressor:
                             openCompressorWindow(hwnd, trackId);
                             break;
+                        case EffectListItemType::Reverb:
+                            openReverbWindow(hwnd, trackId);
+                            break;
                         case EffectListItemType::Sidechain:
                             openSidechainWindow(hwnd, trackId);
                             break;
@@ -4847,6 +5458,45 @@ LRESULT CALLBACK EffectsWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                 }
                 return 0;
             }
+
+            if (header->code == NM_RCLICK)
+            {
+                auto* click = reinterpret_cast<LPNMITEMACTIVATE>(lParam);
+                int trackId = state->selectedTrackId;
+                if (!click || click->iItem < 0 || click->iItem >= kInsertEffectCount || trackId <= 0)
+                    return 0;
+
+                int slot = click->iItem;
+                HMENU menu = CreatePopupMenu();
+                if (!menu)
+                    return 0;
+                AppendMenuW(menu, MF_STRING | (slot > 0 ? MF_ENABLED : MF_GRAYED), kEffectsMoveInsertUpId, L"Move Up");
+                AppendMenuW(menu,
+                            MF_STRING | (slot + 1 < kInsertEffectCount ? MF_ENABLED : MF_GRAYED),
+                            kEffectsMoveInsertDownId,
+                            L"Move Down");
+
+                POINT screenPoint = click->ptAction;
+                ClientToScreen(state->effectList, &screenPoint);
+                SetForegroundWindow(hwnd);
+                UINT command = TrackPopupMenu(menu, TPM_RIGHTBUTTON | TPM_RETURNCMD, screenPoint.x, screenPoint.y, 0, hwnd, nullptr);
+                DestroyMenu(menu);
+
+                int targetSlot = slot;
+                if (command == kEffectsMoveInsertUpId)
+                    targetSlot = slot - 1;
+                else if (command == kEffectsMoveInsertDownId)
+                    targetSlot = slot + 1;
+                if (targetSlot != slot && trackMoveInsert(trackId, slot, targetSlot))
+                {
+                    effectsWindowSyncControls(hwnd, state);
+                    state->effectListUpdating = true;
+                    ListView_SetItemState(state->effectList, targetSlot, LVIS_SELECTED | LVIS_FOCUSED,
+                                          LVIS_SELECTED | LVIS_FOCUSED);
+                    state->effectListUpdating = false;
+                }
+                return 0;
+            }
         }
         break;
     }
@@ -4910,7 +5560,7 @@ LRESULT CALLBACK EffectsWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
     return DefWindowProcW(hwnd, msg, wParam, lParam);
 }
 
-void drawButton(LICE_SysBitmap& surface, const RECT& rect, COLORREF fill, COLORREF outline, const char* text)
+void drawButton(LICE_IBitmap& surface, const RECT& rect, COLORREF fill, COLORREF outline, const char* text)
 {
     const int width = rect.right - rect.left;
     const int height = rect.bottom - rect.top;
@@ -5122,67 +5772,177 @@ void drawSliderControl(LICE_SysBitmap& surface, SliderControlRects& sliderRects,
     sliderRects.track = trackRect;
 }
 
-void drawSequencer(LICE_SysBitmap& surface, int activeTrackId)
+struct SequencerStepView
 {
-    bool playing = isPlaying.load(std::memory_order_relaxed);
-    auto tracks = getTracks();
-    if (activeTrackId <= 0 && !tracks.empty())
+    int stepIndex = 0;
+    bool inRange = false;
+    bool active = false;
+    bool current = false;
+};
+
+std::array<SequencerStepView, kSequencerStepsPerPage> gSequencerStepViews{};
+std::array<int, kSequencerStepsPerPage> gSequencerStepWidgetIds{};
+RetainedWidgetLayer gMainWidgetLayer;
+
+// Step borders are drawn up to two pixels outside the cell, so the widget
+// bounds cover that margin as well.
+constexpr int kSequencerStepBorderMargin = 2;
+
+RECT sequencerStepWidgetBounds(const RECT& rect)
+{
+    return RECT{rect.left - kSequencerStepBorderMargin, rect.top - kSequencerStepBorderMargin,
+                rect.right + kSequencerStepBorderMargin, rect.bottom + kSequencerStepBorderMargin};
+}
+
+void drawSequencerStep(LICE_IBitmap& surface, const RECT& bounds, int slot)
+{
+    const SequencerStepView& view = gSequencerStepViews[static_cast<size_t>(slot)];
+    const RECT& rect = stepRects[static_cast<size_t>(slot)];
+    const int width = rect.right - rect.left;
+    const int height = rect.bottom - rect.top;
+
+    LICE_FillRect(&surface, bounds.left, bounds.top, bounds.right - bounds.left, bounds.bottom - bounds.top,
+                  LICE_ColorFromCOLORREF(RGB(20, 20, 20)));
+
+    COLORREF fill = view.active ? RGB(0, 120, 200) : RGB(45, 45, 45);
+    if (!view.inRange)
     {
-        activeTrackId = tracks.front().id;
+        fill = RGB(30, 30, 30);
     }
+    LICE_FillRect(&surface, rect.left, rect.top, width, height,
+                  LICE_ColorFromCOLORREF(fill));
 
-    clampCurrentPageForTrack(activeTrackId);
+    COLORREF borderColor = RGB(70, 70, 70);
+    int penWidth = 2;
+    if (view.current)
+    {
+        borderColor = RGB(255, 215, 0);
+        penWidth = 3;
+    }
+
+    if (!view.inRange)
+    {
+        borderColor = RGB(50, 50, 50);
+    }
+
+    for (int p = 0; p < penWidth; ++p)
+    {
+        LICE_DrawRect(&surface, rect.left - p, rect.top - p,
+                      width + p * 2, height + p * 2,
+                      LICE_ColorFromCOLORREF(borderColor));
+    }
 
-    int currentStep = sequencerCurrentStep.load(std::memory_order_relaxed);
+    RECT labelRect = rect;
+    labelRect.top = rect.bottom - 22;
+    labelRect.left += 4;
+    std::string label = view.inRange ? std::to_string(view.stepIndex + 1) : "-";
+    drawText(surface, labelRect, label.c_str(), RGB(220, 220, 220),
+             DT_LEFT | DT_BOTTOM | DT_SINGLELINE);
+}
 
+void buildMainWidgetLayer()
+{
+    gMainWidgetLayer.clear();
+    for (int i = 0; i < kSequencerStepsPerPage; ++i)
+    {
+        gSequencerStepWidgetIds[static_cast<size_t>(i)] = gMainWidgetLayer.addWidget(
+            sequencerStepWidgetBounds(stepRects[static_cast<size_t>(i)]),
+            [i](LICE_IBitmap& surface, const RECT& bounds) { drawSequencerStep(surface, bounds, i); });
+    }
+}
+
+int resolveSequencerTrackId(int activeTrackId)
+{
+    if (activeTrackId > 0)
+        return activeTrackId;
+
+    auto tracks = getTracks();
+    return tracks.empty() ? 0 : tracks.front().id;
+}
+
+// Samples the sequencer state shown by each step cell and publishes it to the
+// widget layer. Only cells whose visible state changed end up dirty.
+void updateSequencerStepWidgets(int activeTrackId)
+{
     int totalSteps = getSequencerStepCount(activeTrackId);
     if (totalSteps < 1)
         totalSteps = kSequencerStepsPerPage;
+    int currentStep = transportPatternStep(transportGetPosition(), totalSteps);
 
     for (int i = 0; i < kSequencerStepsPerPage; ++i)
     {
-        const RECT& rect = stepRects[i];
-        const int width = rect.right - rect.left;
-        const int height = rect.bottom - rect.top;
-        int stepIndex = currentStepPage * kSequencerStepsPerPage + i;
-        bool inRange = stepIndex < totalSteps;
-        bool active = inRange && getTrackStepState(activeTrackId, stepIndex);
-
-        COLORREF fill = active ? RGB(0, 120, 200) : RGB(45, 45, 45);
-        if (!inRange)
-        {
-            fill = RGB(30, 30, 30);
-        }
-        LICE_FillRect(&surface, rect.left, rect.top, width, height,
-                      LICE_ColorFromCOLORREF(fill));
+        SequencerStepView view{};
+        view.stepIndex = currentStepPage * kSequencerStepsPerPage + i;
+        view.inRange = view.stepIndex < totalSteps;
+        view.active = view.inRange && getTrackStepState(activeTrackId, view.stepIndex);
+        view.current = view.inRange && view.stepIndex == currentStep;
+        gSequencerStepViews[static_cast<size_t>(i)] = view;
 
-        COLORREF borderColor = RGB(70, 70, 70);
-        int penWidth = 2;
-        if (playing && inRange && stepIndex == currentStep)
-        {
-            borderColor = RGB(255, 215, 0);
-            penWidth = 3;
-        }
+        std::uint64_t version = hashWidgetState(0, static_cast<std::uint64_t>(view.stepIndex));
+        version = hashWidgetState(version, (view.inRange ? 1u : 0u) | (view.active ? 2u : 0u) | (view.current ? 4u : 0u));
+        int widgetId = gSequencerStepWidgetIds[static_cast<size_t>(i)];
+        gMainWidgetLayer.setWidgetBounds(widgetId, sequencerStepWidgetBounds(stepRects[static_cast<size_t>(i)]));
+        gMainWidgetLayer.updateWidgetState(widgetId, version);
+    }
+}
 
-        if (!inRange)
-        {
-            borderColor = RGB(50, 50, 50);
-        }
+void drawSequencer(LICE_SysBitmap& surface, int activeTrackId)
+{
+    activeTrackId = resolveSequencerTrackId(activeTrackId);
+    clampCurrentPageForTrack(activeTrackId);
+    updateSequencerStepWidgets(activeTrackId);
+    gMainWidgetLayer.renderAll(surface);
+}
 
-        for (int p = 0; p < penWidth; ++p)
-        {
-            LICE_DrawRect(&surface, rect.left - p, rect.top - p,
-                          width + p * 2, height + p * 2,
-                          LICE_ColorFromCOLORREF(borderColor));
-        }
+template <typename String>
+std::uint64_t hashWidgetString(std::uint64_t seed, const String& value)
+{
+    std::uint64_t hash = hashWidgetState(seed, value.size());
+    for (auto ch : value)
+        hash = hashWidgetState(hash, static_cast<std::uint64_t>(ch));
+    return hash;
+}
 
-        RECT labelRect = rect;
-        labelRect.top = rect.bottom - 22;
-        labelRect.left += 4;
-        std::string label = inRange ? std::to_string(stepIndex + 1) : "-";
-        drawText(surface, labelRect, label.c_str(), RGB(220, 220, 220),
-                 DT_LEFT | DT_BOTTOM | DT_SINGLELINE);
-    }
+// Version of everything renderUI draws outside the step cells. A change here
+// repaints the whole window; otherwise the heartbeat only repaints the step
+// cells whose state moved.
+std::uint64_t computeMainWindowChromeVersion()
+{
+    std::uint64_t version = hashWidgetState(0, isPlaying.load(std::memory_order_relaxed) ? 1u : 0u);
+    version = hashWidgetState(version, static_cast<std::uint64_t>(std::llround(sequencerBPM.load(std::memory_order_relaxed) * 100.0)));
+    version = hashWidgetState(version, static_cast<std::uint64_t>(selectedTrackId));
+    version = hashWidgetState(version, static_cast<std::uint64_t>(currentStepPage));
+    version = hashWidgetState(version, (audioDeviceDropdownOpen ? 1u : 0u) | (waveDropdownOpen ? 2u : 0u) |
+                                           (midiPortDropdownOpen ? 4u : 0u) | (midiChannelDropdownOpen ? 8u : 0u) |
+                                           (gAudioDeviceRefreshInProgress.load(std::memory_order_acquire) ? 16u : 0u));
+    version = hashWidgetState(version, static_cast<std::uint64_t>(openTrackTypeTrackId));
+    version = hashWidgetState(version, ((gPianoRollWindow && IsWindow(gPianoRollWindow)) ? 1u : 0u) |
+                                           ((gEffectsWindow && IsWindow(gEffectsWindow)) ? 2u : 0u));
+
+    // Track settings are hashed through their version rather than copied out
+    // on every tick.
+    version = hashWidgetState(version, getTrackSettingsVersion());
+
+    int activeTrackId = resolveSequencerTrackId(selectedTrackId);
+    version = hashWidgetState(version, static_cast<std::uint64_t>(getSequencerStepCount(activeTrackId)));
+
+    kj::VstUiState vstUiState = kj::queryVstUiState(activeTrackId, nullptr);
+    version = hashWidgetState(version, (vstUiState.showLoader ? 1u : 0u) | (vstUiState.editorAvailable ? 2u : 0u) |
+                                           (vstUiState.editorLoading ? 4u : 0u));
+
+    // The port selector shows which ports are online, so a device coming or
+    // going has to repaint it even when nothing else moved.
+    if (activeTrackId > 0 && trackGetType(activeTrackId) == TrackType::MidiOut)
+        refreshMidiPortList(false);
+    version = hashWidgetState(version, gCachedMidiPorts.size());
+    for (const auto& port : gCachedMidiPorts)
+    {
+        version = hashWidgetState(version, static_cast<std::uint64_t>(port.id));
+        version = hashWidgetString(version, port.name);
+    }
+
+    version = hashWidgetString(version, getActiveAudioOutputDevice().name);
+    return version;
 }
 
 void drawSynthTrackControls(LICE_SysBitmap& surface, const RECT& client, const Track* activeTrack)
@@ -5720,8 +6480,13 @@ void renderUI(LICE_SysBitmap& surface, const RECT& client)
         }
     }
 
-    int bpm = sequencerBPM.load(std::memory_order_relaxed);
-    std::string bpmText = "Tempo: " + std::to_string(bpm) + " BPM";
+    double bpm = sequencerBPM.load(std::memory_order_relaxed);
+    char bpmBuffer[32];
+    if (std::abs(bpm - std::round(bpm)) < 0.005)
+        std::snprintf(bpmBuffer, sizeof(bpmBuffer), "%d", static_cast<int>(std::lround(bpm)));
+    else
+        std::snprintf(bpmBuffer, sizeof(bpmBuffer), "%.2f", bpm);
+    std::string bpmText = std::string("Tempo: ") + bpmBuffer + " BPM";
     RECT bpmRect {470, 20, client.right - 40, 50};
     drawText(surface, bpmRect, bpmText.c_str(), RGB(220, 220, 220),
              DT_LEFT | DT_VCENTER | DT_SINGLELINE);
@@ -5862,6 +6627,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     case WM_CREATE:
         gMainWindow = hwnd;
         buildStepRects();
+        buildMainWidgetLayer();
         // UI heartbeat timer (~66 fps)
         SetTimer(hwnd, 1, 15, nullptr);
         {
@@ -5877,6 +6643,34 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                     AppendMenuW(menuBar, MF_POPUP, reinterpret_cast<UINT_PTR>(fileMenu), L"&File");
                 }
 
+                HMENU trackMenu = CreatePopupMenu();
+                if (trackMenu)
+                {
+                    AppendMenuW(trackMenu, MF_STRING, kMenuCommandFreezeTrack, L"&Freeze Track");
+                    AppendMenuW(trackMenu, MF_STRING, kMenuCommandUnfreezeTrack, L"&Unfreeze Track");
+                    AppendMenuW(trackMenu, MF_SEPARATOR, 0, nullptr);
+                    AppendMenuW(trackMenu, MF_STRING, kMenuCommandRecordInput, L"&Record Input...");
+                    AppendMenuW(trackMenu, MF_STRING, kMenuCommandToggleInputMonitoring, L"Input &Monitoring");
+                    AppendMenuW(trackMenu, MF_STRING, kMenuCommandToggleAutomationRecording,
+                                L"Record Plug-in &Automation");
+                    updateTrackMenuChecks(trackMenu);
+                    AppendMenuW(trackMenu, MF_SEPARATOR, 0, nullptr);
+                    AppendMenuW(trackMenu, MF_STRING | (pluginSandboxEnabled() ? MF_CHECKED : MF_UNCHECKED),
+                                kMenuCommandTogglePluginSandbox, L"Load Plug-ins in &Sandbox");
+                    HMENU panLawMenu = CreatePopupMenu();
+                    if (panLawMenu)
+                    {
+                        AppendMenuW(panLawMenu, MF_STRING, kMenuCommandPanLawConstantPower, L"&Constant Power (-3 dB)");
+                        AppendMenuW(panLawMenu, MF_STRING, kMenuCommandPanLawCompromise, L"C&ompromise (-4.5 dB)");
+                        AppendMenuW(panLawMenu, MF_STRING, kMenuCommandPanLawLinear, L"&Linear (-6 dB)");
+                        CheckMenuRadioItem(panLawMenu, kMenuCommandPanLawConstantPower, kMenuCommandPanLawLinear,
+                                           kMenuCommandPanLawConstantPower + static_cast<int>(getPanLaw()),
+                                           MF_BYCOMMAND);
+                        AppendMenuW(trackMenu, MF_POPUP, reinterpret_cast<UINT_PTR>(panLawMenu), L"&Pan Law");
+                    }
+                    AppendMenuW(menuBar, MF_POPUP, reinterpret_cast<UINT_PTR>(trackMenu), L"&Track");
+                }
+
                 HMENU viewMenu = CreatePopupMenu();
                 if (viewMenu)
                 {
@@ -5885,6 +6679,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                     AppendMenuW(viewMenu, MF_STRING, kMenuCommandToggleEffects, L"Track &Effects");
                     AppendMenuW(viewMenu, MF_STRING, kMenuCommandToggleWaveform, L"&Waveform Visualizer");
                     AppendMenuW(viewMenu, MF_STRING, kMenuCommandToggleModMatrix, L"&Mod Matrix");
+                    AppendMenuW(viewMenu, MF_STRING, kMenuCommandToggleAuxBuses, L"Sends && &Aux Buses");
                     AppendMenuW(menuBar, MF_POPUP, reinterpret_cast<UINT_PTR>(viewMenu), L"&View");
                     updateViewMenuChecks();
                 }
@@ -5897,6 +6692,9 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
             }
         }
         return 0;
+    case WM_INITMENUPOPUP:
+        updateTrackMenuChecks(reinterpret_cast<HMENU>(wParam));
+        return 0;
     case WM_COMMAND:
     {
         switch (LOWORD(wParam))
@@ -5907,6 +6705,39 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         case kMenuCommandSaveProject:
             showSaveProjectDialog(hwnd);
             return 0;
+        case kMenuCommandFreezeTrack:
+            freezeActiveTrack(hwnd);
+            return 0;
+        case kMenuCommandUnfreezeTrack:
+            trackUnfreeze(getActiveSequencerTrackId());
+            return 0;
+        case kMenuCommandRecordInput:
+            toggleActiveTrackRecording(hwnd);
+            return 0;
+        case kMenuCommandToggleInputMonitoring:
+            setInputMonitoring(!inputMonitoringEnabled());
+            return 0;
+        case kMenuCommandToggleAutomationRecording:
+        {
+            int trackId = getActiveSequencerTrackId();
+            setTrackAutomationRecording(trackId, !trackAutomationRecording(trackId));
+            return 0;
+        }
+        case kMenuCommandTogglePluginSandbox:
+        {
+            const bool enabled = !pluginSandboxEnabled();
+            setPluginSandboxEnabled(enabled);
+            CheckMenuItem(GetMenu(hwnd), kMenuCommandTogglePluginSandbox,
+                          MF_BYCOMMAND | (enabled ? MF_CHECKED : MF_UNCHECKED));
+            return 0;
+        }
+        case kMenuCommandPanLawConstantPower:
+        case kMenuCommandPanLawCompromise:
+        case kMenuCommandPanLawLinear:
+            setPanLaw(static_cast<PanLaw>(LOWORD(wParam) - kMenuCommandPanLawConstantPower));
+            CheckMenuRadioItem(GetMenu(hwnd), kMenuCommandPanLawConstantPower, kMenuCommandPanLawLinear,
+                               LOWORD(wParam), MF_BYCOMMAND);
+            return 0;
         case kMenuCommandTogglePianoRoll:
             togglePianoRollWindow(hwnd);
             return 0;
@@ -5919,6 +6750,9 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         case kMenuCommandToggleModMatrix:
             toggleModMatrixWindow(hwnd);
             return 0;
+        case kMenuCommandToggleAuxBuses:
+            toggleAuxBusWindow(hwnd);
+            return 0;
         default:
             break;
         }
@@ -6570,8 +7404,8 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 
         if (pointInRect(bpmDownButton, x, y))
         {
-            int bpm = sequencerBPM.load(std::memory_order_relaxed);
-            bpm = std::clamp(bpm - 5, 40, 240);
+            double bpm = sequencerBPM.load(std::memory_order_relaxed);
+            bpm = std::clamp(bpm - 5.0, 40.0, kSequencerMaxBpm);
             sequencerBPM.store(bpm, std::memory_order_relaxed);
             InvalidateRect(hwnd, nullptr, FALSE);
             return 0;
@@ -6579,8 +7413,8 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 
         if (pointInRect(bpmUpButton, x, y))
         {
-            int bpm = sequencerBPM.load(std::memory_order_relaxed);
-            bpm = std::clamp(bpm + 5, 40, 240);
+            double bpm = sequencerBPM.load(std::memory_order_relaxed);
+            bpm = std::clamp(bpm + 5.0, 40.0, kSequencerMaxBpm);
             sequencerBPM.store(bpm, std::memory_order_relaxed);
             InvalidateRect(hwnd, nullptr, FALSE);
             return 0;
@@ -6859,8 +7693,26 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 MessageBoxW(hwnd, notification.message.c_str(), notification.title.c_str(), MB_OK | MB_ICONERROR);
             }
         }
-        // Soft heartbeat for plugin UIs
-        InvalidateRect(hwnd, nullptr, FALSE);
+        // Heartbeat: repaint everything only when the chrome changed,
+        // otherwise invalidate just the step cells that moved.
+        // Open dropdowns overlap the step grid, so they keep the full repaint.
+        std::uint64_t chromeVersion = computeMainWindowChromeVersion();
+        bool overlayOpen = audioDeviceDropdownOpen || waveDropdownOpen || midiPortDropdownOpen ||
+                           midiChannelDropdownOpen || openTrackTypeTrackId != 0;
+        if (chromeVersion != gMainWindowChromeVersion || overlayOpen)
+        {
+            gMainWindowChromeVersion = chromeVersion;
+            InvalidateRect(hwnd, nullptr, FALSE);
+            return 0;
+        }
+
+        updateSequencerStepWidgets(resolveSequencerTrackId(selectedTrackId));
+        std::vector<RECT> dirtyRects;
+        gMainWidgetLayer.collectDirtyRects(dirtyRects);
+        for (const RECT& dirty : dirtyRects)
+        {
+            InvalidateRect(hwnd, &dirty, FALSE);
+        }
         return 0;
     }
     case WM_SIZE:
@@ -6868,6 +7720,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         int width = LOWORD(lParam);
         int height = HIWORD(lParam);
         ensureSurfaceSize(width, height);
+        InvalidateRect(hwnd, nullptr, FALSE);
         return 0;
     }
     case WM_PAINT:
@@ -6879,8 +7732,30 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         ensureSurfaceSize(client.right, client.bottom);
         if (gSurface)
         {
-            renderUI(*gSurface, client);
-            LICE_Scale_BitBlt(hdc, 0, 0, gSurface->getWidth(), gSurface->getHeight(), gSurface.get(), 0, 0, SRCCOPY); // Use LICE helper to blit the surface to the window HDC.
+            // Anything invalidated outside the heartbeat (input handlers,
+            // other windows, resizes) covers the whole client area and gets a
+            // full render. Partial invalidations come from the widget layer, so
+            // only dirty widgets are redrawn into the retained surface.
+            const RECT& paint = ps.rcPaint;
+            bool fullPaint = gSurfaceNeedsFullRender || (paint.left <= client.left && paint.top <= client.top &&
+                                                         paint.right >= client.right && paint.bottom >= client.bottom);
+            if (fullPaint)
+            {
+                renderUI(*gSurface, client);
+                gSurfaceNeedsFullRender = false;
+                gMainWindowChromeVersion = computeMainWindowChromeVersion();
+            }
+            else
+            {
+                gMainWidgetLayer.renderDirty(*gSurface);
+            }
+
+            int width = paint.right - paint.left;
+            int height = paint.bottom - paint.top;
+            if (width > 0 && height > 0)
+            {
+                LICE_Scale_BitBlt(hdc, paint.left, paint.top, width, height, gSurface.get(), paint.left, paint.top, SRCCOPY); // Use LICE helper to blit the surface to the window HDC.
+            }
         }
         EndPaint(hwnd, &ps);
         return 0;
@@ -6888,16 +7763,21 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     case WM_DESTROY:
         KillTimer(hwnd, 1);
         gSurface.reset();
+        gSurfaceNeedsFullRender = true;
+        gMainWidgetLayer.clear();
         gMainWindow = nullptr;
         gViewMenu = nullptr;
         closePianoRollWindow();
         closeEffectsWindow();
         closeWaveformWindow();
+        closeAuxBusWindow();
         closeCompressorWindow();
         if (gEqWindow && IsWindow(gEqWindow))
             DestroyWindow(gEqWindow);
         if (gDelayWindow && IsWindow(gDelayWindow))
             DestroyWindow(gDelayWindow);
+        if (gReverbWindow && IsWindow(gReverbWindow))
+            DestroyWindow(gReverbWindow);
         if (gSidechainWindow && IsWindow(gSidechainWindow))
             DestroyWindow(gSidechainWindow);
         PostQuitMessage(0);
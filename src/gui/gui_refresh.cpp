@@ -1,4 +1,5 @@
 #include "gui/gui_refresh.h"
+#include "gui/aux_bus_window.h"
 #include "gui/menu_commands.h"
 #include "gui/mod_matrix_window.h"
 #include "gui/waveform_window.h"
@@ -32,6 +33,9 @@ void updateViewMenuChecks()
 
     UINT modMatrixState = isModMatrixWindowOpen() ? MF_CHECKED : MF_UNCHECKED;
     CheckMenuItem(gViewMenu, kMenuCommandToggleModMatrix, MF_BYCOMMAND | modMatrixState);
+
+    UINT auxBusState = isAuxBusWindowOpen() ? MF_CHECKED : MF_UNCHECKED;
+    CheckMenuItem(gViewMenu, kMenuCommandToggleAuxBuses, MF_BYCOMMAND | auxBusState);
 }
 
 void requestMainMenuRefresh()
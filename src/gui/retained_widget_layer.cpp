@@ -0,0 +1,177 @@
+#include "gui/retained_widget_layer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+bool rectIsEmpty(const RECT& rect)
+{
+    return rect.right <= rect.left || rect.bottom <= rect.top;
+}
+
+bool rectsEqual(const RECT& a, const RECT& b)
+{
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+void unionInto(RECT& target, const RECT& rect, bool& hasTarget)
+{
+    if (rectIsEmpty(rect))
+        return;
+
+    if (!hasTarget)
+    {
+        target = rect;
+        hasTarget = true;
+        return;
+    }
+
+    target.left = std::min(target.left, rect.left);
+    target.top = std::min(target.top, rect.top);
+    target.right = std::max(target.right, rect.right);
+    target.bottom = std::max(target.bottom, rect.bottom);
+}
+
+} // namespace
+
+int RetainedWidgetLayer::addWidget(const RECT& bounds, DrawCallback draw)
+{
+    Widget widget{};
+    widget.bounds = bounds;
+    widget.draw = std::move(draw);
+    m_widgets.push_back(std::move(widget));
+    return static_cast<int>(m_widgets.size()) - 1;
+}
+
+void RetainedWidgetLayer::clear()
+{
+    m_widgets.clear();
+}
+
+bool RetainedWidgetLayer::validId(int widgetId) const noexcept
+{
+    return widgetId >= 0 && widgetId < static_cast<int>(m_widgets.size());
+}
+
+void RetainedWidgetLayer::setWidgetBounds(int widgetId, const RECT& bounds)
+{
+    if (!validId(widgetId))
+        return;
+
+    Widget& widget = m_widgets[static_cast<size_t>(widgetId)];
+    if (rectsEqual(widget.bounds, bounds))
+        return;
+
+    widget.bounds = bounds;
+    widget.dirty = true;
+}
+
+RECT RetainedWidgetLayer::widgetBounds(int widgetId) const noexcept
+{
+    if (!validId(widgetId))
+        return RECT{0, 0, 0, 0};
+    return m_widgets[static_cast<size_t>(widgetId)].bounds;
+}
+
+bool RetainedWidgetLayer::updateWidgetState(int widgetId, std::uint64_t stateVersion)
+{
+    if (!validId(widgetId))
+        return false;
+
+    Widget& widget = m_widgets[static_cast<size_t>(widgetId)];
+    if (widget.hasState && widget.stateVersion == stateVersion)
+        return false;
+
+    widget.stateVersion = stateVersion;
+    widget.hasState = true;
+    widget.dirty = true;
+    return true;
+}
+
+void RetainedWidgetLayer::markWidgetDirty(int widgetId)
+{
+    if (validId(widgetId))
+        m_widgets[static_cast<size_t>(widgetId)].dirty = true;
+}
+
+void RetainedWidgetLayer::markAllDirty()
+{
+    for (auto& widget : m_widgets)
+        widget.dirty = true;
+}
+
+bool RetainedWidgetLayer::hasDirtyWidgets() const noexcept
+{
+    for (const auto& widget : m_widgets)
+    {
+        if (widget.dirty)
+            return true;
+    }
+    return false;
+}
+
+bool RetainedWidgetLayer::isWidgetDirty(int widgetId) const noexcept
+{
+    return validId(widgetId) && m_widgets[static_cast<size_t>(widgetId)].dirty;
+}
+
+void RetainedWidgetLayer::collectDirtyRects(std::vector<RECT>& rects) const
+{
+    for (const auto& widget : m_widgets)
+    {
+        if (!widget.dirty)
+            continue;
+
+        if (!rectIsEmpty(widget.bounds))
+            rects.push_back(widget.bounds);
+
+        // A widget that moved also has to repaint the area it used to cover.
+        if (!rectIsEmpty(widget.lastDrawnBounds) && !rectsEqual(widget.lastDrawnBounds, widget.bounds))
+            rects.push_back(widget.lastDrawnBounds);
+    }
+}
+
+RECT RetainedWidgetLayer::dirtyBounds() const noexcept
+{
+    RECT result{0, 0, 0, 0};
+    bool hasResult = false;
+    for (const auto& widget : m_widgets)
+    {
+        if (!widget.dirty)
+            continue;
+        unionInto(result, widget.bounds, hasResult);
+        if (!rectsEqual(widget.lastDrawnBounds, widget.bounds))
+            unionInto(result, widget.lastDrawnBounds, hasResult);
+    }
+    return result;
+}
+
+void RetainedWidgetLayer::drawWidget(LICE_IBitmap& surface, Widget& widget)
+{
+    if (widget.draw && !rectIsEmpty(widget.bounds))
+        widget.draw(surface, widget.bounds);
+
+    widget.lastDrawnBounds = widget.bounds;
+    widget.dirty = false;
+}
+
+int RetainedWidgetLayer::renderDirty(LICE_IBitmap& surface)
+{
+    int drawn = 0;
+    for (auto& widget : m_widgets)
+    {
+        if (!widget.dirty)
+            continue;
+        drawWidget(surface, widget);
+        ++drawn;
+    }
+    return drawn;
+}
+
+int RetainedWidgetLayer::renderAll(LICE_IBitmap& surface)
+{
+    for (auto& widget : m_widgets)
+        drawWidget(surface, widget);
+    return static_cast<int>(m_widgets.size());
+}
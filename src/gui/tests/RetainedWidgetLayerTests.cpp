@@ -0,0 +1,79 @@
+#include "gui/retained_widget_layer.h"
+
+#include <iostream>
+#include <vector>
+
+namespace {
+
+LICE_pixel pixelAt(LICE_IBitmap& bitmap, int x, int y)
+{
+    return bitmap.getBits()[static_cast<size_t>(bitmap.getRowSpan()) * y + x];
+}
+
+} // namespace
+
+int main()
+{
+    LICE_MemBitmap surface(64, 32);
+    LICE_Clear(&surface, LICE_RGBA(0, 0, 0, 255));
+
+    const LICE_pixel leftColor = LICE_RGBA(255, 0, 0, 255);
+    const LICE_pixel rightColor = LICE_RGBA(0, 0, 255, 255);
+    const LICE_pixel scribbleColor = LICE_RGBA(0, 255, 0, 255);
+    int leftDraws = 0;
+    int rightDraws = 0;
+
+    RetainedWidgetLayer layer;
+    int left = layer.addWidget(RECT{0, 0, 32, 32}, [&](LICE_IBitmap& bitmap, const RECT& bounds) {
+        ++leftDraws;
+        LICE_FillRect(&bitmap, bounds.left, bounds.top, bounds.right - bounds.left, bounds.bottom - bounds.top, leftColor);
+    });
+    int right = layer.addWidget(RECT{32, 0, 64, 32}, [&](LICE_IBitmap& bitmap, const RECT& bounds) {
+        ++rightDraws;
+        LICE_FillRect(&bitmap, bounds.left, bounds.top, bounds.right - bounds.left, bounds.bottom - bounds.top, rightColor);
+    });
+
+    layer.updateWidgetState(left, 1);
+    layer.updateWidgetState(right, 1);
+    if (layer.renderDirty(surface) != 2 || pixelAt(surface, 4, 4) != leftColor || pixelAt(surface, 40, 4) != rightColor)
+    {
+        std::cerr << "[Test] Expected the initial render to draw every widget." << std::endl;
+        return 1;
+    }
+
+    if (layer.updateWidgetState(left, 1) || layer.hasDirtyWidgets())
+    {
+        std::cerr << "[Test] Expected an unchanged state version to keep the widget clean." << std::endl;
+        return 1;
+    }
+
+    // Scribble over the right widget; a partial render must leave it alone.
+    LICE_FillRect(&surface, 32, 0, 32, 32, scribbleColor);
+    layer.updateWidgetState(left, 2);
+
+    std::vector<RECT> dirtyRects;
+    layer.collectDirtyRects(dirtyRects);
+    if (dirtyRects.size() != 1 || dirtyRects.front().left != 0 || dirtyRects.front().right != 32)
+    {
+        std::cerr << "[Test] Expected only the changed widget to report a dirty rect." << std::endl;
+        return 1;
+    }
+
+    if (layer.renderDirty(surface) != 1 || leftDraws != 2 || rightDraws != 1 ||
+        pixelAt(surface, 40, 4) != scribbleColor)
+    {
+        std::cerr << "[Test] Expected a partial render to redraw only the dirty widget." << std::endl;
+        return 1;
+    }
+
+    layer.setWidgetBounds(right, RECT{40, 0, 64, 32});
+    RECT bounds = layer.dirtyBounds();
+    if (bounds.left != 32 || bounds.right != 64)
+    {
+        std::cerr << "[Test] Expected a moved widget to dirty both its old and new bounds." << std::endl;
+        return 1;
+    }
+
+    std::cout << "[Test] RetainedWidgetLayer dirty tracking checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include "hosting/AutomationLane.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace kj {
+
+namespace {
+
+static_assert((AutomationCaptureQueue::kCapacity & (AutomationCaptureQueue::kCapacity - 1)) == 0,
+              "Ring capacity must be a power of two");
+
+constexpr std::size_t kEncodedPointBytes = 12;
+
+void appendLE(std::vector<std::uint8_t>& out, std::uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        out.push_back(static_cast<std::uint8_t>((value >> (8 * i)) & 0xFF));
+}
+
+std::uint64_t readLE(const std::uint8_t* data, int bytes)
+{
+    std::uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i)
+        value = (value << 8) | data[i];
+    return value;
+}
+
+} // namespace
+
+float AutomationLane::valueAt(double beat, std::size_t& hint) const
+{
+    if (points.empty())
+        return 0.0f;
+
+    // Jumps backwards (loops, relocation) fall back to a binary search.
+    if (hint >= points.size() || points[hint].beat > beat)
+    {
+        auto it = std::upper_bound(points.begin(), points.end(), beat,
+                                   [](double position, const AutomationPoint& point) { return position < point.beat; });
+        hint = it == points.begin() ? 0 : static_cast<std::size_t>(it - points.begin()) - 1;
+    }
+    while (hint + 1 < points.size() && points[hint + 1].beat <= beat)
+        ++hint;
+
+    const AutomationPoint& from = points[hint];
+    if (beat <= from.beat || hint + 1 >= points.size())
+        return from.value;
+
+    const AutomationPoint& to = points[hint + 1];
+    const double t = (beat - from.beat) / (to.beat - from.beat);
+    return static_cast<float>(from.value + (to.value - from.value) * t);
+}
+
+std::vector<AutomationPoint> thinAutomationPoints(const std::vector<AutomationPoint>& points, float tolerance)
+{
+    if (points.size() <= 2)
+        return points;
+
+    std::vector<char> keep(points.size(), 0);
+    keep.front() = 1;
+    keep.back() = 1;
+
+    std::vector<std::pair<std::size_t, std::size_t>> spans;
+    spans.emplace_back(0, points.size() - 1);
+    while (!spans.empty())
+    {
+        const auto [first, last] = spans.back();
+        spans.pop_back();
+
+        const AutomationPoint& from = points[first];
+        const AutomationPoint& to = points[last];
+        const double length = to.beat - from.beat;
+        double worstError = tolerance;
+        std::size_t worst = 0;
+        for (std::size_t i = first + 1; i < last; ++i)
+        {
+            const double t = length > 0.0 ? (points[i].beat - from.beat) / length : 0.0;
+            const double expected = from.value + (to.value - from.value) * t;
+            const double error = std::abs(points[i].value - expected);
+            if (error > worstError)
+            {
+                worstError = error;
+                worst = i;
+            }
+        }
+
+        if (worst == 0)
+            continue;
+        keep[worst] = 1;
+        spans.emplace_back(first, worst);
+        spans.emplace_back(worst, last);
+    }
+
+    std::vector<AutomationPoint> thinned;
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        if (keep[i])
+            thinned.push_back(points[i]);
+    }
+    return thinned;
+}
+
+void mergeAutomationTake(AutomationLanes& lanes, std::vector<AutomationCapturePoint> take, float tolerance)
+{
+    // Stable, so changes on the same beat keep the order they arrived in.
+    std::stable_sort(take.begin(), take.end(), [](const AutomationCapturePoint& a, const AutomationCapturePoint& b) {
+        if (a.paramId != b.paramId)
+            return a.paramId < b.paramId;
+        return a.beat < b.beat;
+    });
+
+    std::vector<AutomationPoint> recorded;
+    for (std::size_t begin = 0; begin < take.size();)
+    {
+        const std::uint32_t paramId = take[begin].paramId;
+        std::size_t end = begin;
+        recorded.clear();
+        for (; end < take.size() && take[end].paramId == paramId; ++end)
+        {
+            // Only the last change on a beat is heard.
+            if (!recorded.empty() && recorded.back().beat == take[end].beat)
+                recorded.back().value = take[end].value;
+            else
+                recorded.push_back({take[end].beat, take[end].value});
+        }
+        begin = end;
+
+        auto lane = std::lower_bound(lanes.begin(), lanes.end(), paramId,
+                                     [](const AutomationLane& existing, std::uint32_t id) { return existing.paramId < id; });
+        if (lane == lanes.end() || lane->paramId != paramId)
+        {
+            lane = lanes.insert(lane, AutomationLane{});
+            lane->paramId = paramId;
+        }
+
+        const double first = recorded.front().beat;
+        const double last = recorded.back().beat;
+        auto& points = lane->points;
+        auto eraseBegin = std::lower_bound(points.begin(), points.end(), first,
+                                           [](const AutomationPoint& point, double beat) { return point.beat < beat; });
+        auto eraseEnd = std::upper_bound(eraseBegin, points.end(), last,
+                                         [](double beat, const AutomationPoint& point) { return beat < point.beat; });
+        auto thinned = thinAutomationPoints(recorded, tolerance);
+        auto insertAt = points.erase(eraseBegin, eraseEnd);
+        points.insert(insertAt, thinned.begin(), thinned.end());
+    }
+}
+
+std::vector<std::uint8_t> encodeAutomationPoints(const std::vector<AutomationPoint>& points)
+{
+    std::vector<std::uint8_t> out;
+    out.reserve(points.size() * kEncodedPointBytes);
+    for (const auto& point : points)
+    {
+        std::uint64_t beatBits = 0;
+        std::uint32_t valueBits = 0;
+        std::memcpy(&beatBits, &point.beat, sizeof(beatBits));
+        std::memcpy(&valueBits, &point.value, sizeof(valueBits));
+        appendLE(out, beatBits, 8);
+        appendLE(out, valueBits, 4);
+    }
+    return out;
+}
+
+bool decodeAutomationPoints(const std::vector<std::uint8_t>& data, std::vector<AutomationPoint>& points)
+{
+    if (data.size() % kEncodedPointBytes != 0)
+        return false;
+
+    std::vector<AutomationPoint> decoded(data.size() / kEncodedPointBytes);
+    for (std::size_t i = 0; i < decoded.size(); ++i)
+    {
+        const std::uint8_t* bytes = data.data() + i * kEncodedPointBytes;
+        const std::uint64_t beatBits = readLE(bytes, 8);
+        const auto valueBits = static_cast<std::uint32_t>(readLE(bytes + 8, 4));
+        std::memcpy(&decoded[i].beat, &beatBits, sizeof(beatBits));
+        std::memcpy(&decoded[i].value, &valueBits, sizeof(valueBits));
+        if (!std::isfinite(decoded[i].beat) || !std::isfinite(decoded[i].value) ||
+            (i > 0 && decoded[i].beat < decoded[i - 1].beat))
+            return false;
+    }
+    points = std::move(decoded);
+    return true;
+}
+
+AutomationCaptureQueue::AutomationCaptureQueue()
+{
+    ring_.resize(kCapacity);
+}
+
+bool AutomationCaptureQueue::push(const AutomationCapturePoint& point)
+{
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= kCapacity)
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ring_[head & (kCapacity - 1)] = point;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool AutomationCaptureQueue::pop(AutomationCapturePoint& point)
+{
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire))
+        return false;
+
+    point = ring_[tail & (kCapacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+void AutomationCaptureQueue::clear()
+{
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+} // namespace kj
@@ -0,0 +1,638 @@
+#include "hosting/PluginDatabase.h"
+
+#include "hosting/PluginSandbox.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <system_error>
+
+namespace kj {
+
+namespace {
+
+constexpr std::uint32_t kCacheMagic = 0x4b4a5043; // "KJPC"
+constexpr std::uint32_t kCacheVersion = 1;
+// Guards against reading garbage counts from a damaged cache.
+constexpr std::uint32_t kMaxCachedItems = 1u << 16;
+
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<std::uint8_t>& out) : out_(out) {}
+
+    template <typename T>
+    void value(T v)
+    {
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(&v);
+        out_.insert(out_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void string(const std::string& text)
+    {
+        value(static_cast<std::uint32_t>(text.size()));
+        out_.insert(out_.end(), text.begin(), text.end());
+    }
+
+private:
+    std::vector<std::uint8_t>& out_;
+};
+
+class ByteReader {
+public:
+    ByteReader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool value(T& v)
+    {
+        if (size_ - offset_ < sizeof(T))
+            return false;
+        std::memcpy(&v, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool string(std::string& text)
+    {
+        std::uint32_t length = 0;
+        if (!value(length) || size_ - offset_ < length)
+            return false;
+        text.assign(reinterpret_cast<const char*>(data_ + offset_), length);
+        offset_ += length;
+        return true;
+    }
+
+    bool count(std::uint32_t& n) { return value(n) && n <= kMaxCachedItems; }
+
+    const std::uint8_t* cursor() const { return data_ + offset_; }
+    std::size_t remaining() const { return size_ - offset_; }
+    bool skip(std::size_t n)
+    {
+        if (remaining() < n)
+            return false;
+        offset_ += n;
+        return true;
+    }
+
+private:
+    const std::uint8_t* data_;
+    std::size_t size_;
+    std::size_t offset_ = 0;
+};
+
+bool hasVst3Extension(const std::filesystem::path& path)
+{
+    auto ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".vst3";
+}
+
+std::int64_t stampOf(std::filesystem::file_time_type time)
+{
+    return static_cast<std::int64_t>(time.time_since_epoch().count());
+}
+
+std::filesystem::path environmentPath(const char* name)
+{
+#ifdef _WIN32
+    std::wstring wideName(name, name + std::strlen(name));
+    if (const wchar_t* value = _wgetenv(wideName.c_str()))
+        return std::filesystem::path(value);
+#else
+    if (const char* value = std::getenv(name))
+        return std::filesystem::path(value);
+#endif
+    return {};
+}
+
+} // namespace
+
+bool serializePluginBundleInfo(const PluginBundleInfo& info, std::vector<std::uint8_t>& out)
+{
+    out.clear();
+    ByteWriter writer(out);
+    writer.string(info.path);
+    writer.value(info.modifiedTime);
+    writer.value(info.size);
+    writer.value(static_cast<std::uint8_t>(info.valid ? 1 : 0));
+    writer.string(info.error);
+    writer.value(static_cast<std::uint32_t>(info.classes.size()));
+    for (const auto& cls : info.classes)
+    {
+        writer.string(cls.classId);
+        writer.string(cls.name);
+        writer.string(cls.category);
+        writer.string(cls.subCategories);
+        writer.string(cls.vendor);
+        writer.string(cls.version);
+        writer.string(cls.sdkVersion);
+        writer.value(cls.latencySamples);
+        writer.value(static_cast<std::uint32_t>(cls.buses.size()));
+        for (const auto& bus : cls.buses)
+        {
+            writer.string(bus.name);
+            writer.value(bus.mediaType);
+            writer.value(bus.direction);
+            writer.value(bus.busType);
+            writer.value(bus.channelCount);
+            writer.value(bus.arrangement);
+        }
+    }
+    return true;
+}
+
+bool deserializePluginBundleInfo(const std::uint8_t* data, std::size_t size, PluginBundleInfo& info)
+{
+    if (!data)
+        return false;
+
+    ByteReader reader(data, size);
+    PluginBundleInfo parsed;
+    std::uint8_t valid = 0;
+    std::uint32_t classCount = 0;
+    if (!reader.string(parsed.path) || !reader.value(parsed.modifiedTime) || !reader.value(parsed.size) ||
+        !reader.value(valid) || !reader.string(parsed.error) || !reader.count(classCount))
+        return false;
+    parsed.valid = valid != 0;
+
+    parsed.classes.resize(classCount);
+    for (auto& cls : parsed.classes)
+    {
+        std::uint32_t busCount = 0;
+        if (!reader.string(cls.classId) || !reader.string(cls.name) || !reader.string(cls.category) ||
+            !reader.string(cls.subCategories) || !reader.string(cls.vendor) || !reader.string(cls.version) ||
+            !reader.string(cls.sdkVersion) || !reader.value(cls.latencySamples) || !reader.count(busCount))
+            return false;
+
+        cls.buses.resize(busCount);
+        for (auto& bus : cls.buses)
+        {
+            if (!reader.string(bus.name) || !reader.value(bus.mediaType) || !reader.value(bus.direction) ||
+                !reader.value(bus.busType) || !reader.value(bus.channelCount) || !reader.value(bus.arrangement))
+                return false;
+        }
+    }
+
+    if (reader.remaining() != 0)
+        return false;
+    info = std::move(parsed);
+    return true;
+}
+
+bool readPluginBundleStamp(const std::filesystem::path& bundle, std::int64_t& modifiedTime, std::uint64_t& size)
+{
+    std::error_code ec;
+    const auto status = std::filesystem::status(bundle, ec);
+    if (ec || !std::filesystem::exists(status))
+        return false;
+
+    const auto bundleTime = std::filesystem::last_write_time(bundle, ec);
+    if (ec)
+        return false;
+
+    modifiedTime = stampOf(bundleTime);
+    size = 0;
+    if (std::filesystem::is_regular_file(status))
+    {
+        size = std::filesystem::file_size(bundle, ec);
+        return !ec;
+    }
+
+    // Bundle folder: binaries and moduleinfo.json; Resources only holds
+    // artwork and presets.
+    const auto contents = bundle / "Contents";
+    std::filesystem::recursive_directory_iterator it(
+        contents, std::filesystem::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+    {
+        const auto& entry = *it;
+        std::error_code entryError;
+        if (entry.is_directory(entryError))
+        {
+            if (entry.path().filename() == "Resources")
+                it.disable_recursion_pending();
+            continue;
+        }
+        if (!entry.is_regular_file(entryError))
+            continue;
+
+        const auto fileTime = entry.last_write_time(entryError);
+        if (!entryError)
+            modifiedTime = std::max(modifiedTime, stampOf(fileTime));
+        const auto fileSize = entry.file_size(entryError);
+        if (!entryError)
+            size += fileSize;
+    }
+    return true;
+}
+
+std::vector<std::filesystem::path> defaultVst3SearchPaths()
+{
+    std::vector<std::filesystem::path> paths;
+#ifdef _WIN32
+    if (auto common = environmentPath("COMMONPROGRAMFILES"); !common.empty())
+        paths.push_back(common / "VST3");
+    if (auto local = environmentPath("LOCALAPPDATA"); !local.empty())
+        paths.push_back(local / "Programs" / "Common" / "VST3");
+#elif defined(__APPLE__)
+    paths.emplace_back("/Library/Audio/Plug-Ins/VST3");
+    if (auto home = environmentPath("HOME"); !home.empty())
+        paths.push_back(home / "Library" / "Audio" / "Plug-Ins" / "VST3");
+#else
+    if (auto home = environmentPath("HOME"); !home.empty())
+        paths.push_back(home / ".vst3");
+    paths.emplace_back("/usr/lib/vst3");
+    paths.emplace_back("/usr/local/lib/vst3");
+#endif
+    return paths;
+}
+
+std::vector<std::filesystem::path> findVst3Bundles(const std::vector<std::filesystem::path>& roots)
+{
+    std::vector<std::filesystem::path> bundles;
+    for (const auto& root : roots)
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(root, ec))
+            continue;
+
+        std::filesystem::recursive_directory_iterator it(
+            root, std::filesystem::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+        {
+            if (!hasVst3Extension(it->path()))
+                continue;
+
+            std::error_code entryError;
+            if (it->is_directory(entryError))
+                it.disable_recursion_pending();
+            bundles.push_back(it->path());
+        }
+    }
+
+    std::sort(bundles.begin(), bundles.end());
+    bundles.erase(std::unique(bundles.begin(), bundles.end()), bundles.end());
+    return bundles;
+}
+
+PluginScanFunction makeSandboxedPluginScanner(const std::filesystem::path& workerExecutable)
+{
+    struct WorkerPool {
+        std::filesystem::path executable;
+        std::mutex mutex;
+        std::vector<std::shared_ptr<PluginSandboxProcess>> idle;
+    };
+
+    auto pool = std::make_shared<WorkerPool>();
+    pool->executable = workerExecutable;
+
+    return [pool](const std::filesystem::path& bundle, PluginBundleInfo& info) {
+        std::shared_ptr<PluginSandboxProcess> process;
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            while (!pool->idle.empty() && !process)
+            {
+                process = std::move(pool->idle.back());
+                pool->idle.pop_back();
+                if (!process->alive())
+                    process.reset();
+            }
+        }
+        if (!process)
+            process = PluginSandboxProcess::launch(pool->executable);
+        if (!process)
+        {
+            info.error = "Could not start the plug-in scan worker.";
+            return false;
+        }
+
+        bool scanned = false;
+        std::vector<std::uint8_t> description;
+        {
+            SandboxedPlugin plugin(process);
+            scanned = plugin.scan(bundle.u8string(), description);
+        }
+
+        if (!process->alive())
+        {
+            info.error = "Plug-in crashed or stopped responding while being scanned.";
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            pool->idle.push_back(std::move(process));
+        }
+
+        PluginBundleInfo scannedInfo;
+        if (!scanned || !deserializePluginBundleInfo(description.data(), description.size(), scannedInfo))
+        {
+            info.error = "Plug-in could not be scanned.";
+            return false;
+        }
+
+        info.valid = scannedInfo.valid;
+        info.error = std::move(scannedInfo.error);
+        info.classes = std::move(scannedInfo.classes);
+        return info.valid;
+    };
+}
+
+PluginDatabase::PluginDatabase(std::filesystem::path cacheFile) : cacheFile_(std::move(cacheFile)) {}
+
+PluginDatabase::~PluginDatabase()
+{
+    waitForScan();
+}
+
+std::string PluginDatabase::keyFor(const std::filesystem::path& bundle)
+{
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(bundle, ec);
+    auto key = (ec ? bundle : absolute).lexically_normal().generic_u8string();
+    while (key.size() > 1 && key.back() == '/')
+        key.pop_back();
+#ifdef _WIN32
+    // Windows paths are case-insensitive.
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+#endif
+    return key;
+}
+
+bool PluginDatabase::loadCache()
+{
+    std::unordered_map<std::string, std::shared_ptr<const PluginBundleInfo>> loaded;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+    std::ifstream file(cacheFile_, std::ios::binary);
+    if (!file)
+        return false;
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    ByteReader reader(bytes.data(), bytes.size());
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t count = 0;
+    if (!reader.value(magic) || magic != kCacheMagic || !reader.value(version) || version != kCacheVersion ||
+        !reader.count(count))
+    {
+        std::cerr << "[KJ] Ignoring unreadable plug-in cache " << cacheFile_.u8string() << std::endl;
+        return false;
+    }
+
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        std::uint32_t length = 0;
+        auto info = std::make_shared<PluginBundleInfo>();
+        if (!reader.value(length) || reader.remaining() < length ||
+            !deserializePluginBundleInfo(reader.cursor(), length, *info) || !reader.skip(length))
+        {
+            std::cerr << "[KJ] Plug-in cache " << cacheFile_.u8string() << " is damaged; rescanning." << std::endl;
+            return false;
+        }
+        loaded[keyFor(std::filesystem::u8path(info->path))] = std::move(info);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_ = std::move(loaded);
+    return true;
+}
+
+bool PluginDatabase::saveCache() const
+{
+    if (cacheFile_.empty())
+        return false;
+
+    std::vector<std::uint8_t> bytes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ByteWriter writer(bytes);
+        writer.value(kCacheMagic);
+        writer.value(kCacheVersion);
+        writer.value(static_cast<std::uint32_t>(entries_.size()));
+
+        std::vector<std::uint8_t> entry;
+        for (const auto& [key, info] : entries_)
+        {
+            serializePluginBundleInfo(*info, entry);
+            writer.value(static_cast<std::uint32_t>(entry.size()));
+            bytes.insert(bytes.end(), entry.begin(), entry.end());
+        }
+    }
+
+    std::error_code ec;
+    if (cacheFile_.has_parent_path())
+        std::filesystem::create_directories(cacheFile_.parent_path(), ec);
+
+    auto temporary = cacheFile_;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())))
+        {
+            std::cerr << "[KJ] Failed to write plug-in cache " << temporary.u8string() << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporary, cacheFile_, ec);
+    if (ec)
+    {
+        std::cerr << "[KJ] Failed to replace plug-in cache " << cacheFile_.u8string() << ": " << ec.message()
+                  << std::endl;
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+std::size_t PluginDatabase::refresh(const std::vector<std::filesystem::path>& bundles,
+                                    const PluginScanFunction& scanner, unsigned threadCount)
+{
+    struct Pending {
+        std::filesystem::path bundle;
+        std::string key;
+        std::shared_ptr<PluginBundleInfo> info;
+        bool attempted = false;
+    };
+
+    // Stamp the bundles before taking the lock; lookups keep working meanwhile.
+    std::vector<Pending> stamped;
+    for (const auto& bundle : bundles)
+    {
+        auto info = std::make_shared<PluginBundleInfo>();
+        if (!readPluginBundleStamp(bundle, info->modifiedTime, info->size))
+            continue;
+        info->path = bundle.u8string();
+        stamped.push_back({bundle, keyFor(bundle), std::move(info)});
+    }
+
+    std::unordered_map<std::string, std::shared_ptr<const PluginBundleInfo>> current;
+    std::vector<Pending> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& item : stamped)
+        {
+            if (current.count(item.key))
+                continue;
+
+            auto found = entries_.find(item.key);
+            if (found != entries_.end() && found->second->modifiedTime == item.info->modifiedTime &&
+                found->second->size == item.info->size)
+            {
+                current.emplace(item.key, found->second);
+                continue;
+            }
+
+            current.emplace(item.key, nullptr);
+            pending.push_back(std::move(item));
+        }
+    }
+
+    if (!pending.empty() && scanner)
+    {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::min<unsigned>(threadCount, static_cast<unsigned>(pending.size()));
+
+        std::atomic<std::size_t> next {0};
+        auto scanLoop = [&]() {
+            for (std::size_t i = next.fetch_add(1); i < pending.size(); i = next.fetch_add(1))
+            {
+                if (cancelled_.load(std::memory_order_acquire))
+                    break;
+
+                auto& item = pending[i];
+                item.attempted = true;
+                bool scanned = false;
+                try
+                {
+                    scanned = scanner(item.bundle, *item.info);
+                }
+                catch (const std::exception& ex)
+                {
+                    item.info->error = ex.what();
+                }
+                catch (...)
+                {
+                    item.info->error = "Unknown exception while scanning.";
+                }
+
+                item.info->valid = scanned;
+                if (!scanned)
+                {
+                    item.info->classes.clear();
+                    if (item.info->error.empty())
+                        item.info->error = "Plug-in could not be scanned.";
+                    std::cerr << "[KJ] Plug-in scan failed for " << item.info->path << ": " << item.info->error
+                              << std::endl;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < threadCount; ++t)
+            threads.emplace_back(scanLoop);
+        scanLoop();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    // Bundles that were not scanned stay unknown instead of cached.
+    std::size_t scannedCount = 0;
+    for (auto& item : pending)
+    {
+        if (item.attempted)
+        {
+            current[item.key] = std::move(item.info);
+            ++scannedCount;
+        }
+        else
+        {
+            current.erase(item.key);
+        }
+    }
+
+    cancelled_.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_ = std::move(current);
+    return scannedCount;
+}
+
+bool PluginDatabase::refreshAsync(std::vector<std::filesystem::path> bundles, PluginScanFunction scanner,
+                                  std::function<void(std::size_t)> onFinished, unsigned threadCount)
+{
+    std::lock_guard<std::mutex> lock(scanMutex_);
+    if (scanning_.load(std::memory_order_acquire))
+        return false;
+    if (scanThread_.joinable())
+        scanThread_.join();
+
+    cancelled_.store(false, std::memory_order_release);
+    scanning_.store(true, std::memory_order_release);
+    scanThread_ = std::thread([this, bundles = std::move(bundles), scanner = std::move(scanner),
+                               onFinished = std::move(onFinished), threadCount]() {
+        const auto scanned = refresh(bundles, scanner, threadCount);
+        if (scanned > 0)
+            saveCache();
+        scanning_.store(false, std::memory_order_release);
+        if (onFinished)
+            onFinished(scanned);
+    });
+    return true;
+}
+
+void PluginDatabase::waitForScan()
+{
+    std::lock_guard<std::mutex> lock(scanMutex_);
+    if (scanThread_.joinable())
+        scanThread_.join();
+}
+
+std::optional<PluginBundleInfo> PluginDatabase::findBundle(const std::filesystem::path& bundle) const
+{
+    const auto key = keyFor(bundle);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = entries_.find(key);
+    if (found == entries_.end())
+        return std::nullopt;
+    return *found->second;
+}
+
+std::optional<PluginBundleInfo> PluginDatabase::findClass(const std::string& classId) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [key, info] : entries_)
+    {
+        if (!info->valid)
+            continue;
+        for (const auto& cls : info->classes)
+        {
+            if (cls.classId == classId)
+                return *info;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<PluginBundleInfo> PluginDatabase::bundles() const
+{
+    std::vector<PluginBundleInfo> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.reserve(entries_.size());
+        for (const auto& [key, info] : entries_)
+            result.push_back(*info);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const PluginBundleInfo& a, const PluginBundleInfo& b) { return a.path < b.path; });
+    return result;
+}
+
+} // namespace kj
@@ -0,0 +1,1146 @@
+#include "hosting/PluginSandbox.h"
+
+#include "core/denormals.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+extern char** environ;
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+
+namespace kj {
+
+namespace {
+
+enum SandboxCommand : std::uint32_t {
+    kSandboxCommandNone = 0,
+    kSandboxCommandLoad,
+    kSandboxCommandPrepare,
+    kSandboxCommandProcess,
+    kSandboxCommandSaveState,
+    kSandboxCommandLoadState,
+    kSandboxCommandUnload,
+    kSandboxCommandScan,
+};
+
+constexpr std::uint32_t kSandboxMagic = 0x4b4a5342; // "KJSB"
+constexpr std::uint32_t kSandboxLayoutVersion = 3;
+
+constexpr auto kWorkerStartTimeout = std::chrono::seconds(10);
+constexpr auto kWorkerShutdownTimeout = std::chrono::seconds(1);
+constexpr auto kWorkerIdleWait = std::chrono::milliseconds(200);
+// Longest single wait while blocking on a control request; the worker's exit
+// status is checked in between.
+constexpr auto kControlPollInterval = std::chrono::milliseconds(100);
+constexpr auto kLoadTimeout = std::chrono::milliseconds(30000);
+constexpr auto kControlTimeout = std::chrono::milliseconds(10000);
+// A process request still unanswered after this long means the worker hangs.
+constexpr auto kStallLimit = std::chrono::seconds(2);
+
+void recordMaximum(std::atomic<std::uint64_t>& maximum, std::uint64_t value)
+{
+    std::uint64_t previous = maximum.load(std::memory_order_relaxed);
+    while (value > previous && !maximum.compare_exchange_weak(previous, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+double averageMicros(const std::atomic<std::uint64_t>& totalNanos, std::uint64_t count)
+{
+    if (count == 0)
+        return 0.0;
+    return static_cast<double>(totalNanos.load(std::memory_order_relaxed)) / 1000.0 / static_cast<double>(count);
+}
+
+} // namespace
+
+struct SandboxSlot {
+    std::atomic<std::uint32_t> request {0};
+    std::atomic<std::uint32_t> reply {0};
+    std::uint32_t command = kSandboxCommandNone;
+    std::int32_t result = 0;
+    double sampleRate = 0.0;
+    std::int32_t blockSize = 0;
+    std::int32_t numSamples = 0;
+    std::int32_t numChannels = 0;
+    std::int32_t latencySamples = 0;
+    std::int32_t parameterCount = 0;
+    std::uint32_t eventCount = 0;
+    std::uint32_t pointCount = 0;
+    std::uint64_t renderNanos = 0;
+    std::uint64_t messageSize = 0;
+    SandboxTransport transport;
+    Steinberg::Vst::Event events[kSandboxMaxEvents];
+    SandboxParameterPoint points[kSandboxMaxParameterPoints];
+    float outputs[kSandboxMaxChannels][kSandboxMaxBlockSize];
+    std::uint8_t message[kSandboxMaxMessageBytes];
+};
+
+struct SandboxSharedMemory {
+    std::uint32_t magic = kSandboxMagic;
+    std::uint32_t layoutVersion = kSandboxLayoutVersion;
+    std::atomic<std::uint32_t> doorbell {0};
+    std::atomic<std::uint32_t> workerReady {0};
+    std::atomic<std::uint32_t> shutdown {0};
+    SandboxSlot slots[kSandboxMaxSlots];
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "Sandbox wait words must be lock-free to be shared between processes.");
+
+namespace {
+
+// Doorbell and reply wake-ups. On Linux the shared counters are futex words;
+// Windows cannot wait on memory across processes, so each word gets a named
+// semaphore. Either way the counters are the source of truth and wake-ups may
+// be spurious.
+class SandboxSignals {
+public:
+    SandboxSignals() = default;
+    SandboxSignals(const SandboxSignals&) = delete;
+    SandboxSignals& operator=(const SandboxSignals&) = delete;
+    ~SandboxSignals() { close(); }
+
+    bool open(const std::string& name, bool create);
+    void close();
+
+    void ringDoorbell(SandboxSharedMemory& shared);
+    void waitDoorbell(SandboxSharedMemory& shared, std::uint32_t seen, std::chrono::nanoseconds timeout);
+    void wakeReply(SandboxSlot& slot, int index);
+    void waitReply(SandboxSlot& slot, int index, std::uint32_t seen, std::chrono::nanoseconds timeout);
+    void wakeWorkerReady(SandboxSharedMemory& shared);
+    void waitWorkerReady(SandboxSharedMemory& shared, std::chrono::nanoseconds timeout);
+
+private:
+#ifdef _WIN32
+    HANDLE doorbell_ = nullptr;
+    HANDLE ready_ = nullptr;
+    std::array<HANDLE, kSandboxMaxSlots> replies_ {};
+#endif
+};
+
+#ifdef _WIN32
+
+std::wstring widen(const std::string& text)
+{
+    return std::wstring(text.begin(), text.end());
+}
+
+DWORD toMilliseconds(std::chrono::nanoseconds timeout)
+{
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeout + std::chrono::microseconds(999));
+    return static_cast<DWORD>(std::clamp<long long>(ms.count(), 0, 0x7fffffff));
+}
+
+HANDLE openSemaphore(const std::string& name, bool create)
+{
+    const std::wstring wideName = widen("Local\\" + name);
+    if (create)
+        return CreateSemaphoreW(nullptr, 0, 0x7fffffff, wideName.c_str());
+    return OpenSemaphoreW(SEMAPHORE_MODIFY_STATE | SYNCHRONIZE, FALSE, wideName.c_str());
+}
+
+bool SandboxSignals::open(const std::string& name, bool create)
+{
+    doorbell_ = openSemaphore(name + "-bell", create);
+    ready_ = openSemaphore(name + "-ready", create);
+    bool ok = doorbell_ && ready_;
+    for (int i = 0; i < kSandboxMaxSlots; ++i)
+    {
+        replies_[static_cast<std::size_t>(i)] = openSemaphore(name + "-reply" + std::to_string(i), create);
+        ok = ok && replies_[static_cast<std::size_t>(i)];
+    }
+    return ok;
+}
+
+void SandboxSignals::close()
+{
+    for (HANDLE* handle : {&doorbell_, &ready_})
+    {
+        if (*handle)
+            CloseHandle(*handle);
+        *handle = nullptr;
+    }
+    for (auto& reply : replies_)
+    {
+        if (reply)
+            CloseHandle(reply);
+        reply = nullptr;
+    }
+}
+
+void SandboxSignals::ringDoorbell(SandboxSharedMemory& shared)
+{
+    shared.doorbell.fetch_add(1, std::memory_order_acq_rel);
+    ReleaseSemaphore(doorbell_, 1, nullptr);
+}
+
+void SandboxSignals::waitDoorbell(SandboxSharedMemory& shared, std::uint32_t seen, std::chrono::nanoseconds timeout)
+{
+    if (shared.doorbell.load(std::memory_order_acquire) == seen)
+        WaitForSingleObject(doorbell_, toMilliseconds(timeout));
+}
+
+void SandboxSignals::wakeReply(SandboxSlot&, int index)
+{
+    ReleaseSemaphore(replies_[static_cast<std::size_t>(index)], 1, nullptr);
+}
+
+void SandboxSignals::waitReply(SandboxSlot& slot, int index, std::uint32_t seen, std::chrono::nanoseconds timeout)
+{
+    if (slot.reply.load(std::memory_order_acquire) == seen)
+        WaitForSingleObject(replies_[static_cast<std::size_t>(index)], toMilliseconds(timeout));
+}
+
+void SandboxSignals::wakeWorkerReady(SandboxSharedMemory&)
+{
+    ReleaseSemaphore(ready_, 1, nullptr);
+}
+
+void SandboxSignals::waitWorkerReady(SandboxSharedMemory& shared, std::chrono::nanoseconds timeout)
+{
+    if (shared.workerReady.load(std::memory_order_acquire) == 0)
+        WaitForSingleObject(ready_, toMilliseconds(timeout));
+}
+
+#else
+
+void wakeWord(std::atomic<std::uint32_t>& word)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+void waitWord(std::atomic<std::uint32_t>& word, std::uint32_t seen, std::chrono::nanoseconds timeout)
+{
+    if (timeout <= std::chrono::nanoseconds::zero())
+        return;
+#if defined(__linux__)
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec ts {};
+    ts.tv_sec = static_cast<time_t>(seconds.count());
+    ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+    // Shared (not FUTEX_PRIVATE) so the wake-up crosses processes.
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, seen, &ts, nullptr, 0);
+#else
+    if (word.load(std::memory_order_acquire) == seen)
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::microseconds(50)));
+#endif
+}
+
+bool SandboxSignals::open(const std::string&, bool)
+{
+    return true;
+}
+
+void SandboxSignals::close() {}
+
+void SandboxSignals::ringDoorbell(SandboxSharedMemory& shared)
+{
+    shared.doorbell.fetch_add(1, std::memory_order_acq_rel);
+    wakeWord(shared.doorbell);
+}
+
+void SandboxSignals::waitDoorbell(SandboxSharedMemory& shared, std::uint32_t seen, std::chrono::nanoseconds timeout)
+{
+    waitWord(shared.doorbell, seen, timeout);
+}
+
+void SandboxSignals::wakeReply(SandboxSlot& slot, int)
+{
+    wakeWord(slot.reply);
+}
+
+void SandboxSignals::waitReply(SandboxSlot& slot, int, std::uint32_t seen, std::chrono::nanoseconds timeout)
+{
+    waitWord(slot.reply, seen, timeout);
+}
+
+void SandboxSignals::wakeWorkerReady(SandboxSharedMemory& shared)
+{
+    wakeWord(shared.workerReady);
+}
+
+void SandboxSignals::waitWorkerReady(SandboxSharedMemory& shared, std::chrono::nanoseconds timeout)
+{
+    waitWord(shared.workerReady, 0, timeout);
+}
+
+#endif
+
+// Maps the shared segment. The creator sizes and initialises it.
+class SandboxMapping {
+public:
+    SandboxMapping() = default;
+    SandboxMapping(const SandboxMapping&) = delete;
+    SandboxMapping& operator=(const SandboxMapping&) = delete;
+    ~SandboxMapping() { close(); }
+
+    SandboxSharedMemory* open(const std::string& name, bool create);
+    void unlinkName();
+    void close();
+
+private:
+    SandboxSharedMemory* shared_ = nullptr;
+    std::string name_;
+#ifdef _WIN32
+    HANDLE mapping_ = nullptr;
+#else
+    bool linked_ = false;
+#endif
+};
+
+SandboxSharedMemory* SandboxMapping::open(const std::string& name, bool create)
+{
+    name_ = name;
+    const std::size_t size = sizeof(SandboxSharedMemory);
+    void* memory = nullptr;
+#ifdef _WIN32
+    const std::wstring wideName = widen("Local\\" + name);
+    if (create)
+    {
+        mapping_ = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<std::uint64_t>(size) >> 32),
+                                      static_cast<DWORD>(size & 0xffffffffu), wideName.c_str());
+    }
+    else
+    {
+        mapping_ = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, wideName.c_str());
+    }
+    if (!mapping_)
+        return nullptr;
+    memory = MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!memory)
+        return nullptr;
+#else
+    const std::string path = "/" + name;
+    int fd = create ? shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600) : shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        return nullptr;
+    linked_ = create;
+    if (create && ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        ::close(fd);
+        unlinkName();
+        return nullptr;
+    }
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        unlinkName();
+        return nullptr;
+    }
+#endif
+    shared_ = create ? new (memory) SandboxSharedMemory() : static_cast<SandboxSharedMemory*>(memory);
+    return shared_;
+}
+
+void SandboxMapping::unlinkName()
+{
+#ifndef _WIN32
+    if (linked_)
+        shm_unlink(("/" + name_).c_str());
+    linked_ = false;
+#endif
+}
+
+void SandboxMapping::close()
+{
+#ifdef _WIN32
+    if (shared_)
+        UnmapViewOfFile(shared_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    mapping_ = nullptr;
+#else
+    if (shared_)
+        munmap(shared_, sizeof(SandboxSharedMemory));
+    unlinkName();
+#endif
+    shared_ = nullptr;
+}
+
+void serveRequest(SandboxSlot& slot, std::unique_ptr<SandboxProcessor>& processor,
+                  const SandboxProcessorFactory& factory, std::vector<std::uint8_t>& stateBuffer)
+{
+    switch (slot.command)
+    {
+    case kSandboxCommandLoad:
+    {
+        const auto size = static_cast<std::size_t>(std::min<std::uint64_t>(slot.messageSize, kSandboxMaxMessageBytes));
+        std::string path(reinterpret_cast<const char*>(slot.message), size);
+        processor = factory ? factory() : nullptr;
+        bool loaded = processor && processor->load(path);
+        if (!loaded)
+            processor.reset();
+        slot.parameterCount = loaded ? processor->parameterCount() : 0;
+        slot.result = loaded ? 1 : 0;
+        break;
+    }
+    case kSandboxCommandPrepare:
+    {
+        const int blockSize = std::clamp(slot.blockSize, 1, kSandboxMaxBlockSize);
+        bool prepared = processor && processor->prepare(slot.sampleRate, blockSize);
+        slot.latencySamples = prepared ? std::max(0, processor->latencySamples()) : 0;
+        slot.result = prepared ? 1 : 0;
+        break;
+    }
+    case kSandboxCommandProcess:
+    {
+        const int numSamples = std::clamp(slot.numSamples, 0, kSandboxMaxBlockSize);
+        const int numChannels = std::clamp(slot.numChannels, 0, kSandboxMaxChannels);
+        float* outputs[kSandboxMaxChannels] = {};
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            outputs[ch] = slot.outputs[ch];
+            std::fill(outputs[ch], outputs[ch] + numSamples, 0.0f);
+        }
+
+        SandboxBlock block;
+        block.numSamples = numSamples;
+        block.numChannels = numChannels;
+        block.outputs = outputs;
+        block.events = slot.events;
+        block.eventCount = std::min<std::size_t>(slot.eventCount, kSandboxMaxEvents);
+        block.points = slot.points;
+        block.pointCount = std::min<std::size_t>(slot.pointCount, kSandboxMaxParameterPoints);
+        block.transport = slot.transport;
+        slot.renderNanos = 0;
+        if (processor && numSamples > 0)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            processor->process(block);
+            slot.renderNanos = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            slot.latencySamples = std::max(0, processor->latencySamples());
+        }
+        slot.result = processor ? 1 : 0;
+        break;
+    }
+    case kSandboxCommandSaveState:
+    {
+        stateBuffer.clear();
+        bool saved = processor && processor->saveState(stateBuffer) && stateBuffer.size() <= kSandboxMaxMessageBytes;
+        if (saved)
+            std::memcpy(slot.message, stateBuffer.data(), stateBuffer.size());
+        slot.messageSize = saved ? stateBuffer.size() : 0;
+        slot.result = saved ? 1 : 0;
+        break;
+    }
+    case kSandboxCommandLoadState:
+    {
+        const auto size = static_cast<std::size_t>(std::min<std::uint64_t>(slot.messageSize, kSandboxMaxMessageBytes));
+        slot.result = processor && processor->loadState(slot.message, size) ? 1 : 0;
+        break;
+    }
+    case kSandboxCommandUnload:
+        processor.reset();
+        slot.result = 1;
+        break;
+    case kSandboxCommandScan:
+    {
+        const auto size = static_cast<std::size_t>(std::min<std::uint64_t>(slot.messageSize, kSandboxMaxMessageBytes));
+        std::string path(reinterpret_cast<const char*>(slot.message), size);
+        auto scanner = factory ? factory() : nullptr;
+        stateBuffer.clear();
+        bool scanned = scanner && scanner->scan(path, stateBuffer) && stateBuffer.size() <= kSandboxMaxMessageBytes;
+        if (scanned)
+            std::memcpy(slot.message, stateBuffer.data(), stateBuffer.size());
+        slot.messageSize = scanned ? stateBuffer.size() : 0;
+        slot.result = scanned ? 1 : 0;
+        break;
+    }
+    default:
+        slot.result = 0;
+        break;
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Worker side
+// ---------------------------------------------------------------------------
+
+bool isSandboxWorkerCommandLine(int argc, char** argv)
+{
+    return argc >= 4 && argv && argv[1] && std::strcmp(argv[1], kSandboxWorkerFlag) == 0;
+}
+
+int runSandboxWorker(int argc, char** argv, const SandboxProcessorFactory& factory)
+{
+    if (!isSandboxWorkerCommandLine(argc, argv))
+        return 2;
+
+    const std::string name = argv[2];
+    const auto parentPid = std::strtoll(argv[3], nullptr, 10);
+
+#ifdef _WIN32
+    HANDLE parent = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(parentPid));
+    auto parentAlive = [parent]() { return !parent || WaitForSingleObject(parent, 0) != WAIT_OBJECT_0; };
+#else
+#if defined(__linux__)
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+    auto parentAlive = [parentPid]() { return static_cast<long long>(getppid()) == parentPid; };
+#endif
+
+    SandboxMapping mapping;
+    SandboxSharedMemory* shared = parentAlive() ? mapping.open(name, false) : nullptr;
+    SandboxSignals signals;
+    if (!shared || shared->magic != kSandboxMagic || shared->layoutVersion != kSandboxLayoutVersion ||
+        !signals.open(name, false))
+    {
+        std::cerr << "[KJ] Plug-in worker could not attach to " << name << std::endl;
+        return 3;
+    }
+
+    std::array<std::unique_ptr<SandboxProcessor>, kSandboxMaxSlots> processors;
+    std::array<std::uint32_t, kSandboxMaxSlots> handled {};
+    for (int i = 0; i < kSandboxMaxSlots; ++i)
+        handled[static_cast<std::size_t>(i)] = shared->slots[i].request.load(std::memory_order_acquire);
+    std::vector<std::uint8_t> stateBuffer;
+    // The worker processes audio the way the render thread would.
+    ScopedDenormalFlush denormalFlush;
+
+    shared->workerReady.store(1, std::memory_order_release);
+    signals.wakeWorkerReady(*shared);
+
+    while (shared->shutdown.load(std::memory_order_acquire) == 0)
+    {
+        // Read the doorbell before scanning so a request posted during the
+        // scan still wakes the wait below.
+        const std::uint32_t bell = shared->doorbell.load(std::memory_order_acquire);
+        bool served = false;
+        for (int i = 0; i < kSandboxMaxSlots; ++i)
+        {
+            auto& slot = shared->slots[i];
+            const auto index = static_cast<std::size_t>(i);
+            const std::uint32_t request = slot.request.load(std::memory_order_acquire);
+            if (request == handled[index])
+                continue;
+
+            handled[index] = request;
+            served = true;
+            serveRequest(slot, processors[index], factory, stateBuffer);
+            slot.reply.store(request, std::memory_order_release);
+            signals.wakeReply(slot, i);
+        }
+
+        if (served)
+            continue;
+        if (!parentAlive())
+            break;
+        signals.waitDoorbell(*shared, bell, kWorkerIdleWait);
+    }
+
+    for (auto& processor : processors)
+        processor.reset();
+#ifdef _WIN32
+    if (parent)
+        CloseHandle(parent);
+#endif
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Host side
+// ---------------------------------------------------------------------------
+
+struct PluginSandboxProcess::Platform {
+    SandboxMapping mapping;
+    SandboxSignals signals;
+    std::mutex exitMutex;
+#ifdef _WIN32
+    HANDLE process = nullptr;
+#else
+    pid_t pid = -1;
+#endif
+};
+
+PluginSandboxProcess::PluginSandboxProcess() : platform_(std::make_unique<Platform>()) {}
+
+std::shared_ptr<PluginSandboxProcess> PluginSandboxProcess::launch(const std::filesystem::path& workerExecutable)
+{
+    static std::atomic<unsigned> launchCounter {0};
+
+    std::shared_ptr<PluginSandboxProcess> sandbox(new PluginSandboxProcess());
+    auto& platform = *sandbox->platform_;
+
+#ifdef _WIN32
+    const auto ownPid = static_cast<long long>(GetCurrentProcessId());
+#else
+    const auto ownPid = static_cast<long long>(getpid());
+#endif
+    const std::string name = "kj-sandbox-" + std::to_string(ownPid) + "-" +
+                             std::to_string(launchCounter.fetch_add(1, std::memory_order_relaxed));
+
+    sandbox->shared_ = platform.mapping.open(name, true);
+    if (!sandbox->shared_ || !platform.signals.open(name, true))
+    {
+        std::cerr << "[KJ] Failed to create plug-in sandbox memory " << name << std::endl;
+        return nullptr;
+    }
+
+#ifdef _WIN32
+    std::wstring commandLine = L"\"" + workerExecutable.wstring() + L"\" " + widen(kSandboxWorkerFlag) + L" " +
+                               widen(name) + L" " + std::to_wstring(ownPid);
+    STARTUPINFOW startup {};
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION info {};
+    if (!CreateProcessW(workerExecutable.c_str(), commandLine.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr,
+                        nullptr, &startup, &info))
+    {
+        std::cerr << "[KJ] Failed to start plug-in worker " << workerExecutable.string() << std::endl;
+        return nullptr;
+    }
+    CloseHandle(info.hThread);
+    platform.process = info.hProcess;
+#else
+    const std::string executable = workerExecutable.string();
+    const std::string pidText = std::to_string(ownPid);
+    char* args[] = {const_cast<char*>(executable.c_str()), const_cast<char*>(kSandboxWorkerFlag),
+                    const_cast<char*>(name.c_str()), const_cast<char*>(pidText.c_str()), nullptr};
+    if (posix_spawn(&platform.pid, executable.c_str(), nullptr, nullptr, args, environ) != 0)
+    {
+        platform.pid = -1;
+        std::cerr << "[KJ] Failed to start plug-in worker " << executable << std::endl;
+        return nullptr;
+    }
+#endif
+
+    const auto deadline = std::chrono::steady_clock::now() + kWorkerStartTimeout;
+    while (sandbox->shared_->workerReady.load(std::memory_order_acquire) == 0)
+    {
+        sandbox->checkWorkerExited();
+        const auto now = std::chrono::steady_clock::now();
+        if (!sandbox->alive() || now >= deadline)
+        {
+            std::cerr << "[KJ] Plug-in worker did not start." << std::endl;
+            sandbox->terminate();
+            return nullptr;
+        }
+        platform.signals.waitWorkerReady(*sandbox->shared_, std::min<std::chrono::nanoseconds>(deadline - now,
+                                                                                               kControlPollInterval));
+    }
+
+    // Both sides have it mapped; drop the name so nothing leaks if either dies.
+    platform.mapping.unlinkName();
+    return sandbox;
+}
+
+PluginSandboxProcess::~PluginSandboxProcess()
+{
+    if (shared_ && alive())
+    {
+        shared_->shutdown.store(1, std::memory_order_release);
+        platform_->signals.ringDoorbell(*shared_);
+
+        const auto deadline = std::chrono::steady_clock::now() + kWorkerShutdownTimeout;
+        while (alive() && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            checkWorkerExited();
+        }
+    }
+
+    terminate();
+#ifdef _WIN32
+    if (platform_->process)
+    {
+        WaitForSingleObject(platform_->process, INFINITE);
+        CloseHandle(platform_->process);
+        platform_->process = nullptr;
+    }
+#else
+    if (platform_->pid > 0)
+    {
+        int status = 0;
+        waitpid(platform_->pid, &status, 0);
+        platform_->pid = -1;
+    }
+#endif
+    platform_->signals.close();
+    platform_->mapping.close();
+}
+
+int PluginSandboxProcess::acquireSlot()
+{
+    if (!alive())
+        return -1;
+    std::lock_guard<std::mutex> lock(slotsMutex_);
+    for (int i = 0; i < kSandboxMaxSlots; ++i)
+    {
+        if (!slotUsed_[static_cast<std::size_t>(i)])
+        {
+            slotUsed_[static_cast<std::size_t>(i)] = true;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void PluginSandboxProcess::releaseSlot(int slot)
+{
+    if (slot < 0 || slot >= kSandboxMaxSlots)
+        return;
+    std::lock_guard<std::mutex> lock(slotsMutex_);
+    slotUsed_[static_cast<std::size_t>(slot)] = false;
+}
+
+int PluginSandboxProcess::freeSlotCount() const
+{
+    if (!alive())
+        return 0;
+    std::lock_guard<std::mutex> lock(slotsMutex_);
+    return static_cast<int>(std::count(slotUsed_.begin(), slotUsed_.end(), false));
+}
+
+void PluginSandboxProcess::terminate()
+{
+    failed_.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(platform_->exitMutex);
+#ifdef _WIN32
+    if (platform_->process && WaitForSingleObject(platform_->process, 0) != WAIT_OBJECT_0)
+        TerminateProcess(platform_->process, 1);
+#else
+    // Reaped in the destructor; terminate() may run on the audio thread.
+    if (platform_->pid > 0)
+        kill(platform_->pid, SIGKILL);
+#endif
+}
+
+SandboxSlot& PluginSandboxProcess::slot(int index)
+{
+    return shared_->slots[index];
+}
+
+std::uint32_t PluginSandboxProcess::post(int index)
+{
+    const std::uint32_t sequence = slot(index).request.fetch_add(1, std::memory_order_acq_rel) + 1;
+    platform_->signals.ringDoorbell(*shared_);
+    return sequence;
+}
+
+bool PluginSandboxProcess::replied(int index, std::uint32_t sequence) const
+{
+    return shared_->slots[index].reply.load(std::memory_order_acquire) == sequence;
+}
+
+bool PluginSandboxProcess::waitReply(int index, std::uint32_t sequence, std::chrono::nanoseconds timeout)
+{
+    auto& target = slot(index);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true)
+    {
+        const std::uint32_t current = target.reply.load(std::memory_order_acquire);
+        if (current == sequence)
+            return true;
+        if (!alive())
+            return false;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            checkWorkerExited();
+            return false;
+        }
+
+        const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+        platform_->signals.waitReply(target, index, current, std::min<std::chrono::nanoseconds>(remaining,
+                                                                                                kControlPollInterval));
+        if (remaining > kControlPollInterval)
+            checkWorkerExited();
+    }
+}
+
+bool PluginSandboxProcess::awaitReply(int index, std::uint32_t sequence, std::chrono::nanoseconds timeout)
+{
+    auto& target = slot(index);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true)
+    {
+        const std::uint32_t current = target.reply.load(std::memory_order_acquire);
+        if (current == sequence)
+            return true;
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline || !alive())
+            return false;
+        platform_->signals.waitReply(target, index, current,
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now));
+    }
+}
+
+void PluginSandboxProcess::checkWorkerExited()
+{
+    std::lock_guard<std::mutex> lock(platform_->exitMutex);
+#ifdef _WIN32
+    if (platform_->process && WaitForSingleObject(platform_->process, 0) == WAIT_OBJECT_0)
+        failed_.store(true, std::memory_order_release);
+#else
+    if (platform_->pid <= 0)
+        return;
+    int status = 0;
+    if (waitpid(platform_->pid, &status, WNOHANG) == platform_->pid)
+    {
+        platform_->pid = -1;
+        failed_.store(true, std::memory_order_release);
+    }
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// SandboxedPlugin
+// ---------------------------------------------------------------------------
+
+SandboxedPlugin::SandboxedPlugin(std::shared_ptr<PluginSandboxProcess> process) : process_(std::move(process))
+{
+    if (process_)
+        slot_ = process_->acquireSlot();
+    pendingEvents_.reserve(kSandboxMaxEvents);
+    pendingPoints_.reserve(kSandboxMaxParameterPoints);
+}
+
+SandboxedPlugin::~SandboxedPlugin()
+{
+    if (slot_ < 0)
+        return;
+    unload();
+    process_->releaseSlot(slot_);
+}
+
+bool SandboxedPlugin::control(std::uint32_t command, std::chrono::milliseconds timeout)
+{
+    auto& slot = process_->slot(slot_);
+    slot.command = command;
+    const std::uint32_t sequence = process_->post(slot_);
+    if (!process_->waitReply(slot_, sequence, timeout))
+    {
+        std::cerr << "[KJ] Plug-in worker did not answer; terminating it." << std::endl;
+        process_->terminate();
+        return false;
+    }
+    return slot.result != 0;
+}
+
+// The block in flight is dropped; control requests reset the pipeline.
+bool SandboxedPlugin::drainInFlightRequest(std::chrono::nanoseconds timeout)
+{
+    if (!inFlight_)
+        return true;
+    if (!process_->waitReply(slot_, inFlightSequence_, timeout))
+        return false;
+    inFlight_ = false;
+    return true;
+}
+
+bool SandboxedPlugin::load(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    prepared_.store(false, std::memory_order_release);
+    if (!valid() || crashed() || path.size() > kSandboxMaxMessageBytes || !drainInFlightRequest(kControlTimeout))
+        return false;
+
+    auto& slot = process_->slot(slot_);
+    std::memcpy(slot.message, path.data(), path.size());
+    slot.messageSize = path.size();
+    if (!control(kSandboxCommandLoad, kLoadTimeout))
+        return false;
+    parameterCount_ = slot.parameterCount;
+    return true;
+}
+
+bool SandboxedPlugin::prepare(double sampleRate, int maxBlockSize)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    prepared_.store(false, std::memory_order_release);
+    if (!valid() || crashed() || sampleRate <= 0.0 || maxBlockSize <= 0 || !drainInFlightRequest(kControlTimeout))
+        return false;
+
+    const int blockSize = std::min(maxBlockSize, kSandboxMaxBlockSize);
+    auto& slot = process_->slot(slot_);
+    slot.sampleRate = sampleRate;
+    slot.blockSize = blockSize;
+    if (!control(kSandboxCommandPrepare, kControlTimeout))
+        return false;
+
+    blockSize_ = blockSize;
+    replyBudget_ = std::chrono::nanoseconds(static_cast<std::int64_t>(0.5e9 * blockSize / sampleRate));
+    for (auto& channel : ready_)
+        channel.assign(static_cast<std::size_t>(blockSize), 0.0f);
+    cursor_ = 0;
+    pendingEvents_.clear();
+    pendingPoints_.clear();
+    latencySamples_.store(slot.latencySamples + blockSize, std::memory_order_release);
+    prepared_.store(true, std::memory_order_release);
+    return true;
+}
+
+void SandboxedPlugin::unload()
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    prepared_.store(false, std::memory_order_release);
+    latencySamples_.store(0, std::memory_order_release);
+    if (valid() && !crashed() && drainInFlightRequest(kControlTimeout))
+        control(kSandboxCommandUnload, kControlTimeout);
+}
+
+bool SandboxedPlugin::saveState(std::vector<std::uint8_t>& outState)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (!valid() || crashed() || !drainInFlightRequest(kControlTimeout))
+        return false;
+    if (!control(kSandboxCommandSaveState, kControlTimeout))
+        return false;
+
+    auto& slot = process_->slot(slot_);
+    const auto size = static_cast<std::size_t>(std::min<std::uint64_t>(slot.messageSize, kSandboxMaxMessageBytes));
+    outState.assign(slot.message, slot.message + size);
+    return true;
+}
+
+bool SandboxedPlugin::loadState(const std::uint8_t* data, std::size_t size)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (!valid() || crashed() || !data || size > kSandboxMaxMessageBytes || !drainInFlightRequest(kControlTimeout))
+        return false;
+
+    auto& slot = process_->slot(slot_);
+    std::memcpy(slot.message, data, size);
+    slot.messageSize = size;
+    return control(kSandboxCommandLoadState, kControlTimeout);
+}
+
+bool SandboxedPlugin::scan(const std::string& path, std::vector<std::uint8_t>& outDescription)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (!valid() || crashed() || path.size() > kSandboxMaxMessageBytes || !drainInFlightRequest(kControlTimeout))
+        return false;
+
+    auto& slot = process_->slot(slot_);
+    std::memcpy(slot.message, path.data(), path.size());
+    slot.messageSize = path.size();
+    if (!control(kSandboxCommandScan, kLoadTimeout))
+        return false;
+
+    const auto size = static_cast<std::size_t>(std::min<std::uint64_t>(slot.messageSize, kSandboxMaxMessageBytes));
+    outDescription.assign(slot.message, slot.message + size);
+    return true;
+}
+
+void SandboxedPlugin::setParameterSource(ParameterSource source)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    parameterSource_ = std::move(source);
+}
+
+void SandboxedPlugin::process(float** outputs, int numChannels, int numSamples, const Steinberg::Vst::Event* events,
+                              std::size_t eventCount, const SandboxTransport& transport)
+{
+    if (!outputs || numSamples <= 0)
+        return;
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (outputs[ch])
+            std::fill(outputs[ch], outputs[ch] + numSamples, 0.0f);
+    }
+
+    // Control requests own the slot; play silence until they are done.
+    std::unique_lock<std::mutex> lock(controlMutex_, std::try_to_lock);
+    if (!lock.owns_lock() || !prepared_.load(std::memory_order_acquire) || crashed())
+        return;
+
+    int done = 0;
+    std::size_t nextEvent = 0;
+    while (done < numSamples)
+    {
+        if (cursor_ >= blockSize_)
+        {
+            exchange();
+            cursor_ = 0;
+        }
+        if (cursor_ == 0)
+        {
+            blockTransport_ = transport;
+            blockTransport_.samplePosition += done;
+        }
+
+        const int chunk = std::min(numSamples - done, blockSize_ - cursor_);
+        const bool lastChunk = done + chunk == numSamples;
+        for (; nextEvent < eventCount && (lastChunk || events[nextEvent].sampleOffset < done + chunk); ++nextEvent)
+        {
+            if (pendingEvents_.size() >= kSandboxMaxEvents)
+                continue;
+            Steinberg::Vst::Event event = events[nextEvent];
+            event.sampleOffset = cursor_ + std::clamp(event.sampleOffset - done, 0, chunk - 1);
+            pendingEvents_.push_back(event);
+        }
+        for (int ch = 0; ch < numChannels && ch < kSandboxMaxChannels; ++ch)
+        {
+            if (outputs[ch])
+                std::memcpy(outputs[ch] + done, ready_[static_cast<std::size_t>(ch)].data() + cursor_,
+                            static_cast<std::size_t>(chunk) * sizeof(float));
+        }
+        cursor_ += chunk;
+        done += chunk;
+    }
+}
+
+// Appends this block's parameter points to the ones held back by earlier
+// misses; the source drains its queue, so points not sent now would be lost.
+void SandboxedPlugin::gatherParameterPoints()
+{
+    Steinberg::Vst::IParameterChanges* changes = parameterSource_ ? parameterSource_(blockSize_) : nullptr;
+    const Steinberg::int32 queueCount = changes ? changes->getParameterCount() : 0;
+    for (Steinberg::int32 q = 0; q < queueCount; ++q)
+    {
+        auto* queue = changes->getParameterData(q);
+        if (!queue)
+            continue;
+        const Steinberg::int32 points = queue->getPointCount();
+        for (Steinberg::int32 p = 0; p < points; ++p)
+        {
+            Steinberg::int32 offset = 0;
+            Steinberg::Vst::ParamValue value = 0.0;
+            if (queue->getPoint(p, offset, value) != Steinberg::kResultOk)
+                continue;
+            if (pendingPoints_.size() >= kSandboxMaxParameterPoints)
+                pendingPoints_.pop_back();
+            pendingPoints_.push_back(SandboxParameterPoint {queue->getParameterId(), offset, value});
+        }
+    }
+}
+
+// Keeps the gathered block's input for the next request. Its audio is never
+// rendered, so held events move to the start of the next block and each
+// parameter keeps only its last value there.
+void SandboxedPlugin::holdPendingInput()
+{
+    for (auto& event : pendingEvents_)
+        event.sampleOffset = 0;
+
+    auto kept = pendingPoints_.end();
+    for (auto it = pendingPoints_.end(); it != pendingPoints_.begin();)
+    {
+        --it;
+        const auto id = it->id;
+        if (std::any_of(kept, pendingPoints_.end(), [id](const SandboxParameterPoint& point) { return point.id == id; }))
+            continue;
+        --kept;
+        *kept = SandboxParameterPoint {id, 0, it->value};
+    }
+    pendingPoints_.erase(pendingPoints_.begin(), kept);
+}
+
+// Posts the block just gathered and waits up to replyBudget_ for it. A block
+// that misses the wait plays as silence; while it is still being rendered at
+// the next boundary that block's input is held back, and a worker busy past
+// kStallLimit is terminated. Reaping a worker that exited is left to the
+// control calls, which are allowed to block.
+void SandboxedPlugin::exchange()
+{
+    auto& slot = process_->slot(slot_);
+    gatherParameterPoints();
+
+    auto silence = [this]() {
+        for (auto& channel : ready_)
+            std::fill(channel.begin(), channel.end(), 0.0f);
+    };
+
+    if (inFlight_)
+    {
+        if (!process_->replied(slot_, inFlightSequence_))
+        {
+            missedBlockCount_.fetch_add(1, std::memory_order_relaxed);
+            if (std::chrono::steady_clock::now() - inFlightSince_ > kStallLimit)
+                process_->terminate();
+            holdPendingInput();
+            silence();
+            return;
+        }
+        // Its turn to play has passed; the audio is dropped.
+        inFlight_ = false;
+    }
+
+    slot.command = kSandboxCommandProcess;
+    slot.numSamples = blockSize_;
+    slot.numChannels = kSandboxMaxChannels;
+    slot.transport = blockTransport_;
+    slot.eventCount = static_cast<std::uint32_t>(pendingEvents_.size());
+    std::copy(pendingEvents_.begin(), pendingEvents_.end(), slot.events);
+    pendingEvents_.clear();
+    slot.pointCount = static_cast<std::uint32_t>(pendingPoints_.size());
+    std::copy(pendingPoints_.begin(), pendingPoints_.end(), slot.points);
+    pendingPoints_.clear();
+
+    const auto postedAt = std::chrono::steady_clock::now();
+    const std::uint32_t sequence = process_->post(slot_);
+    if (!process_->awaitReply(slot_, sequence, replyBudget_))
+    {
+        inFlight_ = true;
+        inFlightSequence_ = sequence;
+        inFlightSince_ = postedAt;
+        missedBlockCount_.fetch_add(1, std::memory_order_relaxed);
+        silence();
+        return;
+    }
+
+    const auto roundTripNanos = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - postedAt).count());
+    for (int ch = 0; ch < kSandboxMaxChannels; ++ch)
+        std::memcpy(ready_[static_cast<std::size_t>(ch)].data(), slot.outputs[ch],
+                    static_cast<std::size_t>(blockSize_) * sizeof(float));
+    latencySamples_.store(slot.latencySamples + blockSize_, std::memory_order_release);
+
+    exchangeCount_.fetch_add(1, std::memory_order_relaxed);
+    totalRoundTripNanos_.fetch_add(roundTripNanos, std::memory_order_relaxed);
+    recordMaximum(maxRoundTripNanos_, roundTripNanos);
+    totalRenderNanos_.fetch_add(slot.renderNanos, std::memory_order_relaxed);
+    recordMaximum(maxRenderNanos_, slot.renderNanos);
+}
+
+double SandboxedPlugin::averageRoundTripMicros() const
+{
+    return averageMicros(totalRoundTripNanos_, exchangeCount_.load(std::memory_order_relaxed));
+}
+
+double SandboxedPlugin::maxRoundTripMicros() const
+{
+    return static_cast<double>(maxRoundTripNanos_.load(std::memory_order_relaxed)) / 1000.0;
+}
+
+double SandboxedPlugin::averageRenderMicros() const
+{
+    return averageMicros(totalRenderNanos_, exchangeCount_.load(std::memory_order_relaxed));
+}
+
+double SandboxedPlugin::maxRenderMicros() const
+{
+    return static_cast<double>(maxRenderNanos_.load(std::memory_order_relaxed)) / 1000.0;
+}
+
+} // namespace kj
@@ -0,0 +1,73 @@
+#include "hosting/PluginDatabase.h"
+#include "hosting/PluginSandbox.h"
+#include "hosting/VST3Host.h"
+
+#include <iostream>
+
+namespace {
+
+// Hosts one plug-in inside the worker process with the regular in-process
+// host; the sandbox only replaces how audio and state reach it.
+class Vst3SandboxProcessor : public kj::SandboxProcessor {
+public:
+    bool load(const std::string& path) override { return host_.load(path); }
+
+    bool prepare(double sampleRate, int maxBlockSize) override
+    {
+        processedSamples_ = 0;
+        return host_.prepare(sampleRate, maxBlockSize);
+    }
+
+    void process(const kj::SandboxBlock& block) override
+    {
+        for (std::size_t i = 0; i < block.eventCount; ++i)
+            host_.queueEvent(block.events[i]);
+        for (std::size_t i = 0; i < block.pointCount; ++i)
+        {
+            const auto& point = block.points[i];
+            host_.queueParameterPoint(point.id, point.value, processedSamples_ + point.sampleOffset);
+        }
+
+        kj::VST3Host::HostTransportState transport;
+        transport.samplePosition = block.transport.samplePosition;
+        transport.projectTimeMusic = block.transport.projectTimeMusic;
+        transport.barPositionMusic = block.transport.barPositionMusic;
+        transport.tempo = block.transport.tempo;
+        transport.timeSigNum = block.transport.timeSigNum;
+        transport.timeSigDen = block.transport.timeSigDen;
+        transport.playing = block.transport.playing;
+        host_.setTransportState(transport);
+
+        host_.process(const_cast<float**>(block.outputs), block.numChannels, block.numSamples);
+        processedSamples_ += block.numSamples;
+    }
+
+    bool saveState(std::vector<std::uint8_t>& outState) override { return host_.saveState(outState); }
+    bool loadState(const std::uint8_t* data, std::size_t size) override { return host_.loadState(data, size); }
+    int latencySamples() const override { return static_cast<int>(host_.latencySamples()); }
+    int parameterCount() const override { return host_.parameterCount(); }
+
+    bool scan(const std::string& path, std::vector<std::uint8_t>& outDescription) override
+    {
+        kj::PluginBundleInfo info;
+        info.valid = kj::VST3Host::scanBundle(path, info);
+        return kj::serializePluginBundleInfo(info, outDescription);
+    }
+
+private:
+    kj::VST3Host host_;
+    std::int64_t processedSamples_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (!kj::isSandboxWorkerCommandLine(argc, argv))
+    {
+        std::cerr << "[KJ] kj_plugin_worker is started by KJ when plug-in sandboxing is enabled." << std::endl;
+        return 1;
+    }
+
+    return kj::runSandboxWorker(argc, argv, [] { return std::make_unique<Vst3SandboxProcessor>(); });
+}
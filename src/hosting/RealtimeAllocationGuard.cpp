@@ -0,0 +1,103 @@
+#include "hosting/RealtimeAllocationGuard.h"
+
+#ifdef KJ_REALTIME_ALLOCATION_GUARD
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Plain thread_locals: operator new runs before and after any dynamic
+// initialisation, so these must not need one.
+thread_local int guardDepth = 0;
+thread_local int exemptionDepth = 0;
+thread_local bool reportedInGuard = false;
+thread_local bool reporting = false;
+std::atomic<std::size_t> violations {0};
+
+void noteAllocation(std::size_t size)
+{
+    if (guardDepth == 0 || exemptionDepth > 0 || reporting)
+        return;
+
+    violations.fetch_add(1, std::memory_order_relaxed);
+    if (reportedInGuard)
+        return;
+    reportedInGuard = true;
+
+    // Formatted on the stack; stderr is unbuffered, so reporting does not
+    // allocate either.
+    reporting = true;
+    char message[96];
+    std::snprintf(message, sizeof(message), "[KJ] Allocation of %zu bytes on the realtime audio path.\n", size);
+    std::fputs(message, stderr);
+    reporting = false;
+}
+
+void* allocate(std::size_t size)
+{
+    noteAllocation(size);
+    if (size == 0)
+        size = 1;
+    for (;;)
+    {
+        if (void* block = std::malloc(size))
+            return block;
+        auto handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+} // namespace
+
+// The default array and nothrow forms forward to these.
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+namespace kj {
+
+RealtimeAllocationGuard::RealtimeAllocationGuard()
+{
+    if (guardDepth++ == 0)
+        reportedInGuard = false;
+}
+
+RealtimeAllocationGuard::~RealtimeAllocationGuard()
+{
+    --guardDepth;
+}
+
+std::size_t RealtimeAllocationGuard::violationCount()
+{
+    return violations.load(std::memory_order_relaxed);
+}
+
+RealtimeAllocationExemption::RealtimeAllocationExemption()
+{
+    ++exemptionDepth;
+}
+
+RealtimeAllocationExemption::~RealtimeAllocationExemption()
+{
+    --exemptionDepth;
+}
+
+} // namespace kj
+
+#endif // KJ_REALTIME_ALLOCATION_GUARD
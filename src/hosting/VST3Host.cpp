@@ -10,6 +10,9 @@
 #endif
 
 #include "hosting/VST3Host.h"
+#include "hosting/PluginDatabase.h"
+#include "hosting/PluginSandbox.h"
+#include "hosting/RealtimeAllocationGuard.h"
 using namespace kj;
 
 #include "hosting/VSTEditorWindow.h"
@@ -720,6 +723,8 @@ private:
     std::unique_lock<std::mutex> lock_;
 };
 
+VST3Host::VST3Host() = default;
+
 VST3Host::~VST3Host()
 {
     unload();
@@ -734,6 +739,7 @@ void VST3Host::suspendProcessing()
 void VST3Host::resumeProcessing()
 {
     processingSuspended_.store(false, std::memory_order_release);
+    parameterQueue_.flush_overflow();
 }
 
 void VST3Host::waitForProcessingToComplete()
@@ -1084,11 +1090,8 @@ bool VST3Host::load(const std::string& pluginPath)
         currentViewType_.clear();
 
         componentHandler_ = componentHandler;
-        inputParameterChanges_.setMaxParameters(controller_->getParameterCount());
-
-        parameterChangeQueue_.clear();
+        parameterQueue_.clear();
         eventQueue_.clear();
-        processParameterChanges_.clear();
         processEvents_.clear();
 
 #ifdef _WIN32
@@ -1116,7 +1119,121 @@ bool VST3Host::load(const std::string& pluginPath)
     return false;
 }
 
-bool VST3Host::prepare(double sampleRate, int blockSize)
+bool VST3Host::scanBundle(const std::string& path, PluginBundleInfo& info)
+{
+    auto busName = [](const Steinberg::Vst::String128& name) {
+#ifdef _WIN32
+        return WideToUtf8(String128ToWide(name));
+#else
+        char ascii[VST3_STRING128_SIZE] {};
+        Steinberg::UString(const_cast<Steinberg::Vst::TChar*>(name), VST3_STRING128_SIZE).toAscii(ascii, VST3_STRING128_SIZE);
+        return std::string(ascii);
+#endif
+    };
+
+    std::string error;
+    const auto resolvedPath = resolveVST3BundlePath(std::filesystem::u8path(path));
+    auto module = Module::create(resolvedPath.u8string(), error);
+    if (!module)
+    {
+        info.error = error.empty() ? "Module could not be loaded." : error;
+        return false;
+    }
+
+    HostApplication hostApplication;
+    auto factory = module->getFactory();
+    for (const auto& classInfo : factory.classInfos())
+    {
+        PluginClassInfo cls;
+        cls.classId = fuidToString(Steinberg::FUID::fromTUID(classInfo.ID().data()));
+        cls.name = classInfo.name();
+        cls.category = classInfo.category();
+        cls.subCategories = classInfo.subCategoriesString();
+        cls.vendor = classInfo.vendor();
+        cls.version = classInfo.version();
+        cls.sdkVersion = classInfo.sdkVersion();
+
+        if (classInfo.category() == kVstAudioEffectClass)
+        {
+            auto component = factory.createInstance<IComponent>(classInfo.ID());
+            if (component && component->initialize(&hostApplication) == kResultOk)
+            {
+                auto processor = Steinberg::FUnknownPtr<IAudioProcessor>(component);
+                for (const auto mediaType : {Steinberg::Vst::kAudio, Steinberg::Vst::kEvent})
+                {
+                    for (const auto direction : {Steinberg::Vst::kInput, Steinberg::Vst::kOutput})
+                    {
+                        const Steinberg::int32 count = component->getBusCount(mediaType, direction);
+                        for (Steinberg::int32 index = 0; index < count; ++index)
+                        {
+                            BusInfo busInfo {};
+                            if (component->getBusInfo(mediaType, direction, index, busInfo) != kResultOk)
+                                continue;
+
+                            PluginBusInfo bus;
+                            bus.name = busName(busInfo.name);
+                            bus.mediaType = mediaType;
+                            bus.direction = direction;
+                            bus.busType = busInfo.busType;
+                            bus.channelCount = busInfo.channelCount;
+                            SpeakerArrangement arrangement = 0;
+                            if (mediaType == Steinberg::Vst::kAudio && processor &&
+                                processor->getBusArrangement(direction, index, arrangement) == kResultOk)
+                                bus.arrangement = arrangement;
+                            cls.buses.push_back(std::move(bus));
+                        }
+                    }
+                }
+
+                // Latency is only meaningful once processing is set up and active.
+                ProcessSetup setup {kRealtime, kSample32, 512, 48000.0};
+                if (processor && processor->setupProcessing(setup) == kResultOk &&
+                    component->setActive(true) == kResultOk)
+                {
+                    cls.latencySamples = static_cast<std::int32_t>(processor->getLatencySamples());
+                    component->setActive(false);
+                }
+                component->terminate();
+            }
+            else
+            {
+                std::cerr << "[KJ] Failed to instantiate " << cls.name << " while scanning " << path << std::endl;
+            }
+        }
+
+        info.classes.push_back(std::move(cls));
+    }
+
+    info.valid = true;
+    return true;
+}
+
+bool VST3Host::loadSandboxed(const std::string& path, std::shared_ptr<PluginSandboxProcess> sandbox)
+{
+    markLoadStarted();
+    NonRealtimeScope scope(*this);
+    unloadLocked();
+
+    auto plugin = std::make_unique<SandboxedPlugin>(std::move(sandbox));
+    if (!plugin->valid() || !plugin->load(path))
+    {
+        std::cerr << "[KJ] Failed to load " << path << " in the plug-in sandbox.\n";
+        markLoadFinished(false);
+        return false;
+    }
+
+    sandbox_ = std::move(plugin);
+    pluginPath_ = path;
+    markLoadFinished(true);
+    return true;
+}
+
+bool VST3Host::sandboxCrashed() const
+{
+    return sandbox_ && sandbox_->crashed();
+}
+
+bool VST3Host::prepare(double sampleRate, int blockSize, Steinberg::int32 processMode)
 {
     auto logArrangement = [](const char* prefix, Steinberg::Vst::BusDirection direction, Steinberg::int32 index,
                              Steinberg::Vst::SpeakerArrangement arrangement) {
@@ -1127,12 +1244,29 @@ bool VST3Host::prepare(double sampleRate, int blockSize)
     };
 
     NonRealtimeScope scope(*this);
-    if (!processor_)
-        return false;
-
     processingActive_ = false;
     preparedSampleRate_ = 0.0;
     preparedMaxBlockSize_ = 0;
+    processMode_ = processMode;
+    automationCursors_.reserve(kMaxAutomationLanes);
+    cursorLanes_ = nullptr;
+
+    if (sandbox_)
+    {
+        if (!sandbox_->prepare(sampleRate, blockSize))
+            return false;
+        processEvents_.reserve(eventQueue_.capacity());
+        parameterQueue_.prepare(sandbox_->parameterCount(), sampleRate, sandbox_->blockSize());
+        sandbox_->setParameterSource([this](int numSamples) { return parameterQueue_.collect_block(numSamples); });
+        preparedSampleRate_ = sampleRate;
+        preparedMaxBlockSize_ = blockSize;
+        processingActive_ = true;
+        latencySamples_.store(sandbox_->latencySamples(), std::memory_order_release);
+        return true;
+    }
+
+    if (!processor_)
+        return false;
 
     // --- Count buses ---
     const Steinberg::int32 inputBusCount  = component_ ? component_->getBusCount(Steinberg::Vst::kAudio, Steinberg::Vst::kInput)  : 0;
@@ -1273,7 +1407,7 @@ bool VST3Host::prepare(double sampleRate, int blockSize)
     // STEP 4: setupProcessing AFTER arrangements
     // ————————————————————————————————
     Steinberg::Vst::ProcessSetup setup {};
-    setup.processMode        = Steinberg::Vst::kRealtime;
+    setup.processMode        = processMode_;
     setup.symbolicSampleSize = Steinberg::Vst::kSample32;
     setup.maxSamplesPerBlock = blockSize;
     setup.sampleRate         = sampleRate;
@@ -1284,12 +1418,55 @@ bool VST3Host::prepare(double sampleRate, int blockSize)
     if (result != kResultOk)
         return false;
 
-    internalIn_.assign(static_cast<size_t>(inputChannelCount),
-                       std::vector<float>(static_cast<size_t>(blockSize), 0.0f));
-    internalOut_.assign(static_cast<size_t>(outputChannelCount),
-                        std::vector<float>(static_cast<size_t>(blockSize), 0.0f));
-    inputChannelPointers_.assign(static_cast<size_t>(inputChannelCount), nullptr);
-    outputChannelPointers_.assign(static_cast<size_t>(outputChannelCount), nullptr);
+    // Buffers and pointer tables for every bus, not only the main pair, plus
+    // room for a full event queue: process() only fills them in.
+    auto layoutBuses = [](const std::vector<Steinberg::Vst::SpeakerArrangement>& arrangements, Steinberg::int32 busCount,
+                          Steinberg::int32 mainIndex, Steinberg::int32 mainChannels,
+                          std::vector<AudioBusBuffers>& buses, std::vector<size_t>& firstChannels) {
+        buses.assign(static_cast<size_t>(std::max<Steinberg::int32>(0, busCount)), AudioBusBuffers {});
+        firstChannels.assign(buses.size(), 0);
+        size_t channels = 0;
+        for (size_t i = 0; i < buses.size(); ++i)
+        {
+            buses[i].numChannels = static_cast<Steinberg::int32>(i) == mainIndex
+                                       ? mainChannels
+                                       : std::max<Steinberg::int32>(0, SpeakerArr::getChannelCount(arrangements[i]));
+            firstChannels[i] = channels;
+            channels += static_cast<size_t>(buses[i].numChannels);
+        }
+        return channels;
+    };
+    const size_t inputTableSize =
+        layoutBuses(inputArrangements, inputBusCount, mainInputBusIndex_, inputChannelCount, inputBuses_, inputBusFirstChannel_);
+    const size_t outputTableSize = layoutBuses(outputArrangements, outputBusCount, mainOutputBusIndex_,
+                                               outputChannelCount, outputBuses_, outputBusFirstChannel_);
+
+    const auto blockLength = static_cast<size_t>(blockSize);
+    busStorage_.assign((inputTableSize + outputTableSize) * blockLength, 0.0f);
+    inputStorageTable_.resize(inputTableSize);
+    outputStorageTable_.resize(outputTableSize);
+    for (size_t ch = 0; ch < inputTableSize; ++ch)
+        inputStorageTable_[ch] = busStorage_.data() + ch * blockLength;
+    for (size_t ch = 0; ch < outputTableSize; ++ch)
+        outputStorageTable_[ch] = busStorage_.data() + (inputTableSize + ch) * blockLength;
+    inputChannelTable_ = inputStorageTable_;
+    outputChannelTable_ = outputStorageTable_;
+    inputMappings_.assign(inputTableSize, nullptr);
+    outputMappings_.assign(outputTableSize, nullptr);
+    sidechainInputBus_ = -1;
+    for (Steinberg::int32 i = 0; i < inputBusCount && sidechainInputBus_ < 0; ++i)
+    {
+        Steinberg::Vst::BusInfo info {};
+        if (component_->getBusInfo(Steinberg::Vst::kAudio, Steinberg::Vst::kInput, i, info) == kResultOk &&
+            info.busType == Steinberg::Vst::kAux && inputBuses_[static_cast<size_t>(i)].numChannels > 0)
+            sidechainInputBus_ = i;
+    }
+    for (size_t i = 0; i < inputBuses_.size(); ++i)
+        inputBuses_[i].channelBuffers32 = inputChannelTable_.data() + inputBusFirstChannel_[i];
+    for (size_t i = 0; i < outputBuses_.size(); ++i)
+        outputBuses_[i].channelBuffers32 = outputChannelTable_.data() + outputBusFirstChannel_[i];
+
+    inputEventList_.setMaxSize(static_cast<Steinberg::int32>(eventQueue_.capacity()));
 
     // Sync controller state after setupProcessing (required for Surge XT)
     if (!controllerStateData_.empty())
@@ -1310,6 +1487,7 @@ bool VST3Host::prepare(double sampleRate, int blockSize)
     // Store result values
     preparedSampleRate_   = sampleRate;
     preparedMaxBlockSize_ = blockSize;
+    parameterQueue_.prepare(controller_ ? controller_->getParameterCount() : 0, sampleRate, blockSize);
 
     processContext_ = {};
     processContext_.sampleRate = sampleRate;
@@ -1322,6 +1500,7 @@ bool VST3Host::prepare(double sampleRate, int blockSize)
         return false;
 
     processingActive_ = true;
+    refreshLatency();
     guiAttachReady_.store(true, std::memory_order_release);
     return true;
 }
@@ -1332,6 +1511,7 @@ void VST3Host::queueParameterChange(ParamID paramId, ParamValue value, bool noti
         return;
 
     ParamValue clamped = std::clamp(value, 0.0, 1.0);
+    editGeneration_.fetch_add(1, std::memory_order_acq_rel);
 
     if (notifyController && controller_)
     {
@@ -1348,9 +1528,16 @@ void VST3Host::queueParameterChange(ParamID paramId, ParamValue value, bool noti
             hostEditing->endEditFromHost(paramId);
     }
 
-    PendingParameterChange change {paramId, clamped};
-    if (!parameterChangeQueue_.push(change))
-        parameterChangeQueue_.pushOverwrite(change);
+    parameterQueue_.push_gui_change(paramId, clamped);
+}
+
+void VST3Host::queueParameterPoint(ParamID paramId, ParamValue value, std::int64_t sampleTime)
+{
+    if (paramId == kNoParamId || IsInvalidNormalizedValue(value))
+        return;
+
+    editGeneration_.fetch_add(1, std::memory_order_acq_rel);
+    parameterQueue_.push_change(paramId, std::clamp(value, 0.0, 1.0), sampleTime);
 }
 
 void VST3Host::queueEvent(const Steinberg::Vst::Event& ev)
@@ -1366,17 +1553,25 @@ void VST3Host::queueNoteEvent(const Steinberg::Vst::Event& ev)
 
 void VST3Host::setTransportState(const HostTransportState& state)
 {
+    sandboxTransport_ = state;
     processContext_ = {};
     processContext_.sampleRate = preparedSampleRate_;
     processContext_.projectTimeSamples = static_cast<Steinberg::Vst::TSamples>(state.samplePosition);
     processContext_.continousTimeSamples = static_cast<Steinberg::Vst::TSamples>(state.samplePosition);
-    if (preparedSampleRate_ > 0.0)
+    if (state.projectTimeMusic >= 0.0)
+        processContext_.projectTimeMusic = state.projectTimeMusic;
+    else if (preparedSampleRate_ > 0.0)
         processContext_.projectTimeMusic = (state.samplePosition / preparedSampleRate_) * (state.tempo / 60.0);
     processContext_.tempo = state.tempo;
     processContext_.timeSigNumerator = state.timeSigNum;
     processContext_.timeSigDenominator = state.timeSigDen;
 
     processContext_.state = ProcessContext::kTempoValid | ProcessContext::kTimeSigValid | ProcessContext::kProjectTimeMusicValid;
+    if (state.barPositionMusic >= 0.0)
+    {
+        processContext_.barPositionMusic = state.barPositionMusic;
+        processContext_.state |= ProcessContext::kBarPositionValid;
+    }
 
     // The VST3 spec states projectTimeSamples is always valid, so there is no dedicated
     // state flag for it (kProjectTimeSamplesValid does not exist). Use the continuous time
@@ -1388,6 +1583,9 @@ void VST3Host::setTransportState(const HostTransportState& state)
 
 bool VST3Host::saveState(std::vector<uint8_t>& outState) const
 {
+    if (sandbox_)
+        return sandbox_->saveState(outState);
+
     if (!component_ || !controller_)
         return false;
 
@@ -1421,6 +1619,12 @@ bool VST3Host::saveState(std::vector<uint8_t>& outState) const
 
 bool VST3Host::loadState(const uint8_t* data, size_t size)
 {
+    if (sandbox_)
+    {
+        editGeneration_.fetch_add(1, std::memory_order_acq_rel);
+        return sandbox_->loadState(data, size);
+    }
+
     if (!component_ || !controller_ || !data || size == 0)
         return false;
 
@@ -1464,6 +1668,7 @@ bool VST3Host::loadState(const uint8_t* data, size_t size)
         if (component_->setState(&componentStream) != kResultOk)
             return false;
     }
+    editGeneration_.fetch_add(1, std::memory_order_acq_rel);
 
     VectorIBStream controllerStream(controllerData, controllerSize);
     return controller_->setState(&controllerStream) == kResultOk;
@@ -1476,8 +1681,32 @@ void VST3Host::onControllerParameterChanged(ParamID paramId, ParamValue value)
 
 void VST3Host::onRestartComponent(int32 flags)
 {
-    if ((flags & kParamValuesChanged) == 0)
+    if ((flags & kLatencyChanged) == 0)
         return;
+
+    // The spec requires a deactivate/activate cycle before the new latency
+    // is valid. restartComponent arrives on the UI thread, never in process().
+    {
+        NonRealtimeScope scope(*this);
+        if (processor_ && component_ && processingActive_)
+        {
+            std::lock_guard<std::mutex> lock(vst3Mutex());
+            processor_->setProcessing(false);
+            component_->setActive(false);
+            component_->setActive(true);
+            processor_->setProcessing(true);
+        }
+    }
+
+    refreshLatency();
+}
+
+void VST3Host::refreshLatency()
+{
+    int32 latency = 0;
+    if (processor_)
+        latency = static_cast<int32>(std::min<uint32>(processor_->getLatencySamples(), 1u << 30));
+    latencySamples_.store(latency, std::memory_order_release);
 }
 
 #ifdef _WIN32
@@ -1630,7 +1859,6 @@ void VST3Host::process(float** outputs, int numChannels, int numSamples)
 
 void VST3Host::process(float** inputs, int numInputChannels, float** outputs, int numOutputChannels, int numSamples)
 {
-    const int inputChannels = std::max<Steinberg::int32>(0, SpeakerArr::getChannelCount(inputArrangement_));
     const int outputChannels = std::max<Steinberg::int32>(1, SpeakerArr::getChannelCount(outputArrangement_));
 
     if (outputs && numSamples > 0)
@@ -1644,283 +1872,271 @@ void VST3Host::process(float** inputs, int numInputChannels, float** outputs, in
     }
 
     AudioProcessScope processScope(processingSuspended_, activeProcessCount_);
-    if (!processScope.engaged() || !processor_ || !processingActive_ || !outputs || numSamples <= 0)
-        return;
-
-    parameterChangeQueue_.popAll(processParameterChanges_);
-    eventQueue_.popAll(processEvents_);
-
-    inputParameterChanges_.clearQueue();
-    for (const auto& change : processParameterChanges_)
+    if (processScope.engaged() && sandbox_ && processingActive_ && outputs && numSamples > 0)
     {
-        if (change.id == kNoParamId)
-            continue;
-
-        int32 index = 0;
-        if (auto* queue = inputParameterChanges_.addParameterData(change.id, index))
-            queue->addPoint(0, change.value, index);
+        processSandboxed(outputs, numOutputChannels, numSamples);
+        return;
     }
+    if (!processScope.engaged() || !processor_ || !processingActive_ || !outputs || numSamples <= 0 ||
+        preparedMaxBlockSize_ <= 0)
+        return;
 
-    inputEventList_.clear();
-    for (auto ev : processEvents_)
-    {
-        inputEventList_.addEvent(ev);
-    }
+    RealtimeAllocationGuard noAllocations;
 
-    const auto sampleCount = static_cast<size_t>(numSamples);
+    // Events go straight from the queue into the list handed to the plug-in
+    // (sized for a full queue in prepare()) and belong to the first block.
+    inputEventList_.clear();
+    eventQueue_.popEach([this](Steinberg::Vst::Event& ev) { inputEventList_.addEvent(ev); });
 
-    if (static_cast<Steinberg::int32>(outputChannelPointers_.size()) < outputChannels ||
-        static_cast<Steinberg::int32>(internalOut_.size()) < outputChannels)
+    // Calls longer than the prepared block size are split; parameter points
+    // are split across blocks by their sample time.
+    for (int processed = 0; processed < numSamples;)
     {
-        return;
+        const int blockSamples = std::min(numSamples - processed, preparedMaxBlockSize_);
+        processBlock(inputs, numInputChannels, outputs, numOutputChannels, processed, blockSamples);
+        advanceProcessContext(blockSamples);
+        inputEventList_.clear();
+        processed += blockSamples;
     }
+}
 
-    for (int ch = 0; ch < outputChannels; ++ch)
-    {
-        auto& buffer = internalOut_[static_cast<size_t>(ch)];
-        if (sampleCount > buffer.size())
-            return;
-
-        std::fill(buffer.begin(), buffer.begin() + sampleCount, 0.0f);
-        outputChannelPointers_[static_cast<size_t>(ch)] = buffer.data();
-    }
+void VST3Host::processBlock(float** inputs, int numInputChannels, float** outputs, int numOutputChannels, int offset,
+                            int numSamples)
+{
+    const auto sampleCount = static_cast<size_t>(numSamples);
 
-    float** inputBuffers = nullptr;
-    if (inputChannels > 0 && static_cast<Steinberg::int32>(inputChannelPointers_.size()) >= inputChannels)
+    // Mapped buses (sidechains) and the main input read their sources in
+    // place; missing channels and the other input buses read silence.
+    for (size_t bus = 0; bus < inputBuses_.size(); ++bus)
     {
-        for (int ch = 0; ch < inputChannels; ++ch)
+        const bool isMain = static_cast<Steinberg::int32>(bus) == mainInputBusIndex_;
+        const size_t first = inputBusFirstChannel_[bus];
+        for (int ch = 0; ch < inputBuses_[bus].numChannels; ++ch)
         {
-            float* source = nullptr;
-            if (inputs && ch < numInputChannels && inputs[ch])
+            const size_t slot = first + static_cast<size_t>(ch);
+            if (inputMappings_[slot])
             {
-                source = inputs[ch];
+                inputChannelTable_[slot] = inputMappings_[slot] + offset;
+                continue;
             }
-            else if (static_cast<size_t>(ch) < internalIn_.size())
+            if (isMain && inputs && ch < numInputChannels && inputs[ch])
             {
-                auto& buffer = internalIn_[static_cast<size_t>(ch)];
-                if (sampleCount > buffer.size())
-                    return;
-
-                std::fill(buffer.begin(), buffer.begin() + sampleCount, 0.0f);
-                source = buffer.data();
+                inputChannelTable_[slot] = inputs[ch] + offset;
+                continue;
             }
-            inputChannelPointers_[static_cast<size_t>(ch)] = source;
+            std::fill(inputStorageTable_[slot], inputStorageTable_[slot] + sampleCount, 0.0f);
+            inputChannelTable_[slot] = inputStorageTable_[slot];
         }
-
-        inputBuffers = inputChannelPointers_.data();
+        inputBuses_[bus].silenceFlags = 0;
     }
 
-    AudioBusBuffers inputBus {};
-    inputBus.numChannels = inputChannels;
-    inputBus.channelBuffers32 = inputBuffers;
+    // The main output renders into the caller's buffers (cleared by
+    // process()) when every channel is provided, mapped buses into their
+    // mapping, everything else into host storage.
+    const int mainChannels = audioOutputBusChannelCount(mainOutputBusIndex_);
+    bool mainInPlace = mainOutputBusIndex_ >= 0 && numOutputChannels >= mainChannels;
+    for (int ch = 0; mainInPlace && ch < mainChannels; ++ch)
+        mainInPlace = outputs[ch] != nullptr;
 
-    AudioBusBuffers outputBus {};
-    outputBus.numChannels = outputChannels;
-    outputBus.channelBuffers32 = outputChannelPointers_.data();
+    for (size_t bus = 0; bus < outputBuses_.size(); ++bus)
+    {
+        const bool isMain = static_cast<Steinberg::int32>(bus) == mainOutputBusIndex_;
+        const size_t first = outputBusFirstChannel_[bus];
+        for (int ch = 0; ch < outputBuses_[bus].numChannels; ++ch)
+        {
+            const size_t slot = first + static_cast<size_t>(ch);
+            if (isMain && mainInPlace)
+            {
+                outputChannelTable_[slot] = outputs[ch] + offset;
+                continue;
+            }
+            float* target = outputMappings_[slot] ? outputMappings_[slot] + offset : outputStorageTable_[slot];
+            std::fill(target, target + sampleCount, 0.0f);
+            outputChannelTable_[slot] = target;
+        }
+        outputBuses_[bus].silenceFlags = 0;
+    }
 
     ProcessData data {};
+    data.processMode = processMode_;
+    data.symbolicSampleSize = kSample32;
+    data.numSamples = numSamples;
+    data.numInputs = static_cast<Steinberg::int32>(inputBuses_.size());
+    data.numOutputs = static_cast<Steinberg::int32>(outputBuses_.size());
+    data.inputs = inputBuses_.empty() ? nullptr : inputBuses_.data();
+    data.outputs = outputBuses_.empty() ? nullptr : outputBuses_.data();
     data.processContext = &processContext_;
-    data.inputParameterChanges = inputParameterChanges_.getParameterCount() > 0 ? &inputParameterChanges_ : nullptr;
-    data.outputParameterChanges = nullptr;
     data.inputEvents = inputEventList_.getEventCount() > 0 ? &inputEventList_ : nullptr;
-    data.outputEvents = nullptr;
-    data.inputs = inputChannels > 0 ? &inputBus : nullptr;
-    data.outputs = &outputBus;
-    data.numSamples = numSamples;
-    data.symbolicSampleSize = kSample32;
-
-    processor_->process(data);
+    playAutomation(numSamples);
+    parameterQueue_.apply_to_audio_processor(data);
 
-    for (int ch = 0; ch < outputChannels && ch < numOutputChannels; ++ch)
     {
-        if (!outputs[ch])
-            continue;
-
-        const float* source = outputChannelPointers_[static_cast<size_t>(ch)];
-        if (source)
-        {
-            std::memcpy(outputs[ch], source, sampleCount * sizeof(float));
-        }
+        // What the plug-in does inside process() is its own business.
+        RealtimeAllocationExemption pluginCode;
+        processor_->process(data);
     }
+    captureAutomation(parameterQueue_.take_gui_changes());
+    captureAutomation(parameterQueue_.output_changes());
 
-    inputParameterChanges_.clearQueue();
-    inputEventList_.clear();
-}
-
-void VST3Host::processInternal(float** inputs, int numInputChannels, float** outputs, int numOutputChannels, int numSamples,
-                               const std::vector<PendingParameterChange>& changes,
-                               const std::vector<Steinberg::Vst::Event>& events)
-{
-    const int inputChannels = std::max<Steinberg::int32>(0, SpeakerArr::getChannelCount(inputArrangement_));
-    const int outputChannels = std::max<Steinberg::int32>(1, SpeakerArr::getChannelCount(outputArrangement_));
+    if (mainInPlace || mainOutputBusIndex_ < 0)
+        return;
 
-    if (outputs)
+    const auto& mainBus = outputBuses_[static_cast<size_t>(mainOutputBusIndex_)];
+    for (int ch = 0; ch < mainBus.numChannels && ch < numOutputChannels; ++ch)
     {
-        const auto samplesToClear = static_cast<size_t>(std::max(0, numSamples));
-        for (int ch = 0; ch < outputChannels && ch < numOutputChannels; ++ch)
-        {
-            if (outputs[ch])
-                std::fill(outputs[ch], outputs[ch] + samplesToClear, 0.0f);
-        }
+        if (outputs[ch])
+            std::memcpy(outputs[ch] + offset, mainBus.channelBuffers32[ch], sampleCount * sizeof(float));
     }
+}
 
-    if (!processor_ || !processingActive_ || !outputs || numSamples <= 0)
+void VST3Host::playAutomation(int numSamples)
+{
+    const AutomationLanes* lanes = automationLanes_;
+    if (!lanes || lanes->empty() || automationRecording() || !(processContext_.state & ProcessContext::kPlaying) ||
+        preparedSampleRate_ <= 0.0 || numSamples <= 0)
         return;
 
-    if (numOutputChannels < outputChannels)
+    if (lanes != cursorLanes_)
     {
-        std::cerr << "[KJ] Provided output channels (" << numOutputChannels
-                  << ") do not satisfy bus layout requiring " << outputChannels << " channels.\n";
-        return;
+        cursorLanes_ = lanes;
+        automationCursors_.resize(std::min(lanes->size(), automationCursors_.capacity()));
+        std::fill(automationCursors_.begin(), automationCursors_.end(), AutomationCursor{});
     }
 
-    inputParameterChanges_.clearQueue();
-    for (const auto& change : changes)
+    // Points at the start, at every breakpoint inside the block and at its
+    // last sample; the plug-in ramps linearly between them.
+    const double beatsPerSample = processContext_.tempo / (60.0 * preparedSampleRate_);
+    const double start = processContext_.projectTimeMusic;
+    const double last = start + (numSamples - 1) * beatsPerSample;
+    for (size_t i = 0; i < automationCursors_.size(); ++i)
     {
-        if (change.id == kNoParamId)
+        const AutomationLane& lane = (*lanes)[i];
+        AutomationCursor& cursor = automationCursors_[i];
+        if (lane.points.empty())
             continue;
 
-        int32 index = 0;
-        if (auto* queue = inputParameterChanges_.addParameterData(change.id, index))
-            queue->addPoint(0, change.value, index);
-    }
+        auto send = [&](Steinberg::int32 sampleOffset, float value) {
+            if (cursor.hasSent && cursor.sent == value)
+                return;
+            parameterQueue_.push_block_point(lane.paramId, value, sampleOffset);
+            cursor.sent = value;
+            cursor.hasSent = true;
+        };
 
-    inputEventList_.clear();
-    inputEventList_.setMaxSize(std::max<int32>(static_cast<int32>(events.size()), 1));
-    for (auto ev : events)
-    {
-        inputEventList_.addEvent(ev);
+        send(0, lane.valueAt(start, cursor.hint));
+        if (numSamples == 1)
+            continue;
+        for (size_t p = cursor.hint + 1; p < lane.points.size() && lane.points[p].beat <= last; ++p)
+        {
+            if (lane.points[p].beat <= start)
+                continue;
+            const auto sampleOffset = static_cast<Steinberg::int32>((lane.points[p].beat - start) / beatsPerSample);
+            send(std::min(sampleOffset, numSamples - 1), lane.points[p].value);
+        }
+        send(numSamples - 1, lane.valueAt(last, cursor.hint));
     }
+}
 
-    std::vector<float*> inputPointers(static_cast<size_t>(std::max(1, inputChannels)), nullptr);
-    if (!inputs)
-    {
-        for (int ch = 0; ch < inputChannels && ch < static_cast<int>(internalIn_.size()); ++ch)
-            inputPointers[static_cast<size_t>(ch)] = internalIn_[static_cast<size_t>(ch)].data();
-        numInputChannels = inputChannels;
-        inputs = inputPointers.data();
-    }
-    else
-    {
-        for (int ch = 0; ch < inputChannels && ch < numInputChannels; ++ch)
-            inputPointers[static_cast<size_t>(ch)] = inputs[ch];
-        numInputChannels = inputChannels;
-        inputs = inputPointers.data();
-    }
+void VST3Host::captureAutomation(IParameterChanges* changes)
+{
+    if (!changes || !automationRecording() || !(processContext_.state & ProcessContext::kPlaying) ||
+        preparedSampleRate_ <= 0.0)
+        return;
 
-    std::vector<float*> outputPointers(static_cast<size_t>(outputChannels), nullptr);
-    for (int ch = 0; ch < outputChannels; ++ch)
+    const double beatsPerSample = processContext_.tempo / (60.0 * preparedSampleRate_);
+    const double start = processContext_.projectTimeMusic;
+    for (Steinberg::int32 q = 0; q < changes->getParameterCount(); ++q)
     {
-        outputPointers[static_cast<size_t>(ch)] = outputs[ch];
+        IParamValueQueue* queue = changes->getParameterData(q);
+        if (!queue)
+            continue;
+        for (Steinberg::int32 p = 0; p < queue->getPointCount(); ++p)
+        {
+            Steinberg::int32 sampleOffset = 0;
+            ParamValue value = 0.0;
+            if (queue->getPoint(p, sampleOffset, value) != kResultTrue)
+                continue;
+            automationCapture_.push({queue->getParameterId(), static_cast<float>(value),
+                                     start + sampleOffset * beatsPerSample});
+        }
     }
-
-    AudioBusBuffers inputBuses[1] {};
-    AudioBusBuffers outputBuses[1] {};
-
-    inputBuses[0].numChannels = inputChannels;
-    inputBuses[0].channelBuffers32 = inputChannels > 0 ? inputPointers.data() : nullptr;
-    outputBuses[0].numChannels = outputChannels;
-    outputBuses[0].channelBuffers32 = outputPointers.data();
-
-    ProcessData data {};
-    data.processMode = kRealtime;
-    data.symbolicSampleSize = kSample32;
-    data.numSamples = numSamples;
-    data.numInputs = inputChannels > 0 ? 1 : 0;
-    data.numOutputs = 1;
-    data.inputs = inputBuses;
-    data.outputs = outputBuses;
-    data.processContext = &processContext_;
-
-    if (inputParameterChanges_.getParameterCount() > 0)
-        data.inputParameterChanges = &inputParameterChanges_;
-    if (inputEventList_.getEventCount() > 0)
-        data.inputEvents = &inputEventList_;
-
-    processor_->process(data);
-
-    inputParameterChanges_.clearQueue();
-    inputEventList_.clear();
 }
 
-void VST3Host::renderAudio(float** out, int numChannels, int numSamples)
+// Moves the context past a rendered block, so the next block of a split call
+// starts where this one ended. Automation reads its beat position from here.
+void VST3Host::advanceProcessContext(int numSamples)
 {
-    AudioProcessScope processScope(processingSuspended_, activeProcessCount_);
-    if (!processScope.engaged())
-        return;
-    if (!out || numChannels <= 0 || numSamples <= 0)
+    processContext_.continousTimeSamples += numSamples;
+    if (!(processContext_.state & ProcessContext::kPlaying))
         return;
 
-    const int forcedChannels = std::max<Steinberg::int32>(1, SpeakerArr::getChannelCount(outputArrangement_));
-
-    for (int ch = 0; ch < forcedChannels && ch < numChannels; ++ch)
+    processContext_.projectTimeSamples += numSamples;
+    if (preparedSampleRate_ > 0.0)
+        processContext_.projectTimeMusic += numSamples * processContext_.tempo / (60.0 * preparedSampleRate_);
+    if ((processContext_.state & ProcessContext::kBarPositionValid) && processContext_.timeSigDenominator > 0)
     {
-        if (out[ch])
-            std::fill(out[ch], out[ch] + static_cast<size_t>(numSamples), 0.0f);
+        const double barBeats = processContext_.timeSigNumerator * 4.0 / processContext_.timeSigDenominator;
+        while (barBeats > 0.0 && processContext_.projectTimeMusic >= processContext_.barPositionMusic + barBeats)
+            processContext_.barPositionMusic += barBeats;
     }
+}
 
-    if (!processor_ || !processingActive_)
-        return;
+int VST3Host::audioOutputBusChannelCount(int bus) const
+{
+    if (bus < 0 || bus >= static_cast<int>(outputBuses_.size()))
+        return 0;
+    return outputBuses_[static_cast<size_t>(bus)].numChannels;
+}
 
-    if (static_cast<Steinberg::int32>(internalOut_.size()) < forcedChannels)
+void VST3Host::mapOutputBus(int bus, float* const* channels, int numChannels)
+{
+    if (bus < 0 || bus >= static_cast<int>(outputBuses_.size()))
         return;
 
-    processParameterChanges_.clear();
-    processEvents_.clear();
-    parameterChangeQueue_.popAll(processParameterChanges_);
-    eventQueue_.popAll(processEvents_);
+    const size_t first = outputBusFirstChannel_[static_cast<size_t>(bus)];
+    for (int ch = 0; ch < outputBuses_[static_cast<size_t>(bus)].numChannels; ++ch)
+        outputMappings_[first + static_cast<size_t>(ch)] = channels && ch < numChannels ? channels[ch] : nullptr;
+}
 
-    const int maxChunkSize = (preparedMaxBlockSize_ > 0) ? preparedMaxBlockSize_ : numSamples;
-    static const std::vector<PendingParameterChange> kEmptyChanges;
-    static const std::vector<Steinberg::Vst::Event> kEmptyEvents;
+void VST3Host::mapInputBus(int bus, float* const* channels, int numChannels)
+{
+    if (bus < 0 || bus >= static_cast<int>(inputBuses_.size()))
+        return;
 
-    bool automationApplied = false;
-    int processed = 0;
-    while (processed < numSamples)
+    const size_t first = inputBusFirstChannel_[static_cast<size_t>(bus)];
+    for (int ch = 0; ch < inputBuses_[static_cast<size_t>(bus)].numChannels; ++ch)
     {
-        const int remaining = numSamples - processed;
-        const int chunkSize = std::min(remaining, maxChunkSize);
-
-        for (Steinberg::int32 ch = 0; ch < forcedChannels; ++ch)
-        {
-            auto& buffer = internalOut_[static_cast<size_t>(ch)];
-            const auto toClear = std::min<size_t>(buffer.size(), static_cast<size_t>(chunkSize));
-            std::fill(buffer.begin(), buffer.begin() + toClear, 0.0f);
-            outputChannelPointers_[static_cast<size_t>(ch)] = buffer.data();
-        }
-
-        float** inputBuffers = nullptr;
-        const auto inputChannels = static_cast<int>(internalIn_.size());
-        if (!internalIn_.empty())
-        {
-            for (Steinberg::int32 ch = 0; ch < std::min<Steinberg::int32>(forcedChannels, inputChannels); ++ch)
-            {
-                auto& buffer = internalIn_[static_cast<size_t>(ch)];
-                const auto toClear = std::min<size_t>(buffer.size(), static_cast<size_t>(chunkSize));
-                std::fill(buffer.begin(), buffer.begin() + toClear, 0.0f);
-                inputChannelPointers_[static_cast<size_t>(ch)] = buffer.data();
-            }
-            inputBuffers = inputChannelPointers_.data();
-        }
-
-        const auto& chunkChanges = automationApplied ? kEmptyChanges : processParameterChanges_;
-        const auto& chunkEvents = automationApplied ? kEmptyEvents : processEvents_;
+        float* source = channels && numChannels > 0 ? channels[std::min(ch, numChannels - 1)] : nullptr;
+        inputMappings_[first + static_cast<size_t>(ch)] = source;
+    }
+}
 
-        processInternal(inputBuffers, inputChannels, outputChannelPointers_.data(), forcedChannels, chunkSize,
-                        chunkChanges, chunkEvents);
-        automationApplied = true;
+void VST3Host::processSandboxed(float** outputs, int numChannels, int numSamples)
+{
+    // processEvents_ is reserved for a full queue in prepare().
+    eventQueue_.popAll(processEvents_);
 
-        for (int ch = 0; ch < forcedChannels && ch < numChannels; ++ch)
-        {
-            if (out[ch])
-            {
-                std::memcpy(out[ch] + processed, internalOut_[static_cast<size_t>(ch)].data(),
-                            static_cast<size_t>(chunkSize) * sizeof(float));
-            }
-        }
+    SandboxTransport transport;
+    transport.samplePosition = sandboxTransport_.samplePosition;
+    transport.projectTimeMusic = sandboxTransport_.projectTimeMusic;
+    transport.barPositionMusic = sandboxTransport_.barPositionMusic;
+    transport.tempo = sandboxTransport_.tempo;
+    transport.timeSigNum = sandboxTransport_.timeSigNum;
+    transport.timeSigDen = sandboxTransport_.timeSigDen;
+    transport.playing = sandboxTransport_.playing;
+
+    playAutomation(numSamples);
+    sandbox_->process(outputs, numChannels, numSamples, processEvents_.data(), processEvents_.size(), transport);
+    processEvents_.clear();
+    captureAutomation(parameterQueue_.take_gui_changes());
+    latencySamples_.store(sandbox_->latencySamples(), std::memory_order_release);
+}
 
-        processed += chunkSize;
-    }
+void VST3Host::renderAudio(float** out, int numChannels, int numSamples)
+{
+    if (!out || numChannels <= 0)
+        return;
+    process(nullptr, 0, out, numChannels, numSamples);
 }
 
 void VST3Host::unload()
@@ -1940,6 +2156,7 @@ void VST3Host::unloadLocked()
     guiAttachReady_.store(false, std::memory_order_release);
     pendingEditorShow_.store(false, std::memory_order_release);
 
+    sandbox_.reset();
     if (processor_)
         processor_->setProcessing(false);
 
@@ -1964,11 +2181,19 @@ void VST3Host::unloadLocked()
     }
 
     processingActive_ = false;
-
-    internalIn_.clear();
-    internalOut_.clear();
-    inputChannelPointers_.clear();
-    outputChannelPointers_.clear();
+    latencySamples_.store(0, std::memory_order_release);
+
+    busStorage_.clear();
+    inputBuses_.clear();
+    outputBuses_.clear();
+    inputChannelTable_.clear();
+    outputChannelTable_.clear();
+    inputStorageTable_.clear();
+    outputStorageTable_.clear();
+    inputMappings_.clear();
+    outputMappings_.clear();
+    inputBusFirstChannel_.clear();
+    outputBusFirstChannel_.clear();
     if (controller_ && componentHandler_)
         controller_->setComponentHandler(nullptr);
 
@@ -1997,12 +2222,11 @@ void VST3Host::unloadLocked()
     preparedMaxBlockSize_ = 0;
     mainInputBusIndex_ = -1;
     mainOutputBusIndex_ = -1;
+    sidechainInputBus_ = -1;
     inputArrangement_ = SpeakerArr::kEmpty;
     outputArrangement_ = SpeakerArr::kEmpty;
     processContext_ = {};
 
-    inputParameterChanges_.setMaxParameters(0);
-    inputParameterChanges_.clearQueue();
     inputEventList_.clear();
     processEvents_.clear();
     eventQueue_.clear();
@@ -2015,13 +2239,21 @@ void VST3Host::unloadLocked()
     pluginPath_.clear();
 #endif
 
-    parameterChangeQueue_.clear();
-    processParameterChanges_.clear();
+    parameterQueue_.clear();
+    cursorLanes_ = nullptr;
+    automationCursors_.clear();
 }
 
 bool VST3Host::isPluginLoaded() const
 {
-    return component_ != nullptr;
+    return component_ != nullptr || sandbox_ != nullptr;
+}
+
+Steinberg::int32 VST3Host::parameterCount() const
+{
+    if (sandbox_)
+        return sandbox_->parameterCount();
+    return controller_ ? controller_->getParameterCount() : 0;
 }
 
 bool VST3Host::isPluginReady() const
@@ -2030,6 +2262,12 @@ bool VST3Host::isPluginReady() const
     return !loadingInProgress_ && pluginReady_;
 }
 
+bool VST3Host::isPreparedFor(double sampleRate, int maxBlockSize) const
+{
+    return (processor_ || sandbox_) && processingActive_ && processMode_ == kRealtime &&
+           std::abs(preparedSampleRate_ - sampleRate) < 1e-6 && preparedMaxBlockSize_ >= maxBlockSize;
+}
+
 bool VST3Host::isPluginLoading() const
 {
     std::lock_guard<std::mutex> lock(loadingMutex_);
@@ -6,6 +6,7 @@
 
 #include "hosting/VSTGuiThread.h"
 
+#include "core/audio_engine.h"
 #include "core/track_type_vst.h"
 #include "hosting/VST3Host.h"
 
@@ -647,21 +648,20 @@ bool promptAndLoadVstPlugin(HWND parent, int trackId)
     if (!std::filesystem::exists(pluginPath))
         std::wcout << L"[GUI] Selected plug-in path does not exist: " << pluginPath.c_str() << std::endl;
 
-    auto host = trackEnsureVstHost(trackId);
-    if (!host)
-    {
-        std::cerr << "[GUI] Failed to obtain VST3 host for track." << std::endl;
-        return false;
-    }
-
-    host->setOnPluginLoaded([parent, trackId](bool success) {
+    // The plug-in is instantiated into a fresh host on the engine's loader
+    // pool; the track keeps its current plug-in until the new one is ready.
+    bool requested = requestTrackVstLoad(trackId, pluginPath, [parent, trackId](bool success) {
         if (success)
             PostMessageW(parent, kShowVstEditorMessage, static_cast<WPARAM>(trackId), 0);
         else
             std::cerr << "[GUI] VST3 plug-in failed to load for the selected track; editor will not be shown." << std::endl;
     });
+    if (!requested)
+    {
+        std::cerr << "[GUI] Failed to request VST3 plug-in load for track." << std::endl;
+        return false;
+    }
 
-    host->loadPluginAsync(pluginPath.wstring());
     std::cout << "[GUI] Requested async VST3 plug-in load: " << pluginPath.string() << std::endl;
     return true;
 }
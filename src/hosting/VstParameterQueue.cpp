@@ -1,47 +1,390 @@
 #include "hosting/VstParameterQueue.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
 namespace kj {
 
-void VstParameterQueue::push_gui_change(Steinberg::Vst::ParamID id, double normalized_value)
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace {
+
+static_assert((VstParameterQueue::kRingCapacity & (VstParameterQueue::kRingCapacity - 1)) == 0,
+              "Ring capacity must be a power of two");
+
+std::int64_t steadyNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+void VstParameterQueue::PointQueue::reset(ParamID id)
+{
+    id_ = id;
+    count_ = 0;
+}
+
+void VstParameterQueue::PointQueue::append(int32 sampleOffset, ParamValue value)
+{
+    if (count_ > 0 && (points_[count_ - 1].offset == sampleOffset || count_ == kMaxPointsPerParameter))
+    {
+        points_[count_ - 1] = {std::max(sampleOffset, points_[count_ - 1].offset), value};
+        return;
+    }
+
+    points_[count_++] = {sampleOffset, value};
+}
+
+tresult PLUGIN_API VstParameterQueue::PointQueue::queryInterface(const TUID iid, void** obj)
+{
+    if (!obj)
+        return kInvalidArgument;
+
+    *obj = nullptr;
+    if (std::memcmp(iid, IParamValueQueue::iid, sizeof(TUID)) == 0 ||
+        std::memcmp(iid, FUnknown::iid, sizeof(TUID)) == 0)
+    {
+        *obj = static_cast<IParamValueQueue*>(this);
+        return kResultOk;
+    }
+    return kNoInterface;
+}
+
+tresult PLUGIN_API VstParameterQueue::PointQueue::getPoint(int32 index, int32& sampleOffset, ParamValue& value)
 {
-    std::lock_guard<std::mutex> lock(access_mutex_);
+    if (index < 0 || index >= count_)
+        return kResultFalse;
 
-    ParameterChange change{};
-    change.id = id;
-    change.value = normalized_value;
-    change.sampleOffset = 0;
+    sampleOffset = points_[index].offset;
+    value = points_[index].value;
+    return kResultTrue;
+}
+
+tresult PLUGIN_API VstParameterQueue::PointQueue::addPoint(int32 sampleOffset, ParamValue value, int32& index)
+{
+    int32 dest = 0;
+    while (dest < count_ && points_[dest].offset < sampleOffset)
+        ++dest;
+
+    if (dest < count_ && points_[dest].offset == sampleOffset)
+    {
+        points_[dest].value = value;
+        index = dest;
+        return kResultTrue;
+    }
 
-    change_buffer_.push_back(change);
-    is_dirty_.store(true, std::memory_order_release);
+    if (count_ == kMaxPointsPerParameter)
+        return kResultFalse;
+
+    for (int32 i = count_; i > dest; --i)
+        points_[i] = points_[i - 1];
+    points_[dest] = {sampleOffset, value};
+    ++count_;
+    index = dest;
+    return kResultTrue;
 }
 
-void VstParameterQueue::apply_to_audio_processor(Steinberg::Vst::ProcessData& data)
+void VstParameterQueue::BlockChanges::resize(int32 maxParameters)
 {
-    data.inputParameterChanges = nullptr;
+    queues_.resize(static_cast<std::size_t>(std::max<int32>(maxParameters, 0)));
+    used_ = 0;
+}
 
-    if (!is_dirty_.load(std::memory_order_acquire))
+VstParameterQueue::PointQueue* VstParameterQueue::BlockChanges::append(ParamID id)
+{
+    if (used_ >= static_cast<int32>(queues_.size()))
+        return nullptr;
+
+    PointQueue& queue = queues_[static_cast<std::size_t>(used_++)];
+    queue.reset(id);
+    return &queue;
+}
+
+tresult PLUGIN_API VstParameterQueue::BlockChanges::queryInterface(const TUID iid, void** obj)
+{
+    if (!obj)
+        return kInvalidArgument;
+
+    *obj = nullptr;
+    if (std::memcmp(iid, IParameterChanges::iid, sizeof(TUID)) == 0 ||
+        std::memcmp(iid, FUnknown::iid, sizeof(TUID)) == 0)
+    {
+        *obj = static_cast<IParameterChanges*>(this);
+        return kResultOk;
+    }
+    return kNoInterface;
+}
+
+IParamValueQueue* PLUGIN_API VstParameterQueue::BlockChanges::getParameterData(int32 index)
+{
+    if (index < 0 || index >= used_)
+        return nullptr;
+    return &queues_[static_cast<std::size_t>(index)];
+}
+
+IParamValueQueue* PLUGIN_API VstParameterQueue::BlockChanges::addParameterData(const ParamID& id, int32& index)
+{
+    for (int32 i = 0; i < used_; ++i)
+    {
+        if (queues_[static_cast<std::size_t>(i)].getParameterId() == id)
+        {
+            index = i;
+            return &queues_[static_cast<std::size_t>(i)];
+        }
+    }
+
+    PointQueue* queue = append(id);
+    if (!queue)
+        return nullptr;
+    index = used_ - 1;
+    return queue;
+}
+
+VstParameterQueue::VstParameterQueue()
+{
+    ring_.resize(kRingCapacity);
+    pending_.reserve(kRingCapacity);
+    due_.reserve(kRingCapacity);
+}
+
+void VstParameterQueue::prepare(int32 maxParameters, double sampleRate, int32 maxBlockSize)
+{
+    changes_.resize(maxParameters);
+    gui_changes_.resize(maxParameters);
+    output_changes_.resize(maxParameters);
+    gui_changes_pending_ = false;
+    block_start_sample_ = 0;
+    sample_rate_ = sampleRate;
+    max_block_size_ = std::max<int32>(maxBlockSize, 0);
+
+    // Points stamped against the previous clock would land far in the future.
+    for (auto& point : pending_)
+        point.sampleTime = kAsSoonAsPossible;
+
+    clock_.store(ClockSnapshot{});
+}
+
+void VstParameterQueue::clear()
+{
+    std::lock_guard<std::mutex> lock(producer_mutex_);
+    overflow_.clear();
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    pending_.clear();
+    due_.clear();
+    changes_.clear();
+    gui_changes_.clear();
+    output_changes_.clear();
+    gui_changes_pending_ = false;
+    block_start_sample_ = 0;
+    clock_.store(ClockSnapshot{});
+}
+
+std::int64_t VstParameterQueue::estimated_sample_time() const
+{
+    const ClockSnapshot clock = clock_.load();
+    if (clock.blockStartNanos == 0 || clock.sampleRate <= 0.0)
+        return kAsSoonAsPossible;
+
+    const double elapsed = static_cast<double>(steadyNanos() - clock.blockStartNanos) * 1.0e-9;
+    return clock.blockStartSample + static_cast<std::int64_t>(std::max(0.0, elapsed) * clock.sampleRate) +
+           clock.latencySamples;
+}
+
+void VstParameterQueue::push_gui_change(ParamID id, double normalized_value)
+{
+    push_point(id, normalized_value, estimated_sample_time(), true);
+}
+
+void VstParameterQueue::push_change(ParamID id, double normalized_value, std::int64_t sample_time)
+{
+    push_point(id, normalized_value, sample_time, false);
+}
+
+void VstParameterQueue::push_point(ParamID id, double normalized_value, std::int64_t sample_time, bool from_gui)
+{
+    if (id == kNoParamId || !std::isfinite(normalized_value))
+        return;
+
+    std::lock_guard<std::mutex> lock(producer_mutex_);
+
+    ParameterPoint point{};
+    point.id = id;
+    point.value = std::clamp(normalized_value, 0.0, 1.0);
+    point.sampleTime = sample_time;
+    point.sequence = next_sequence_++;
+    point.fromGui = from_gui;
+
+    // Keep ordering: nothing new goes into the ring while older points wait.
+    std::size_t flushed = 0;
+    while (flushed < overflow_.size() && try_push_locked(overflow_[flushed]))
+        ++flushed;
+    overflow_.erase(overflow_.begin(), overflow_.begin() + static_cast<std::ptrdiff_t>(flushed));
+
+    if (overflow_.empty() && try_push_locked(point))
+        return;
+
+    // The audio thread is not draining (processing stopped or stalled). Only
+    // the latest value per parameter matters for points that are already late.
+    auto existing = std::find_if(overflow_.begin(), overflow_.end(),
+                                 [id](const ParameterPoint& queued) { return queued.id == id; });
+    if (existing != overflow_.end())
+    {
+        overflow_.erase(existing);
+    }
+    point.sampleTime = kAsSoonAsPossible;
+    overflow_.push_back(point);
+}
+
+void VstParameterQueue::flush_overflow()
+{
+    std::lock_guard<std::mutex> lock(producer_mutex_);
+    std::size_t flushed = 0;
+    while (flushed < overflow_.size() && try_push_locked(overflow_[flushed]))
+        ++flushed;
+    overflow_.erase(overflow_.begin(), overflow_.begin() + static_cast<std::ptrdiff_t>(flushed));
+}
+
+bool VstParameterQueue::try_push_locked(const ParameterPoint& point)
+{
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= kRingCapacity)
+        return false;
+
+    ring_[head & (kRingCapacity - 1)] = point;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void VstParameterQueue::push_block_point(ParamID id, double normalized_value, int32 sampleOffset)
+{
+    if (id == kNoParamId || !std::isfinite(normalized_value))
         return;
+    if (pending_.size() >= pending_.capacity())
+    {
+        dropped_points_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ParameterPoint point{};
+    point.id = id;
+    point.value = std::clamp(normalized_value, 0.0, 1.0);
+    point.sampleTime = block_start_sample_ + std::max<int32>(sampleOffset, 0);
+    // Ordered after producer points on the same sample, so playback wins.
+    point.sequence = UINT64_MAX;
+    pending_.push_back(point);
+}
+
+IParameterChanges* VstParameterQueue::collect_block(int32 numSamples)
+{
+    gui_changes_.clear();
+    gui_changes_pending_ = true;
+
+    const std::int64_t blockStart = block_start_sample_;
+    const std::int64_t blockEnd = blockStart + std::max<int32>(numSamples, 0);
+    block_start_sample_ = blockEnd;
+
+    ClockSnapshot clock{};
+    clock.blockStartSample = blockStart;
+    clock.blockStartNanos = steadyNanos();
+    clock.sampleRate = sample_rate_;
+    clock.latencySamples = std::max(max_block_size_, numSamples);
+    clock_.store(clock);
+
+    // Drain the ring into the pending list (capacity reserved up front).
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t head = head_.load(std::memory_order_acquire);
+    while (tail != head && pending_.size() < pending_.capacity())
+    {
+        pending_.push_back(ring_[tail & (kRingCapacity - 1)]);
+        ++tail;
+    }
+    tail_.store(tail, std::memory_order_release);
+
+    if (pending_.empty() || numSamples <= 0)
+        return nullptr;
+
+    // Move points due in this block to due_; later points stay pending.
+    due_.clear();
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < pending_.size(); ++i)
+    {
+        if (pending_[i].sampleTime < blockEnd)
+            due_.push_back(pending_[i]);
+        else
+            pending_[kept++] = pending_[i];
+    }
+    pending_.resize(kept);
 
-    std::lock_guard<std::mutex> lock(access_mutex_);
+    if (due_.empty())
+        return nullptr;
 
-    parameter_changes_.clearQueue();
-    parameter_changes_.setMaxParameters(static_cast<Steinberg::int32>(change_buffer_.size()));
+    std::sort(due_.begin(), due_.end(), [](const ParameterPoint& a, const ParameterPoint& b) {
+        if (a.id != b.id)
+            return a.id < b.id;
+        if (a.sampleTime != b.sampleTime)
+            return a.sampleTime < b.sampleTime;
+        return a.sequence < b.sequence;
+    });
 
-    for (const auto& change : change_buffer_)
+    changes_.clear();
+    PointQueue* queue = nullptr;
+    PointQueue* guiQueue = nullptr;
+    ParamID queueId = kNoParamId;
+    for (const auto& point : due_)
     {
-        Steinberg::int32 index = 0;
-        if (auto* queue = parameter_changes_.addParameterData(change.id, index))
+        if (!queue || point.id != queueId)
         {
-            queue->addPoint(change.sampleOffset, change.value, index);
+            queueId = point.id;
+            queue = changes_.append(point.id);
+            guiQueue = nullptr;
+        }
+        if (!queue)
+        {
+            dropped_points_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        const std::int64_t offset = std::clamp<std::int64_t>(
+            point.sampleTime == kAsSoonAsPossible ? 0 : point.sampleTime - blockStart, 0, numSamples - 1);
+        queue->append(static_cast<int32>(offset), point.value);
+
+        if (point.fromGui)
+        {
+            if (!guiQueue)
+                guiQueue = gui_changes_.append(point.id);
+            if (guiQueue)
+                guiQueue->append(static_cast<int32>(offset), point.value);
         }
     }
 
-    change_buffer_.clear();
-    is_dirty_.store(false, std::memory_order_release);
+    return changes_.getParameterCount() > 0 ? &changes_ : nullptr;
+}
 
-    if (parameter_changes_.getParameterCount() > 0)
-        data.inputParameterChanges = &parameter_changes_;
+void VstParameterQueue::apply_to_audio_processor(ProcessData& data)
+{
+    data.inputParameterChanges = collect_block(data.numSamples);
+    output_changes_.clear();
+    data.outputParameterChanges = &output_changes_;
 }
 
-} // namespace kj
+IParameterChanges* VstParameterQueue::take_gui_changes()
+{
+    if (!gui_changes_pending_)
+        return nullptr;
+    gui_changes_pending_ = false;
+    return gui_changes_.getParameterCount() > 0 ? &gui_changes_ : nullptr;
+}
 
+IParameterChanges* VstParameterQueue::output_changes()
+{
+    return output_changes_.getParameterCount() > 0 ? &output_changes_ : nullptr;
+}
+
+} // namespace kj
@@ -0,0 +1,140 @@
+#include "hosting/AutomationLane.h"
+#include "hosting/VstParameterQueue.h"
+#include "core/tests/TestSupport.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace {
+
+IParamValueQueue* findQueue(IParameterChanges* changes, ParamID id)
+{
+    if (!changes)
+        return nullptr;
+    for (int32 i = 0; i < changes->getParameterCount(); ++i)
+    {
+        auto* queue = changes->getParameterData(i);
+        if (queue && queue->getParameterId() == id)
+            return queue;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+int main()
+{
+    kj::AutomationLane lane;
+    lane.paramId = 5;
+    lane.points = {{1.0, 0.0f}, {3.0, 1.0f}, {4.0, 0.5f}};
+    size_t hint = 0;
+    if (!expect(lane.valueAt(0.0, hint) == 0.0f && lane.valueAt(2.0, hint) == 0.5f &&
+                    lane.valueAt(3.5, hint) == 0.75f && lane.valueAt(9.0, hint) == 0.5f,
+                "Expected held ends and linear segments."))
+        return 1;
+    if (!expect(lane.valueAt(1.5, hint) == 0.25f, "Expected a jump backwards to find its segment again."))
+        return 1;
+
+    // A dense linear ramp thins to its end points; a dense sine keeps its
+    // shape within the tolerance.
+    std::vector<kj::AutomationPoint> ramp;
+    for (int i = 0; i <= 1000; ++i)
+        ramp.push_back({i * 0.01, i / 1000.0f});
+    if (!expect(kj::thinAutomationPoints(ramp, 0.001f).size() == 2, "Expected a straight ramp to thin to two points."))
+        return 1;
+
+    constexpr float kTolerance = 0.002f;
+    std::vector<kj::AutomationPoint> sine;
+    for (int i = 0; i < 4800; ++i)
+        sine.push_back({i / 1200.0, 0.5f + 0.5f * static_cast<float>(std::sin(i * 0.005))});
+    kj::AutomationLane thinned;
+    thinned.points = kj::thinAutomationPoints(sine, kTolerance);
+    float worst = 0.0f;
+    hint = 0;
+    for (const auto& point : sine)
+        worst = std::max(worst, std::abs(thinned.valueAt(point.beat, hint) - point.value));
+    if (!expect(thinned.points.size() < sine.size() / 20 && worst <= kTolerance,
+                "Expected the sine to thin within tolerance."))
+        return 1;
+
+    // A take replaces the range it covers and leaves the rest alone.
+    kj::AutomationLanes lanes(1);
+    lanes[0].paramId = 9;
+    lanes[0].points = {{0.0, 0.2f}, {3.0, 0.2f}, {8.0, 0.2f}};
+    std::vector<kj::AutomationCapturePoint> take;
+    for (int i = 0; i <= 200; ++i)
+        take.push_back({9, 0.2f + 0.6f * (i / 200.0f), 2.0 + i * 0.01});
+    take.push_back({4, 0.7f, 1.0});
+    kj::mergeAutomationTake(lanes, take, kTolerance);
+    if (!expect(lanes.size() == 2 && lanes[0].paramId == 4 && lanes[1].paramId == 9,
+                "Expected a new lane in paramId order."))
+        return 1;
+    const auto& merged = lanes[1].points;
+    hint = 0;
+    if (!expect(merged.size() == 4 && merged[1].beat == 2.0 && merged[2].beat == 4.0 &&
+                    std::abs(lanes[1].valueAt(3.0, hint) - 0.5f) < 1e-4f && lanes[1].valueAt(8.0, hint) == 0.2f,
+                "Expected the take to replace beats 2 to 4 only."))
+        return 1;
+
+    std::vector<kj::AutomationPoint> decoded;
+    auto packed = kj::encodeAutomationPoints(merged);
+    if (!expect(packed.size() == merged.size() * 12 && kj::decodeAutomationPoints(packed, decoded) &&
+                    decoded.size() == merged.size() && decoded[2].beat == merged[2].beat &&
+                    decoded[2].value == merged[2].value,
+                "Expected packed points to round-trip."))
+        return 1;
+    packed.pop_back();
+    if (!expect(!kj::decodeAutomationPoints(packed, decoded), "Expected truncated points to be rejected."))
+        return 1;
+
+    kj::AutomationCaptureQueue capture;
+    for (size_t i = 0; i < kj::AutomationCaptureQueue::kCapacity + 3; ++i)
+        capture.push({1, 0.5f, static_cast<double>(i)});
+    kj::AutomationCapturePoint popped;
+    size_t count = 0;
+    while (capture.pop(popped))
+        ++count;
+    if (!expect(count == kj::AutomationCaptureQueue::kCapacity && capture.droppedPoints() == 3,
+                "Expected a full capture queue to count what it drops."))
+        return 1;
+
+    // The parameter queue reports GUI edits and output changes for recording
+    // and carries playback points without recording them.
+    kj::VstParameterQueue queue;
+    queue.prepare(4, 48000.0, 64);
+    queue.push_gui_change(2, 0.3);
+    queue.push_change(3, 0.6, 0);
+    queue.push_block_point(1, 0.9, 10);
+
+    ProcessData data {};
+    data.numSamples = 64;
+    queue.apply_to_audio_processor(data);
+    IParamValueQueue* played = findQueue(data.inputParameterChanges, 1);
+    int32 offset = -1;
+    ParamValue value = 0.0;
+    if (!expect(played && played->getPoint(0, offset, value) == kResultTrue && offset == 10 && value == 0.9 &&
+                    findQueue(data.inputParameterChanges, 2) && findQueue(data.inputParameterChanges, 3),
+                "Expected GUI, producer and playback points in the block."))
+        return 1;
+
+    IParameterChanges* gui = queue.take_gui_changes();
+    if (!expect(gui && gui->getParameterCount() == 1 && findQueue(gui, 2) && !queue.take_gui_changes(),
+                "Expected only the GUI edit to be reported, once."))
+        return 1;
+
+    int32 index = 0;
+    if (!expect(data.outputParameterChanges != nullptr && !queue.output_changes(),
+                "Expected an empty output queue for the processor."))
+        return 1;
+    IParamValueQueue* output = data.outputParameterChanges->addParameterData(7, index);
+    if (!expect(output && output->addPoint(5, 0.4, index) == kResultTrue && findQueue(queue.output_changes(), 7),
+                "Expected the processor's output changes to be readable."))
+        return 1;
+
+    std::cout << "[Test] Automation lane checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include "hosting/PluginDatabase.h"
+#include "hosting/PluginSandbox.h"
+#include "core/tests/TestSupport.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void writeFile(const std::filesystem::path& path, const std::string& contents)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+// One effect class named after the bundle; "crash" bundles abort the scanner.
+bool describeBundle(const std::filesystem::path& bundle, kj::PluginBundleInfo& info)
+{
+    const auto stem = bundle.stem().u8string();
+    if (stem.find("crash") != std::string::npos)
+        std::abort();
+
+    kj::PluginClassInfo cls;
+    cls.classId = std::string(32 - std::min<std::size_t>(32, stem.size()), '0') + stem.substr(0, 32);
+    cls.name = stem;
+    cls.category = "Audio Module Class";
+    cls.subCategories = "Fx";
+    cls.vendor = "KJ Tests";
+    cls.version = "1.0.0";
+    cls.latencySamples = static_cast<std::int32_t>(stem.size());
+
+    kj::PluginBusInfo output;
+    output.name = "Main Out";
+    output.direction = 1;
+    output.channelCount = 2;
+    output.arrangement = 3;
+    cls.buses.push_back(output);
+
+    info.classes.push_back(cls);
+    info.valid = true;
+    return true;
+}
+
+class ScanProcessor : public kj::SandboxProcessor {
+public:
+    bool load(const std::string&) override { return false; }
+    bool prepare(double, int) override { return false; }
+    void process(const kj::SandboxBlock&) override {}
+    bool saveState(std::vector<std::uint8_t>&) override { return false; }
+    bool loadState(const std::uint8_t*, std::size_t) override { return false; }
+    int latencySamples() const override { return 0; }
+    int parameterCount() const override { return 0; }
+
+    bool scan(const std::string& path, std::vector<std::uint8_t>& outDescription) override
+    {
+        kj::PluginBundleInfo info;
+        return describeBundle(std::filesystem::u8path(path), info) &&
+               kj::serializePluginBundleInfo(info, outDescription);
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (kj::isSandboxWorkerCommandLine(argc, argv))
+        return kj::runSandboxWorker(argc, argv, [] { return std::make_unique<ScanProcessor>(); });
+
+    const auto self = std::filesystem::absolute(argv[0]);
+    const auto root = std::filesystem::temp_directory_path() /
+                      ("kj_plugin_db_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    struct Cleanup {
+        std::filesystem::path path;
+        ~Cleanup()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(path, ec);
+        }
+    } cleanup{root};
+
+    const auto plugins = root / "VST3";
+    writeFile(plugins / "alpha.vst3", "alpha");
+    writeFile(plugins / "beta.vst3", "beta");
+    writeFile(plugins / "gamma.vst3" / "Contents" / "x86_64-win" / "gamma.vst3", "gamma");
+    writeFile(plugins / "gamma.vst3" / "Contents" / "Resources" / "knob.png", "png");
+    writeFile(plugins / "Vendor" / "delta.vst3", "delta");
+    writeFile(plugins / "readme.txt", "not a plug-in");
+
+    const auto bundles = kj::findVst3Bundles({plugins, root / "missing"});
+    if (!expect(bundles.size() == 4, "Expected four bundles without descending into bundle folders."))
+        return 1;
+
+    std::atomic<int> scans {0};
+    kj::PluginScanFunction countingScanner = [&scans](const std::filesystem::path& bundle, kj::PluginBundleInfo& info) {
+        ++scans;
+        return describeBundle(bundle, info);
+    };
+
+    const auto cacheFile = root / "cache" / "plugins.bin";
+    {
+        kj::PluginDatabase database(cacheFile);
+        if (!expect(!database.loadCache(), "Expected no cache before the first scan."))
+            return 1;
+        if (!expect(database.refresh(bundles, countingScanner, 4) == 4 && scans == 4,
+                    "Expected every bundle to be scanned once."))
+            return 1;
+        auto gamma = database.findBundle(plugins / "gamma.vst3");
+        if (!expect(gamma && gamma->valid && gamma->classes.size() == 1 && gamma->classes[0].name == "gamma" &&
+                        gamma->classes[0].buses.size() == 1 && gamma->classes[0].latencySamples == 5,
+                    "Expected the bundle folder to be described."))
+            return 1;
+        if (!expect(database.saveCache(), "Expected the cache to be written."))
+            return 1;
+    }
+
+    kj::PluginDatabase database(cacheFile);
+    if (!expect(database.loadCache() && database.bundles().size() == 4, "Expected the cache to load four bundles."))
+        return 1;
+    auto delta = database.findClass(std::string(27, '0') + "delta");
+    if (!expect(delta && delta->classes[0].vendor == "KJ Tests", "Expected a class lookup without rescanning."))
+        return 1;
+
+    scans = 0;
+    if (!expect(database.refresh(bundles, countingScanner) == 0 && scans == 0,
+                "Expected unchanged bundles to come from the cache."))
+        return 1;
+
+    // Artwork does not invalidate a bundle; a new binary does.
+    writeFile(plugins / "gamma.vst3" / "Contents" / "Resources" / "knob.png", "bigger png");
+    writeFile(plugins / "beta.vst3", "beta, rebuilt");
+    if (!expect(database.refresh(bundles, countingScanner) == 1 && scans == 1,
+                "Expected only the modified bundle to be rescanned."))
+        return 1;
+
+    std::filesystem::remove(plugins / "alpha.vst3");
+    if (!expect(database.refresh(kj::findVst3Bundles({plugins}), countingScanner) == 0 &&
+                    database.bundles().size() == 3 && !database.findBundle(plugins / "alpha.vst3"),
+                "Expected removed bundles to be dropped."))
+        return 1;
+
+    // Out-of-process scanning: a crashing plug-in only fails its own entry
+    // and is not retried while unchanged.
+    writeFile(plugins / "crash.vst3", "crash");
+    const auto withCrash = kj::findVst3Bundles({plugins});
+    kj::PluginDatabase sandboxed(root / "sandboxed.bin");
+    const auto sandboxScanner = kj::makeSandboxedPluginScanner(self);
+    bool finished = false;
+    std::size_t scannedAsync = 0;
+    if (!expect(sandboxed.refreshAsync(withCrash, sandboxScanner,
+                                       [&](std::size_t scanned) {
+                                           scannedAsync = scanned;
+                                           finished = true;
+                                       },
+                                       2),
+                "Expected the background scan to start."))
+        return 1;
+    sandboxed.waitForScan();
+    if (!expect(finished && scannedAsync == 4, "Expected the background scan to cover every bundle."))
+        return 1;
+
+    auto crash = sandboxed.findBundle(plugins / "crash.vst3");
+    auto beta = sandboxed.findBundle(plugins / "beta.vst3");
+    if (!expect(crash && !crash->valid && !crash->error.empty(), "Expected the crashing bundle to be recorded."))
+        return 1;
+    if (!expect(beta && beta->valid && beta->classes.size() == 1 && beta->classes[0].name == "beta",
+                "Expected the other bundles to scan in their workers."))
+        return 1;
+
+    kj::PluginDatabase reloaded(root / "sandboxed.bin");
+    if (!expect(reloaded.loadCache() && reloaded.refresh(withCrash, sandboxScanner) == 0,
+                "Expected the failed scan to be cached."))
+        return 1;
+
+    std::cout << "[Test] Plug-in database checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,321 @@
+#include "hosting/PluginSandbox.h"
+#include "core/tests/TestSupport.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int kBlockSize = 256;
+constexpr ParamID kGainParameter = 1;
+constexpr int16 kCrashPitch = 127;
+constexpr auto kSlowRender = std::chrono::milliseconds(20);
+
+// Writes an impulse of the note velocity (times the gain parameter) at each
+// note-on. Loaded as "crash" it aborts the worker on note 127; loaded as
+// "slow" it takes kSlowRender over its first block.
+class ImpulseProcessor : public kj::SandboxProcessor {
+public:
+    bool load(const std::string& path) override
+    {
+        crashOnNote_ = path == "crash";
+        slow_ = path == "slow";
+        return path == "impulse" || crashOnNote_ || slow_;
+    }
+
+    bool prepare(double, int) override { return true; }
+
+    void process(const kj::SandboxBlock& block) override
+    {
+        if (slow_)
+        {
+            std::this_thread::sleep_for(kSlowRender);
+            slow_ = false;
+        }
+        for (std::size_t i = 0; i < block.pointCount; ++i)
+        {
+            if (block.points[i].id == kGainParameter)
+                gain_ = static_cast<float>(block.points[i].value);
+        }
+
+        for (std::size_t i = 0; i < block.eventCount; ++i)
+        {
+            const auto& event = block.events[i];
+            if (event.type != Event::kNoteOnEvent)
+                continue;
+            if (crashOnNote_ && event.noteOn.pitch == kCrashPitch)
+                std::abort();
+            const int offset = std::clamp<int>(event.sampleOffset, 0, block.numSamples - 1);
+            for (int ch = 0; ch < block.numChannels; ++ch)
+                block.outputs[ch][offset] += event.noteOn.velocity * gain_;
+        }
+    }
+
+    bool saveState(std::vector<uint8_t>& outState) override
+    {
+        outState.resize(sizeof(gain_));
+        std::memcpy(outState.data(), &gain_, sizeof(gain_));
+        return true;
+    }
+
+    bool loadState(const uint8_t* data, std::size_t size) override
+    {
+        if (size != sizeof(gain_))
+            return false;
+        std::memcpy(&gain_, data, sizeof(gain_));
+        return true;
+    }
+
+    int latencySamples() const override { return 0; }
+    int parameterCount() const override { return 1; }
+
+private:
+    float gain_ = 1.0f;
+    bool slow_ = false;
+    bool crashOnNote_ = false;
+};
+
+// One parameter point at offset 0; enough to exercise the parameter path.
+class SinglePointQueue : public IParamValueQueue {
+public:
+    SinglePointQueue(ParamID id, ParamValue value) : id_(id), value_(value) {}
+
+    tresult PLUGIN_API queryInterface(const TUID, void** obj) override
+    {
+        *obj = nullptr;
+        return kNoInterface;
+    }
+    uint32 PLUGIN_API addRef() override { return 1; }
+    uint32 PLUGIN_API release() override { return 1; }
+
+    ParamID PLUGIN_API getParameterId() override { return id_; }
+    int32 PLUGIN_API getPointCount() override { return 1; }
+    tresult PLUGIN_API getPoint(int32 index, int32& sampleOffset, ParamValue& value) override
+    {
+        if (index != 0)
+            return kResultFalse;
+        sampleOffset = 0;
+        value = value_;
+        return kResultOk;
+    }
+    tresult PLUGIN_API addPoint(int32, ParamValue, int32&) override { return kResultFalse; }
+
+private:
+    ParamID id_;
+    ParamValue value_;
+};
+
+class SingleParameterChanges : public IParameterChanges {
+public:
+    explicit SingleParameterChanges(SinglePointQueue& queue) : queue_(queue) {}
+
+    tresult PLUGIN_API queryInterface(const TUID, void** obj) override
+    {
+        *obj = nullptr;
+        return kNoInterface;
+    }
+    uint32 PLUGIN_API addRef() override { return 1; }
+    uint32 PLUGIN_API release() override { return 1; }
+
+    int32 PLUGIN_API getParameterCount() override { return 1; }
+    IParamValueQueue* PLUGIN_API getParameterData(int32 index) override { return index == 0 ? &queue_ : nullptr; }
+    IParamValueQueue* PLUGIN_API addParameterData(const ParamID&, int32&) override { return nullptr; }
+
+private:
+    SinglePointQueue& queue_;
+};
+
+Event makeNoteOn(int16 pitch, float velocity, int32 sampleOffset = 0)
+{
+    Event event {};
+    event.sampleOffset = sampleOffset;
+    event.type = Event::kNoteOnEvent;
+    event.noteOn.pitch = pitch;
+    event.noteOn.velocity = velocity;
+    event.noteOn.noteId = -1;
+    return event;
+}
+
+// Runs the plug-in one frame at a time, the way the engine does, and returns
+// the left channel.
+std::vector<float> renderFrames(kj::SandboxedPlugin& plugin, int frames, int noteFrame, float velocity)
+{
+    std::vector<float> rendered(static_cast<std::size_t>(frames), 0.0f);
+    kj::SandboxTransport transport;
+    transport.playing = true;
+    for (int i = 0; i < frames; ++i)
+    {
+        float left = 0.0f;
+        float right = 0.0f;
+        float* outputs[2] = {&left, &right};
+        const Event note = makeNoteOn(60, velocity);
+        transport.samplePosition = i;
+        plugin.process(outputs, 2, 1, &note, i == noteFrame ? 1 : 0, transport);
+        rendered[static_cast<std::size_t>(i)] = left;
+    }
+    return rendered;
+}
+
+int findImpulse(const std::vector<float>& samples)
+{
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+        if (samples[i] != 0.0f)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (kj::isSandboxWorkerCommandLine(argc, argv))
+        return kj::runSandboxWorker(argc, argv, [] { return std::make_unique<ImpulseProcessor>(); });
+
+    const auto self = std::filesystem::absolute(argv[0]);
+    auto worker = kj::PluginSandboxProcess::launch(self);
+    if (!expect(worker != nullptr, "Expected the sandbox worker to start."))
+        return 1;
+
+    // Two plug-ins share one worker process.
+    kj::SandboxedPlugin first(worker);
+    kj::SandboxedPlugin second(worker);
+    if (!expect(first.valid() && second.valid() && worker->freeSlotCount() == kj::kSandboxMaxSlots - 2,
+                "Expected two slots in one worker."))
+        return 1;
+    if (!expect(first.load("impulse") && second.load("impulse"), "Expected both plug-ins to load."))
+        return 1;
+    {
+        kj::SandboxedPlugin missing(worker);
+        if (!expect(!missing.load("missing"), "Expected an unknown plug-in to fail to load."))
+            return 1;
+    }
+    if (!expect(first.prepare(kSampleRate, kBlockSize) && second.prepare(kSampleRate, kBlockSize),
+                "Expected both plug-ins to prepare."))
+        return 1;
+    if (!expect(first.latencySamples() <= kBlockSize, "Expected the sandbox to add at most one block of latency."))
+        return 1;
+
+    // A note queued at frame n is heard at frame n + one block.
+    auto firstOut = renderFrames(first, 8 * kBlockSize, 10, 0.5f);
+    auto secondOut = renderFrames(second, 8 * kBlockSize, 100, 0.25f);
+    if (!expect(findImpulse(firstOut) == 10 + kBlockSize && firstOut[10 + kBlockSize] == 0.5f,
+                "Expected the first impulse one block after its note."))
+        return 1;
+    if (!expect(findImpulse(secondOut) == 100 + kBlockSize && secondOut[100 + kBlockSize] == 0.25f,
+                "Expected the second impulse one block after its note."))
+        return 1;
+
+    // State round trip through the worker.
+    const float gain = 2.0f;
+    std::vector<uint8_t> state(sizeof(gain));
+    std::memcpy(state.data(), &gain, sizeof(gain));
+    std::vector<uint8_t> saved;
+    if (!expect(first.loadState(state.data(), state.size()) && first.saveState(saved) && saved == state,
+                "Expected plug-in state to round-trip."))
+        return 1;
+
+    // Parameter points reach the worker with the block they belong to.
+    SinglePointQueue gainPoint(kGainParameter, 0.25);
+    SingleParameterChanges gainChanges(gainPoint);
+    first.setParameterSource([&gainChanges](int) -> IParameterChanges* { return &gainChanges; });
+    firstOut = renderFrames(first, 4 * kBlockSize, 5, 1.0f);
+    int impulse = findImpulse(firstOut);
+    if (!expect(impulse >= 0 && firstOut[static_cast<std::size_t>(impulse)] == 0.25f,
+                "Expected the gain parameter to apply to the sandboxed block."))
+        return 1;
+    first.setParameterSource({});
+
+    // Events keep their offset within a block-sized call.
+    std::vector<float> left(kBlockSize);
+    std::vector<float> right(kBlockSize);
+    float* outputs[2] = {left.data(), right.data()};
+    const Event offsetNote = makeNoteOn(60, 1.0f, 20);
+    second.process(outputs, 2, kBlockSize, &offsetNote, 1, kj::SandboxTransport {});
+    second.process(outputs, 2, kBlockSize, nullptr, 0, kj::SandboxTransport {});
+    if (!expect(findImpulse(left) == 20, "Expected a block-sized call to keep the event offset."))
+        return 1;
+
+    // One exchange per block-sized call.
+    const auto exchangesBefore = second.exchangeCount();
+    for (int block = 0; block < 500; ++block)
+        second.process(outputs, 2, kBlockSize, nullptr, 0, kj::SandboxTransport {});
+    if (!expect(second.exchangeCount() - exchangesBefore == 500 && second.missedBlockCount() == 0,
+                "Expected one exchange per block."))
+        return 1;
+    std::cout << "[Test] Sandbox round trip: average " << second.averageRoundTripMicros() << " us, max "
+              << second.maxRoundTripMicros() << " us (render average " << second.averageRenderMicros()
+              << " us) for " << kBlockSize << "-sample blocks (" << (0.5e6 * kBlockSize / kSampleRate)
+              << " us wait budget)." << std::endl;
+
+    // A worker that falls behind costs silence, not a wait past the budget,
+    // and the notes and parameter points queued meanwhile still reach it.
+    auto slowWorker = kj::PluginSandboxProcess::launch(self);
+    if (!expect(slowWorker != nullptr, "Expected a worker for the slow plug-in to start."))
+        return 1;
+    kj::SandboxedPlugin slow(slowWorker);
+    if (!expect(slow.load("slow") && slow.prepare(kSampleRate, kBlockSize), "Expected the slow plug-in to load."))
+        return 1;
+    // The source drains its queue: the point it hands out during the miss is
+    // only seen once.
+    SinglePointQueue slowGainPoint(kGainParameter, 0.25);
+    SingleParameterChanges slowGainChanges(slowGainPoint);
+    int sourceCalls = 0;
+    slow.setParameterSource(
+        [&](int) -> IParameterChanges* { return ++sourceCalls == 2 ? &slowGainChanges : nullptr; });
+    const Event slowNote = makeNoteOn(60, 1.0f, 30);
+    const auto callsStart = std::chrono::steady_clock::now();
+    for (int block = 0; block < 3; ++block)
+        slow.process(outputs, 2, kBlockSize, block == 1 ? &slowNote : nullptr, block == 1 ? 1 : 0,
+                     kj::SandboxTransport {});
+    const auto callsTook = std::chrono::steady_clock::now() - callsStart;
+    if (!expect(callsTook < kSlowRender && slow.missedBlockCount() == 2 && findImpulse(left) < 0,
+                "Expected a late block to play as silence without waiting for it."))
+        return 1;
+    std::this_thread::sleep_for(2 * kSlowRender);
+    slow.process(outputs, 2, kBlockSize, nullptr, 0, kj::SandboxTransport {});
+    if (!expect(findImpulse(left) == 0 && left[0] == 0.25f,
+                "Expected the note and gain point held during a miss to play once the worker caught up."))
+        return 1;
+
+    // A crashing plug-in takes down only its own worker.
+    auto crashWorker = kj::PluginSandboxProcess::launch(self);
+    if (!expect(crashWorker != nullptr, "Expected a second worker to start."))
+        return 1;
+    kj::SandboxedPlugin crashing(crashWorker);
+    if (!expect(crashing.load("crash") && crashing.prepare(kSampleRate, kBlockSize), "Expected the crash plug-in to load."))
+        return 1;
+
+    const Event crashNote = makeNoteOn(kCrashPitch, 1.0f);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    bool sentCrash = false;
+    while (!crashing.crashed() && std::chrono::steady_clock::now() < deadline)
+    {
+        crashing.process(outputs, 2, kBlockSize, &crashNote, sentCrash ? 0 : 1, kj::SandboxTransport {});
+        sentCrash = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!expect(crashing.crashed(), "Expected the crashed worker to be detected."))
+        return 1;
+    crashing.process(outputs, 2, kBlockSize, nullptr, 0, kj::SandboxTransport {});
+    if (!expect(left[0] == 0.0f && !crashing.saveState(saved), "Expected a crashed plug-in to stay silent."))
+        return 1;
+
+    secondOut = renderFrames(second, 4 * kBlockSize, 3, 0.75f);
+    if (!expect(worker->alive() && findImpulse(secondOut) >= 0, "Expected the other worker to keep running."))
+        return 1;
+
+    std::cout << "[Test] Plug-in sandbox checks passed." << std::endl;
+    return 0;
+}
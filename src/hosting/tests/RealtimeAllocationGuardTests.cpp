@@ -0,0 +1,72 @@
+#include "hosting/RealtimeAllocationGuard.h"
+#include "hosting/VstParameterQueue.h"
+#include "core/tests/TestSupport.h"
+
+#include "public.sdk/source/vst/hosting/eventlist.h"
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+int main()
+{
+    auto violations = kj::RealtimeAllocationGuard::violationCount();
+    {
+        kj::RealtimeAllocationGuard guard;
+        auto leaked = std::make_unique<std::vector<int>>(16);
+        leaked->push_back(1);
+    }
+    if (!expect(kj::RealtimeAllocationGuard::violationCount() > violations, "Expected allocations inside a guard to be counted."))
+        return 1;
+
+    violations = kj::RealtimeAllocationGuard::violationCount();
+    {
+        std::vector<int> outside(64);
+        kj::RealtimeAllocationGuard guard;
+        {
+            kj::RealtimeAllocationExemption pluginCode;
+            std::vector<int> exempt(64);
+        }
+        outside[0] = 1;
+    }
+    if (!expect(kj::RealtimeAllocationGuard::violationCount() == violations,
+                "Expected exempt and unguarded allocations to be ignored."))
+        return 1;
+
+    // The host's block path: parameter points and a preallocated event list.
+    kj::VstParameterQueue queue;
+    queue.prepare(8, 48000.0, 64);
+    EventList events;
+    events.setMaxSize(512);
+
+    violations = kj::RealtimeAllocationGuard::violationCount();
+    int delivered = 0;
+    for (int block = 0; block < 32; ++block)
+    {
+        queue.push_change(static_cast<ParamID>(block % 8), 0.5, block * 64 + 3);
+        kj::RealtimeAllocationGuard guard;
+        events.clear();
+        for (int i = 0; i < 512; ++i)
+        {
+            Event ev {};
+            ev.type = Event::kNoteOnEvent;
+            ev.sampleOffset = i % 64;
+            events.addEvent(ev);
+        }
+        ProcessData data {};
+        data.numSamples = 64;
+        queue.apply_to_audio_processor(data);
+        if (data.inputParameterChanges)
+            delivered += data.inputParameterChanges->getParameterCount();
+    }
+    if (!expect(kj::RealtimeAllocationGuard::violationCount() == violations && delivered == 32 &&
+                    events.getEventCount() == 512,
+                "Expected the block path to run without allocating."))
+        return 1;
+
+    std::cout << "[Test] Realtime allocation guard checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "hosting/VstParameterQueue.h"
+#include "core/tests/TestSupport.h"
+
+#include <iostream>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace {
+
+IParamValueQueue* findQueue(IParameterChanges* changes, ParamID id)
+{
+    if (!changes)
+        return nullptr;
+    for (int32 i = 0; i < changes->getParameterCount(); ++i)
+    {
+        auto* queue = changes->getParameterData(i);
+        if (queue && queue->getParameterId() == id)
+            return queue;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+int main()
+{
+    kj::VstParameterQueue queue;
+    queue.prepare(4, 48000.0, 256);
+
+    // Points in the first block, out of order and with a duplicate offset.
+    queue.push_change(7, 0.50, 100);
+    queue.push_change(7, 0.25, 10);
+    queue.push_change(3, 0.90, 0);
+    queue.push_change(7, 0.75, 100);
+    // Due in the second block.
+    queue.push_change(7, 1.00, 300);
+
+    IParameterChanges* changes = queue.collect_block(256);
+    if (!expect(changes && changes->getParameterCount() == 2, "Expected two parameter queues in the first block."))
+        return 1;
+
+    IParamValueQueue* ramp = findQueue(changes, 7);
+    if (!expect(ramp && ramp->getPointCount() == 2, "Expected parameter 7 to be coalesced into two points."))
+        return 1;
+
+    int32 offset = -1;
+    ParamValue value = -1.0;
+    ramp->getPoint(0, offset, value);
+    if (!expect(offset == 10 && value == 0.25, "Expected first ramp point at offset 10."))
+        return 1;
+    ramp->getPoint(1, offset, value);
+    if (!expect(offset == 100 && value == 0.75, "Expected the latest value at offset 100."))
+        return 1;
+
+    changes = queue.collect_block(256);
+    ramp = findQueue(changes, 7);
+    if (!expect(ramp && ramp->getPointCount() == 1, "Expected the deferred point in the second block."))
+        return 1;
+    ramp->getPoint(0, offset, value);
+    if (!expect(offset == 300 - 256 && value == 1.0, "Expected the deferred point at its in-block offset."))
+        return 1;
+
+    if (!expect(queue.collect_block(256) == nullptr, "Expected no changes once the queue is drained."))
+        return 1;
+
+    // A dense sweep keeps its final value even when it exceeds the point budget.
+    for (int i = 0; i < 200; ++i)
+        queue.push_change(1, i / 199.0, 768 + i);
+    changes = queue.collect_block(256);
+    ramp = findQueue(changes, 1);
+    if (!expect(ramp && ramp->getPointCount() == kj::VstParameterQueue::kMaxPointsPerParameter,
+                "Expected the sweep to be capped at the point budget."))
+        return 1;
+    ramp->getPoint(ramp->getPointCount() - 1, offset, value);
+    if (!expect(offset == 199 && value == 1.0, "Expected the sweep to end on its last point."))
+        return 1;
+
+    std::cout << "[Test] VstParameterQueue ramp and coalescing checks passed." << std::endl;
+    return 0;
+}